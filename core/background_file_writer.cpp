@@ -0,0 +1,92 @@
+// (C) Averisera Ltd 2014-2020
+#include "background_file_writer.hpp"
+#include "log.hpp"
+#include <fstream>
+#include <stdexcept>
+
+namespace averisera {
+    BackgroundFileWriter::BackgroundFileWriter()
+        : nbr_pending_(0), stopping_(false) {
+        worker_ = std::thread([this]() { work(); });
+    }
+
+    BackgroundFileWriter::~BackgroundFileWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_available_.notify_all();
+        worker_.join();
+        if (first_error_) {
+            try {
+                std::rethrow_exception(first_error_);
+            } catch (std::exception& e) {
+                LOG_ERROR() << "BackgroundFileWriter: " << e.what();
+            }
+        }
+    }
+
+    void BackgroundFileWriter::write(const std::string& filename, std::string content, bool append) {
+        write(filename, [content = std::move(content)](std::ostream& os) { os << content; }, append);
+    }
+
+    void BackgroundFileWriter::write(const std::string& filename, content_writer_type content_writer, bool append) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push(Task{ filename, std::move(content_writer), append });
+            ++nbr_pending_;
+        }
+        task_available_.notify_one();
+    }
+
+    void BackgroundFileWriter::flush() {
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            tasks_finished_.wait(lock, [this]() { return nbr_pending_ == 0; });
+            std::swap(error, first_error_);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void BackgroundFileWriter::work() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return; // stopping
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            std::exception_ptr error;
+            try {
+                std::ofstream ofs(task.filename, task.append ? std::ios_base::app : std::ios_base::out);
+                if (!ofs) {
+                    throw std::runtime_error(std::string("BackgroundFileWriter: cannot open file ") + task.filename);
+                }
+                task.content_writer(ofs);
+                ofs.flush();
+                if (!ofs) {
+                    throw std::runtime_error(std::string("BackgroundFileWriter: error writing to file ") + task.filename);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (error && !first_error_) {
+                    first_error_ = error;
+                }
+                --nbr_pending_;
+                if (nbr_pending_ == 0) {
+                    tasks_finished_.notify_all();
+                }
+            }
+        }
+    }
+}
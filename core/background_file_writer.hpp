@@ -0,0 +1,65 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_BACKGROUND_FILE_WRITER_H
+#define __AVERISERA_BACKGROUND_FILE_WRITER_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <queue>
+#include <string>
+#include <thread>
+
+namespace averisera {
+    /** @brief Writes text to files on a background thread, so that the caller does not block on disk I/O.
+    Writes are performed in the order in which they were submitted. */
+    class BackgroundFileWriter {
+    public:
+        /** Function which writes the content to the stream on the background thread */
+        typedef std::function<void(std::ostream&)> content_writer_type;
+
+        /** Starts the writer thread */
+        BackgroundFileWriter();
+
+        BackgroundFileWriter(const BackgroundFileWriter&) = delete;
+        BackgroundFileWriter& operator=(const BackgroundFileWriter&) = delete;
+
+        /** Finishes all pending writes and joins the writer thread. Errors are logged. */
+        ~BackgroundFileWriter();
+
+        /** Schedule writing content to file.
+        @param append If true, append to the file, otherwise overwrite it.
+        */
+        void write(const std::string& filename, std::string content, bool append);
+
+        /** Schedule writing the output of content_writer to file, so that formatting the content also happens on the background thread.
+        content_writer must not refer to data which can change before flush() returns. Exceptions it throws are reported as write errors.
+        @param append If true, append to the file, otherwise overwrite it.
+        */
+        void write(const std::string& filename, content_writer_type content_writer, bool append);
+
+        /** Block until all scheduled writes have finished.
+        @throw std::runtime_error If any write failed since the last call to flush(). */
+        void flush();
+    private:
+        struct Task {
+            std::string filename;
+            content_writer_type content_writer;
+            bool append;
+        };
+
+        void work();
+
+        std::thread worker_;
+        std::queue<Task> tasks_;
+        std::mutex mutex_;
+        std::condition_variable task_available_;
+        std::condition_variable tasks_finished_;
+        size_t nbr_pending_; /**< Number of scheduled writes which have not finished yet */
+        std::exception_ptr first_error_;
+        bool stopping_;
+    };
+}
+
+#endif // __AVERISERA_BACKGROUND_FILE_WRITER_H
@@ -0,0 +1,98 @@
+/*
+* (C) Averisera Ltd 2019
+*/
+#pragma once
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace averisera {
+	/** Thread-safe least-recently-used cache with a bounded number of stored objects, which creates missing objects on demand and counts cache hits and misses.
+	When the cache is full, storing a new object evicts the least recently used one; callers which still hold it keep it alive.
+	@tparam O Stored object type.
+	@tparam T Tag type used to label objects.
+	*/
+	template <class O, class T = std::string> class BoundedObjectCache {
+	public:
+		typedef T tag_t;
+		typedef O object_t;
+
+		/** @param max_size Maximum number of stored objects. Zero disables caching. */
+		explicit BoundedObjectCache(size_t max_size)
+			: max_size_(max_size), hits_(0), misses_(0) {}
+
+		BoundedObjectCache(const BoundedObjectCache&) = delete;
+		BoundedObjectCache& operator=(const BoundedObjectCache&) = delete;
+
+		/** Retrieve the object with given tag, creating it with factory() if it is not present.
+		@tparam F Functor returning std::shared_ptr<O>. Called without holding the lock.
+		*/
+		template <class F> std::shared_ptr<O> get(const T& tag, F factory) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				const auto iter = index_.find(tag);
+				if (iter != index_.end()) {
+					++hits_;
+					return touch(iter->second);
+				}
+			}
+			++misses_;
+			std::shared_ptr<O> object(factory());
+			if (!max_size_) {
+				return object;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			const auto iter = index_.find(tag);
+			if (iter != index_.end()) {
+				// Another thread got there first, return its object to keep them shared.
+				return touch(iter->second);
+			}
+			if (entries_.size() >= max_size_) {
+				index_.erase(entries_.back().first);
+				entries_.pop_back();
+			}
+			entries_.emplace_front(tag, object);
+			index_.insert(std::make_pair(tag, entries_.begin()));
+			return object;
+		}
+
+		/** Number of stored objects. */
+		size_t size() const {
+			std::lock_guard<std::mutex> lock(mutex_);
+			return entries_.size();
+		}
+
+		/** Maximum number of stored objects. */
+		size_t max_size() const {
+			return max_size_;
+		}
+
+		/** Number of calls to get() which found the object in the cache. */
+		size_t hits() const {
+			return hits_;
+		}
+
+		/** Number of calls to get() which had to create the object. */
+		size_t misses() const {
+			return misses_;
+		}
+	private:
+		typedef std::list<std::pair<T, std::shared_ptr<O>>> entry_list_t;
+
+		/** Move the entry to the front of the list (most recently used). Requires the lock. */
+		const std::shared_ptr<O>& touch(typename entry_list_t::iterator entry) {
+			entries_.splice(entries_.begin(), entries_, entry);
+			return entry->second;
+		}
+
+		entry_list_t entries_; /**< From the most to the least recently used */
+		std::unordered_map<T, typename entry_list_t::iterator> index_;
+		mutable std::mutex mutex_;
+		size_t max_size_;
+		std::atomic<size_t> hits_;
+		std::atomic<size_t> misses_;
+	};
+}
@@ -0,0 +1,33 @@
+// (C) Averisera Ltd 2014-2020
+#include "date_table.hpp"
+
+namespace averisera {
+	const unsigned int DateTable::FIRST_YEAR;
+	const unsigned int DateTable::LAST_YEAR;
+	const DateTable::day_number_type DateTable::FIRST_DAY;
+	const DateTable::day_number_type DateTable::LAST_DAY;
+
+	static_assert(DateTable::FIRST_DAY == DateTable::day_number_of_jan1(DateTable::FIRST_YEAR), "DateTable: wrong FIRST_DAY");
+	static_assert(DateTable::LAST_DAY == DateTable::day_number_of_jan1(DateTable::LAST_YEAR + 1) - 1, "DateTable: wrong LAST_DAY");
+
+	constexpr DateTable::Tables::Tables()
+		: jan1(), month(), month_start() {
+		for (unsigned int i = 0; i <= NBR_YEARS; ++i) {
+			jan1[i] = day_number_of_jan1(FIRST_YEAR + i);
+		}
+		const unsigned int month_lengths[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		for (unsigned int leap = 0; leap < 2; ++leap) {
+			unsigned int doy = 1;
+			for (unsigned int m = 1; m <= 12; ++m) {
+				month_start[leap][m] = static_cast<uint16_t>(doy);
+				const unsigned int len = month_lengths[m - 1] + (m == 2 ? leap : 0);
+				for (unsigned int d = 0; d < len; ++d) {
+					month[leap][doy + d] = static_cast<uint8_t>(m);
+				}
+				doy += len;
+			}
+		}
+	}
+
+	constexpr DateTable::Tables DateTable::tables_;
+}
@@ -0,0 +1,112 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_DATE_TABLE_H
+#define __AVERISERA_DATE_TABLE_H
+
+#include <cassert>
+#include <cstdint>
+
+namespace averisera {
+	/** @brief Precomputed Gregorian calendar tables over the 32-bit day numbers (Julian day numbers) used by Date.
+
+	Covers all years supported by Date. Converting a day number to year, day of year, month and day takes a multiplication
+	and a few table lookups instead of the general Gregorian calendar arithmetic. The tables are constant-initialised, so they can be used
+	during static initialisation.
+	*/
+	class DateTable {
+	public:
+		typedef uint32_t day_number_type;
+
+		/** First year in the tables */
+		static const unsigned int FIRST_YEAR = 1400;
+
+		/** Last year in the tables */
+		static const unsigned int LAST_YEAR = 9999;
+
+		static constexpr bool is_leap(unsigned int year) {
+			return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+		}
+
+		/** Day number of 1 January of the year */
+		static constexpr day_number_type day_number_of_jan1(unsigned int year) {
+			return static_cast<day_number_type>(365 * (year - 1) + (year - 1) / 4 - (year - 1) / 100 + (year - 1) / 400 + 1721426);
+		}
+
+		/** First day number in the tables (1 January FIRST_YEAR) */
+		static const day_number_type FIRST_DAY = 2232400;
+
+		/** Last day number in the tables (31 December LAST_YEAR) */
+		static const day_number_type LAST_DAY = 5373484;
+
+		/** Is the day number covered by the tables */
+		static bool contains(day_number_type dn) {
+			return dn >= FIRST_DAY && dn <= LAST_DAY;
+		}
+
+		/** Year containing the day number.
+		@param dn Day number for which contains(dn) is true */
+		static unsigned int year(day_number_type dn) {
+			assert(contains(dn));
+			// average length of the Gregorian year is 146097 / 400 days, so the estimate is off by at most one year
+			unsigned int y = FIRST_YEAR + static_cast<unsigned int>((static_cast<uint64_t>(dn - FIRST_DAY) * 400) / 146097);
+			while (tables_.jan1[y - FIRST_YEAR] > dn) {
+				--y;
+			}
+			while (tables_.jan1[y + 1 - FIRST_YEAR] <= dn) {
+				++y;
+			}
+			return y;
+		}
+
+		/** Year and day of year (1 for 1 January) of the day number.
+		@param dn Day number for which contains(dn) is true */
+		static void year_day_of_year(day_number_type dn, unsigned int& year, unsigned int& day_of_year) {
+			year = DateTable::year(dn);
+			day_of_year = dn - tables_.jan1[year - FIRST_YEAR] + 1;
+		}
+
+		/** Month (1-12) and day of month (1-31) for a day of year (1-366) */
+		static void month_day(unsigned int day_of_year, bool leap, unsigned int& month, unsigned int& day) {
+			assert(day_of_year >= 1 && day_of_year <= (leap ? 366u : 365u));
+			month = tables_.month[leap][day_of_year];
+			day = day_of_year - tables_.month_start[leap][month] + 1;
+		}
+
+		/** Number of full years between dn1 and dn2 >= dn1, i.e. the maximum k such that Date(dn1) + Period::years(k) <= Date(dn2).
+		Adding years preserves the end of month (28 February in a common year is followed by 29 February in leap years) and moves 29 February to
+		28 February in common years.
+		@param dn1 Day number for which contains(dn1) is true
+		@param dn2 Day number for which contains(dn2) is true */
+		static unsigned int full_years(day_number_type dn1, day_number_type dn2) {
+			assert(dn1 <= dn2);
+			unsigned int y1, doy1, y2, doy2;
+			year_day_of_year(dn1, y1, doy1);
+			year_day_of_year(dn2, y2, doy2);
+			const bool leap1 = is_leap(y1);
+			const bool leap2 = is_leap(y2);
+			unsigned int anniversary; // day of year of the anniversary of dn1 in year y2
+			if (doy1 == 59u + leap1) {
+				// last day of February
+				anniversary = 59 + leap2;
+			} else if (doy1 < 60) {
+				anniversary = doy1;
+			} else {
+				anniversary = doy1 - leap1 + leap2;
+			}
+			return y2 - y1 - (doy2 < anniversary ? 1 : 0);
+		}
+	private:
+		static const unsigned int NBR_YEARS = LAST_YEAR - FIRST_YEAR + 1;
+
+		struct Tables {
+			constexpr Tables();
+
+			day_number_type jan1[NBR_YEARS + 1]; /**< Day numbers of 1 January of FIRST_YEAR, ..., LAST_YEAR + 1 */
+			uint8_t month[2][367]; /**< month[leap][day_of_year] */
+			uint16_t month_start[2][13]; /**< month_start[leap][month] is the day of year of the first day of month */
+		};
+
+		static const Tables tables_;
+	};
+}
+
+#endif // __AVERISERA_DATE_TABLE_H
@@ -15,9 +15,11 @@ namespace averisera {
     const Date Date::NAD = Date();
     const Date Date::POS_INF = Date(boost::gregorian::pos_infin);
     const Date Date::NEG_INF = Date(boost::gregorian::neg_infin);
-	const Date::year_type Date::MIN_YEAR = 1400;
+	static_assert(sizeof(Date) == sizeof(DateTable::day_number_type), "Date should be a 32-bit day number");
+
+	const Date::year_type Date::MIN_YEAR = DateTable::FIRST_YEAR;
     const Date Date::MIN = Date(Date::MIN_YEAR, 1, 1);
-	const Date::year_type Date::MAX_YEAR = 9999;
+	const Date::year_type Date::MAX_YEAR = DateTable::LAST_YEAR;
     const Date Date::MAX = Date(Date::MAX_YEAR, 12, 31);
 
 #ifndef NDEBUG
@@ -54,7 +56,7 @@ namespace averisera {
     }
 
     bool Date::is_leap(year_type year) {
-        return boost::gregorian::gregorian_calendar::is_leap_year(year);
+        return DateTable::is_leap(year);
     }
 
 	static Period::size_type dist_any_period(Date d1, const Date d2, const Period& period) {
@@ -69,6 +71,9 @@ namespace averisera {
 
 	static Period::size_type dist_years_(Date d1, Date d2) {
 		assert(d1 < d2);
+		if (DateTable::contains(d1.day_number()) && DateTable::contains(d2.day_number())) {
+			return static_cast<Period::size_type>(DateTable::full_years(d1.day_number(), d2.day_number()));
+		}
 		const auto diff_days = d1.dist_days(d2);
 		//LOG_TRACE() << "diff_days=" << diff_days;
 		assert(diff_days >= 0);
@@ -5,6 +5,7 @@
 #define __AVERISERA_DATES_H
 
 #include "dates_fwd.hpp"
+#include "date_table.hpp"
 #include <cmath>
 #include <iosfwd>
 #include <memory>
@@ -17,7 +18,8 @@
  */
 namespace averisera {
 
-	/** Date class - wrapper around boost::gregorian::date */
+	/** Date class - wrapper around boost::gregorian::date, stored as a 32-bit day number.
+	Year, month and day of normal dates are read from DateTable. */
 	class Date {
 	public:
 		typedef unsigned short int year_type; /**< Type for year number */
@@ -122,28 +124,65 @@ namespace averisera {
 		int dist_days(Date other) const;
 
 		bool is_leap() const {
-			return is_leap(impl_.year());
+			return is_leap(year());
 		}
 
 		year_type year() const {
-			return impl_.year();
+			const DateTable::day_number_type dn = day_number();
+			if (DateTable::contains(dn)) {
+				return static_cast<year_type>(DateTable::year(dn));
+			} else {
+				return impl_.year();
+			}
 		}
 
 		month_type month() const {
-			return impl_.month();
+			const DateTable::day_number_type dn = day_number();
+			if (DateTable::contains(dn)) {
+				unsigned int y, doy, m, d;
+				DateTable::year_day_of_year(dn, y, doy);
+				DateTable::month_day(doy, DateTable::is_leap(y), m, d);
+				return static_cast<month_type>(m);
+			} else {
+				return impl_.month();
+			}
 		}
 
 		day_type day() const {
-			return impl_.day();
+			const DateTable::day_number_type dn = day_number();
+			if (DateTable::contains(dn)) {
+				unsigned int y, doy, m, d;
+				DateTable::year_day_of_year(dn, y, doy);
+				DateTable::month_day(doy, DateTable::is_leap(y), m, d);
+				return static_cast<day_type>(d);
+			} else {
+				return impl_.day();
+			}
 		}
 
 		/** Which day of year it is. Return 1 for 1 Jan. */
 		uint16_t day_of_year() const {
-			return static_cast<uint16_t>(impl_.day_of_year());
+			const DateTable::day_number_type dn = day_number();
+			if (DateTable::contains(dn)) {
+				unsigned int y, doy;
+				DateTable::year_day_of_year(dn, y, doy);
+				return static_cast<uint16_t>(doy);
+			} else {
+				return static_cast<uint16_t>(impl_.day_of_year());
+			}
 		}
 
 		long julian_day() const {
-			return impl_.julian_day();
+			if (!is_special()) {
+				return static_cast<long>(day_number());
+			} else {
+				return impl_.julian_day();
+			}
+		}
+
+		/** Internal day number. Equal to julian_day() for normal dates. */
+		DateTable::day_number_type day_number() const {
+			return static_cast<DateTable::day_number_type>(impl_.day_number());
 		}
 
 		bool is_special() const {
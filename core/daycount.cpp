@@ -51,26 +51,15 @@ namespace averisera {
         double _basis;
     };
 
+    static double basis_for_year(unsigned int year) {
+        return DateTable::is_leap(year) ? 366.0 : 365.0;
+    }
+
     /** Fraction of years between dates */
     class YearFraction: public Daycount {
     public:
         double calc(Date d1, Date d2) const override {
-            assert(!d1.is_special());
-            assert(!d2.is_special());
-            if (d2 >= d1) {               
-                const auto y1 = d1.year();
-                const auto y2 = d2.year();
-                if (y2 > y1) {
-                    const long whole_part = std::max(y2 - y1 - 1, 0);
-					const double head_fract = 1.0 - static_cast<double>(d1.day_of_year() - 1) / basis_for_year(y1);
-                    const double tail_fract = static_cast<double>(d2.day_of_year() - 1) / basis_for_year(y2);
-                    return static_cast<double>(whole_part) + (head_fract + tail_fract);
-                } else {
-                    return static_cast<double>((d2 - d1).days()) / basis_for_year(y1);
-                }
-            } else {
-                return - calc(d2, d1);
-            }
+            return year_fract(d1, d2);
         }
 
         Date add_year_fraction(Date d1, double yfr) const override {
@@ -141,12 +130,28 @@ namespace averisera {
         void print(std::ostream& s) const override {
             s << "YEAR_FRACT";
         }
-    private:
-		inline static double basis_for_year(Date::year_type year) {
-            return Date::is_leap(year) ? 366.0 : 365.0;
-        }
     };
 
+    double Daycount::year_fract(const Date d1, const Date d2) {
+        assert(!d1.is_special());
+        assert(!d2.is_special());
+        if (d2 >= d1) {
+            unsigned int y1, doy1, y2, doy2;
+            DateTable::year_day_of_year(d1.day_number(), y1, doy1);
+            DateTable::year_day_of_year(d2.day_number(), y2, doy2);
+            if (y2 > y1) {
+                const long whole_part = static_cast<long>(y2 - y1 - 1);
+                const double head_fract = 1.0 - static_cast<double>(doy1 - 1) / basis_for_year(y1);
+                const double tail_fract = static_cast<double>(doy2 - 1) / basis_for_year(y2);
+                return static_cast<double>(whole_part) + (head_fract + tail_fract);
+            } else {
+                return static_cast<double>(d2.day_number() - d1.day_number()) / basis_for_year(y1);
+            }
+        } else {
+            return - year_fract(d2, d1);
+        }
+    }
+
 	/** Caches results of calc() */
 	class CachingDaycount : public Daycount {
 	public:
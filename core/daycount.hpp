@@ -43,6 +43,12 @@ namespace averisera {
          */
         static std::shared_ptr<const Daycount> YEAR_FRACT();
 
+        /** Equal to YEAR_FRACT()->calc(d1, d2), without the virtual call. Uses DateTable.
+          @param d1 Valid date
+          @param d2 Valid date
+        */
+        static double year_fract(Date d1, Date d2);
+
 		/** @throw std::runtime_error If str can't be parsed */
 		static std::shared_ptr<const Daycount> from_string(const char* str);
     };
@@ -0,0 +1,145 @@
+// (C) Averisera Ltd 2014-2020
+#include "memory_pool.hpp"
+#include "preconditions.hpp"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+
+namespace averisera {
+	static const size_t MAX_THREAD_CACHES = 16;
+
+	/** Caches of the pools used by this thread, most recently used first. Trivially destructible, so that pools can be destroyed
+	after the thread-local storage of the thread. */
+	struct ThreadCaches {
+		std::array<std::pair<uint64_t, void*>, MAX_THREAD_CACHES> entries;
+		size_t size;
+
+		std::pair<uint64_t, void*>* begin() {
+			return entries.data();
+		}
+
+		std::pair<uint64_t, void*>* end() {
+			return entries.data() + size;
+		}
+
+		std::pair<uint64_t, void*>* find(uint64_t id) {
+			return std::find_if(begin(), end(), [id](const std::pair<uint64_t, void*>& entry) { return entry.first == id; });
+		}
+	};
+
+	static thread_local ThreadCaches thread_caches = { {}, 0 };
+
+	static uint64_t next_pool_id() {
+		static std::atomic<uint64_t> last_id(0);
+		return ++last_id;
+	}
+
+	MemoryPool::ThreadCache::ThreadCache()
+		: next(nullptr), end(nullptr) {
+		free_lists.fill(nullptr);
+	}
+
+	MemoryPool::MemoryPool(size_t chunk_size)
+		: id_(next_pool_id()), chunk_size_(chunk_size), nbr_blocks_(0) {
+		check_that(chunk_size >= MAX_BLOCK_SIZE, "MemoryPool: chunk size too small");
+	}
+
+	MemoryPool::~MemoryPool() {
+		// Entries of other threads are left behind; they are never matched because pool ids are not reused.
+		const auto it = thread_caches.find(id_);
+		if (it != thread_caches.end()) {
+			std::copy(it + 1, thread_caches.end(), it);
+			--thread_caches.size;
+		}
+	}
+
+	MemoryPool::ThreadCache& MemoryPool::thread_cache() {
+		ThreadCaches& caches = thread_caches;
+		if (caches.size && caches.entries[0].first == id_) {
+			return *static_cast<ThreadCache*>(caches.entries[0].second);
+		}
+		const auto it = caches.find(id_);
+		if (it == caches.end()) {
+			std::unique_ptr<ThreadCache> new_cache(new ThreadCache());
+			ThreadCache* cache = new_cache.get();
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				caches_.push_back(std::move(new_cache));
+			}
+			if (caches.size < MAX_THREAD_CACHES) {
+				++caches.size;
+			} // otherwise forget the least recently used pool, which only leaves its cache idle
+			std::copy_backward(caches.begin(), caches.end() - 1, caches.end());
+			caches.entries[0] = std::make_pair(id_, static_cast<void*>(cache));
+		} else {
+			std::rotate(caches.begin(), it, it + 1);
+		}
+		return *static_cast<ThreadCache*>(caches.entries[0].second);
+	}
+
+	void MemoryPool::refill(ThreadCache& cache) {
+		// memory returned by new char[] is suitably aligned for any object
+		std::unique_ptr<char[]> chunk(new char[chunk_size_]);
+		cache.next = chunk.get();
+		cache.end = cache.next + chunk_size_;
+		std::lock_guard<std::mutex> lock(mutex_);
+		chunks_.push_back(std::move(chunk));
+	}
+
+	void* MemoryPool::allocate(const size_t size) {
+		assert(size > 0);
+		if (size > MAX_BLOCK_SIZE) {
+			void* ptr = ::operator new(size);
+			nbr_blocks_.fetch_add(1, std::memory_order_relaxed);
+			return ptr;
+		}
+		const size_t cls = size_class(size);
+		ThreadCache& cache = thread_cache();
+		FreeBlock*& head = cache.free_lists[cls];
+		nbr_blocks_.fetch_add(1, std::memory_order_relaxed);
+		if (head) {
+			FreeBlock* block = head;
+			head = block->next;
+			return block;
+		}
+		const size_t block_size = cls * ALIGNMENT;
+		if (static_cast<size_t>(cache.end - cache.next) < block_size) {
+			refill(cache);
+		}
+		void* ptr = cache.next;
+		cache.next += block_size;
+		return ptr;
+	}
+
+	void MemoryPool::deallocate(void* ptr, const size_t size) noexcept {
+		if (!ptr) {
+			return;
+		}
+		nbr_blocks_.fetch_sub(1, std::memory_order_relaxed);
+		if (size > MAX_BLOCK_SIZE) {
+			::operator delete(ptr);
+			return;
+		}
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+		ThreadCache* cache;
+		try {
+			cache = &thread_cache();
+		} catch (std::bad_alloc&) {
+			// cannot register this thread; the block stays unused until the pool is destroyed
+			return;
+		}
+		FreeBlock*& head = cache->free_lists[size_class(size)];
+		block->next = head;
+		head = block;
+	}
+
+	size_t MemoryPool::nbr_chunks() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return chunks_.size();
+	}
+
+	size_t MemoryPool::nbr_blocks() const {
+		return nbr_blocks_.load(std::memory_order_relaxed);
+	}
+}
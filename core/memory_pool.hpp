@@ -0,0 +1,136 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MEMORY_POOL_H
+#define __AVERISERA_MEMORY_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+namespace averisera {
+	/** @brief Thread-safe pool of small memory blocks carved out of large chunks.
+
+	Blocks are grouped in size classes (multiples of ALIGNMENT). Every thread using the pool gets its own cache with a free list per class and
+	a chunk it carves new blocks from, so allocation and deallocation do not lock. A freed block goes to the free list of the thread which
+	frees it, which is safe because chunks are released only when the pool is destroyed. The mutex is taken only to register a new thread
+	or to allocate a chunk. Blocks larger than MAX_BLOCK_SIZE are allocated with the global operator new.
+	*/
+	class MemoryPool {
+	public:
+		/** Alignment of every block */
+		static const size_t ALIGNMENT = alignof(std::max_align_t);
+
+		/** Maximum size of a block allocated from the chunks */
+		static const size_t MAX_BLOCK_SIZE = 1024;
+
+		/** @param chunk_size Size of the chunks allocated from the system
+		@throw std::domain_error If chunk_size < MAX_BLOCK_SIZE
+		*/
+		explicit MemoryPool(size_t chunk_size = 1 << 20);
+
+		~MemoryPool();
+
+		MemoryPool(const MemoryPool&) = delete;
+		MemoryPool& operator=(const MemoryPool&) = delete;
+
+		/** Allocate a block of at least size bytes (size > 0), aligned to ALIGNMENT.
+		@throw std::bad_alloc If memory cannot be allocated
+		*/
+		void* allocate(size_t size);
+
+		/** Return a block obtained from allocate(size) with the same size */
+		void deallocate(void* ptr, size_t size) noexcept;
+
+		/** Number of chunks allocated from the system */
+		size_t nbr_chunks() const;
+
+		/** Number of blocks allocated and not yet returned */
+		size_t nbr_blocks() const;
+	private:
+		static size_t size_class(size_t size) {
+			return (size + ALIGNMENT - 1) / ALIGNMENT;
+		}
+
+		/** Intrusive free list node stored in a free block */
+		struct FreeBlock {
+			FreeBlock* next;
+		};
+
+		/** Blocks owned by a single thread */
+		struct ThreadCache {
+			ThreadCache();
+
+			char* next; /**< Next unused byte in the chunk of this thread */
+			char* end; /**< End of the chunk of this thread */
+			std::array<FreeBlock*, MAX_BLOCK_SIZE / ALIGNMENT + 1> free_lists; /**< Indexed by size class */
+		};
+
+		/** Cache of the calling thread, created on first use */
+		ThreadCache& thread_cache();
+
+		/** Allocate a new chunk for the cache */
+		void refill(ThreadCache& cache);
+
+		const uint64_t id_; /**< Unique for every pool created, so that threads do not confuse a new pool with a destroyed one */
+		mutable std::mutex mutex_;
+		size_t chunk_size_;
+		std::vector<std::unique_ptr<char[]>> chunks_;
+		std::vector<std::unique_ptr<ThreadCache>> caches_;
+		std::atomic<size_t> nbr_blocks_;
+	};
+
+	/** @brief Standard-compatible allocator drawing memory from a shared MemoryPool.
+
+	Can be used with std::allocate_shared, so that the object and its control block share one pooled block;
+	the control block keeps a copy of the allocator and hence the pool alive until the object is released.
+	*/
+	template <class T> class PoolAllocator {
+	public:
+		typedef T value_type;
+
+		/** @throw std::domain_error If pool is null */
+		explicit PoolAllocator(std::shared_ptr<MemoryPool> pool)
+			: pool_(std::move(pool)) {
+			if (!pool_) {
+				throw std::domain_error("PoolAllocator: null pool");
+			}
+		}
+
+		template <class U> PoolAllocator(const PoolAllocator<U>& other)
+			: pool_(other.pool()) {}
+
+		T* allocate(size_t n) {
+			static_assert(alignof(T) <= MemoryPool::ALIGNMENT, "PoolAllocator: type is over-aligned");
+			if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+				throw std::bad_alloc();
+			}
+			return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept {
+			pool_->deallocate(ptr, n * sizeof(T));
+		}
+
+		const std::shared_ptr<MemoryPool>& pool() const {
+			return pool_;
+		}
+	private:
+		std::shared_ptr<MemoryPool> pool_;
+	};
+
+	template <class T, class U> bool operator==(const PoolAllocator<T>& l, const PoolAllocator<U>& r) {
+		return l.pool() == r.pool();
+	}
+
+	template <class T, class U> bool operator!=(const PoolAllocator<T>& l, const PoolAllocator<U>& r) {
+		return !(l == r);
+	}
+}
+
+#endif // __AVERISERA_MEMORY_POOL_H
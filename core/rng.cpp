@@ -2,6 +2,11 @@
  * (C) Averisera Ltd 2015
  */
 #include "rng.hpp"
+#include "cauchy_distribution.hpp"
+#include "math_utils.hpp"
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
 
 namespace averisera {
     RNG::~RNG() {}
@@ -11,4 +16,40 @@ namespace averisera {
 		const double u = next_uniform();
 		return u < p;
 	}
+
+	void RNG::fill_uniform(double* x, const size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			x[i] = next_uniform();
+		}
+	}
+
+	void RNG::fill_gaussian(double* x, const size_t n) {
+		for (size_t i = 0; i < n; ++i) {
+			x[i] = next_gaussian();
+		}
+	}
+
+	void RNG::save_state(std::ostream&) const {
+		throw std::logic_error("RNG: saving state not supported");
+	}
+
+	void RNG::load_state(std::istream&) {
+		throw std::logic_error("RNG: loading state not supported");
+	}
+
+	double RNG::draw_alpha_stable(const double alpha) {
+		if (alpha == 2) {
+			return next_gaussian();
+		} else if (alpha == 1) {
+			// Cauchy
+			return CauchyDistribution::icdf(next_uniform());
+		} else {
+			assert(alpha > 0);
+			assert(alpha < 2);
+			const double V = MathUtils::pi / 2 * (2 * next_uniform() - 1);
+			const double W = -log(next_uniform());
+			const double r = sin(alpha * V) / ( pow(cos(V), (1 / alpha)) ) * pow( cos( V * (1 - alpha) ) / W , (1 - alpha) / alpha );
+			return r;
+		}
+	}
 }
@@ -5,6 +5,9 @@
 #define __AVERISERA_RNG_H
 
 #include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include "eigen.hpp"
 
@@ -89,11 +92,34 @@ namespace averisera {
         /** Advance by z random numbers in the sequence, discarding them. */
         virtual void discard(unsigned long long z) = 0;
 
+		/** Write the complete state of the generator to a stream, so that it can be restored by load_state().
+		@throw std::logic_error If not supported by the implementation
+		*/
+		virtual void save_state(std::ostream& os) const;
+
+		/** Restore the state written by save_state() of the same implementation.
+		@throw std::logic_error If not supported by the implementation
+		@throw std::runtime_error If the state cannot be read
+		*/
+		virtual void load_state(std::istream& is);
+
 		/** Return true with probability p and false with 1-p 
 		@param p In [0, 1] range (not checked)
 		*/
 		virtual bool flip(double p = 0.5);
 
+		/** Draw n U(0, 1) numbers. Results are the same as from n calls to next_uniform(),
+		but implementations can generate them in batches.
+		@param[out] x Array of size at least n
+		*/
+		virtual void fill_uniform(double* x, size_t n);
+
+		/** Draw n N(0, 1) numbers. Results are the same as from n calls to next_gaussian(),
+		but implementations can generate them in batches.
+		@param[out] x Array of size at least n
+		*/
+		virtual void fill_gaussian(double* x, size_t n);
+
         /** Wraps RNG implementation to make it work like STL random number generators */
         class StlWrapper {
         public:
@@ -123,6 +149,27 @@ namespace averisera {
         private:
             RNG& _rng;
         };
+	protected:
+		/** Draw from symmetric alpha-stable distribution using next_uniform() and next_gaussian(), following Chambers, Mallows and Stuck (1976).
+		@param alpha In (0, 2]
+		*/
+		double draw_alpha_stable(double alpha);
+
+		/** Set y = S * x where x is a vector of S.cols() i.i.d. numbers returned by next_value().
+		@throw std::domain_error If S.rows() != y.size()
+		*/
+		template <class F, class V> static void draw_vector(const Eigen::MatrixXd& S, V y, F next_value) {
+			const unsigned int n = static_cast<unsigned int>(y.size());
+			if (n != static_cast<unsigned int>(S.rows())) {
+				throw std::domain_error("RNG: S and x dimensions do not match");
+			}
+			const unsigned int m = static_cast<unsigned int>(S.cols());
+			Eigen::VectorXd x(m); // TODO: how to avoid repeated heap allocation?
+			for (unsigned int i = 0; i < m; ++i) {
+				x[i] = next_value();
+			}
+			y = S * x;
+		}
     };
 }
 
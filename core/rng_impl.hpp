@@ -36,6 +36,10 @@ namespace averisera {
             _rng.discard(z);
         }
 
+        void save_state(std::ostream& os) const override;
+
+        void load_state(std::istream& is) override;
+
 		
     private:
         std::mt19937_64 _rng;
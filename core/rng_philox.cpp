@@ -0,0 +1,258 @@
+// (C) Averisera Ltd 2014-2020
+#include "rng_philox.hpp"
+#include "math_utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace averisera {
+    static const uint32_t PHILOX_M0 = 0xD2511F53u;
+    static const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+    static const uint32_t PHILOX_W0 = 0x9E3779B9u;
+    static const uint32_t PHILOX_W1 = 0xBB67AE85u;
+    static const unsigned int PHILOX_ROUNDS = 10;
+    static const double TWO_POW_MINUS_53 = 1.0 / 9007199254740992.0;
+
+    static inline uint32_t lo32(uint64_t x) {
+        return static_cast<uint32_t>(x);
+    }
+
+    static inline uint32_t hi32(uint64_t x) {
+        return static_cast<uint32_t>(x >> 32);
+    }
+
+    RNGPhilox::RNGPhilox(uint64_t key, uint64_t stream)
+        : key_({ lo32(key), hi32(key) }), stream_(stream), block_(0), buffer_idx_(4), spare_gaussian_(0), has_spare_gaussian_(false) {
+    }
+
+    RNGPhilox::counter_type RNGPhilox::encrypt(counter_type ctr, key_type key) {
+        for (unsigned int r = 0; r < PHILOX_ROUNDS; ++r) {
+            if (r > 0) {
+                key[0] += PHILOX_W0;
+                key[1] += PHILOX_W1;
+            }
+            const uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * ctr[0];
+            const uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * ctr[2];
+            ctr = { hi32(p1) ^ ctr[1] ^ key[0], lo32(p1), hi32(p0) ^ ctr[3] ^ key[1], lo32(p0) };
+        }
+        return ctr;
+    }
+
+    uint64_t RNGPhilox::mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    void RNGPhilox::generate_block() {
+        buffer_ = encrypt({ lo32(block_), hi32(block_), lo32(stream_), hi32(stream_) }, key_);
+        ++block_;
+        buffer_idx_ = 0;
+    }
+
+    uint32_t RNGPhilox::next_word() {
+        if (buffer_idx_ == buffer_.size()) {
+            generate_block();
+        }
+        return buffer_[buffer_idx_++];
+    }
+
+    RNG::int_type RNGPhilox::rand_int() {
+        const uint64_t lo = next_word();
+        const uint64_t hi = next_word();
+        return (hi << 32) | lo;
+    }
+
+    double RNGPhilox::next_uniform() {
+        return static_cast<double>(rand_int() >> 11) * TWO_POW_MINUS_53;
+    }
+
+    double RNGPhilox::next_gaussian() {
+        if (has_spare_gaussian_) {
+            has_spare_gaussian_ = false;
+            return spare_gaussian_;
+        }
+        const double u1 = 1.0 - next_uniform(); // in (0, 1]
+        const double u2 = next_uniform();
+        const double r = std::sqrt(-2.0 * std::log(u1));
+        const double phi = 2.0 * MathUtils::pi * u2;
+        spare_gaussian_ = r * std::sin(phi);
+        has_spare_gaussian_ = true;
+        return r * std::cos(phi);
+    }
+
+    RNG::int_type RNGPhilox::next_uniform(const int_type n) {
+        if (n == int_max()) {
+            return rand_int();
+        }
+        const int_type range = n + 1;
+        // reject the incomplete last segment to avoid modulo bias
+        const int_type limit = int_max() - (int_max() % range + 1) % range;
+        int_type x;
+        do {
+            x = rand_int();
+        } while (x > limit);
+        return x % range;
+    }
+
+    double RNGPhilox::next_alpha_stable(const double alpha) {
+        return draw_alpha_stable(alpha);
+    }
+
+    template <class V> void RNGPhilox::draw_gaussians(const Eigen::MatrixXd& S, V y) {
+        if (y.size() != S.rows()) {
+            throw std::domain_error("RNG: S and x dimensions do not match");
+        }
+        Eigen::VectorXd x(S.cols());
+        fill_gaussian(x.data(), static_cast<size_t>(x.size()));
+        y = S * x;
+    }
+
+    void RNGPhilox::next_gaussians(const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd> y) {
+        draw_gaussians(S, y);
+    }
+
+    void RNGPhilox::next_gaussians_noncont(const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd, 0, Eigen::InnerStride<>> y) {
+        draw_gaussians(S, y);
+    }
+
+    void RNGPhilox::next_alpha_stable(double alpha, const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd> y) {
+        draw_vector(S, y, [this, alpha]() { return next_alpha_stable(alpha); });
+    }
+
+    void RNGPhilox::discard(unsigned long long z) {
+        const uint64_t words_per_block = buffer_.size();
+        // current position as (block index, index of the next unused word in it)
+        uint64_t block = block_;
+        uint64_t word = 0;
+        if (buffer_idx_ < words_per_block) {
+            --block;
+            word = buffer_idx_;
+        }
+        // 2 words per random number; divide first to avoid overflow
+        word += 2 * (z % 2);
+        block += z / 2 + word / words_per_block;
+        word %= words_per_block;
+        block_ = block;
+        buffer_idx_ = static_cast<unsigned int>(words_per_block);
+        if (word) {
+            generate_block();
+            buffer_idx_ = static_cast<unsigned int>(word);
+        }
+        has_spare_gaussian_ = false;
+    }
+
+    /** Number of blocks encrypted together by fill_uniform() */
+    static const size_t BATCH_SIZE = 64;
+
+    void RNGPhilox::generate_uniforms(double* const x, const size_t nbr_blocks) {
+        // Structure of arrays, so that the rounds can be vectorised across counters
+        uint32_t c0[BATCH_SIZE];
+        uint32_t c1[BATCH_SIZE];
+        uint32_t c2[BATCH_SIZE];
+        uint32_t c3[BATCH_SIZE];
+        for (size_t start = 0; start < nbr_blocks; start += BATCH_SIZE) {
+            const size_t m = std::min(BATCH_SIZE, nbr_blocks - start);
+            for (size_t j = 0; j < m; ++j) {
+                const uint64_t block = block_ + j;
+                c0[j] = lo32(block);
+                c1[j] = hi32(block);
+                c2[j] = lo32(stream_);
+                c3[j] = hi32(stream_);
+            }
+            block_ += m;
+            key_type key(key_);
+            for (unsigned int r = 0; r < PHILOX_ROUNDS; ++r) {
+                if (r > 0) {
+                    key[0] += PHILOX_W0;
+                    key[1] += PHILOX_W1;
+                }
+                const uint32_t k0 = key[0];
+                const uint32_t k1 = key[1];
+                for (size_t j = 0; j < m; ++j) {
+                    const uint64_t p0 = static_cast<uint64_t>(PHILOX_M0) * c0[j];
+                    const uint64_t p1 = static_cast<uint64_t>(PHILOX_M1) * c2[j];
+                    c0[j] = hi32(p1) ^ c1[j] ^ k0;
+                    c1[j] = lo32(p1);
+                    c2[j] = hi32(p0) ^ c3[j] ^ k1;
+                    c3[j] = lo32(p0);
+                }
+            }
+            double* const out = x + 2 * start;
+            for (size_t j = 0; j < m; ++j) {
+                const uint64_t w0 = (static_cast<uint64_t>(c1[j]) << 32) | c0[j];
+                const uint64_t w1 = (static_cast<uint64_t>(c3[j]) << 32) | c2[j];
+                out[2 * j] = static_cast<double>(w0 >> 11) * TWO_POW_MINUS_53;
+                out[2 * j + 1] = static_cast<double>(w1 >> 11) * TWO_POW_MINUS_53;
+            }
+        }
+    }
+
+    void RNGPhilox::fill_uniform(double* const x, const size_t n) {
+        size_t i = 0;
+        // use up the buffered words first, to keep the sequence the same as from next_uniform()
+        while (i < n && buffer_idx_ < buffer_.size()) {
+            x[i++] = next_uniform();
+        }
+        const size_t nbr_blocks = (n - i) / 2;
+        generate_uniforms(x + i, nbr_blocks);
+        i += 2 * nbr_blocks;
+        if (i < n) {
+            x[i] = next_uniform();
+        }
+    }
+
+    void RNGPhilox::fill_gaussian(double* const x, const size_t n) {
+        size_t i = 0;
+        if (n > 0 && has_spare_gaussian_) {
+            x[i++] = next_gaussian();
+        }
+        // Box-Muller transform of pairs, in the same order as in next_gaussian()
+        const size_t nbr_pairs = (n - i) / 2;
+        double* const y = x + i;
+        fill_uniform(y, 2 * nbr_pairs);
+        for (size_t j = 0; j < nbr_pairs; ++j) {
+            const double r = std::sqrt(-2.0 * std::log(1.0 - y[2 * j]));
+            const double phi = 2.0 * MathUtils::pi * y[2 * j + 1];
+            y[2 * j] = r * std::cos(phi);
+            y[2 * j + 1] = r * std::sin(phi);
+        }
+        i += 2 * nbr_pairs;
+        if (i < n) {
+            x[i] = next_gaussian();
+        }
+    }
+
+    RNGPhilox RNGPhilox::split(const uint64_t stream_id) const {
+        const uint64_t key = (static_cast<uint64_t>(key_[1]) << 32) | key_[0];
+        return RNGPhilox(mix(mix(key) ^ stream_), stream_id);
+    }
+
+    void RNGPhilox::save_state(std::ostream& os) const {
+        uint64_t spare_bits;
+        std::memcpy(&spare_bits, &spare_gaussian_, sizeof(spare_bits));
+        os << key_[0] << " " << key_[1] << " " << stream_ << " " << block_;
+        for (uint32_t w : buffer_) {
+            os << " " << w;
+        }
+        os << " " << buffer_idx_ << " " << spare_bits << " " << has_spare_gaussian_ << " ";
+    }
+
+    void RNGPhilox::load_state(std::istream& is) {
+        uint64_t spare_bits;
+        is >> key_[0] >> key_[1] >> stream_ >> block_;
+        for (uint32_t& w : buffer_) {
+            is >> w;
+        }
+        is >> buffer_idx_ >> spare_bits >> has_spare_gaussian_;
+        if (!is || buffer_idx_ > buffer_.size()) {
+            throw std::runtime_error("RNGPhilox: cannot read state");
+        }
+        std::memcpy(&spare_gaussian_, &spare_bits, sizeof(spare_bits));
+    }
+}
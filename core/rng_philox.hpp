@@ -0,0 +1,101 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_RNG_PHILOX_H
+#define __AVERISERA_RNG_PHILOX_H
+
+#include "rng.hpp"
+#include <array>
+#include <cstdint>
+
+namespace averisera {
+    /** @brief Counter-based RNG implementation using the Philox4x32-10 bijection (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011).
+
+    The n-th block of 4 random 32-bit words is obtained by encrypting the 128-bit counter (n, stream) with a 64-bit key.
+    The state is a few dozen bytes, so independent streams can be created cheaply for every simulated object
+    (see make_key() and split()), and discard() and jump() run in O(1) time. fill_uniform() and fill_gaussian()
+    encrypt many counters at once in loops which the compiler can vectorise.
+    */
+    class RNGPhilox: public RNG {
+    public:
+        typedef std::array<uint32_t, 4> counter_type;
+        typedef std::array<uint32_t, 2> key_type;
+
+        /**
+        @param key Key selecting the sequence (e.g. a seed)
+        @param stream Index of the stream of random numbers within the sequence
+        */
+        RNGPhilox(uint64_t key = 42, uint64_t stream = 0);
+
+        double next_uniform() override;
+
+        /** Uses the Box-Muller transform */
+        double next_gaussian() override;
+
+        int_type next_uniform(int_type n) override;
+
+        double next_alpha_stable(double alpha) override;
+
+        void next_gaussians(const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd> y) override;
+
+        void next_gaussians_noncont(const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd, 0, Eigen::InnerStride<>> y) override;
+
+        void next_alpha_stable(double alpha, const Eigen::MatrixXd& S, Eigen::Ref<Eigen::VectorXd> y) override;
+
+        int_type rand_int() override;
+
+        /** Advance by z 64-bit random numbers in O(1) time */
+        void discard(unsigned long long z) override;
+
+        void fill_uniform(double* x, size_t n) override;
+
+        void fill_gaussian(double* x, size_t n) override;
+
+        void save_state(std::ostream& os) const override;
+
+        void load_state(std::istream& is) override;
+
+        /** Create in O(1) time a generator for the sub-stream stream_id of this generator, independent of it
+        and of the sub-streams with other IDs. Does not change the state of this generator. */
+        RNGPhilox split(uint64_t stream_id) const;
+
+        /** Advance by JUMP_SIZE 64-bit random numbers in O(1) time. Jumping copies of a generator
+        by different numbers of times gives non-overlapping sequences of length up to JUMP_SIZE. */
+        void jump() {
+            discard(JUMP_SIZE);
+        }
+
+        /** Number of 64-bit random numbers skipped by jump() */
+        static const unsigned long long JUMP_SIZE = 1ull << 62;
+
+        /** Derive a key from a seed and two indices (e.g. schedule date index and operator index).
+        Together with the stream index (e.g. Actor ID) they select the sequence of random numbers. */
+        static uint64_t make_key(uint64_t seed, uint64_t idx1, uint64_t idx2) {
+            return mix(mix(mix(seed) + idx1) + idx2);
+        }
+
+        /** Philox4x32-10 bijection: encrypt the counter with the key. */
+        static counter_type encrypt(counter_type counter, key_type key);
+
+        /** Mix the bits of x (SplitMix64 finaliser). Used to derive keys from several integers. */
+        static uint64_t mix(uint64_t x);
+    private:
+        uint32_t next_word();
+
+        void generate_block();
+
+        /** Set y = S * x where x is a vector of S.cols() i.i.d. N(0, 1) numbers drawn with fill_gaussian(). */
+        template <class V> void draw_gaussians(const Eigen::MatrixXd& S, V y);
+
+        /** Convert nbr_blocks consecutive blocks starting from block_ to uniform numbers in x (2 per block) and advance block_. */
+        void generate_uniforms(double* x, size_t nbr_blocks);
+
+        key_type key_;
+        uint64_t stream_;
+        uint64_t block_; /**< Index of the next block to be generated */
+        counter_type buffer_;
+        unsigned int buffer_idx_; /**< Index of the next unused word in buffer_; buffer_.size() if buffer is used up */
+        double spare_gaussian_;
+        bool has_spare_gaussian_;
+    };
+}
+
+#endif // __AVERISERA_RNG_PHILOX_H
@@ -0,0 +1,183 @@
+// (C) Averisera Ltd 2014-2020
+#pragma once
+#include "core/preconditions.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace averisera {
+	/** Streaming, mergeable estimator of quantiles of a sample, based on a hierarchy of compactors (KLL sketch with deterministic
+	compaction, so that results are reproducible).
+
+	Level h stores samples with weight 2^h. When a level holds capacity() samples, they are sorted and every second one is promoted to level h + 1,
+	alternating between odd and even positions. Memory use is O(k * log(N / k)). Up to capacity() samples quantiles are exact; above that
+	the rank error is of the order of log2(N / k) / k. With capacity EXACT, samples are never compacted and quantiles are always exact, at the cost of O(N) memory.
+	@tparam T Type of collected values
+	*/
+	template <class T = double> class RunningQuantiles {
+	public:
+		typedef uint64_t counter_t; /**< Type used to count the samples */
+
+		static const size_t DEFAULT_CAPACITY = 256;
+
+		/** Capacity value which keeps all samples */
+		static const size_t EXACT = 0;
+
+		/** @param capacity Capacity k of a single compactor. Larger values decrease the error. EXACT disables compaction.
+		@throw std::domain_error If capacity is 1
+		*/
+		explicit RunningQuantiles(size_t capacity = DEFAULT_CAPACITY)
+			: capacity_(capacity), cnt_(0) {
+			check_that(capacity == EXACT || capacity >= 2, "RunningQuantiles: capacity must be at least 2");
+		}
+
+		/** Add new sample x. */
+		void add(T x) {
+			if (levels_.empty()) {
+				levels_.resize(1);
+			}
+			levels_[0].push_back(x);
+			++cnt_;
+			if (capacity_ != EXACT && levels_[0].size() >= capacity_) {
+				compress();
+			}
+		}
+
+		/** Add new sample if it's not NaN. Return whether it was added or not. */
+		bool add_if_not_nan(T x) {
+			if (!std::isnan(x)) {
+				add(x);
+				return true;
+			} else {
+				return false;
+			}
+		}
+
+		/** Merge samples collected by other estimator into this one.
+		@throw std::domain_error If capacities differ.
+		*/
+		void merge(const RunningQuantiles<T>& other) {
+			check_equals(capacity_, other.capacity_, "RunningQuantiles: capacity mismatch");
+			if (levels_.size() < other.levels_.size()) {
+				levels_.resize(other.levels_.size());
+			}
+			for (size_t h = 0; h < other.levels_.size(); ++h) {
+				levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+			}
+			cnt_ += other.cnt_;
+			compress();
+		}
+
+		/** Number of accumulated samples */
+		counter_t nbr_samples() const {
+			return cnt_;
+		}
+
+		/** Capacity of a single compactor (EXACT if samples are never compacted) */
+		size_t capacity() const {
+			return capacity_;
+		}
+
+		/** Number of samples stored at all levels */
+		size_t nbr_stored() const {
+			size_t n = 0;
+			for (const auto& level : levels_) {
+				n += level.size();
+			}
+			return n;
+		}
+
+		/** Estimate the q-th quantile. If all samples are stored exactly, linearly interpolates between order statistics, so that
+		quantile(0.5) is equal to the median calculated by Statistics::median.
+		@param q Quantile level in [0, 1]
+		@return NaN if no samples were added (NaN samples are never added, see add_if_not_nan)
+		@throw std::domain_error If q is outside [0, 1]
+		*/
+		T quantile(double q) const {
+			check_that(q >= 0 && q <= 1, "RunningQuantiles: quantile level outside [0, 1]");
+			if (cnt_ == 0) {
+				return std::numeric_limits<T>::quiet_NaN();
+			}
+			std::vector<std::pair<T, counter_t>> weighted;
+			weighted.reserve(nbr_stored());
+			counter_t weight = 1;
+			for (const auto& level : levels_) {
+				for (const T& x : level) {
+					weighted.push_back(std::make_pair(x, weight));
+				}
+				weight *= 2;
+			}
+			std::sort(weighted.begin(), weighted.end(), [](const std::pair<T, counter_t>& l, const std::pair<T, counter_t>& r) { return l.first < r.first; });
+			const double pos = q * static_cast<double>(cnt_ - 1);
+			const counter_t lo = static_cast<counter_t>(std::floor(pos));
+			const counter_t hi = std::min(lo + 1, cnt_ - 1);
+			const double frac = pos - static_cast<double>(lo);
+			// find values at positions lo and hi of the sorted sample expanded by weights
+			counter_t cumulative = 0;
+			size_t i = 0;
+			while (cumulative + weighted[i].second <= lo) {
+				cumulative += weighted[i].second;
+				++i;
+			}
+			const T x_lo = weighted[i].first;
+			if (frac == 0) {
+				return x_lo;
+			}
+			while (cumulative + weighted[i].second <= hi) {
+				cumulative += weighted[i].second;
+				++i;
+			}
+			const T x_hi = weighted[i].first;
+			return (1 - frac) * x_lo + frac * x_hi;
+		}
+
+		/** Estimate the median */
+		T median() const {
+			return quantile(0.5);
+		}
+	private:
+		/** Compact every level which reached the capacity */
+		void compress() {
+			if (capacity_ == EXACT) {
+				return;
+			}
+			for (size_t h = 0; h < levels_.size(); ++h) {
+				if (levels_[h].size() >= capacity_) {
+					compact(h);
+				}
+			}
+		}
+
+		void compact(size_t h) {
+			if (levels_.size() == h + 1) {
+				levels_.resize(h + 2);
+				offsets_.resize(h + 1, false);
+			} else if (offsets_.size() <= h) {
+				offsets_.resize(h + 1, false);
+			}
+			std::vector<T>& level = levels_[h];
+			std::sort(level.begin(), level.end());
+			// with odd size, largest sample stays at this level
+			const size_t nbr_compacted = level.size() - level.size() % 2;
+			std::vector<T>& next = levels_[h + 1];
+			for (size_t i = offsets_[h] ? 1 : 0; i < nbr_compacted; i += 2) {
+				next.push_back(level[i]);
+			}
+			offsets_[h] = !offsets_[h];
+			level.erase(level.begin(), level.begin() + static_cast<std::ptrdiff_t>(nbr_compacted));
+		}
+
+		size_t capacity_;
+		counter_t cnt_;
+		std::vector<std::vector<T>> levels_; /**< levels_[h] holds samples with weight 2^h */
+		std::vector<bool> offsets_; /**< Whether the next compaction of level h keeps odd (true) or even (false) positions */
+	};
+
+	template <class T> const size_t RunningQuantiles<T>::DEFAULT_CAPACITY;
+	template <class T> const size_t RunningQuantiles<T>::EXACT;
+}
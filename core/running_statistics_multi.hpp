@@ -3,6 +3,11 @@
 #include "core/running_statistics.hpp"
 #include "core/running_covariance.hpp"
 #include <cassert>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 namespace averisera {
@@ -129,11 +134,45 @@ namespace averisera {
 			const size_t k = flat_idx(i, j);
 			return _covariances[k];
 		}
+		/** Write the accumulated statistics to a binary stream, in native byte order */
+		void save(std::ostream& os) const {
+			const uint64_t dim = _dim;
+			os.write(reinterpret_cast<const char*>(&dim), sizeof(dim));
+			write_elements(os, _marginal_stats);
+			write_elements(os, _covariances);
+		}
+
+		/** Replace the statistics with the ones written by save().
+		@throw std::runtime_error If the stream ends prematurely.
+		*/
+		void load(std::istream& is) {
+			uint64_t dim;
+			is.read(reinterpret_cast<char*>(&dim), sizeof(dim));
+			if (!is) {
+				throw std::runtime_error("RunningStatisticsMulti: cannot read dimension");
+			}
+			RunningStatisticsMulti<V> loaded(static_cast<size_t>(dim));
+			read_elements(is, loaded._marginal_stats);
+			read_elements(is, loaded._covariances);
+			swap(loaded);
+		}
 	private:
 		size_t _dim;
 		std::vector<RunningStatistics<V>> _marginal_stats;
 		std::vector<RunningCovariance<V>> _covariances;
 
+		template <class S> static void write_elements(std::ostream& os, const std::vector<S>& elements) {
+			static_assert(std::is_trivially_copyable<S>::value, "RunningStatisticsMulti: statistics must be trivially copyable");
+			os.write(reinterpret_cast<const char*>(elements.data()), static_cast<std::streamsize>(elements.size() * sizeof(S)));
+		}
+
+		template <class S> static void read_elements(std::istream& is, std::vector<S>& elements) {
+			is.read(reinterpret_cast<char*>(elements.data()), static_cast<std::streamsize>(elements.size() * sizeof(S)));
+			if (!is) {
+				throw std::runtime_error("RunningStatisticsMulti: cannot read statistics");
+			}
+		}
+
 		static size_t flat_idx(size_t i, size_t j) {
 			assert(i > j);
 			return (i * (i - 1)) / 2 + j;
@@ -0,0 +1,89 @@
+// (C) Averisera Ltd 2014-2020
+#include "thread_pool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace averisera {
+    /** How many ranges per thread parallel_for creates, to balance the load */
+    static const size_t RANGES_PER_THREAD = 4;
+
+    ThreadPool::ThreadPool(unsigned int nbr_threads)
+        : nbr_pending_(0), stopping_(false) {
+        if (nbr_threads == 0) {
+            throw std::domain_error("ThreadPool: number of threads must be positive");
+        }
+        workers_.reserve(nbr_threads);
+        for (unsigned int i = 0; i < nbr_threads; ++i) {
+            workers_.push_back(std::thread([this]() { work(); }));
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        task_available_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::work() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                task_available_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return; // stopping
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (error && !first_error_) {
+                    first_error_ = error;
+                }
+                --nbr_pending_;
+                if (nbr_pending_ == 0) {
+                    tasks_finished_.notify_all();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::parallel_for(const size_t n, const range_function_t& f, const size_t min_range_size) {
+        if (n == 0) {
+            return;
+        }
+        const size_t nbr_ranges = std::max<size_t>(1, std::min(workers_.size() * RANGES_PER_THREAD, n / std::max<size_t>(1, min_range_size)));
+        const size_t range_size = (n + nbr_ranges - 1) / nbr_ranges;
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            for (size_t begin = 0; begin < n; begin += range_size) {
+                const size_t end = std::min(n, begin + range_size);
+                tasks_.push([&f, begin, end]() { f(begin, end); });
+                ++nbr_pending_;
+            }
+            task_available_.notify_all();
+            tasks_finished_.wait(lock, [this]() { return nbr_pending_ == 0; });
+            std::swap(error, first_error_);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    unsigned int ThreadPool::hardware_concurrency() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+}
@@ -0,0 +1,65 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_THREAD_POOL_H
+#define __AVERISERA_THREAD_POOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace averisera {
+    /** @brief Fixed-size pool of worker threads executing ranges of loop iterations. */
+    class ThreadPool {
+    public:
+        typedef std::function<void(size_t, size_t)> range_function_t;
+
+        /** @param nbr_threads Number of worker threads
+        @throw std::domain_error If nbr_threads == 0 */
+        explicit ThreadPool(unsigned int nbr_threads);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** Stops and joins the worker threads */
+        ~ThreadPool();
+
+        unsigned int nbr_threads() const {
+            return static_cast<unsigned int>(workers_.size());
+        }
+
+        /** Call f(begin, end) for contiguous ranges [begin, end) covering [0, n), using the worker threads.
+        Blocks until all calls have finished. Ranges are processed in unspecified order.
+        If any call throws, rethrows the first exception caught after all calls have finished.
+        @param min_range_size Minimum size of the range passed to a single call (except possibly the last one)
+        */
+        void parallel_for(size_t n, const range_function_t& f, size_t min_range_size = 1);
+
+        /** Call f(i) for every i in [0, n) using the worker threads. @see parallel_for */
+        template <class F> void for_each_index(size_t n, F f, size_t min_range_size = 1) {
+            parallel_for(n, [&f](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    f(i);
+                }
+            }, min_range_size);
+        }
+
+        /** Number of threads which can run concurrently on this machine (at least 1) */
+        static unsigned int hardware_concurrency();
+    private:
+        void work();
+
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable task_available_;
+        std::condition_variable tasks_finished_;
+        size_t nbr_pending_; /**< Number of submitted tasks which have not finished yet */
+        std::exception_ptr first_error_;
+        bool stopping_;
+    };
+}
+
+#endif // __AVERISERA_THREAD_POOL_H
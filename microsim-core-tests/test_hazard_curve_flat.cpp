@@ -26,3 +26,17 @@ TEST(HazardCurveFlat, MultiplyHazardRate) {
 	ASSERT_EQ(r, c1->instantaneous_hazard_rate(2));
 	ASSERT_EQ(r, c1->instantaneous_hazard_rate(100));
 }
+
+TEST(HazardCurveFlat, Batch) {
+	HazardCurveFlat curve(0.2);
+	const std::vector<double> t1s({ 0., 0.5, 1.0, 3.0 });
+	const std::vector<double> t2s({ 0., 1.5, 4.0, 3.5 });
+	std::vector<double> ihrs(t1s.size());
+	std::vector<double> calc_t2s(t1s.size());
+	curve.integrated_hazard_rates(t1s.data(), t2s.data(), ihrs.data(), t1s.size());
+	curve.calc_t2s(t1s.data(), ihrs.data(), calc_t2s.data(), t1s.size());
+	for (size_t i = 0; i < t1s.size(); ++i) {
+		ASSERT_EQ(curve.integrated_hazard_rate(t1s[i], t2s[i]), ihrs[i]);
+		ASSERT_EQ(curve.calc_t2(t1s[i], ihrs[i]), calc_t2s[i]);
+	}
+}
@@ -117,3 +117,31 @@ TEST(HazardModel, ZeroRiskWithYearFract) {
     ASSERT_EQ(Date::POS_INF, model.calc_end_date(0, start, 0.01, 0.));
     ASSERT_EQ(start, model.calc_end_date(0, start, 0, 1));
 }
+
+TEST(HazardModel, Batch) {
+    std::vector<std::shared_ptr<const AnchoredHazardCurve>> curves(2);
+    const Date start(2015, 1, 1);
+    curves[0] = AnchoredHazardCurve::build(start, DAYCOUNT, FACTORY, std::vector<Date>({ start + Period::years(1), start + Period::years(2), start + Period::years(3) }), std::vector<double>({ 0.01, 0.03, 0.1 }), std::vector<HazardRateMultiplier>());
+    HazardModel model(curves, { 1, 1 });
+    const std::vector<Date> starts({ start, Date(2015, 6, 1), Date(2016, 2, 3), Date(2016, 2, 3), Date(2017, 1, 1), start });
+    const std::vector<Date> ends({ Date(2015, 2, 1), Date(2016, 6, 1), Date(2018, 2, 3), Date(2016, 2, 3), Date(2020, 1, 1), Date(2017, 1, 1) });
+    const std::vector<HazardRateMultiplier> multipliers({ HazardRateMultiplier(), HazardRateMultiplier(1.5), HazardRateMultiplier(0.5, Date(2016, 1, 1), Date(2017, 1, 1), false), HazardRateMultiplier(2.0), HazardRateMultiplier(0.), HazardRateMultiplier(3.0, Date(2014, 1, 1), Date(2018, 1, 1), false) });
+    const std::vector<double> us({ 0.001, 0.2, 0.5, 0., 0.3, 0.999 });
+    const size_t n = starts.size();
+    for (unsigned int from = 0; from < 2; ++from) {
+        std::vector<double> probas(n);
+        std::vector<Date> end_dates(n);
+        model.calc_transition_probabilities(from, starts.data(), ends.data(), multipliers.data(), probas.data(), n);
+        model.calc_end_dates(from, starts.data(), us.data(), multipliers.data(), end_dates.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(model.calc_transition_probability(from, starts[i], ends[i], multipliers[i]), probas[i]) << from << " " << i;
+            ASSERT_EQ(model.calc_end_date(from, starts[i], us[i], multipliers[i]), end_dates[i]) << from << " " << i;
+        }
+    }
+    double proba;
+    const Date early(2014, 1, 1);
+    ASSERT_THROW(model.calc_transition_probabilities(0, &early, &start, multipliers.data(), &proba, 1), std::out_of_range);
+    Date end_date;
+    const double bad_u = 1.1;
+    ASSERT_THROW(model.calc_end_dates(0, &start, &bad_u, multipliers.data(), &end_date, 1), std::out_of_range);
+}
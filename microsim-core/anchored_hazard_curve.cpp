@@ -144,6 +144,10 @@ namespace averisera {
             const double t1 = _daycount->calc(_start, d1);
             BOOST_ASSERT_MSG(t1 >= 0, boost::lexical_cast<std::string>(t1).c_str());
             const double t2 = _hazard_curve->calc_t2(t1, ihr);
+            return calc_next_date(d1, t1, t2);
+        }
+
+        Date AnchoredHazardCurve::calc_next_date(const Date d1, const double t1, const double t2) const {
             BOOST_ASSERT_MSG(t2 >= t1, boost::lexical_cast<std::string>(t2).c_str());
             const double dt = t2 - t1;
             BOOST_ASSERT_MSG(dt >= 0, boost::lexical_cast<std::string>(dt).c_str());
@@ -152,7 +156,7 @@ namespace averisera {
             } else {
                 try {
                     const Date result = _daycount->add_year_fraction(d1, dt);
-                    BOOST_ASSERT_MSG(result.is_pos_infinity() || result >= d1, boost::str(boost::format("%s %s %s %g %g %g") % boost::lexical_cast<std::string>(*_daycount) % boost::lexical_cast<std::string>(d1) % boost::lexical_cast<std::string>(result) % t1 % t2 % ihr).c_str());
+                    BOOST_ASSERT_MSG(result.is_pos_infinity() || result >= d1, boost::str(boost::format("%s %s %s %g %g") % boost::lexical_cast<std::string>(*_daycount) % boost::lexical_cast<std::string>(d1) % boost::lexical_cast<std::string>(result) % t1 % t2).c_str());
                     return result;
                 } catch (std::out_of_range) {
                     return Date::MAX;
@@ -160,6 +164,68 @@ namespace averisera {
             }
         }
 
+        void AnchoredHazardCurve::conditional_jump_probabilities(const Date* d1s, const Date* d2s, const HazardRateMultiplier* hazard_rate_multipliers, double* probas, const size_t n) const {
+            std::vector<double> t1s(n);
+            std::vector<double> t2s(n);
+            for (size_t i = 0; i < n; ++i) {
+                if (d1s[i] < _start || d2s[i] < d1s[i]) {
+                    throw std::out_of_range("AnchoredHazardCurve: inputs out of range");
+                }
+                t1s[i] = _daycount->calc(_start, d1s[i]);
+                t2s[i] = _daycount->calc(_start, d2s[i]);
+            }
+            _hazard_curve->integrated_hazard_rates(t1s.data(), t2s.data(), probas, n);
+            for (size_t i = 0; i < n; ++i) {
+                const HazardRateMultiplier& hrm = hazard_rate_multipliers[i];
+                const Date d1 = d1s[i];
+                const Date d2 = d2s[i];
+                if (hrm.value != 1 && d1 < d2 && hrm.to > d1 && hrm.from < d2) {
+                    if (hrm.from <= d1 && hrm.to >= d2) {
+                        // multiplier covers the whole period
+                        probas[i] *= hrm.value;
+                    } else {
+                        probas[i] = integrated_hazard_rate(d1, d2, hrm);
+                    }
+                }
+            }
+            HazardCurve::jump_probabilities(probas, probas, n);
+        }
+
+        void AnchoredHazardCurve::divide_by_hazard_rate_multipliers(const Date* starts, const double* expected_multiplied_ihrs, const HazardRateMultiplier* hazard_rate_multipliers, double* ihrs, const size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                const HazardRateMultiplier& hrm = hazard_rate_multipliers[i];
+                const double expected_multiplied_ihr = expected_multiplied_ihrs[i];
+                if (starts[i] < _start) {
+                    throw std::out_of_range("AnchoredHazardCurve: start date out of range");
+                }
+                if (expected_multiplied_ihr < 0) {
+                    throw std::out_of_range("AnchoredHazardCurve: expected IHR negative");
+                }
+                if (expected_multiplied_ihr == 0 || hrm.value == 1) {
+                    ihrs[i] = expected_multiplied_ihr;
+                } else if (starts[i] >= hrm.from && hrm.to == Date::POS_INF) {
+                    ihrs[i] = safe_divide(expected_multiplied_ihr, hrm.value);
+                } else {
+                    ihrs[i] = divide_by_hazard_rate_multiplier(starts[i], expected_multiplied_ihr, &hrm, (&hrm) + 1);
+                }
+            }
+        }
+
+        void AnchoredHazardCurve::calc_next_dates(const Date* d1s, const double* ihrs, Date* d2s, const size_t n) const {
+            std::vector<double> t1s(n);
+            std::vector<double> t2s(n);
+            for (size_t i = 0; i < n; ++i) {
+                if (d1s[i] < _start || ihrs[i] < 0) {
+                    throw std::out_of_range("AnchoredHazardCurve: inputs out of range");
+                }
+                t1s[i] = _daycount->calc(_start, d1s[i]);
+            }
+            _hazard_curve->calc_t2s(t1s.data(), ihrs, t2s.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                d2s[i] = calc_next_date(d1s[i], t1s[i], t2s[i]);
+            }
+        }
+
         HazardRateMultiplier AnchoredHazardCurve::calc_hazard_rate_multiplier(const RelativeRiskValue& relative_risk_value) const {
             const Date start = relative_risk_value.ref_start;
             const Date end = relative_risk_value.ref_end;               
@@ -116,6 +116,22 @@ namespace averisera {
             */
             Date calc_next_date(Date d1, double ihr) const;
 
+            /** Batch version of conditional_jump_probability(Date, Date, const HazardRateMultiplier): probas[i] = conditional_jump_probability(d1s[i], d2s[i], hazard_rate_multipliers[i]) for i < n.
+              Integrated hazard rates are calculated for the whole batch at once, so multipliers covering the whole period [d1s[i], d2s[i]) are cheap to apply.
+              @throw std::out_of_range If inputs out of accepted ranges
+             */
+            void conditional_jump_probabilities(const Date* d1s, const Date* d2s, const HazardRateMultiplier* hazard_rate_multipliers, double* probas, size_t n) const;
+
+            /** Batch version of divide_by_hazard_rate_multiplier(Date, double, const HazardRateMultiplier&): ihrs[i] = divide_by_hazard_rate_multiplier(starts[i], expected_multiplied_ihrs[i], hazard_rate_multipliers[i]) for i < n.
+              @throw std::out_of_range If inputs out of accepted ranges
+             */
+            void divide_by_hazard_rate_multipliers(const Date* starts, const double* expected_multiplied_ihrs, const HazardRateMultiplier* hazard_rate_multipliers, double* ihrs, size_t n) const;
+
+            /** Batch version of calc_next_date(): d2s[i] = calc_next_date(d1s[i], ihrs[i]) for i < n.
+              @throw std::out_of_range If inputs out of accepted ranges
+             */
+            void calc_next_dates(const Date* d1s, const double* ihrs, Date* d2s, size_t n) const;
+
             /** Given expected value of integrated_hazard_rate(start, X, hazard_rate_multiplier) for some unknown X, calculate the value of integrated_hazard_rate(start, X).
               @param start Date >= start()
               @param expected_multiplied_ihr integrated_hazard_rate(start, X, hazard_rate_multiplier) >= 0
@@ -179,6 +195,8 @@ namespace averisera {
         private:
             template <class I> double integrated_hazard_rate(Date d1, Date d2, I begin, I end) const;
             template <class I> double divide_by_hazard_rate_multiplier(Date start, double expected_multiplied_ihr, I begin, I end) const;
+            /** Convert time t2 >= t1 back to a date, given that t1 corresponds to d1 */
+            Date calc_next_date(Date d1, double t1, double t2) const;
         private:
             Date _start;
         protected:
@@ -21,6 +21,33 @@ namespace averisera {
             return - log1p(-p);
         }
 
+        void HazardCurve::jump_probabilities(const double* ihrs, double* probas, const size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                assert(ihrs[i] >= 0);
+                probas[i] = - expm1(- ihrs[i]);
+            }
+        }
+
+        void HazardCurve::integrated_hazard_rates_from_jump_probas(const double* probas, double* ihrs, const size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                assert(probas[i] >= 0);
+                assert(probas[i] <= 1);
+                ihrs[i] = - log1p(- probas[i]);
+            }
+        }
+
+        void HazardCurve::integrated_hazard_rates(const double* t1s, const double* t2s, double* ihrs, const size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                ihrs[i] = integrated_hazard_rate(t1s[i], t2s[i]);
+            }
+        }
+
+        void HazardCurve::calc_t2s(const double* t1s, const double* ihrs, double* t2s, const size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                t2s[i] = calc_t2(t1s[i], ihrs[i]);
+            }
+        }
+
 		std::unique_ptr<HazardCurve> HazardCurve::multiply_probability(const double t0, const double t1, const double factor) const {
 			validate(t0, t1, factor);
 			if (factor == 0 || factor == 1) {
@@ -68,11 +68,24 @@ namespace averisera {
             */
             virtual double calc_t2(double t1, double ihr) const = 0;
 
+            /** Batch version of integrated_hazard_rate(): ihrs[i] = integrated_hazard_rate(t1s[i], t2s[i]) for i < n.
+            Default implementation calls integrated_hazard_rate() in a loop.
+            */
+            virtual void integrated_hazard_rates(const double* t1s, const double* t2s, double* ihrs, size_t n) const;
+
+            /** Batch version of calc_t2(): t2s[i] = calc_t2(t1s[i], ihrs[i]) for i < n.
+            Default implementation calls calc_t2() in a loop.
+            */
+            virtual void calc_t2s(const double* t1s, const double* ihrs, double* t2s, size_t n) const;
+
             /** Conditional or unconditional jump probability 
               @param integrated_hazard_rate >= 0
              */
             static double jump_probability(double integrated_hazard_rate);
 
+            /** Batch version of jump_probability(double): probas[i] = jump_probability(ihrs[i]) for i < n. */
+            static void jump_probabilities(const double* ihrs, double* probas, size_t n);
+
 			double jump_probability(double t0, double t1) const {
 				return jump_probability(integrated_hazard_rate(t0, t1));
 			}
@@ -82,6 +95,9 @@ namespace averisera {
              */
             static double integrated_hazard_rate_from_jump_proba(double p);
 
+            /** Batch version of integrated_hazard_rate_from_jump_proba(): ihrs[i] = integrated_hazard_rate_from_jump_proba(probas[i]) for i < n. */
+            static void integrated_hazard_rates_from_jump_probas(const double* probas, double* ihrs, size_t n);
+
 			/** Extrapolate jump probability to a period x times longer */
 			static double extrapolate_proba(double p, double x) {
 				//TRACE() << "HazardCurve::extrapolate_proba: p=" << p << ", x=" << x;
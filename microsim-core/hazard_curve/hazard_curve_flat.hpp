@@ -68,6 +68,24 @@ namespace averisera {
                     return t1;
                 }
             }
+
+            void integrated_hazard_rates(const double* t1s, const double* t2s, double* ihrs, size_t n) const override {
+                const double rate = _rate;
+                for (size_t i = 0; i < n; ++i) {
+                    assert(t1s[i] >= 0);
+                    assert(t2s[i] >= t1s[i]);
+                    ihrs[i] = (t2s[i] - t1s[i]) * rate;
+                }
+            }
+
+            void calc_t2s(const double* t1s, const double* ihrs, double* t2s, size_t n) const override {
+                const double rate = _rate;
+                for (size_t i = 0; i < n; ++i) {
+                    assert(t1s[i] >= 0);
+                    assert(ihrs[i] >= 0);
+                    t2s[i] = ihrs[i] > 0 ? t1s[i] + ihrs[i] / rate : t1s[i];
+                }
+            }
         private:
             double _rate;
         };
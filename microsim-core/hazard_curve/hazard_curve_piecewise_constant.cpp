@@ -121,6 +121,29 @@ namespace averisera {
             }
         }
 
+		void HazardCurvePiecewiseConstant::integrated_hazard_rates(const double* t1s, const double* t2s, double* ihrs, const size_t n) const {
+			if (_rates.size() == 1) {
+				// flat curve
+				const double rate = _rates[0].second;
+				for (size_t i = 0; i < n; ++i) {
+					assert(t1s[i] >= 0);
+					assert(t2s[i] >= t1s[i]);
+					ihrs[i] = rate * (t2s[i] - t1s[i]);
+				}
+			} else {
+				for (size_t i = 0; i < n; ++i) {
+					// qualified call avoids virtual dispatch
+					ihrs[i] = HazardCurvePiecewiseConstant::integrated_hazard_rate(t1s[i], t2s[i]);
+				}
+			}
+		}
+
+		void HazardCurvePiecewiseConstant::calc_t2s(const double* t1s, const double* ihrs, double* t2s, const size_t n) const {
+			for (size_t i = 0; i < n; ++i) {
+				t2s[i] = HazardCurvePiecewiseConstant::calc_t2(t1s[i], ihrs[i]);
+			}
+		}
+
 		void HazardCurvePiecewiseConstant::validate() const {
 			if (_rates.empty()) {
 				throw std::domain_error("HazardCurvePiecewiseConstant: rates time series empty");
@@ -65,6 +65,10 @@ namespace averisera {
 			}
 
             double calc_t2(double t1, double ihr) const override;
+
+			void integrated_hazard_rates(const double* t1s, const double* t2s, double* ihrs, size_t n) const override;
+
+			void calc_t2s(const double* t1s, const double* ihrs, double* t2s, size_t n) const override;
 		private:
 			using HazardCurve::validate;
 			void validate() const;
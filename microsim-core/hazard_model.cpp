@@ -5,6 +5,7 @@
 #include "relative_risk_value.hpp"
 #include "core/log.hpp"
 #include "core/math_utils.hpp"
+#include <algorithm>
 #include <cassert>
 //#include <cmath>
 #include <stdexcept>
@@ -142,6 +143,53 @@ namespace averisera {
             }
         }
 
+        void HazardModel::calc_transition_probabilities(const unsigned int from, const Date* starts, const Date* ends, const HazardRateMultiplier* hazard_rate_multipliers, double* probas, const size_t n) const {
+            for (size_t i = 0; i < n; ++i) {
+                if (starts[i] < _start || ends[i] < starts[i]) {
+                    LOG_ERROR() << "HazardModel: period " << starts[i] << " to " << ends[i] << " outside supported range " << _start << " to INF";
+                    throw std::out_of_range("HazardModel: bad dates");
+                }
+            }
+            if (from >= dim()) {
+                throw std::out_of_range("HazardModel: initial state out of range");
+            }
+            if (_curves[from] && _next_states[from] != from) {
+                _curves[from]->conditional_jump_probabilities(starts, ends, hazard_rate_multipliers, probas, n);
+            } else {
+                std::fill(probas, probas + n, 0.);
+            }
+        }
+
+        void HazardModel::calc_end_dates(const unsigned int from, const Date* starts, const double* transition_probabilities, const HazardRateMultiplier* hazard_rate_multipliers, Date* end_dates, const size_t n) const {
+            if (from >= dim()) {
+                throw std::out_of_range("HazardModel: initial state out of range");
+            }
+            for (size_t i = 0; i < n; ++i) {
+                if (starts[i] < _start) {
+                    throw std::out_of_range("HazardModel: bad start date");
+                }
+                if (transition_probabilities[i] < 0 || transition_probabilities[i] > 1) {
+                    throw std::out_of_range("HazardModel: probability out of range");
+                }
+            }
+            if (_curves[from] && _next_states[from] != from) {
+                const AnchoredHazardCurve& curve = *_curves[from];
+                std::vector<double> expected_multiplied_ihrs(n);
+                std::vector<double> ihrs(n);
+                HazardCurve::integrated_hazard_rates_from_jump_probas(transition_probabilities, expected_multiplied_ihrs.data(), n);
+                curve.divide_by_hazard_rate_multipliers(starts, expected_multiplied_ihrs.data(), hazard_rate_multipliers, ihrs.data(), n);
+                curve.calc_next_dates(starts, ihrs.data(), end_dates, n);
+                for (size_t i = 0; i < n; ++i) {
+                    // as in calc_end_date_impl
+                    if (transition_probabilities[i] == 0.0 || expected_multiplied_ihrs[i] == 0.0) {
+                        end_dates[i] = starts[i];
+                    }
+                }
+            } else {
+                std::fill(end_dates, end_dates + n, Date::POS_INF);
+            }
+        }
+
         HazardRateMultiplier HazardModel::calc_hazard_rate_multiplier(unsigned int from, const RelativeRiskValue& relative_risk_value) const {
             if (from >= dim()) {
                 throw std::out_of_range("HazardModel: initial state out of range");
@@ -97,6 +97,18 @@ namespace averisera {
 
             Date calc_end_date(unsigned int from, Date start, double transition_probability, const std::vector<HazardRateMultiplier>& hazard_rate_multipliers) const;
 
+            /** Batch version of calc_transition_probability(unsigned int, Date, Date, const HazardRateMultiplier&):
+              probas[i] = calc_transition_probability(from, starts[i], ends[i], hazard_rate_multipliers[i]) for i < n.
+              @throw std::out_of_range As calc_transition_probability()
+            */
+            void calc_transition_probabilities(unsigned int from, const Date* starts, const Date* ends, const HazardRateMultiplier* hazard_rate_multipliers, double* probas, size_t n) const;
+
+            /** Batch version of calc_end_date(unsigned int, Date, double, const HazardRateMultiplier&):
+              end_dates[i] = calc_end_date(from, starts[i], transition_probabilities[i], hazard_rate_multipliers[i]) for i < n.
+              @throw std::out_of_range As calc_end_date()
+            */
+            void calc_end_dates(unsigned int from, const Date* starts, const double* transition_probabilities, const HazardRateMultiplier* hazard_rate_multipliers, Date* end_dates, size_t n) const;
+
             /** Calculate hazard rate multiplier corresponding to relative risk in a given reference period.
               @param[in] from State at initial date
               @param[in] relative_risk_value RelativeRiskValue
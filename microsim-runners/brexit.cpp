@@ -13,6 +13,7 @@ Microsimulation runner for Brexit scenarios simulation in England and Wales.
 #include "microsim-calibrator/population_calibrator.hpp"
 #include "microsim-calibrator/procreation_calibrator.hpp"
 #include "microsim-calibrator/stitched_markov_model_calibrator.hpp"
+#include "microsim-simulator/checkpoint.hpp"
 #include "microsim-simulator/contexts.hpp"
 #include "microsim-simulator/common_features.hpp"
 #include "microsim-simulator/hazard_rate_multiplier_provider/hazard_rate_multiplier_provider_bypred_timedependent.hpp"
@@ -22,10 +23,12 @@ Microsimulation runner for Brexit scenarios simulation in England and Wales.
 #include "microsim-simulator/migration/migrant_selector_random.hpp"
 #include "microsim-simulator/migration/migrant_selector_latest_immigrants_first.hpp"
 #include "microsim-simulator/migration/migration_generator_dummy.hpp"
+#include "microsim-simulator/mutable_context.hpp"
 #include "microsim-simulator/observer/observer_demographics_main.hpp"
 #include "microsim-simulator/observer/observer_demographics_immigrants.hpp"
 #include "microsim-simulator/observer/observer_demographics_emigrants.hpp"
 #include "microsim-simulator/observer/observer_stats.hpp"
+#include "microsim-simulator/observer/observer_result_saver_incremental.hpp"
 #include "microsim-simulator/observer/observer_result_saver_simple.hpp"
 #include "microsim-simulator/operator_factory.hpp"
 #include "microsim-simulator/operator/operator_discrete_independent.hpp"
@@ -42,12 +45,16 @@ Microsimulation runner for Brexit scenarios simulation in England and Wales.
 #include "microsim-uk/ethnicity/ethnicity_classifications_england_wales.hpp"
 #include "microsim-uk/state_pension_age.hpp"
 #include "microsim-uk/state_pension_age_2007.hpp"
+#include "core/background_file_writer.hpp"
 #include "core/csv_file_reader.hpp"
 #include "core/distribution_shifted_lognormal.hpp"
 #include "core/math_utils.hpp"
 #include "core/period.hpp"
 #include "core/preconditions.hpp"
+#include "core/thread_pool.hpp"
 #include "core/user_arguments.hpp"
+#include <algorithm>
+#include <sstream>
 #include <string>
 
 using namespace averisera;
@@ -401,7 +408,7 @@ static std::vector<std::unique_ptr<Operator<Person>>> build_bmi_operators(const
 			} // else leave functions[i] empty
 			functions[i] = std::move(fvec);
 		}
-		const auto bmi_value_history_factory = store_percentiles_as_floats ? HistoryFactory::SPARSE<double>() : HistoryFactory::SPARSE<float>(); // store BMI percentiles and value as the same type
+		const auto bmi_value_history_factory = store_percentiles_as_floats ? HistoryFactory::SPARSE_COLUMNAR<double>() : HistoryFactory::SPARSE_COLUMNAR<float>(); // store BMI percentiles and value as the same type; values are set on schedule dates for most persons
 		std::vector<std::unique_ptr<Operator<Person>>> continuous_value_operators(build_operator_function_for_cohorts(ethnic_groupings, percentile_variable_name, continuous_variable_name, functions, period_years, cohorts, start_dates, bmi_value_history_factory));
 		LOG_INFO() << "Built " << continuous_value_operators.size() << " continuous BMI value operators";
 		operators.insert(operators.end(), std::make_move_iterator(continuous_value_operators.begin()), std::make_move_iterator(continuous_value_operators.end())); // move values from continuous_value_operators to the end of operators
@@ -410,6 +417,88 @@ static std::vector<std::unique_ptr<Operator<Person>>> build_bmi_operators(const
 }
 
 /** Main function. */
+/** Parameters which can differ between scenarios simulated from the same calibrated and initialised base. */
+struct ScenarioParameters {
+	std::string name;
+	std::string observations_filename;
+	bool do_brexit;
+	int brexit_year;
+	double post_brexit_eu_migration_multiplier;
+	double post_brexit_other_migration_multiplier;
+	double post_brexit_dominant_emigration_multiplier;
+	double post_brexit_dominant_return_multiplier;
+	double post_brexit_exodus_size;
+	bool is_post_brexit_exodus_size_relative;
+	int post_brexit_exodus_length_years;
+	int post_brexit_return_length_years;
+	bool do_future_eu_enlargement;
+	int future_eu_enlargement_year;
+	double post_future_enlargement_eu_migration_multiplier;
+	int post_future_enlargement_eu_migration_length_years;
+	std::vector<int> post_brexit_eu_migr_ref_years;
+	std::vector<double> post_brexit_eu_migr_ref_weights;
+};
+
+/** Read scenario argument: value of key prefixed with scenario name, defaulting to the value of key.
+@param prefix Empty or scenario name followed by "_"
+*/
+template <class T> static T get_scenario_argument(const UserArguments& ua, const std::string& prefix, const std::string& key, T default_value) {
+	const T value = ua.get(key, default_value);
+	return prefix.empty() ? value : ua.get(prefix + key, value);
+}
+
+template <class T> static void get_scenario_argument(const UserArguments& ua, const std::string& prefix, const std::string& key, std::vector<T>& values) {
+	ua.get(key, values, false);
+	if (!prefix.empty() && ua.contains(prefix + key)) {
+		values.clear();
+		ua.get(prefix + key, values, true);
+	}
+}
+
+/** Read parameters of a scenario.
+@param name Scenario name. If empty, read the parameters of the single scenario simulated in the default mode.
+@throw DataException If parameters are invalid.
+*/
+static ScenarioParameters read_scenario_parameters(const UserArguments& ua, const std::string& name) {
+	const std::string prefix(name.empty() ? name : name + "_");
+	ScenarioParameters sp;
+	sp.name = name;
+	const std::string observations_filename(ua.get<std::string>("OBSERVATIONS_FILE"));
+	sp.observations_filename = name.empty() ? observations_filename : ua.get(prefix + "OBSERVATIONS_FILE", observations_filename + "_" + name);
+	sp.do_brexit = get_scenario_argument(ua, prefix, "BREXIT", ua.get<bool>("BREXIT")); // simulate Brexit scenario
+	sp.brexit_year = get_scenario_argument(ua, prefix, "BREXIT_YEAR", 2019); // year when Brexit happens (assumed to be mid-year)
+	sp.post_brexit_eu_migration_multiplier = get_scenario_argument(ua, prefix, "POSTBREXIT_EU_MIGR_MULTI", 1.0);
+	sp.post_brexit_other_migration_multiplier = get_scenario_argument(ua, prefix, "POSTBREXIT_OTHER_MIGR_MULTI", 1.0);
+	sp.post_brexit_dominant_emigration_multiplier = get_scenario_argument(ua, prefix, "POSTBREXIT_DOMINANT_EMIGR_MULTI", 1.0);
+	sp.post_brexit_dominant_return_multiplier = get_scenario_argument(ua, prefix, "POSTBREXIT_DOMINANT_RETURN_MULTI", 0.0);
+	sp.post_brexit_exodus_size = get_scenario_argument(ua, prefix, "POSTBREXIT_EXODUS_SIZE", 0.0);
+	sp.is_post_brexit_exodus_size_relative = get_scenario_argument(ua, prefix, "IS_POSTBREXIT_EXODUS_SIZE_RELATIVE", true);
+	sp.post_brexit_exodus_length_years = get_scenario_argument(ua, prefix, "POSTBREXIT_EXODUS_LENGTH_YEARS", 1);
+	sp.post_brexit_return_length_years = get_scenario_argument(ua, prefix, "POSTBREXIT_RETURN_LENGTH_YEARS", 1);
+	check_that<DataException>(sp.post_brexit_exodus_size >= 0, "Exodus size cannot be negative");
+	check_that<DataException>(sp.post_brexit_dominant_return_multiplier >= 0, "Post-Brexit return multiplier cannot be negative");
+	check_that<DataException>(sp.post_brexit_eu_migration_multiplier >= 0, "Post-Brexit EU migration multiplier cannot be negative");
+	check_that<DataException>(sp.post_brexit_dominant_emigration_multiplier >= 0, "Post-Brexit dominant group emigration multiplier cannot be negative");
+	check_that<DataException>(sp.post_brexit_exodus_length_years > 0, "Exodus length in years must be positive");
+	check_that<DataException>(sp.post_brexit_return_length_years > 0, "Return length in years must be positive");
+
+	sp.future_eu_enlargement_year = get_scenario_argument(ua, prefix, "FUTURE_EU_ENLARGEMENT_YEAR", static_cast<int>(Date::MAX_YEAR));
+	sp.do_future_eu_enlargement = get_scenario_argument(ua, prefix, "FUTURE_EU_ENLARGEMENT", false);
+	sp.post_future_enlargement_eu_migration_multiplier = get_scenario_argument(ua, prefix, "POST_FUTURE_EU_ENLARGEMENT_MIGR_MULTI", 1.0);
+	sp.post_future_enlargement_eu_migration_length_years = get_scenario_argument(ua, prefix, "POST_FUTURE_EU_ENLARGEMENT_MIGR_LENGTH_YEARS", 15);
+	check_that<DataException>(sp.post_future_enlargement_eu_migration_multiplier >= 0);
+	check_that<DataException>(sp.post_future_enlargement_eu_migration_length_years > 0);
+	get_scenario_argument(ua, prefix, "POST_BREXIT_EU_MIGRATION_REF_YEARS", sp.post_brexit_eu_migr_ref_years);
+	get_scenario_argument(ua, prefix, "POST_BREXIT_EU_MIGRATION_REF_WEIGHTS", sp.post_brexit_eu_migr_ref_weights);
+	check_equals<size_t, size_t, DataException>(sp.post_brexit_eu_migr_ref_years.size(), sp.post_brexit_eu_migr_ref_weights.size(), "Number of post-Brexit reference years and weights for EU migration must be equal");
+	if (sp.post_brexit_eu_migr_ref_years.empty()) {
+		sp.post_brexit_eu_migr_ref_years.push_back(2000);
+		sp.post_brexit_eu_migr_ref_weights.push_back(1.0);
+	}
+	check_that<DataException>(!(sp.do_brexit && sp.do_future_eu_enlargement), "Cannot model Brexit and future EU enlargement effect at the same time");
+	return sp;
+}
+
 void do_main(const UserArguments& ua) {
     // Read user arguments
     //const std::string variables_filename(ua.get<std::string>("VARIABLES_FILE"));
@@ -426,10 +515,19 @@ void do_main(const UserArguments& ua) {
 		ua.get<Period>("FREQUENCY"),
 		ua.get<std::shared_ptr<const Daycount>>("DAYCOUNT"));
 	const Initialiser::pop_size_t init_pop_size = MathUtils::safe_cast<Initialiser::pop_size_t>(ua.get<double>("INIT_POPULATION_SIZE"));
-	const std::string observations_filename(ua.get<std::string>("OBSERVATIONS_FILE"));
 	std::vector<std::string> variables_for_stats;
 	ua.get("OBSERVED_STATS_VARIABLES", variables_for_stats, false);
 	const bool calc_medians = ua.get("CALC_MEDIANS", false);
+	// 0 keeps all values to calculate exact medians, otherwise bounds the memory used per variable at the cost of a rank error (see RunningQuantiles)
+	const size_t median_capacity = ua.get("MEDIAN_CAPACITY", static_cast<size_t>(0));
+	const unsigned int nbr_threads = ua.get("NBR_THREADS", 0u); // 0 means serial mode
+	const size_t operator_check_sample_size = ua.get("OPERATOR_CHECK_SAMPLE_SIZE", static_cast<size_t>(0)); // 0 means checking operator consistency for all persons
+	const bool archive_dead_persons = ua.get("ARCHIVE_DEAD_PERSONS", false);
+	// With several scenarios, each one saves its checkpoints to CHECKPOINT_FILE + "_" + scenario name.
+	const std::string checkpoint_filename = ua.get("CHECKPOINT_FILE", std::string());
+	const size_t checkpoint_interval = ua.get("CHECKPOINT_INTERVAL", static_cast<size_t>(0)); // 0 means no checkpoints
+	const bool resume_from_checkpoint = ua.get("RESUME_FROM_CHECKPOINT", false); // resume from the last saved checkpoint(s)
+	check_that<DataException>(!(checkpoint_interval || resume_from_checkpoint) || !checkpoint_filename.empty(), "Checkpoint file name is required");
 	std::string resource_dir = ua.get("RESOURCE_DIR", std::string("resources/"));
 	if (resource_dir.empty()) {
 		resource_dir = ".";
@@ -475,47 +573,26 @@ void do_main(const UserArguments& ua) {
 	const bool do_spa = ua.get<bool>("DO_SPA"); // model State Pension Age
 	const bool use_spa2007 = ua.get<bool>("USE_SPA2007", false); // use the State Pension Age reform from 2007
 
-	const bool do_brexit = ua.get<bool>("BREXIT"); // simulate Brexit scenario
 	const bool only_calibration = ua.get<bool>("ONLY_CALIBRATION", false); // run only calibration and exit
-	const int brexit_year = ua.get("BREXIT_YEAR", 2019); // year when Brexit happens (assumed to be mid-year)
-	const double post_brexit_eu_migration_multiplier = ua.get("POSTBREXIT_EU_MIGR_MULTI", 1.0);
-	const double post_brexit_other_migration_multiplier = ua.get("POSTBREXIT_OTHER_MIGR_MULTI", 1.0);
-	const double post_brexit_dominant_emigration_multiplier = ua.get("POSTBREXIT_DOMINANT_EMIGR_MULTI", 1.0);
-	const double post_brexit_dominant_return_multiplier = ua.get("POSTBREXIT_DOMINANT_RETURN_MULTI", 0.0);
-	const double post_brexit_exodus_size = ua.get("POSTBREXIT_EXODUS_SIZE", 0.0);
-	const bool is_post_brexit_exodus_size_relative = ua.get("IS_POSTBREXIT_EXODUS_SIZE_RELATIVE", true);
-	const int post_brexit_exodus_length_years = ua.get("POSTBREXIT_EXODUS_LENGTH_YEARS", 1);
-	const int post_brexit_return_length_years = ua.get("POSTBREXIT_RETURN_LENGTH_YEARS", 1);
-	check_that<DataException>(post_brexit_exodus_size >= 0, "Exodus size cannot be negative");
-	check_that<DataException>(post_brexit_dominant_return_multiplier >= 0, "Post-Brexit return multiplier cannot be negative");
-	check_that<DataException>(post_brexit_eu_migration_multiplier >= 0, "Post-Brexit EU migration multiplier cannot be negative");
-	check_that<DataException>(post_brexit_dominant_emigration_multiplier >= 0, "Post-Brexit dominant group emigration multiplier cannot be negative");
-	check_that<DataException>(post_brexit_exodus_length_years > 0, "Exodus length in years must be positive");
-	check_that<DataException>(post_brexit_return_length_years > 0, "Return length in years must be positive");
-
-	const int future_eu_enlargement_year = ua.get("FUTURE_EU_ENLARGEMENT_YEAR", static_cast<int>(Date::MAX_YEAR));
-	const bool do_future_eu_enlargement = ua.get("FUTURE_EU_ENLARGEMENT", false);
-	const double post_future_enlargement_eu_migration_multiplier = ua.get("POST_FUTURE_EU_ENLARGEMENT_MIGR_MULTI", 1.0);
-	const int post_future_enlargement_eu_migration_length_years = ua.get("POST_FUTURE_EU_ENLARGEMENT_MIGR_LENGTH_YEARS", 15);
-	check_that<DataException>(post_future_enlargement_eu_migration_multiplier >= 0);
-	check_that<DataException>(post_future_enlargement_eu_migration_length_years > 0);
-	std::vector<int> post_brexit_eu_migr_ref_years;
-	ua.get("POST_BREXIT_EU_MIGRATION_REF_YEARS", post_brexit_eu_migr_ref_years, false);
-	std::vector<double> post_brexit_eu_migr_ref_weights;
-	ua.get("POST_BREXIT_EU_MIGRATION_REF_WEIGHTS", post_brexit_eu_migr_ref_weights, false);
-	check_equals<size_t, size_t, DataException>(post_brexit_eu_migr_ref_years.size(), post_brexit_eu_migr_ref_weights.size(), "Number of post-Brexit reference years and weights for EU migration must be equal");
-	if (post_brexit_eu_migr_ref_years.empty()) {
-		post_brexit_eu_migr_ref_years.push_back(2000);
-		post_brexit_eu_migr_ref_weights.push_back(1.0);
+	// Scenarios simulated concurrently from a base population calibrated and initialised once. If empty, simulate a single scenario.
+	std::vector<std::string> scenario_names;
+	ua.get("SCENARIOS", scenario_names, false);
+	std::vector<ScenarioParameters> scenarios;
+	if (scenario_names.empty()) {
+		scenarios.push_back(read_scenario_parameters(ua, std::string()));
+	} else {
+		for (const auto& name : scenario_names) {
+			check_that<DataException>(!name.empty(), "Scenario name cannot be empty");
+			scenarios.push_back(read_scenario_parameters(ua, name));
+		}
 	}
-
+	const unsigned int nbr_scenario_threads = ua.get("NBR_SCENARIO_THREADS", std::min(static_cast<unsigned int>(scenarios.size()), ThreadPool::hardware_concurrency()));
+	check_that<DataException>(nbr_scenario_threads > 0, "Number of scenario threads must be positive");
 	LOG_INFO() << "Read user parameters:";
 	for (const auto& kv : ua.read_keys_values()) {
 		LOG_INFO() << "Key = \"" << kv.first << "\", Value = \"" << kv.second << "\"";
 	}
 
-	check_that<DataException>(!(do_brexit && do_future_eu_enlargement), "Cannot model Brexit and future EU enlargement effect at the same time");
-
 	const Ethnicity::IndexConversions ic = EthnicityClassficationsEnglandWales::get_conversions(ethnicity_classification.c_str());
 	const Ethnicity::index_set_type dominant_groups({ ic.index("WHITE_BRITISH"), ic.index("IRISH") });
 	Ethnicity::index_set_type eu_groups; // ethnic group set representing EU immigrants
@@ -645,39 +722,60 @@ void do_main(const UserArguments& ua) {
 		observed_quantities_ethn.push_back(reached_spa65);
 	}
 
+	// Observers of a scenario, writing results to files starting with observations_filename
+	const auto build_observers = [&](const std::string& observations_filename) {
+		std::vector<std::shared_ptr<Observer>> observers;
+		// all observer results of a scenario are written by one background thread
+		const auto observations_writer = std::make_shared<BackgroundFileWriter>();
+		// demographics tables cover the whole schedule, so they are saved only at the end
+		const auto osr_demographics = std::make_shared<ObserverResultSaverSimple>(std::string(), observations_filename + "_demographics", observations_writer);
+		const auto make_osr = [&observations_filename, observations_writer](const std::string& suffix) {
+			return std::make_shared<ObserverResultSaverIncremental>(observations_filename + suffix, observations_filename + suffix, observations_writer);
+		};
+	    const auto osr_all = make_osr("");
+	    const auto osr_male = make_osr("_male");
+	    const auto osr_female = make_osr("_female");
+		const auto osr_dom = make_osr("_dom");
+		const auto osr_male_dom = make_osr("_male_dom");
+		const auto osr_female_dom = make_osr("_female_dom");
+		const auto osr_eu = make_osr("_eu");
+		const auto osr_male_eu = make_osr("_male_eu");
+		const auto osr_female_eu = make_osr("_female_eu");
+		const auto osr_oth = make_osr("_oth");
+		const auto osr_male_oth = make_osr("_male_oth");
+		const auto osr_female_oth = make_osr("_female_oth");
+	    const std::string dem_obs_prefix("demographics_");
+		const auto observer_age_ranges = RateCalibrator::make_age_ranges(1, 100);
+		const auto make_stats = [&](std::shared_ptr<ObserverResultSaver> saver, const std::vector<ObservedQuantity<Person>>& quantities, std::shared_ptr<const Predicate<Person>> predicate) {
+			const auto observer = std::make_shared<ObserverStats<Person>>(saver, quantities, predicate, calc_medians);
+			observer->set_quantile_capacity(median_capacity);
+			return observer;
+		};
+		observers.push_back(std::make_shared<ObserverDemographicsMain>(osr_demographics, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
+	    observers.push_back(std::make_shared<ObserverDemographicsImmigrants>(osr_demographics, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
+	    observers.push_back(std::make_shared<ObserverDemographicsEmigrants>(osr_demographics, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
+		observers.push_back(make_stats(osr_all, observed_quantities, PredicateFactory::make_alive()));
+	    observers.push_back(make_stats(osr_female, observed_quantities, PredicateFactory::make_sex(Sex::FEMALE, true)));
+	    observers.push_back(make_stats(osr_male, observed_quantities, PredicateFactory::make_sex(Sex::MALE, true)));
+		observers.push_back(make_stats(osr_dom, observed_quantities_ethn, PredicateFactory::make_ethnicity(dominant_groups, true)));
+		observers.push_back(make_stats(osr_female_dom, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(dominant_groups, true))));
+		observers.push_back(make_stats(osr_male_dom, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(dominant_groups, true))));
+		observers.push_back(make_stats(osr_eu, observed_quantities_ethn, PredicateFactory::make_ethnicity(eu_groups, true)));
+		observers.push_back(make_stats(osr_female_eu, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(eu_groups, true))));
+		observers.push_back(make_stats(osr_male_eu, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(eu_groups, true))));
+		observers.push_back(make_stats(osr_oth, observed_quantities_ethn, PredicateFactory::make_ethnicity(other_groups, true)));
+		observers.push_back(make_stats(osr_female_oth, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(other_groups, true))));
+		observers.push_back(make_stats(osr_male_oth, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(other_groups, true))));
+		return observers;
+	};
+
 	// Prepare simulator
 	SimulatorBuilder simulator_builder;
 	simulator_builder.set_add_newborns(true); // obviously
     simulator_builder.set_initial_population_size(init_pop_size);
-    const auto osr_all = std::make_shared<ObserverResultSaverSimple>(observations_filename);
-    const auto osr_male = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_male");
-    const auto osr_female = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_female");
-	const auto osr_dom = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_dom");
-	const auto osr_male_dom = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_male_dom");
-	const auto osr_female_dom = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_female_dom");
-	const auto osr_eu = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_eu");
-	const auto osr_male_eu = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_male_eu");
-	const auto osr_female_eu = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_female_eu");
-	const auto osr_oth = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_oth");
-	const auto osr_male_oth = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_male_oth");
-	const auto osr_female_oth = std::make_shared<ObserverResultSaverSimple>(observations_filename + "_female_oth");
-    const std::string dem_obs_prefix("demographics_");
-	const auto observer_age_ranges = RateCalibrator::make_age_ranges(1, 100);
-	simulator_builder.add_observer(std::make_shared<ObserverDemographicsMain>(osr_all, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
-    simulator_builder.add_observer(std::make_shared<ObserverDemographicsImmigrants>(osr_all, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
-    simulator_builder.add_observer(std::make_shared<ObserverDemographicsEmigrants>(osr_all, observer_age_ranges, schedule.nbr_dates(), dem_obs_prefix));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_all, observed_quantities, PredicateFactory::make_alive(), calc_medians));
-    simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_female, observed_quantities, PredicateFactory::make_sex(Sex::FEMALE, true), calc_medians));
-    simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_male, observed_quantities, PredicateFactory::make_sex(Sex::MALE, true), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_dom, observed_quantities_ethn, PredicateFactory::make_ethnicity(dominant_groups, true), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_female_dom, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(dominant_groups, true)), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_male_dom, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(dominant_groups, true)), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_eu, observed_quantities_ethn, PredicateFactory::make_ethnicity(eu_groups, true), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_female_eu, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(eu_groups, true)), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_male_eu, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(eu_groups, true)), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_oth, observed_quantities_ethn, PredicateFactory::make_ethnicity(other_groups, true), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_female_oth, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE, true), PredicateFactory::make_ethnicity(other_groups, true)), calc_medians));
-	simulator_builder.add_observer(std::make_shared<ObserverStats<Person>>(osr_male_oth, observed_quantities_ethn, PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE, true), PredicateFactory::make_ethnicity(other_groups, true)), calc_medians));
+	simulator_builder.set_nbr_threads(nbr_threads);
+	simulator_builder.set_operator_check_sample_size(operator_check_sample_size);
+	simulator_builder.set_dead_person_archiving(archive_dead_persons);
 	/*simulator_builder.add_operators(std::move(build_mortality_operators(resource_dir + "deaths_male.csv", resource_dir + "population_male.csv", schedule, max_age, PredicateFactory::make_sex(Sex::MALE))));
 	simulator_builder.add_operators(build_mortality_operators(resource_dir + "deaths_female.csv", resource_dir + "population_female.csv", schedule, max_age, PredicateFactory::make_sex(Sex::FEMALE)));*/
 	simulator_builder.add_operators(std::move(build_mortality_operators(resource_dir + male_mortality_filename, schedule, max_age, PredicateFactory::make_sex_shared(Sex::MALE, true))));
@@ -692,83 +790,100 @@ void do_main(const UserArguments& ua) {
 			max_age, start_date.year(), end_date.year(), start_date.month(), start_date.day(), get_bmi_ethnic_sets(ic),
 			BMI_CATEGORY_VARIABLE_NAME, do_continuous_bmi ? BMI_PERCENTILE_VARIABLE_NAME : "", DELIM, true, do_continuous_bmi, bmi_thresholds, BMI_VARIABLE_NAME, max_bmi, store_bmi_percentiles_as_floats));
 	}
-	if (do_migration) {
-		const double scale_factor = static_cast<double>(init_pop_size) / total_historical_population_start;
-		if (accurate_migration) {
-			if (ic.classification_name() != std::string("ONS_FULL")) {
-				throw std::domain_error("Accurate migration modelling requires ONS_FULL ethnicity classification");
-			}
-			const std::vector<int> status_quo_years({ std::max(static_cast<Date::year_type>(census_years.back() - 5), census_years.front()) });
-			const std::vector<double> status_quo_weights({ 1.0 });
-			std::vector<std::unique_ptr<const MigrationCalibrator::Extender>> extenders;
-			const std::vector<int> eu_ref_years = do_brexit ? post_brexit_eu_migr_ref_years : status_quo_years;
-			const std::vector<double> eu_ref_weights = do_brexit ? post_brexit_eu_migr_ref_weights : status_quo_weights;
-			const Ethnicity::index_set_type all(Ethnicity::index_range_to_set(ic.index_range_all()));
-			if (do_brexit) {
-				LOG_INFO() << "Extending migration models past " << last_census_year << " for Brexit";
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), brexit_year - 1, Ethnicity::index_set_type(), 1, 1));
-				LOG_DEBUG() << "Extended from " << last_census_year << " to " << (brexit_year - 1);
-				// after Brexit, migration from "other" countries (Asia, Africa, etc.) may increase #helloworld
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, brexit_year, Date::MAX_YEAR, other_groups, post_brexit_other_migration_multiplier, post_brexit_other_migration_multiplier));
-				LOG_DEBUG() << "Extended from " << brexit_year << " to INF for 'other' groups: " << other_groups;
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, brexit_year, Date::MAX_YEAR, dominant_groups, post_brexit_dominant_emigration_multiplier, 1));
-				LOG_DEBUG() << "Extended from " << brexit_year << " to INF for 'dominant' groups: " << dominant_groups;
-				// after Brexit, migration from/to EU countries goes back to eu_ref_years (e.g. 2000)
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(eu_ref_years, eu_ref_weights, brexit_year, Date::MAX_YEAR, eu_groups, post_brexit_eu_migration_multiplier, post_brexit_eu_migration_multiplier));				
-				LOG_DEBUG() << "Extended from " << brexit_year << " to INF for 'EU' groups: " << eu_groups;
-			} else if (do_future_eu_enlargement) {
-				LOG_INFO() << "Extending migration models past " << last_census_year << " for future EU enlargement";
-				Ethnicity::index_set_type not_eu;
-				for (auto idx : all) {
-					if (eu_groups.find(idx) == eu_groups.end()) {
-						not_eu.insert(idx);
-					}
+	// Migration generators of a scenario
+	const auto build_migration_generators = [&](const ScenarioParameters& sp) {
+		std::vector<std::shared_ptr<const MigrationGenerator>> migration_generators;
+		if (do_migration) {
+			const double scale_factor = static_cast<double>(init_pop_size) / total_historical_population_start;
+			if (accurate_migration) {
+				if (ic.classification_name() != std::string("ONS_FULL")) {
+					throw std::domain_error("Accurate migration modelling requires ONS_FULL ethnicity classification");
 				}
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), future_eu_enlargement_year - 1, Ethnicity::index_set_type(), 1, 1));
-				// non EU migrates normally
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, future_eu_enlargement_year, Date::MAX_YEAR, not_eu, 1, 1));
-				// EU migrates more for some time
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, future_eu_enlargement_year, future_eu_enlargement_year + post_future_enlargement_eu_migration_length_years - 1, eu_groups, post_future_enlargement_eu_migration_multiplier, post_future_enlargement_eu_migration_multiplier));
-				// then it drops off to what we have now
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, future_eu_enlargement_year + post_future_enlargement_eu_migration_length_years, Date::MAX_YEAR, eu_groups, 1, 1));
-			} else {
-				LOG_INFO() << "Extending migration models past " << last_census_year << " for status quo";
-				extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), Date::MAX_YEAR, Ethnicity::index_set_type(), 1, 1));
-			}
-			simulator_builder.add_migration_generator(MigrationCalibrator::build_migration_generator("MAIN", female_census_numbers, male_census_numbers
-				, nomigr_female_census_numbers_start
-				, nomigr_male_census_numbers_start
-				, nomigr_female_census_numbers_end
-				, nomigr_male_census_numbers_end
-				, census_years, MIGRATION_MID_YEAR
-				, scale_factor, comigrated_child_age_limit
-				, std::make_shared<const MigrantSelectorRandom>()
-				, dominant_groups, extenders));			
-			if (do_brexit) {
-				if (post_brexit_exodus_size > 0) {
-					// Affects only immigrants who arrived before Brexit.
-					simulator_builder.add_migration_generator(MigrationCalibrator::build_exodus_generator("EXODUS", brexit_year, brexit_year + post_brexit_exodus_length_years, eu_groups, std::make_shared<const MigrantSelectorLatestImigrantsFirst>(), MIGRATION_MID_YEAR, post_brexit_exodus_size, is_post_brexit_exodus_size_relative, scale_factor, comigrated_child_age_limit, PredicateFactory::make_immigration_date(Date::MIN, MigrationCalibrator::make_migration_date(brexit_year, MIGRATION_MID_YEAR), false, true)));
+				const std::vector<int> status_quo_years({ std::max(static_cast<Date::year_type>(census_years.back() - 5), census_years.front()) });
+				const std::vector<double> status_quo_weights({ 1.0 });
+				std::vector<std::unique_ptr<const MigrationCalibrator::Extender>> extenders;
+				const std::vector<int> eu_ref_years = sp.do_brexit ? sp.post_brexit_eu_migr_ref_years : status_quo_years;
+				const std::vector<double> eu_ref_weights = sp.do_brexit ? sp.post_brexit_eu_migr_ref_weights : status_quo_weights;
+				const Ethnicity::index_set_type all(Ethnicity::index_range_to_set(ic.index_range_all()));
+				if (sp.do_brexit) {
+					LOG_INFO() << "Extending migration models past " << last_census_year << " for Brexit";
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), sp.brexit_year - 1, Ethnicity::index_set_type(), 1, 1));
+					LOG_DEBUG() << "Extended from " << last_census_year << " to " << (sp.brexit_year - 1);
+					// after Brexit, migration from "other" countries (Asia, Africa, etc.) may increase #helloworld
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, sp.brexit_year, Date::MAX_YEAR, other_groups, sp.post_brexit_other_migration_multiplier, sp.post_brexit_other_migration_multiplier));
+					LOG_DEBUG() << "Extended from " << sp.brexit_year << " to INF for 'other' groups: " << other_groups;
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, sp.brexit_year, Date::MAX_YEAR, dominant_groups, sp.post_brexit_dominant_emigration_multiplier, 1));
+					LOG_DEBUG() << "Extended from " << sp.brexit_year << " to INF for 'dominant' groups: " << dominant_groups;
+					// after Brexit, migration from/to EU countries goes back to eu_ref_years (e.g. 2000)
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(eu_ref_years, eu_ref_weights, sp.brexit_year, Date::MAX_YEAR, eu_groups, sp.post_brexit_eu_migration_multiplier, sp.post_brexit_eu_migration_multiplier));				
+					LOG_DEBUG() << "Extended from " << sp.brexit_year << " to INF for 'EU' groups: " << eu_groups;
+				} else if (sp.do_future_eu_enlargement) {
+					LOG_INFO() << "Extending migration models past " << last_census_year << " for future EU enlargement";
+					Ethnicity::index_set_type not_eu;
+					for (auto idx : all) {
+						if (eu_groups.find(idx) == eu_groups.end()) {
+							not_eu.insert(idx);
+						}
+					}
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), sp.future_eu_enlargement_year - 1, Ethnicity::index_set_type(), 1, 1));
+					// non EU migrates normally
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, sp.future_eu_enlargement_year, Date::MAX_YEAR, not_eu, 1, 1));
+					// EU migrates more for some time
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, sp.future_eu_enlargement_year, sp.future_eu_enlargement_year + sp.post_future_enlargement_eu_migration_length_years - 1, eu_groups, sp.post_future_enlargement_eu_migration_multiplier, sp.post_future_enlargement_eu_migration_multiplier));
+					// then it drops off to what we have now
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, sp.future_eu_enlargement_year + sp.post_future_enlargement_eu_migration_length_years, Date::MAX_YEAR, eu_groups, 1, 1));
+				} else {
+					LOG_INFO() << "Extending migration models past " << last_census_year << " for status quo";
+					extenders.push_back(std::make_unique<MigrationCalibrator::ExtenderAgeGroup>(status_quo_years, status_quo_weights, census_years.back(), Date::MAX_YEAR, Ethnicity::index_set_type(), 1, 1));
 				}
-				if (post_brexit_dominant_return_multiplier > 0) {
-					// select live emigrants to return
-					simulator_builder.add_migration_generator(MigrationCalibrator::build_return_generator("RETURN", brexit_year, brexit_year + post_brexit_return_length_years, MIGRATION_MID_YEAR, comigrated_child_age_limit, std::make_unique<EmigrantSelector>(PredicateFactory::make_ethnicity(dominant_groups, true), Date::MIN, MigrationCalibrator::make_migration_date(brexit_year, MIGRATION_MID_YEAR), comigrated_child_age_limit), post_brexit_dominant_return_multiplier));
+				migration_generators.push_back(MigrationCalibrator::build_migration_generator("MAIN", female_census_numbers, male_census_numbers
+					, nomigr_female_census_numbers_start
+					, nomigr_male_census_numbers_start
+					, nomigr_female_census_numbers_end
+					, nomigr_male_census_numbers_end
+					, census_years, MIGRATION_MID_YEAR
+					, scale_factor, comigrated_child_age_limit
+					, std::make_shared<const MigrantSelectorRandom>()
+					, dominant_groups, extenders));			
+				if (sp.do_brexit) {
+					if (sp.post_brexit_exodus_size > 0) {
+						// Affects only immigrants who arrived before Brexit.
+						migration_generators.push_back(MigrationCalibrator::build_exodus_generator("EXODUS", sp.brexit_year, sp.brexit_year + sp.post_brexit_exodus_length_years, eu_groups, std::make_shared<const MigrantSelectorLatestImigrantsFirst>(), MIGRATION_MID_YEAR, sp.post_brexit_exodus_size, sp.is_post_brexit_exodus_size_relative, scale_factor, comigrated_child_age_limit, PredicateFactory::make_immigration_date(Date::MIN, MigrationCalibrator::make_migration_date(sp.brexit_year, MIGRATION_MID_YEAR), false, true)));
+					}
+					if (sp.post_brexit_dominant_return_multiplier > 0) {
+						// select live emigrants to return
+						migration_generators.push_back(MigrationCalibrator::build_return_generator("RETURN", sp.brexit_year, sp.brexit_year + sp.post_brexit_return_length_years, MIGRATION_MID_YEAR, comigrated_child_age_limit, std::make_unique<EmigrantSelector>(PredicateFactory::make_ethnicity(dominant_groups, true), Date::MIN, MigrationCalibrator::make_migration_date(sp.brexit_year, MIGRATION_MID_YEAR), comigrated_child_age_limit), sp.post_brexit_dominant_return_multiplier));
+					}
 				}
+			} else {
+				migration_generators.push_back(MigrationCalibrator::build_migration_generator("MAIN", {
+					std::make_pair(resource_dir + "migration_ethnic_91_01.csv", NumericalRange<int>(static_cast<int>(start_year), 2001)),
+					std::make_pair(resource_dir + "migration_ethnic_01_11.csv", NumericalRange<int>(2001, 2011))
+				}, ic, DELIM, MIGRATION_MID_YEAR, scale_factor, census_year_spacing, std::make_shared<const MigrantSelectorRandom>()));
 			}
 		} else {
-			simulator_builder.add_migration_generator(MigrationCalibrator::build_migration_generator("MAIN", {
-				std::make_pair(resource_dir + "migration_ethnic_91_01.csv", NumericalRange<int>(static_cast<int>(start_year), 2001)),
-				std::make_pair(resource_dir + "migration_ethnic_01_11.csv", NumericalRange<int>(2001, 2011))
-			}, ic, DELIM, MIGRATION_MID_YEAR, scale_factor, census_year_spacing, std::make_shared<const MigrantSelectorRandom>()));
+			LOG_DEBUG() << "Using dummy migration generator";
+			check_that<DataException>(!sp.do_brexit, "BREXIT modeling requires accurate migration model");
+			migration_generators.push_back(std::make_shared<MigrationGeneratorDummy>());
+		}
+		return migration_generators;
+	};
+	const bool single_scenario = scenario_names.empty();
+	if (single_scenario) {
+		for (const auto& observer : build_observers(scenarios.front().observations_filename)) {
+			simulator_builder.add_observer(observer);
 		}
+		for (const auto& migration_generator : build_migration_generators(scenarios.front())) {
+			simulator_builder.add_migration_generator(migration_generator);
+		}
+		simulator_builder.set_intermediate_observer_results_filename(scenarios.front().observations_filename);
 	} else {
-		LOG_DEBUG() << "Using dummy migration generator";
-		check_that<DataException>(!do_brexit, "BREXIT modeling requires accurate migration model");
+		// only used to initialise the base population
 		simulator_builder.add_migration_generator(std::make_shared<MigrationGeneratorDummy>());
 	}
 	LOG_INFO() << "Added migration generator";
 	simulator_builder.add_required_features({ CommonFeatures::MORTALITY() });
 	LOG_INFO() << "Added required features";
-	simulator_builder.set_intermediate_observer_results_filename(observations_filename);
 
 	// Build a simulator
 	Simulator simulator(simulator_builder.build(Contexts(std::make_shared<ImmutableContext>( schedule, ic), std::make_shared<MutableContext>())));
@@ -779,12 +894,59 @@ void do_main(const UserArguments& ua) {
 	}
 
 	// Bootstrap a population	
-	Population population("MAIN");
-	simulator.initialise_population(InitialiserGenerations(PopulationCalibrator::make_generations(female_census_numbers[0], male_census_numbers[0], start_year, max_age, ic, start_date)), population);
+	const InitialiserGenerations initialiser(PopulationCalibrator::make_generations(female_census_numbers[0], male_census_numbers[0], start_year, max_age, ic, start_date));
+	if (single_scenario) {
+		Population population("MAIN");
+		simulator.set_checkpointing(checkpoint_filename, checkpoint_interval);
+		if (resume_from_checkpoint) {
+			LOG_INFO() << "Resuming from checkpoint " << checkpoint_filename;
+			simulator.load_checkpoint(checkpoint_filename, population);
+		} else {
+			simulator.initialise_population(initialiser, population);
+		}
 
-	// Run the simulation!
-	simulator.run(population);
-	simulator.save_observer_results();
+		// Run the simulation!
+		simulator.run(population);
+		simulator.save_observer_results();
+	} else {
+		// Fork scenario simulations sharing the calibrated operators and the immutable context. Each one starts from a copy of the
+		// initialised base population and RNG state, so that the scenarios differ only by their parameters.
+		std::stringstream base_state;
+		if (!resume_from_checkpoint) {
+			Population population("MAIN");
+			simulator.initialise_population(initialiser, population);
+			simulator.save_checkpoint(base_state, population);
+		}
+		const size_t nbr_scenarios = scenarios.size();
+		std::vector<Simulator> scenario_simulators;
+		std::vector<Population> scenario_populations;
+		scenario_simulators.reserve(nbr_scenarios);
+		scenario_populations.reserve(nbr_scenarios);
+		for (const auto& sp : scenarios) {
+			LOG_INFO() << "Preparing scenario " << sp.name;
+			std::string observations_filename(sp.observations_filename);
+			scenario_simulators.push_back(simulator.fork(std::make_shared<MutableContext>(), build_observers(observations_filename), build_migration_generators(sp), std::move(observations_filename)));
+			scenario_populations.push_back(Population("MAIN"));
+			const std::string scenario_checkpoint_filename(checkpoint_filename.empty() ? checkpoint_filename : checkpoint_filename + "_" + sp.name);
+			scenario_simulators.back().set_checkpointing(scenario_checkpoint_filename, checkpoint_interval);
+			if (resume_from_checkpoint) {
+				LOG_INFO() << "Resuming scenario " << sp.name << " from checkpoint " << scenario_checkpoint_filename;
+				scenario_simulators.back().load_checkpoint(scenario_checkpoint_filename, scenario_populations.back());
+			} else {
+				base_state.seekg(0);
+				scenario_simulators.back().load_checkpoint(base_state, scenario_populations.back());
+			}
+		}
+		base_state.str(std::string());
+		LOG_INFO() << "Running " << nbr_scenarios << " scenarios using " << nbr_scenario_threads << " threads";
+		ThreadPool scenario_pool(nbr_scenario_threads);
+		scenario_pool.for_each_index(nbr_scenarios, [&](size_t i) {
+			LOG_INFO() << "Running scenario " << scenarios[i].name;
+			scenario_simulators[i].run(scenario_populations[i]);
+			scenario_simulators[i].save_observer_results();
+			LOG_INFO() << "Scenario " << scenarios[i].name << " finished";
+		});
+	}
 
 	LOG_INFO() << "Simulation finished";
 }
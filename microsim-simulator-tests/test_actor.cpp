@@ -3,7 +3,9 @@
 #include "microsim-simulator/actor.hpp"
 #include "microsim-simulator/actor_data.hpp"
 #include "microsim-simulator/history.hpp"
+#include "microsim-simulator/history/history_copy_on_write.hpp"
 #include "microsim-simulator/immutable_context.hpp"
+#include "microsim-simulator/variable_handle.hpp"
 
 using namespace averisera::microsim;
 
@@ -33,3 +35,42 @@ TEST(Actor, ToDataNullHistory) {
 	ASSERT_EQ(actor.id(), data.id);
 	ASSERT_EQ(0, data.histories.size());
 }
+
+TEST(Actor, HistoryByHandle) {
+	MockActor actor(1);
+	ImmutableContext imm_ctx;
+	imm_ctx.register_person_variable("A", HistoryFactory::DENSE<double>());
+	imm_ctx.register_person_variable("B", HistoryFactory::DENSE<double>());
+	std::vector<std::unique_ptr<History>> histories;
+	histories.push_back(nullptr);
+	histories.push_back(HistoryFactory::DENSE<double>()("B"));
+	actor.set_histories(std::move(histories));
+	const VariableHandle a("A");
+	const VariableHandle b("B");
+	const VariableHandle c("C");
+	ASSERT_FALSE(actor.has_history(imm_ctx, a));
+	ASSERT_TRUE(actor.has_history(imm_ctx, b));
+	ASSERT_FALSE(actor.has_history(imm_ctx, c));
+	ASSERT_EQ(&actor.history(1), &actor.history(imm_ctx, b));
+	ASSERT_THROW(actor.history(imm_ctx, a), std::domain_error);
+	ASSERT_THROW(actor.history(imm_ctx, c), std::domain_error);
+}
+
+TEST(Actor, ReleaseCopyOnWrite) {
+	std::shared_ptr<History> prototype(HistoryFactory::DENSE<double>()("A"));
+	prototype->append(averisera::Date(2000, 1, 1), 0.5);
+	MockActor actor(1);
+	std::vector<std::unique_ptr<History>> histories;
+	histories.push_back(std::unique_ptr<History>(new HistoryCopyOnWrite(prototype)));
+	histories.push_back(std::unique_ptr<History>(new HistoryCopyOnWrite(prototype)));
+	actor.set_histories(std::move(histories));
+	const MockActor& const_actor = actor;
+	ASSERT_NE(nullptr, dynamic_cast<const HistoryCopyOnWrite*>(&actor.history(0))); // still shared
+	actor.history(0).append(averisera::Date(2001, 1, 1), 1.5);
+	ASSERT_NE(nullptr, dynamic_cast<const HistoryCopyOnWrite*>(&const_actor.history(0)));
+	ASSERT_EQ(nullptr, dynamic_cast<const HistoryCopyOnWrite*>(&actor.history(0))); // wrapper released
+	ASSERT_EQ(2u, actor.history(0).size());
+	ASSERT_EQ(1.5, const_actor.history(0).last_as_double());
+	ASSERT_NE(nullptr, dynamic_cast<const HistoryCopyOnWrite*>(&actor.history(1)));
+	ASSERT_EQ(1u, prototype->size());
+}
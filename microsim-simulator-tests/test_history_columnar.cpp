@@ -0,0 +1,180 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/history/history_columnar.hpp"
+#include "microsim-simulator/history_factory.hpp"
+#include <cmath>
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+static const Date D0 = Date(1915, 3, 20);
+static const Date D1 = Date(1915, 4, 1);
+static const Date D2 = Date(1915, 4, 4);
+static const Date D3 = Date(1916, 4, 1);
+
+TEST(HistoryColumnar, Test) {
+	HistoryColumnar<uint8_t> hist(std::make_shared<HistoryColumnStore<uint8_t>>("HistoryColumnar.Test", std::vector<Date>({ D1, D3 })));
+	ASSERT_TRUE(hist.empty());
+	ASSERT_EQ("HistoryColumnar.Test", hist.name());
+	ASSERT_EQ(0u, hist.size());
+	ASSERT_THROW(hist.date(0), std::out_of_range);
+	ASSERT_THROW(hist.last_date(), std::logic_error);
+	ASSERT_THROW(hist.first_date(), std::logic_error);
+	ASSERT_THROW(hist.last_as_double(), std::logic_error);
+	ASSERT_THROW(hist.last_as_int(D1), std::out_of_range);
+	ASSERT_EQ(FP_NAN, std::fpclassify(hist.as_double(D1)));
+	ASSERT_THROW(hist.as_int(D1), std::runtime_error);
+
+	hist.append(D0, 1.4); // not a column date
+	hist.append(D1, History::int_t(3));
+	hist.append(D2, 5.0); // not a column date
+	hist.append(D3, 7.0);
+	ASSERT_THROW(hist.append(D3, 8.0), std::domain_error);
+	ASSERT_THROW(hist.append(Date(1916, 4, 2), 300.0), std::out_of_range);
+	ASSERT_EQ(4u, hist.size());
+	ASSERT_EQ(D0, hist.first_date());
+	ASSERT_EQ(D3, hist.last_date());
+	ASSERT_EQ(7, hist.last_as_int());
+	ASSERT_EQ(1.0, hist.as_double(D0));
+	ASSERT_EQ(3, hist.as_int(D1));
+	ASSERT_EQ(5, hist.as_int(D2));
+	ASSERT_EQ(FP_NAN, std::fpclassify(hist.as_double(Date(1915, 4, 2))));
+	ASSERT_EQ(D1, hist.last_date(Date(1915, 4, 2)));
+	ASSERT_EQ(3.0, hist.last_as_double(Date(1915, 4, 2)));
+	ASSERT_EQ(5, hist.last_as_int(Date(1916, 1, 1)));
+	ASSERT_THROW(hist.last_as_double(Date(1915, 1, 1)), std::out_of_range);
+	const std::vector<Date> dates({ D0, D1, D2, D3 });
+	const std::vector<History::int_t> values({ 1, 3, 5, 7 });
+	for (History::index_t i = 0; i < 4; ++i) {
+		ASSERT_EQ(dates[i], hist.date(i)) << i;
+		ASSERT_EQ(values[i], hist.as_int(i)) << i;
+		ASSERT_EQ(i, hist.last_index(dates[i])) << i;
+		ASSERT_EQ(i, hist.first_index(dates[i])) << i;
+	}
+	ASSERT_THROW(hist.as_int(4), std::out_of_range);
+	ASSERT_EQ(1u, hist.last_index(Date(1915, 4, 2)));
+	ASSERT_EQ(2u, hist.first_index(Date(1915, 4, 2)));
+	ASSERT_THROW(hist.last_index(Date(1915, 1, 1)), std::out_of_range);
+	ASSERT_THROW(hist.first_index(Date(1918, 1, 1)), std::out_of_range);
+
+	hist.correct(9.0);
+	ASSERT_EQ(9, hist.last_as_int());
+
+	const HistoryData hd = hist.to_data();
+	ASSERT_EQ("columnar uint8", hd.factory_type());
+	ASSERT_EQ(dates, hd.dates());
+	const std::unique_ptr<History> copy = hist.clone();
+	ASSERT_EQ(dates, copy->to_data().dates());
+	ASSERT_EQ(hd.values().as<uint8_t>(), copy->to_data().values().as<uint8_t>());
+	HistoryData hd2(hd);
+	const std::unique_ptr<History> restored = HistoryFactory::from_data(std::move(hd2));
+	ASSERT_NE(nullptr, dynamic_cast<HistoryColumnar<uint8_t>*>(restored.get()));
+	ASSERT_EQ(dates, restored->to_data().dates());
+	ASSERT_EQ(hd.values().as<uint8_t>(), restored->to_data().values().as<uint8_t>());
+
+	const std::unique_ptr<History> sparse(HistoryFactory::SPARSE_COLUMNAR<double>()("HistoryColumnar.Test"));
+	sparse->append(D1, 1.0);
+	sparse->append(D2, 1.0);
+	sparse->append(D3, 2.0);
+	ASSERT_EQ(2u, sparse->size());
+	ASSERT_EQ(1.0, sparse->as_double(D2));
+	HistoryData sparse_data(sparse->to_data());
+	ASSERT_EQ("sparse columnar double", sparse_data.factory_type());
+	const std::unique_ptr<History> sparse_restored = HistoryFactory::from_data(std::move(sparse_data));
+	ASSERT_EQ(2u, sparse_restored->size());
+	ASSERT_EQ(2.0, sparse_restored->last_as_double());
+}
+
+TEST(HistoryColumnar, SharedStore) {
+	HistoryColumnStores stores;
+	stores.set_dates(std::vector<Date>({ D1, D3 }));
+	const std::string name("HistoryColumnar.SharedStore");
+	std::unique_ptr<History> h1;
+	std::unique_ptr<History> h2;
+	{
+		const HistoryColumnStores::Scope scope(stores);
+		h1 = HistoryFactory::COLUMNAR<double>()(name);
+		h2 = HistoryFactory::COLUMNAR<double>()(name);
+	}
+	const auto store = stores.get<double>(name);
+	ASSERT_EQ(2u, store->nbr_slots());
+	ASSERT_EQ(2u, store->nbr_columns());
+	ASSERT_THROW(stores.set_dates(std::vector<Date>({ D1 })), std::logic_error);
+	h1->append(D1, 0.5);
+	h2->append(D0, 0.25);
+	h2->append(D1, 1.5);
+	ASSERT_EQ(1u, store->nbr_exceptions());
+	double sum = 0;
+	size_t cnt = 0;
+	ASSERT_TRUE(store->scan_column(D1, [&sum, &cnt](size_t, double v) { sum += v; ++cnt; }));
+	ASSERT_EQ(2u, cnt);
+	ASSERT_EQ(2.0, sum);
+	ASSERT_FALSE(store->scan_column(D0, [](size_t, double) {}));
+	ASSERT_TRUE(store->scan_column(D3, [](size_t, double) { FAIL(); }));
+
+	// clones use the same store
+	const std::unique_ptr<History> h2_copy(h2->clone());
+	ASSERT_EQ(3u, store->nbr_slots());
+	ASSERT_EQ(2u, h2_copy->size());
+	ASSERT_EQ(1.5, h2_copy->as_double(D1));
+
+	h2.reset();
+	ASSERT_EQ(2u, store->nbr_slots());
+	ASSERT_EQ(1u, store->nbr_exceptions());
+	std::unique_ptr<History> h3;
+	{
+		const HistoryColumnStores::Scope scope(stores);
+		h3 = HistoryFactory::COLUMNAR<double>()(name);
+	}
+	ASSERT_TRUE(h3->empty());
+	ASSERT_EQ(FP_NAN, std::fpclassify(h3->as_double(D1)));
+	cnt = 0;
+	store->scan_column(D1, [&cnt](size_t, double) { ++cnt; });
+	ASSERT_EQ(2u, cnt);
+
+	// other simulations and histories created without a scope do not share the store
+	HistoryColumnStores other_stores;
+	ASSERT_NE(store, other_stores.get<double>(name));
+	const std::unique_ptr<History> standalone(HistoryFactory::COLUMNAR<double>()(name));
+	standalone->append(D1, 4.0);
+	ASSERT_EQ(3u, store->nbr_slots()); // h1, h2_copy and h3
+	ASSERT_EQ(4.0, standalone->last_as_double());
+}
+
+TEST(HistoryColumnar, ManySlots) {
+	const auto store = std::make_shared<HistoryColumnStore<int32_t>>("HistoryColumnar.ManySlots", std::vector<Date>({ D1, D2, D3 }));
+	std::vector<std::unique_ptr<HistoryColumnar<int32_t>>> histories;
+	for (int32_t i = 0; i < 1000; ++i) {
+		histories.push_back(std::unique_ptr<HistoryColumnar<int32_t>>(new HistoryColumnar<int32_t>(store)));
+		if (i % 2) {
+			histories.back()->append(D1, History::int_t(i));
+		}
+		histories.back()->append(D3, History::int_t(-i));
+	}
+	ASSERT_EQ(1000u, store->nbr_slots());
+	int64_t sum = 0;
+	store->scan_column(D1, [&sum](size_t, int32_t v) { sum += v; });
+	ASSERT_EQ(250000, sum);
+	for (int32_t i = 0; i < 1000; ++i) {
+		const HistoryColumnar<int32_t>& h = *histories[static_cast<size_t>(i)];
+		ASSERT_EQ(static_cast<History::index_t>(1 + i % 2), h.size()) << i;
+		ASSERT_EQ(-i, h.last_as_int(D3)) << i;
+		ASSERT_EQ(-i, h.last_as_int(Date(2000, 1, 1))) << i;
+		if (i % 2) {
+			ASSERT_EQ(i, h.last_as_int(D2)) << i;
+		} else {
+			ASSERT_THROW(h.last_as_int(D2), std::out_of_range) << i;
+		}
+	}
+	histories.resize(10);
+	ASSERT_EQ(10u, store->nbr_slots());
+}
+
+TEST(HistoryColumnar, FromString) {
+	ASSERT_EQ(std::make_pair(HistoryFactory::COLUMNAR<double>(), std::string("double")), HistoryFactory::from_string("columnar double"));
+	ASSERT_EQ(std::make_pair(HistoryFactory::COLUMNAR<uint8_t>(), std::string("uint8")), HistoryFactory::from_string("columnar uint8"));
+	ASSERT_EQ(std::make_pair(HistoryFactory::SPARSE_COLUMNAR<float>(), std::string("float")), HistoryFactory::from_string("sparse columnar float"));
+	ASSERT_THROW(HistoryFactory::from_string("columnar"), std::runtime_error);
+	ASSERT_THROW(HistoryFactory::from_string("sparse columnar"), std::runtime_error);
+	ASSERT_THROW(HistoryFactory::from_string("columnar foo"), std::runtime_error);
+}
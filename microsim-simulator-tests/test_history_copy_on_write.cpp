@@ -0,0 +1,77 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/history/history_copy_on_write.hpp"
+#include "microsim-simulator/history_data.hpp"
+#include "microsim-simulator/history_factory.hpp"
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+TEST(HistoryCopyOnWrite, HistoryDataSharing) {
+	HistoryData hd("double", "X");
+	hd.append(Date(2000, 1, 1), 0.5);
+	ASSERT_FALSE(hd.is_data_shared());
+	HistoryData copy(hd);
+	ASSERT_TRUE(hd.is_data_shared());
+	ASSERT_EQ(hd.data_id(), copy.data_id());
+	copy.append(Date(2001, 1, 1), 1.5);
+	ASSERT_NE(hd.data_id(), copy.data_id());
+	ASSERT_FALSE(hd.is_data_shared());
+	ASSERT_EQ(1u, hd.size());
+	ASSERT_EQ(2u, copy.size());
+	ASSERT_EQ(0.5, hd.values().as<double>()[0]);
+
+	HistoryData copy2(hd);
+	copy2.set_value(0, 2.5);
+	ASSERT_EQ(0.5, hd.values().as<double>()[0]);
+	ASSERT_EQ(2.5, copy2.values().as<double>()[0]);
+	ASSERT_EQ(hd.dates().data(), copy2.dates().data()); // dates still shared
+
+	HistoryData moved(std::move(copy2));
+	ASSERT_EQ(0u, copy2.size());
+	ASSERT_EQ(1u, moved.size());
+}
+
+TEST(HistoryCopyOnWrite, Wrapper) {
+	std::shared_ptr<History> prototype(HistoryFactory::SPARSE<double>()("X"));
+	prototype->append(Date(2000, 1, 1), 0.5);
+	HistoryCopyOnWrite h1(prototype);
+	const std::unique_ptr<History> h2(h1.clone());
+	ASSERT_TRUE(h1.is_shared());
+	ASSERT_EQ("X", h1.name());
+	ASSERT_EQ(1u, h1.size());
+	ASSERT_EQ(0.5, h1.last_as_double());
+	h1.append(Date(2001, 1, 1), 1.5);
+	ASSERT_FALSE(h1.is_shared());
+	ASSERT_EQ(2u, h1.size());
+	ASSERT_EQ(1u, prototype->size());
+	ASSERT_EQ(1u, h2->size());
+	h2->correct(0.25);
+	ASSERT_EQ(0.25, h2->last_as_double());
+	ASSERT_EQ(0.5, prototype->last_as_double());
+	ASSERT_EQ(1.5, h1.clone()->last_as_double());
+	ASSERT_THROW(HistoryCopyOnWrite(nullptr), std::domain_error);
+}
+
+TEST(HistoryCopyOnWrite, Cache) {
+	HistoryData hd("double", "X");
+	hd.append(Date(2000, 1, 1), 0.5);
+	const HistoryData copy(hd);
+	HistoryData other("double", "X");
+	other.append(Date(2000, 1, 1), 0.5);
+	HistoryCopyOnWriteCache cache;
+	const auto factory = HistoryFactory::SPARSE<double>();
+	std::unique_ptr<History> h1(cache.make_history(0, "X", factory, hd));
+	const std::unique_ptr<History> h2(cache.make_history(0, "X", factory, copy));
+	ASSERT_EQ(1u, cache.size());
+	const std::unique_ptr<History> h3(cache.make_history(0, "X", factory, other));
+	ASSERT_EQ(2u, cache.size());
+	const std::unique_ptr<History> h4(cache.make_history(1, "X", factory, hd));
+	ASSERT_EQ(3u, cache.size());
+	ASSERT_EQ(0.5, h2->last_as_double());
+	ASSERT_EQ(0.5, h3->last_as_double());
+	h1->append(Date(2001, 1, 1), 1.0);
+	ASSERT_EQ(2u, h1->size());
+	ASSERT_EQ(1u, h2->size());
+	ASSERT_THROW(cache.make_history(0, "X", nullptr, hd), std::domain_error);
+}
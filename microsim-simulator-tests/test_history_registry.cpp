@@ -45,3 +45,16 @@ TEST(HistoryRegistry, Test) {
 
     ASSERT_THROW(registry.register_variable(""), std::domain_error) << "We should not be able to register an empty name";
 }
+
+TEST(HistoryRegistry, Id) {
+	HistoryRegistry registry;
+	registry.register_variable("BMI");
+	HistoryRegistry copy(registry);
+	ASSERT_NE(registry.id(), copy.id());
+	ASSERT_EQ(0u, copy.variable_index("BMI"));
+	const auto id = registry.id();
+	HistoryRegistry moved(std::move(registry));
+	ASSERT_EQ(id, moved.id());
+	ASSERT_NE(id, registry.id());
+	ASSERT_EQ(0u, registry.nbr_variables());
+}
@@ -4,9 +4,12 @@
 #include "microsim-simulator/immutable_context.hpp"
 #include "microsim-simulator/initialiser/initialiser_bootstrapping_unlinked.hpp"
 #include "microsim-simulator/initialiser/initialiser_bootstrapping_with_links.hpp"
+#include "microsim-simulator/initialiser/perturb_date_of_birth_day.hpp"
 #include "microsim-simulator/mutable_context.hpp"
 #include "microsim-simulator/person_data.hpp"
+#include "microsim-simulator/population.hpp"
 #include "microsim-simulator/population_data.hpp"
+#include "core/thread_pool.hpp"
 #include "helpers.hpp"
 
 using namespace averisera;
@@ -55,6 +58,50 @@ TEST(InitialiserBootstrapping, Unlinked) {
     ASSERT_TRUE(result.persons[1].mother_id == Actor::INVALID_ID);
 }
 
+TEST(InitialiserBootstrapping, UnlinkedParallel) {
+	const size_t n = 3000; // several chunks
+	std::vector<PopulationData> results;
+	for (unsigned int nbr_threads : { 1u, 3u }) {
+		Contexts ctx;
+		ctx.mutable_ctx().increase_id(100);
+		std::vector<std::unique_ptr<const DataPerturbation<PersonData>>> perturbations;
+		perturbations.push_back(std::make_unique<PerturbDateOfBirthDay>(false));
+		InitialiserBootstrappingUnlinked initialiser(std::make_unique<InitialiserBootstrapping::PersonDataSamplerFromData>(make_population()), std::move(perturbations));
+		ThreadPool pool(nbr_threads);
+		results.push_back(initialiser.initialise_parallel(n, ctx, pool));
+		ASSERT_EQ(100 + n, ctx.mutable_ctx().get_max_id());
+		ASSERT_EQ(n, results.back().persons.size());
+	}
+	const auto sample = make_population();
+	std::vector<size_t> counts(sample.size(), 0);
+	for (size_t i = 0; i < n; ++i) {
+		const PersonData& pd = results.front().persons[i];
+		ASSERT_EQ(101 + i, pd.id) << i;
+		ASSERT_EQ(pd.id, results.back().persons[i].id) << i;
+		ASSERT_EQ(pd.date_of_birth, results.back().persons[i].date_of_birth) << i;
+		ASSERT_EQ(Actor::INVALID_ID, pd.mother_id) << i;
+		ASSERT_TRUE(pd.children.empty()) << i;
+		for (size_t k = 0; k < sample.size(); ++k) {
+			if (sample[k].date_of_birth.year() == pd.date_of_birth.year()) {
+				++counts[k];
+			}
+		}
+	}
+	for (size_t k = 0; k < sample.size(); ++k) {
+		ASSERT_GT(counts[k], n / 5) << k;
+	}
+
+	Contexts ctx;
+	ThreadPool pool(3);
+	Population population;
+	population.import_data(results.back(), ctx, true, false, &pool);
+	ASSERT_EQ(n, population.persons().size());
+	for (size_t i = 0; i < n; ++i) {
+		ASSERT_EQ(101 + i, population.persons()[i]->id()) << i;
+		ASSERT_EQ(results.front().persons[i].date_of_birth, population.persons()[i]->date_of_birth()) << i;
+	}
+}
+
 TEST(InitialiserBootstrapping, WithLinks) {
     Contexts ctx(ctx_with_rng_precalc({0.5, 1.0}));
     //Contexts ctx(std::make_shared<ImmutableContext>(), std::make_shared<MutableContext>(std::unique_ptr<RNG>(new RNGPrecalc({0.5, 1.0}))));
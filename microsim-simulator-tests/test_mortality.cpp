@@ -0,0 +1,76 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/contexts.hpp"
+#include "microsim-simulator/mutable_context.hpp"
+#include "microsim-simulator/person.hpp"
+#include "microsim-simulator/predicate_factory.hpp"
+#include "microsim-simulator/operator/mortality.hpp"
+#include "microsim-core/anchored_hazard_curve.hpp"
+#include "microsim-core/hazard_curve.hpp"
+#include "microsim-core/hazard_curve_factory.hpp"
+#include "microsim-core/schedule.hpp"
+#include "core/daycount.hpp"
+#include "core/thread_pool.hpp"
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+static std::unique_ptr<Mortality> make_mortality() {
+	const HazardModel hazard_model(std::shared_ptr<const AnchoredHazardCurve>(AnchoredHazardCurve::build(Date(1950, 1, 1), Daycount::DAYS_365(), HazardCurveFactory::make_flat(0.3))));
+	return std::make_unique<Mortality>(hazard_model, std::vector<std::shared_ptr<const RelativeRisk<Person>>>(), PredicateFactory::make_true<Person>(), nullptr, true);
+}
+
+static std::vector<std::shared_ptr<Person>> make_persons() {
+	std::vector<std::shared_ptr<Person>> persons;
+	for (Actor::id_t i = 0; i < 1200; ++i) {
+		persons.push_back(std::make_shared<Person>(i + 1, PersonAttributes(Sex::FEMALE, 0), Date(static_cast<Date::year_type>(1960 + i % 7), 1, 1)));
+	}
+	return persons;
+}
+
+static std::vector<Date> dates_of_death(const std::vector<std::shared_ptr<Person>>& persons) {
+	std::vector<Date> dates;
+	for (const auto& p : persons) {
+		dates.push_back(p->date_of_death());
+	}
+	return dates;
+}
+
+static const Schedule SCHEDULE(std::vector<Date>({ Date(2000, 1, 1), Date(2001, 1, 1) }));
+
+TEST(Mortality, BatchMatchesSingle) {
+	const std::unique_ptr<Mortality> op_ptr(make_mortality());
+	const Mortality& op = *op_ptr;
+	const auto persons1 = make_persons();
+	Contexts ctx1(SCHEDULE);
+	op.apply(persons1, ctx1);
+	const auto persons2 = make_persons();
+	Contexts ctx2(SCHEDULE);
+	for (const auto& p : persons2) {
+		op.apply(p, ctx2);
+	}
+	const auto dates = dates_of_death(persons1);
+	ASSERT_EQ(dates_of_death(persons2), dates);
+	ASSERT_GT(std::count_if(dates.begin(), dates.end(), [](Date d) { return !d.is_special(); }), 0);
+	ASSERT_GT(std::count_if(dates.begin(), dates.end(), [](Date d) { return d.is_special(); }), 0);
+	ASSERT_EQ(7u, op.hazard_model_cache().size());
+	ASSERT_EQ(7u, op.hazard_model_cache().misses());
+}
+
+TEST(Mortality, BatchParallelMatchesSingle) {
+	const std::unique_ptr<Mortality> op_ptr(make_mortality());
+	const Mortality& op = *op_ptr;
+	const auto persons1 = make_persons();
+	Contexts ctx1(SCHEDULE);
+	ThreadPool pool(3);
+	const auto make_stream = [](size_t i) { return RNGPhilox(42, i); };
+	op.apply_parallel(persons1, ctx1, pool, make_stream);
+	const auto persons2 = make_persons();
+	Contexts ctx2(SCHEDULE);
+	for (size_t i = 0; i < persons2.size(); ++i) {
+		RNGPhilox stream(make_stream(i));
+		const MutableContext::RNGOverride rng_override(ctx2.mutable_ctx(), stream);
+		op.apply(persons2[i], ctx2);
+	}
+	ASSERT_EQ(dates_of_death(persons2), dates_of_death(persons1));
+}
@@ -0,0 +1,124 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/contexts.hpp"
+#include "microsim-simulator/person.hpp"
+#include "microsim-simulator/population.hpp"
+#include "microsim-simulator/predicate_factory.hpp"
+#include "microsim-simulator/observer/observer_stats.hpp"
+#include "microsim-simulator/observer/observer_result_saver_incremental.hpp"
+#include "microsim-core/schedule.hpp"
+#include "core/background_file_writer.hpp"
+#include "testing/temporary_file.hpp"
+#include <fstream>
+#include <sstream>
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+static std::string read_file(const std::string& filename) {
+	std::ifstream ifs(filename);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+TEST(ObserverStats, SinglePass) {
+	Population population;
+	for (Actor::id_t i = 0; i < 20; ++i) {
+		population.add_person(std::make_shared<Person>(i + 1, PersonAttributes(i % 3 ? Sex::FEMALE : Sex::MALE, 0), Date(static_cast<Date::year_type>(1950 + i), 3, 1)));
+	}
+	const Contexts ctx(Schedule(std::vector<Date>({ Date(2000, 1, 1), Date(2001, 1, 1) })));
+	const std::vector<ObservedQuantity<Person>> quantities({
+		ObservedQuantity<Person>("age", [](const Person& p, const Contexts& c) { return p.age_fract(c.asof()); }),
+		ObservedQuantity<Person>("id", [](const Person& p, const Contexts&) { return static_cast<double>(p.id()); })
+	});
+	ObserverStats<Person> observer1(nullptr, quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	ObserverStats<Person> observer2(nullptr, quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	ASSERT_TRUE(observer2.is_single_pass());
+	ASSERT_NE(nullptr, observer2.pass_predicate());
+	observer1.observe(population, ctx);
+	observer2.begin_pass(ctx);
+	for (const auto& person : population.persons()) {
+		if (observer2.pass_predicate()->select(*person, ctx)) {
+			observer2.observe_person(*person, ctx);
+		}
+	}
+	observer2.end_pass(ctx);
+	std::stringstream ss1;
+	std::stringstream ss2;
+	observer1.save_results(ss1, ctx.immutable_ctx());
+	observer2.save_results(ss2, ctx.immutable_ctx());
+	ASSERT_EQ(ss1.str(), ss2.str());
+	ASSERT_NE(std::string::npos, ss1.str().find("#MEDIAN"));
+}
+
+TEST(ObserverStats, Quantiles) {
+	Population population;
+	for (Actor::id_t i = 0; i < 11; ++i) {
+		population.add_person(std::make_shared<Person>(i + 1, PersonAttributes(Sex::FEMALE, 0), Date(static_cast<Date::year_type>(1950 + i), 3, 1)));
+	}
+	const Contexts ctx(Schedule(std::vector<Date>({ Date(2000, 1, 1), Date(2001, 1, 1) })));
+	const std::vector<ObservedQuantity<Person>> quantities({
+		ObservedQuantity<Person>("id", [](const Person& p, const Contexts&) { return static_cast<double>(p.id()); })
+	});
+	ObserverStats<Person> observer(nullptr, quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	observer.add_quantile(0.1).add_quantile(0.9);
+	ASSERT_THROW(observer.add_quantile(1.5), std::domain_error);
+	ASSERT_THROW(observer.set_quantile_capacity(1), std::domain_error);
+	observer.observe(population, ctx);
+	std::stringstream ss;
+	observer.save_results(ss, ctx.immutable_ctx());
+	const std::string results(ss.str());
+	ASSERT_NE(std::string::npos, results.find("#MEDIAN\nDate\tid\n2000-01-01\t6\n"));
+	ASSERT_NE(std::string::npos, results.find("#QUANTILE_0.1\nDate\tid\n2000-01-01\t2\n"));
+	ASSERT_NE(std::string::npos, results.find("#QUANTILE_0.9\nDate\tid\n2000-01-01\t10\n"));
+}
+
+TEST(ObserverStats, IncrementalResults) {
+	Population population;
+	for (Actor::id_t i = 0; i < 5; ++i) {
+		population.add_person(std::make_shared<Person>(i + 1, PersonAttributes(Sex::FEMALE, 0), Date(static_cast<Date::year_type>(1950 + i), 3, 1)));
+	}
+	const Contexts ctx(Schedule(std::vector<Date>({ Date(2000, 1, 1), Date(2001, 1, 1), Date(2002, 1, 1) })));
+	const std::vector<ObservedQuantity<Person>> quantities({
+		ObservedQuantity<Person>("age", [](const Person& p, const Contexts& c) { return p.age_fract(c.asof()); })
+	});
+	averisera::testing::TemporaryFile tmp_intermediate;
+	averisera::testing::TemporaryFile tmp_final;
+	averisera::testing::TemporaryFile tmp_same;
+	const auto writer = std::make_shared<BackgroundFileWriter>();
+	const auto saver = std::make_shared<ObserverResultSaverIncremental>(tmp_intermediate.filename, tmp_final.filename, writer);
+	ObserverStats<Person> observer(saver, quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	ObserverStats<Person> observer_same(std::make_shared<ObserverResultSaverIncremental>(tmp_same.filename), quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	ASSERT_TRUE(observer.has_date_results());
+	for (size_t i = 0; i < 3; ++i) {
+		observer.observe(population, ctx);
+		observer_same.observe(population, ctx);
+		if (i < 2) {
+			observer.save_intermediate_results(ctx.immutable_ctx(), ctx.asof());
+			observer_same.save_intermediate_results(ctx.immutable_ctx(), ctx.asof());
+		}
+		ctx.mutable_ctx().advance_date_index();
+	}
+	writer->flush();
+	std::stringstream expected_intermediate;
+	observer.date_results_writer(ctx.immutable_ctx(), Date(), Date(2001, 1, 1))(expected_intermediate);
+	const std::string intermediate(read_file(tmp_intermediate.filename));
+	ASSERT_EQ(expected_intermediate.str(), intermediate);
+	ASSERT_NE(std::string::npos, intermediate.find("#MARGINALS 2001-01-01"));
+	ASSERT_EQ(std::string::npos, intermediate.find("#MARGINALS 2002-01-01"));
+	ASSERT_EQ(std::string::npos, intermediate.find("#MEAN"));
+	// intermediate results have the same format as the final ones
+	std::stringstream expected_final;
+	observer.save_results(expected_final, ctx.immutable_ctx());
+	ASSERT_EQ(0u, expected_final.str().find(intermediate));
+	observer.save_final_results(ctx.immutable_ctx());
+	observer_same.save_final_results(ctx.immutable_ctx());
+	ASSERT_EQ(expected_final.str(), read_file(tmp_final.filename));
+	ASSERT_EQ(expected_final.str(), read_file(tmp_same.filename));
+	// results of only one observer can be appended to the file
+	const Contexts other_ctx(Schedule(std::vector<Date>({ Date(2000, 1, 1), Date(2001, 1, 1) })));
+	ObserverStats<Person> other(saver, quantities, PredicateFactory::make_sex(Sex::FEMALE, true), true);
+	other.observe(population, other_ctx);
+	ASSERT_THROW(other.save_intermediate_results(other_ctx.immutable_ctx(), other_ctx.asof()), std::logic_error);
+}
@@ -0,0 +1,131 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/contexts.hpp"
+#include "microsim-simulator/mutable_context.hpp"
+#include "microsim-simulator/operator_individual.hpp"
+#include "microsim-simulator/predicate_factory.hpp"
+#include "core/thread_pool.hpp"
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+struct RandomValueHolder {
+	RandomValueHolder(Actor::id_t n_id)
+		: value(0), id_(n_id) {}
+
+	Actor::id_t id() const {
+		return id_;
+	}
+
+	double value;
+private:
+	Actor::id_t id_;
+};
+
+class OperatorDrawingValue : public OperatorIndividual<RandomValueHolder> {
+public:
+	OperatorDrawingValue(bool parallelisable)
+		: OperatorIndividual<RandomValueHolder>(false), pred_(PredicateFactory::make_true<RandomValueHolder>()), parallelisable_(parallelisable) {}
+
+	void apply(const std::shared_ptr<RandomValueHolder>& obj, const Contexts& contexts) const override {
+		obj->value = contexts.mutable_ctx().rng().next_uniform();
+	}
+
+	bool is_parallelisable() const override {
+		return parallelisable_;
+	}
+
+	const Predicate<RandomValueHolder>& predicate() const override {
+		return *pred_;
+	}
+
+	const std::string& name() const override {
+		static const std::string str("DrawingValue");
+		return str;
+	}
+private:
+	std::shared_ptr<const Predicate<RandomValueHolder>> pred_;
+	bool parallelisable_;
+};
+
+static std::vector<std::shared_ptr<RandomValueHolder>> make_holders(size_t n) {
+	std::vector<std::shared_ptr<RandomValueHolder>> holders;
+	for (size_t i = 0; i < n; ++i) {
+		holders.push_back(std::make_shared<RandomValueHolder>(static_cast<Actor::id_t>(i + 1)));
+	}
+	return holders;
+}
+
+static std::vector<double> apply_parallel(const OperatorDrawingValue& op, unsigned int nbr_threads, size_t stream_idx) {
+	auto holders = make_holders(1000);
+	Contexts ctx;
+	ThreadPool pool(nbr_threads);
+	const MutableContext& mctx = ctx.mutable_ctx();
+	op.apply_parallel(holders, ctx, pool, [&holders, &mctx, stream_idx](size_t i) { return mctx.make_stream(holders[i]->id(), stream_idx); });
+	std::vector<double> values;
+	for (const auto& h : holders) {
+		values.push_back(h->value);
+	}
+	return values;
+}
+
+TEST(OperatorIndividual, ApplyParallel) {
+	const OperatorDrawingValue op(true);
+	const std::vector<double> values1 = apply_parallel(op, 1, 0);
+	const std::vector<double> values4 = apply_parallel(op, 4, 0);
+	ASSERT_EQ(values1, values4);
+	for (double v : values1) {
+		ASSERT_GE(v, 0.0);
+		ASSERT_LT(v, 1.0);
+	}
+	ASSERT_NE(values1[0], values1[1]);
+	const std::vector<double> values_other_stream = apply_parallel(op, 4, 1);
+	ASSERT_NE(values1, values_other_stream);
+}
+
+TEST(OperatorIndividual, ApplyParallelFallback) {
+	const OperatorDrawingValue op(false);
+	auto holders = make_holders(10);
+	Contexts ctx1;
+	ThreadPool pool(2);
+	op.apply_parallel(holders, ctx1, pool, [](size_t i) { return RNGPhilox(1, i); });
+	Contexts ctx2;
+	for (const auto& h : holders) {
+		ASSERT_EQ(ctx2.mutable_ctx().rng().next_uniform(), h->value);
+	}
+}
+
+TEST(OperatorIndividual, ApplyParallelNull) {
+	const OperatorDrawingValue op(true);
+	auto holders = make_holders(10);
+	holders[5] = nullptr;
+	Contexts ctx;
+	ThreadPool pool(2);
+	ASSERT_THROW(op.apply_parallel(holders, ctx, pool, [](size_t i) { return RNGPhilox(1, i); }), std::domain_error);
+}
+
+TEST(OperatorIndividual, ApplySpan) {
+	const OperatorDrawingValue op(true);
+	auto holders = make_holders(1000);
+	std::vector<const std::shared_ptr<RandomValueHolder>*> refs;
+	for (size_t i = 0; i < holders.size(); i += 2) {
+		refs.push_back(&holders[i]);
+	}
+	const ActorSpan<RandomValueHolder> span(refs);
+	ASSERT_EQ(refs.size(), span.size());
+	ASSERT_EQ(holders[4], span[2]);
+	ASSERT_EQ(holders[8], span.subspan(3, 2)[1]);
+	Contexts ctx;
+	ThreadPool pool(4);
+	const MutableContext& mctx = ctx.mutable_ctx();
+	op.apply_span_parallel(span, ctx, pool, [span, &mctx](size_t i) { return mctx.make_stream(span[i]->id(), 0); });
+	const std::vector<double> values = apply_parallel(op, 1, 0);
+	for (size_t i = 0; i < holders.size(); ++i) {
+		ASSERT_EQ(1, holders[i].use_count()) << i;
+		if (i % 2 == 0) {
+			ASSERT_EQ(values[i], holders[i]->value) << i;
+		} else {
+			ASSERT_EQ(0.0, holders[i]->value) << i;
+		}
+	}
+}
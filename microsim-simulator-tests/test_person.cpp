@@ -8,6 +8,7 @@
 #include "microsim-simulator/person_data.hpp"
 #include "microsim-simulator/history_factory.hpp"
 #include "microsim-simulator/immutable_context.hpp"
+#include "core/thread_pool.hpp"
 
 using namespace averisera;
 using namespace averisera::microsim;
@@ -104,6 +105,22 @@ TEST(Person, ToData) {
 	ASSERT_EQ(data.conception_date, p2->conception_date());
 }
 
+TEST(Person, FromDataPooled) {
+	Person p(101, PersonAttributes(Sex::FEMALE, 2), Date(1989, 6, 4));
+	p.add_fetus(Fetus(PersonAttributes(Sex::MALE, 2), Date(2015, 7, 1)));
+	p.set_immigration_date(Date(2008, 12, 4));
+	ImmutableContext im_ctx;
+	const auto pool = std::make_shared<MemoryPool>();
+	Person::shared_ptr p2 = Person::from_data(p.to_data(im_ctx), im_ctx, PoolAllocator<Person>(pool));
+	ASSERT_EQ(1u, pool->nbr_blocks());
+	ASSERT_EQ(101u, p2->id());
+	ASSERT_EQ(1, p2->nbr_fetuses());
+	ASSERT_EQ(p.attributes(), p2->attributes());
+	ASSERT_EQ(p.immigration_date(), p2->immigration_date());
+	p2.reset();
+	ASSERT_EQ(0u, pool->nbr_blocks());
+}
+
 TEST(Person, ToDataMotherAndChild) {
 	Contexts ctx(Date(2020, 9, 1));
 	std::shared_ptr<Person> mother_ptr(new Person(ctx.mutable_ctx().gen_id(), PersonAttributes(Sex::FEMALE, 2), Date(2000, 1, 1)));
@@ -139,3 +156,58 @@ TEST(Person, Fetuses) {
 	ASSERT_EQ(0, p2.nbr_fetuses());
 	ASSERT_NO_THROW(p2.remove_fetuses(Date(2010, 1, 1)));
 }
+
+static void make_families(const Actor::id_t id_step, std::vector<PersonData>& datas, std::vector<Person::shared_ptr>& persons) {
+	Actor::id_t id = 1;
+	for (int m = 0; m < 300; ++m) {
+		PersonData mother;
+		mother.id = id;
+		id += id_step;
+		mother.attributes = PersonAttributes(Sex::FEMALE, 0);
+		mother.date_of_birth = Date(1950, 1, 1);
+		datas.push_back(std::move(mother));
+		const size_t mother_idx = datas.size() - 1;
+		for (unsigned short k = 0; k < 3; ++k) {
+			PersonData child;
+			child.id = id;
+			id += id_step;
+			child.attributes = PersonAttributes(k % 2 ? Sex::MALE : Sex::FEMALE, 0);
+			child.date_of_birth = Date(static_cast<unsigned short>(1980 + k), 6, 1);
+			datas[mother_idx].link_child(child, Date(static_cast<unsigned short>(1979 + k), 9, 1));
+			datas.push_back(std::move(child));
+		}
+	}
+	for (const PersonData& pd : datas) {
+		persons.push_back(std::make_shared<Person>(pd.id, pd.attributes, pd.date_of_birth));
+	}
+}
+
+TEST(Person, LinkParentsChildren) {
+	ThreadPool pool(3);
+	for (Actor::id_t id_step : { 1u, 1000u }) {
+		for (ThreadPool* pool_ptr : { static_cast<ThreadPool*>(nullptr), &pool }) {
+			std::vector<PersonData> datas;
+			std::vector<Person::shared_ptr> persons;
+			make_families(id_step, datas, persons);
+			Person::link_parents_child(persons, datas, pool_ptr);
+			for (size_t i = 0; i < persons.size(); i += 4) {
+				const Person::shared_ptr& mother = persons[i];
+				ASSERT_EQ(nullptr, mother->mother().lock()) << i;
+				ASSERT_EQ(3u, mother->nbr_children()) << i;
+				for (unsigned int k = 0; k < 3; ++k) {
+					const Person::shared_ptr& child = persons[i + 1 + k];
+					ASSERT_EQ(mother, child->mother().lock()) << i;
+					ASSERT_EQ(child, mother->get_child(k)) << i;
+					ASSERT_EQ(Date(static_cast<unsigned short>(1979 + k), 9, 1), child->conception_date()) << i;
+				}
+			}
+		}
+	}
+	std::vector<PersonData> datas;
+	std::vector<Person::shared_ptr> persons;
+	make_families(1, datas, persons);
+	datas[1].mother_id = 5000;
+	ASSERT_THROW(Person::link_parents_child(persons, datas), std::domain_error);
+	persons.pop_back();
+	ASSERT_THROW(Person::link_parents_child(persons, datas), std::domain_error);
+}
@@ -63,6 +63,20 @@ TEST(Perturbations, PerturbDateOfBirthDayWithShift) {
     ASSERT_EQ(d4, datas[1].date_of_birth);
 }
 
+TEST(Perturbations, PerturbDateOfBirthDayRange) {
+    const Date dob(1989, 6, 4);
+    const auto perturbed_dob = [dob](double u) {
+        std::vector<PersonData> datas(1);
+        datas[0].id = 1;
+        datas[0].date_of_birth = dob;
+        Contexts ctx(ctx_with_rng_precalc({u}));
+        PerturbDateOfBirthDay(false).apply(datas, ctx);
+        return datas[0].date_of_birth;
+    };
+    ASSERT_EQ(Date(1989, 6, 1), perturbed_dob(0.0));
+    ASSERT_EQ(Date(1989, 6, 30), perturbed_dob(1.0));
+}
+
 TEST(Perturbations, PerturbDateOfBirthMonthNoShiftWithTrunc) {
     const Date d1(1989, 6, 30);
     const Date d2(1988, 9, 27);
@@ -39,3 +39,201 @@ TEST(Population, GetPerson) {
     ASSERT_EQ(p, pop.get_person(101));
     ASSERT_EQ(nullptr, pop.get_person(102));
 }
+
+static void assert_columns_match(const Population& pop) {
+	PopulationColumns expected;
+	expected.rebuild(pop.persons());
+	const PopulationColumns& actual = pop.columns();
+	ASSERT_EQ(expected.ids(), actual.ids());
+	ASSERT_EQ(expected.dates_of_birth(), actual.dates_of_birth());
+	ASSERT_EQ(expected.years_of_birth(), actual.years_of_birth());
+	ASSERT_EQ(expected.sexes(), actual.sexes());
+	ASSERT_EQ(expected.ethnicities(), actual.ethnicities());
+	ASSERT_EQ(expected.dates_of_death(), actual.dates_of_death());
+	ASSERT_EQ(expected.immigration_dates(), actual.immigration_dates());
+}
+
+TEST(Population, Columns) {
+    Population pop;
+    ASSERT_THROW(pop.columns(), std::logic_error);
+    const std::shared_ptr<Person> p1 = std::make_shared<Person>(101, PersonAttributes(Sex::MALE, 1), Date(1989, 6, 4));
+    const std::shared_ptr<Person> p2 = std::make_shared<Person>(102, PersonAttributes(Sex::FEMALE, 2), Date(1995, 1, 1));
+    pop.add_person(p1);
+    pop.add_person(p2);
+    pop.update_columns();
+    const PopulationColumns& columns = pop.columns();
+    ASSERT_EQ(2u, columns.size());
+    ASSERT_EQ(std::vector<Actor::id_t>({ 101, 102 }), columns.ids());
+    ASSERT_EQ(std::vector<Date>({ Date(1989, 6, 4), Date(1995, 1, 1) }), columns.dates_of_birth());
+    ASSERT_EQ(std::vector<Date::year_type>({ 1989, 1995 }), columns.years_of_birth());
+    ASSERT_EQ(std::vector<Sex>({ Sex::MALE, Sex::FEMALE }), columns.sexes());
+    ASSERT_EQ(std::vector<PersonAttributes::ethnicity_t>({ 1, 2 }), columns.ethnicities());
+    ASSERT_TRUE(columns.dates_of_death()[0].is_not_a_date());
+    ASSERT_EQ(std::vector<size_t>({ 0 }), columns.live_indices(Date(1990, 1, 1)));
+    ASSERT_EQ(std::vector<size_t>({ 0, 1 }), columns.live_indices(Date(2000, 1, 1)));
+    p1->die(Date(1999, 1, 1));
+    // persons update the columns of their population
+    ASSERT_EQ(Date(1999, 1, 1), columns.dates_of_death()[0]);
+    ASSERT_EQ(std::vector<size_t>({ 1 }), columns.live_indices(Date(2000, 1, 1)));
+    ASSERT_EQ(pop.live_persons(Date(2000, 1, 1)), pop.live_persons_from_columns(Date(2000, 1, 1)));
+    p2->set_immigration_date(Date(2000, 1, 1));
+    ASSERT_EQ(Date(2000, 1, 1), columns.immigration_dates()[1]);
+    pop.add_person(std::make_shared<Person>(103, PersonAttributes(Sex::MALE, 1), Date(2001, 1, 1)));
+    ASSERT_EQ(3u, columns.size());
+    assert_columns_match(pop);
+    pop.remove_persons({ p2 });
+    assert_columns_match(pop);
+    // a removed person no longer updates the columns
+    p2->die(Date(2002, 1, 1));
+    assert_columns_match(pop);
+    Population other;
+    other.add_persons({ std::make_shared<Person>(100, PersonAttributes(Sex::FEMALE, 3), Date(1970, 1, 1)), std::make_shared<Person>(102, PersonAttributes(Sex::FEMALE, 3), Date(1971, 1, 1)) });
+    pop.merge(other);
+    ASSERT_EQ(std::vector<Actor::id_t>({ 100, 101, 102, 103 }), columns.ids());
+    pop.persons()[2]->die(Date(2003, 1, 1));
+    ASSERT_EQ(Date(2003, 1, 1), columns.dates_of_death()[2]);
+    assert_columns_match(pop);
+    ASSERT_EQ(1u, pop.archive_dead_persons(Date(2000, 1, 1)));
+    ASSERT_EQ(std::vector<Actor::id_t>({ 100, 102, 103 }), columns.ids());
+    pop.persons()[2]->die(Date(2004, 1, 1));
+    assert_columns_match(pop);
+    pop.wipe_out();
+    ASSERT_EQ(0u, columns.size());
+}
+
+static std::vector<size_t> brute_force_live_indices(const Population& pop, Date asof) {
+	std::vector<size_t> indices;
+	for (size_t i = 0; i < pop.persons().size(); ++i) {
+		if (pop.persons()[i]->is_alive(asof)) {
+			indices.push_back(i);
+		}
+	}
+	return indices;
+}
+
+TEST(Population, AddRemoveMerge) {
+	const auto make_person = [](Actor::id_t id) {
+		return std::make_shared<Person>(id, PersonAttributes(Sex::FEMALE, 0), Date(1990, 1, 1));
+	};
+	const auto ids = [](const Population& population) {
+		std::vector<Actor::id_t> result;
+		for (const auto& p : population.persons()) {
+			result.push_back(p->id());
+		}
+		return result;
+	};
+	Population pop;
+	pop.add_persons({ make_person(2), make_person(4), make_person(6) });
+	pop.add_persons({ make_person(8), make_person(10) });
+	ASSERT_EQ(std::vector<Actor::id_t>({ 2, 4, 6, 8, 10 }), ids(pop));
+	ASSERT_THROW(pop.add_persons({ make_person(9), make_person(12) }), std::domain_error);
+	ASSERT_THROW(pop.add_persons({ make_person(14), make_person(12) }), std::domain_error);
+	ASSERT_EQ(5u, pop.persons().size());
+	ASSERT_THROW(pop.remove_persons({ pop.persons()[1], make_person(5) }), std::domain_error);
+	ASSERT_THROW(pop.remove_persons({ pop.persons()[1], pop.persons()[0] }), std::domain_error);
+	ASSERT_EQ(std::vector<Actor::id_t>({ 2, 4, 6, 8, 10 }), ids(pop));
+	pop.remove_persons({ pop.persons()[1], pop.persons()[3] });
+	ASSERT_EQ(std::vector<Actor::id_t>({ 2, 6, 10 }), ids(pop));
+	Population other;
+	other.add_persons({ make_person(1), make_person(7), make_person(11), make_person(12) });
+	pop.merge(other);
+	ASSERT_EQ(std::vector<Actor::id_t>({ 1, 2, 6, 7, 10, 11, 12 }), ids(pop));
+	Population duplicates;
+	duplicates.add_persons({ make_person(3), make_person(6) });
+	ASSERT_THROW(pop.merge(duplicates), std::logic_error);
+	ASSERT_THROW(pop.merge(other), std::logic_error);
+	ASSERT_EQ(std::vector<Actor::id_t>({ 1, 2, 6, 7, 10, 11, 12 }), ids(pop));
+}
+
+TEST(Population, LiveIndices) {
+	Population pop;
+	for (int i = 0; i < 20; ++i) {
+		pop.add_person(std::make_shared<Person>(static_cast<Actor::id_t>(i + 1), PersonAttributes(i % 2 ? Sex::FEMALE : Sex::MALE, 0), Date(static_cast<Date::year_type>(1990 + i), 1, 1)));
+	}
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2000, 6, 1)), pop.live_indices(Date(2000, 6, 1)));
+	pop.persons()[3]->die(Date(2001, 1, 1));
+	pop.persons()[7]->die(Date(2003, 1, 1));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2002, 6, 1)), pop.live_indices(Date(2002, 6, 1)));
+	pop.add_person(std::make_shared<Person>(21, PersonAttributes(Sex::MALE, 0), Date(2002, 7, 1)));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2003, 6, 1)), pop.live_indices(Date(2003, 6, 1)));
+	pop.remove_persons({ pop.persons()[2], pop.persons()[7], pop.persons()[10] });
+	ASSERT_EQ(18u, pop.persons().size());
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2004, 6, 1)), pop.live_indices(Date(2004, 6, 1)));
+	const std::vector<Actor::shared_ptr<Person>> live_persons(pop.live_persons(Date(2004, 6, 1)));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2004, 6, 1)).size(), live_persons.size());
+	for (size_t i = 0; i < live_persons.size(); ++i) {
+		ASSERT_EQ(pop.persons()[pop.live_indices(Date(2004, 6, 1))[i]], live_persons[i]);
+	}
+	// postponed death
+	pop.persons()[2]->die(Date(2005, 1, 1));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2004, 6, 1)), pop.live_indices(Date(2004, 6, 1)));
+	// earlier date
+	ASSERT_EQ(brute_force_live_indices(pop, Date(1999, 6, 1)), pop.live_indices(Date(1999, 6, 1)));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2010, 6, 1)), pop.live_indices(Date(2010, 6, 1)));
+	pop.update_columns();
+	ASSERT_EQ(pop.live_persons(Date(2010, 6, 1)), pop.live_persons_from_columns(Date(2010, 6, 1)));
+	// death reported without moving asof
+	pop.persons()[5]->die(Date(2010, 1, 1));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2010, 6, 1)), pop.live_indices(Date(2010, 6, 1)));
+	// persons not born yet and future deaths
+	pop.add_person(std::make_shared<Person>(22, PersonAttributes(Sex::FEMALE, 0), Date(2011, 1, 1)));
+	pop.persons()[6]->die(Date(2011, 3, 1));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2010, 6, 1)), pop.live_indices(Date(2010, 6, 1)));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2011, 6, 1)), pop.live_indices(Date(2011, 6, 1)));
+	// a person added to another population notifies that one
+	Population other;
+	other.add_person(pop.persons()[8]);
+	pop.persons()[8]->die(Date(2012, 1, 1));
+	ASSERT_EQ(brute_force_live_indices(pop, Date(2012, 6, 1)), pop.live_indices(Date(2012, 6, 1)));
+	ASSERT_TRUE(other.live_indices(Date(2012, 6, 1)).empty());
+}
+
+TEST(Population, ArchiveDeadPersons) {
+	Population pop;
+	auto mother1 = std::make_shared<Person>(1, PersonAttributes(Sex::FEMALE, 0), Date(1950, 1, 1));
+	auto mother2 = std::make_shared<Person>(2, PersonAttributes(Sex::FEMALE, 1), Date(1952, 1, 1));
+	auto child1 = std::make_shared<Person>(3, PersonAttributes(Sex::MALE, 0), Date(1980, 1, 1));
+	auto child2 = std::make_shared<Person>(4, PersonAttributes(Sex::MALE, 1), Date(1981, 1, 1));
+	auto other = std::make_shared<Person>(5, PersonAttributes(Sex::MALE, 2), Date(1960, 1, 1));
+	Person::link_parents_child(child1, mother1, Date(1979, 4, 1));
+	Person::link_parents_child(child2, mother2, Date(1980, 4, 1));
+	pop.add_persons({ mother1, mother2, child1, child2, other });
+	mother1->die(Date(1990, 1, 1));
+	mother2->die(Date(1991, 1, 1));
+	child2->die(Date(1995, 1, 1));
+	other->die(Date(2001, 1, 1));
+	ASSERT_EQ(std::vector<size_t>({ 2, 4 }), pop.live_indices(Date(2000, 1, 1)));
+	// mother1 has a live child, other died after the cutoff
+	ASSERT_EQ(2u, pop.archive_dead_persons(Date(2000, 1, 1)));
+	ASSERT_EQ(std::vector<Actor::shared_ptr<Person>>({ mother1, child1, other }), pop.persons());
+	ASSERT_EQ(std::vector<size_t>({ 1, 2 }), pop.live_indices(Date(2000, 6, 1)));
+	const PersonArchive& archive = pop.archive();
+	ASSERT_EQ(std::vector<Actor::id_t>({ 2, 4 }), archive.ids());
+	ASSERT_EQ(std::vector<Actor::id_t>({ Actor::INVALID_ID, 2 }), archive.mother_ids());
+	ASSERT_EQ(std::vector<Date>({ Date(), Date(1952, 1, 1) }), archive.mother_dates_of_birth());
+	ASSERT_EQ(Date(1995, 1, 1), archive.dates_of_death()[1]);
+	ASSERT_EQ(0u, archive.batch_begin());
+	ASSERT_EQ(1u, archive.nbr_births(Date(1981, 1, 1), Date(1982, 1, 1)));
+	ASSERT_EQ(2u, archive.nbr_deaths(Date(1990, 1, 1), Date(2000, 1, 1)));
+	ASSERT_EQ(0u, pop.archive_dead_persons(Date(2000, 1, 1)));
+	ASSERT_EQ(2u, archive.batch_begin());
+	// deaths after the first call are reported by Person::die
+	child1->die(Date(2002, 1, 1));
+	ASSERT_EQ(3u, pop.archive_dead_persons(Date(2003, 1, 1)));
+	ASSERT_TRUE(pop.empty());
+	ASSERT_EQ(5u, pop.archive().size());
+	ASSERT_EQ(2u, archive.batch_begin());
+	const PersonArchive::Record record(archive.record(3));
+	ASSERT_EQ(3u, record.id);
+	ASSERT_EQ(1u, record.mother_id);
+	ASSERT_EQ(Date(1950, 1, 1), record.mother_date_of_birth);
+	ASSERT_EQ(Date(2002, 1, 1), record.date_of_death);
+	ASSERT_TRUE(pop.live_indices(Date(2003, 1, 1)).empty());
+	// persons added dead are archived too
+	auto dead = std::make_shared<Person>(6, PersonAttributes(Sex::MALE, 2), Date(1970, 1, 1));
+	dead->die(Date(2002, 6, 1));
+	pop.add_person(dead);
+	ASSERT_EQ(1u, pop.archive_dead_persons(Date(2003, 1, 1)));
+	ASSERT_EQ(5u, archive.batch_begin());
+	ASSERT_EQ(6u, archive.size());
+}
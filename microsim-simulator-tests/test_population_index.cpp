@@ -0,0 +1,121 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/contexts.hpp"
+#include "microsim-simulator/person.hpp"
+#include "microsim-simulator/population.hpp"
+#include "microsim-simulator/population_index.hpp"
+#include "microsim-simulator/predicate_factory.hpp"
+#include <unordered_set>
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+static std::vector<std::shared_ptr<Person>> make_index_test_persons() {
+	std::vector<std::shared_ptr<Person>> persons;
+	Actor::id_t id = 1;
+	for (int i = 0; i < 300; ++i) {
+		const Sex sex = (i % 3 == 0) ? Sex::MALE : Sex::FEMALE;
+		const PersonAttributes::ethnicity_t eth = static_cast<PersonAttributes::ethnicity_t>((i * 7) % 5);
+		const Date dob(static_cast<Date::year_type>(1930 + (i * 13) % 80), static_cast<Date::month_type>(1 + i % 12), 1);
+		persons.push_back(std::make_shared<Person>(id++, PersonAttributes(sex, eth), dob));
+	}
+	return persons;
+}
+
+TEST(PopulationIndex, Select) {
+	const auto persons = make_index_test_persons();
+	PopulationIndex index;
+	index.rebuild(persons);
+	ASSERT_EQ(persons.size(), index.size());
+	SelectionBounds bounds;
+	bounds.min_year_of_birth = 1950;
+	bounds.max_year_of_birth = 1960;
+	bounds.sexes.reset();
+	bounds.sexes.set(static_cast<size_t>(Sex::FEMALE));
+	bounds.ethnicities.reset();
+	bounds.ethnicities.set(1);
+	bounds.ethnicities.set(3);
+	std::vector<size_t> positions;
+	index.select(bounds, positions);
+	std::vector<size_t> expected;
+	for (size_t k = 0; k < persons.size(); ++k) {
+		if (bounds.contains(persons[k]->year_of_birth(), persons[k]->sex(), persons[k]->ethnicity())) {
+			expected.push_back(k);
+		}
+	}
+	ASSERT_FALSE(expected.empty());
+	ASSERT_EQ(expected, positions);
+	positions.clear();
+	index.select(SelectionBounds(), positions);
+	ASSERT_EQ(persons.size(), positions.size());
+	ASSERT_TRUE(std::is_sorted(positions.begin(), positions.end()));
+	positions.clear();
+	bounds.min_year_of_birth = 2100;
+	bounds.max_year_of_birth = 2200;
+	index.select(bounds, positions);
+	ASSERT_TRUE(positions.empty());
+}
+
+TEST(PopulationIndex, RebuildFromColumns) {
+	const auto persons = make_index_test_persons();
+	Population population;
+	population.add_persons(persons);
+	population.update_columns();
+	const std::vector<size_t> indices({ 1, 5, 6, 100, 200 });
+	PopulationIndex index;
+	index.rebuild(population.columns(), indices);
+	ASSERT_EQ(indices.size(), index.size());
+	SelectionBounds bounds;
+	bounds.sexes.reset();
+	bounds.sexes.set(static_cast<size_t>(persons[6]->sex()));
+	std::vector<size_t> positions;
+	index.select(bounds, positions);
+	std::vector<size_t> expected;
+	for (size_t k = 0; k < indices.size(); ++k) {
+		if (persons[indices[k]]->sex() == persons[6]->sex()) {
+			expected.push_back(k);
+		}
+	}
+	ASSERT_EQ(expected, positions);
+	ASSERT_THROW(index.rebuild(population.columns(), std::vector<size_t>({ persons.size() })), std::out_of_range);
+}
+
+TEST(PopulationIndex, SelectAlive) {
+	const auto persons = make_index_test_persons();
+	PopulationIndex index;
+	index.rebuild(persons);
+	const Contexts ctx(Date(2015, 6, 1));
+	std::vector<std::shared_ptr<const Predicate<Person>>> predicates;
+	predicates.push_back(PredicateFactory::make_age(20, 40));
+	predicates.push_back(PredicateFactory::make_year_of_birth(1945, 1955));
+	predicates.push_back(PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE), PredicateFactory::make_ethnicity(2, 3, true)));
+	predicates.push_back(PredicateFactory::make_or<Person>({ PredicateFactory::make_sex(Sex::MALE), PredicateFactory::make_ethnicity(std::unordered_set<PersonAttributes::ethnicity_t>({ 0, 4 }), true) }));
+	predicates.push_back(PredicateFactory::make_not(PredicateFactory::make_min_age(50)));
+	for (const auto& pred : predicates) {
+		std::vector<std::shared_ptr<Person>> expected;
+		pred->select_alive(persons, ctx, expected);
+		std::vector<std::shared_ptr<Person>> actual;
+		index.select_alive(*pred, persons, ctx, actual);
+		ASSERT_EQ(expected, actual) << *pred;
+	}
+	std::vector<std::shared_ptr<Person>> selected;
+	ASSERT_THROW(index.select_alive(*predicates[0], std::vector<std::shared_ptr<Person>>(), ctx, selected), std::domain_error);
+}
+
+TEST(SelectionBounds, Predicates) {
+	const Date asof(2015, 6, 1);
+	SelectionBounds bounds(PredicateFactory::make_age(20, 40)->selection_bounds(asof));
+	ASSERT_EQ(1974, bounds.min_year_of_birth);
+	ASSERT_EQ(1995, bounds.max_year_of_birth);
+	ASSERT_TRUE(bounds.sexes.all());
+	bounds = PredicateFactory::make_and(PredicateFactory::make_sex(Sex::FEMALE), PredicateFactory::make_year_of_birth(1980, 2000))->selection_bounds(asof);
+	ASSERT_EQ(1980, bounds.min_year_of_birth);
+	ASSERT_EQ(2000, bounds.max_year_of_birth);
+	ASSERT_TRUE(bounds.sexes[static_cast<size_t>(Sex::FEMALE)]);
+	ASSERT_FALSE(bounds.sexes[static_cast<size_t>(Sex::MALE)]);
+	ASSERT_TRUE(bounds.ethnicities.all());
+	bounds = PredicateFactory::make_or<Person>({ PredicateFactory::make_ethnicity(1, 2, true), PredicateFactory::make_ethnicity(5, 5, true) })->selection_bounds(asof);
+	ASSERT_EQ(3u, bounds.ethnicities.count());
+	ASSERT_TRUE(bounds.ethnicities[5]);
+	ASSERT_TRUE(PredicateFactory::make_not(PredicateFactory::make_sex(Sex::MALE))->selection_bounds(asof).unbounded());
+}
@@ -0,0 +1,157 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/contexts.hpp"
+#include "microsim-simulator/dispatcher_factory.hpp"
+#include "microsim-simulator/history_factory.hpp"
+#include "microsim-simulator/immutable_context.hpp"
+#include "microsim-simulator/mutable_context.hpp"
+#include "microsim-simulator/person.hpp"
+#include "microsim-simulator/population.hpp"
+#include "microsim-simulator/predicate_factory.hpp"
+#include "microsim-simulator/predicate_program.hpp"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+static std::vector<std::shared_ptr<Person>> make_program_test_persons() {
+	std::vector<std::shared_ptr<Person>> persons;
+	Actor::id_t id = 1;
+	for (int i = 0; i < 700; ++i) {
+		const Sex sex = (i % 2 == 0) ? Sex::MALE : Sex::FEMALE;
+		const PersonAttributes::ethnicity_t eth = static_cast<PersonAttributes::ethnicity_t>((i * 3) % 7);
+		const Date dob = (i % 50 == 0) ? Date(static_cast<Date::year_type>(1960 + 4 * (i % 10)), 2, 29) : Date(static_cast<Date::year_type>(1920 + (i * 17) % 100), static_cast<Date::month_type>(1 + i % 12), static_cast<Date::day_type>(1 + (i * 7) % 28));
+		auto person = std::make_shared<Person>(id++, PersonAttributes(sex, eth), dob);
+		if (i % 9 == 0) {
+			person->die(Date(2014, 3, 1));
+		}
+		const Date immigration_date(static_cast<Date::year_type>(2001 + i % 13), 5, 1);
+		if (i % 5 == 0 && dob < immigration_date) {
+			person->set_immigration_date(immigration_date);
+		}
+		persons.push_back(person);
+	}
+	return persons;
+}
+
+TEST(PredicateProgram, LatestBirthDate) {
+	const Date asof(2016, 2, 29);
+	Date dob;
+	ASSERT_TRUE(PredicateProgram::latest_birth_date(asof, 0, dob));
+	ASSERT_EQ(asof, dob);
+	for (unsigned int age : { 1u, 2u, 17u, 40u, 99u }) {
+		ASSERT_TRUE(PredicateProgram::latest_birth_date(asof, age, dob)) << age;
+		ASSERT_EQ(age, Person(1, PersonAttributes(Sex::MALE, 0), dob).age(asof)) << age;
+		ASSERT_EQ(age - 1, Person(1, PersonAttributes(Sex::MALE, 0), dob + Period(PeriodType::DAYS, 1)).age(asof)) << age;
+	}
+	ASSERT_FALSE(PredicateProgram::latest_birth_date(asof, 100000, dob));
+}
+
+TEST(PredicateProgram, Select) {
+	const auto persons = make_program_test_persons();
+	Population population;
+	population.add_persons(persons);
+	population.update_columns();
+	std::vector<std::shared_ptr<const Predicate<Person>>> predicates;
+	predicates.push_back(PredicateFactory::make_age(20, 40));
+	predicates.push_back(PredicateFactory::make_min_age(65, false));
+	predicates.push_back(PredicateFactory::make_year_of_birth(1945, 1955, false));
+	predicates.push_back(PredicateFactory::make_alive());
+	predicates.push_back(PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE), PredicateFactory::make_ethnicity(2, 3, true)));
+	predicates.push_back(PredicateFactory::make_or<Person>({ PredicateFactory::make_sex(Sex::FEMALE, false), PredicateFactory::make_ethnicity(std::unordered_set<PersonAttributes::ethnicity_t>({ 0, 4 }), true) }));
+	predicates.push_back(PredicateFactory::make_not(PredicateFactory::make_max_age(50)));
+	predicates.push_back(PredicateFactory::make_immigration_date(Date(2005, 1, 1), Date(2010, 1, 1), true, true));
+	predicates.push_back(PredicateFactory::make_and<Person>({ PredicateFactory::make_true<Person>(), PredicateFactory::make_asof<Person>(Date(2010, 1, 1), Date(2020, 1, 1)), PredicateFactory::make_age(30, 60) }));
+	for (const Date asof : { Date(2013, 12, 31), Date(2015, 2, 28), Date(2016, 2, 29) }) {
+		const Contexts ctx(asof);
+		std::vector<size_t> rows(persons.size());
+		for (size_t i = 0; i < rows.size(); ++i) {
+			rows[i] = i;
+		}
+		const std::vector<size_t> live_rows(population.columns().live_indices(asof));
+		for (const auto& pred : predicates) {
+			const PredicateProgram program(*pred);
+			std::vector<std::shared_ptr<Person>> expected;
+			pred->select(persons, ctx, expected);
+			std::vector<std::shared_ptr<Person>> actual;
+			program.select(population.columns(), persons, rows, ctx, false, actual);
+			ASSERT_EQ(expected, actual) << *pred << " " << asof;
+			expected.clear();
+			actual.clear();
+			for (size_t i : live_rows) {
+				if (pred->select_alive(*persons[i], ctx)) {
+					expected.push_back(persons[i]);
+				}
+			}
+			program.select(population.columns(), persons, live_rows, ctx, true, actual);
+			ASSERT_EQ(expected, actual) << *pred << " " << asof;
+			std::vector<uint8_t> mask;
+			program.select(population.columns(), persons, live_rows, ctx, true, mask);
+			ASSERT_EQ(persons.size(), mask.size());
+			for (size_t i = 0; i < persons.size(); ++i) {
+				ASSERT_EQ(std::find(expected.begin(), expected.end(), persons[i]) != expected.end(), mask[i] != 0) << *pred << " " << asof << " " << i;
+			}
+		}
+	}
+}
+
+TEST(PredicateProgram, Compilation) {
+	const PredicateProgram compiled(*PredicateFactory::make_not(PredicateFactory::make_and(PredicateFactory::make_sex(Sex::MALE), PredicateFactory::make_age(10, 20))));
+	ASSERT_EQ(4u, compiled.size());
+	ASSERT_EQ(0u, compiled.nbr_fallbacks());
+	const PredicateProgram partial(*PredicateFactory::make_or<Person>({ PredicateFactory::make_sex(Sex::MALE), PredicateFactory::make_asof<Person>(Date(2010, 1, 1), Date(2020, 1, 1)) }));
+	ASSERT_EQ(3u, partial.size());
+	ASSERT_EQ(1u, partial.nbr_fallbacks());
+}
+
+TEST(PredicateProgram, ShortCircuit) {
+	const Date asof(2014, 1, 1);
+	auto imm_ctx = std::make_shared<ImmutableContext>(Schedule({ asof, Date(2015, 1, 1) }));
+	// variable "X" is only defined for women
+	const auto idx = imm_ctx->register_person_variable("X", ImmutableContext::person_history_dispatcher_ptr_t(DispatcherFactory::make_constant<Person>(HistoryFactory::DENSE<double>(), PredicateFactory::make_sex(Sex::FEMALE, false))));
+	const Contexts ctx(imm_ctx, std::make_shared<MutableContext>());
+	const auto persons = make_program_test_persons();
+	for (size_t i = 0; i < persons.size(); ++i) {
+		Person& person = *persons[i];
+		person.set_histories(imm_ctx->person_history_registry().make_histories(person));
+		if (person.sex() == Sex::FEMALE) {
+			person.history(idx).append(person.date_of_birth(), static_cast<double>(i % 4));
+		}
+	}
+	Population population;
+	population.add_persons(persons);
+	population.update_columns();
+	std::vector<size_t> rows(persons.size());
+	for (size_t i = 0; i < rows.size(); ++i) {
+		rows[i] = i;
+	}
+	const std::shared_ptr<const Predicate<Person>> range(PredicateFactory::make_variable_range<Person>("X", 1.0, 2.0));
+	ASSERT_THROW(range->select(*persons.front(), ctx), std::domain_error);
+	std::vector<std::shared_ptr<const Predicate<Person>>> predicates;
+	predicates.push_back(PredicateFactory::make_and<Person>({ PredicateFactory::make_sex(Sex::FEMALE), range }));
+	predicates.push_back(PredicateFactory::make_or<Person>({ PredicateFactory::make_sex(Sex::MALE, false), range }));
+	predicates.push_back(PredicateFactory::make_not(PredicateFactory::make_and<Person>({ PredicateFactory::make_sex(Sex::FEMALE, false), PredicateFactory::make_not(range) })));
+	for (const auto& pred : predicates) {
+		const PredicateProgram program(*pred);
+		ASSERT_EQ(1u, program.nbr_fallbacks()) << *pred;
+		std::vector<std::shared_ptr<Person>> expected;
+		pred->select(persons, ctx, expected);
+		ASSERT_FALSE(expected.empty()) << *pred;
+		std::vector<std::shared_ptr<Person>> actual;
+		ASSERT_NO_THROW(program.select(population.columns(), persons, rows, ctx, false, actual)) << *pred;
+		ASSERT_EQ(expected, actual) << *pred;
+	}
+}
+
+TEST(PredicateProgram, Errors) {
+	const auto persons = make_program_test_persons();
+	Population population;
+	population.add_persons(persons);
+	population.update_columns();
+	const PredicateProgram program(*PredicateFactory::make_alive());
+	std::vector<std::shared_ptr<Person>> selected;
+	const Contexts ctx(Date(2015, 1, 1));
+	ASSERT_THROW(program.select(population.columns(), persons, std::vector<size_t>({ persons.size() }), ctx, false, selected), std::out_of_range);
+	ASSERT_THROW(program.select(population.columns(), std::vector<std::shared_ptr<Person>>(), std::vector<size_t>(), ctx, false, selected), std::domain_error);
+}
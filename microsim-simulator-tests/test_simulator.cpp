@@ -2,11 +2,13 @@
 (C) Averisera Ltd 2017
 */
 #include <gtest/gtest.h>
+#include "mock_operator.hpp"
 #include "microsim-simulator/contexts.hpp"
 #include "microsim-simulator/common_features.hpp"
 #include "microsim-simulator/immutable_context.hpp"
 #include "microsim-simulator/operator_factory.hpp"
 #include "microsim-simulator/person.hpp"
+#include "microsim-simulator/person_data.hpp"
 #include "microsim-simulator/predicate_factory.hpp"
 #include "microsim-simulator/simulator.hpp"
 #include "microsim-simulator/initialiser/generation.hpp"
@@ -22,6 +24,8 @@
 #include "microsim-simulator/observer/observer_demographics_emigrants.hpp"
 #include "microsim-simulator/observer/observer_stats.hpp"
 #include "microsim-simulator/observer/observer_result_saver_simple.hpp"
+#include "microsim-simulator/predicate/pred_alive.hpp"
+#include "microsim-simulator/predicate/pred_sex.hpp"
 #include "microsim-calibrator/rate_calibrator.hpp"
 #include "microsim-core/anchored_hazard_curve.hpp"
 #include "microsim-core/conception.hpp"
@@ -29,6 +33,12 @@
 #include "microsim-core/hazard_curve.hpp"
 #include "microsim-core/schedule_definition.hpp"
 #include "core/generic_distribution_enumerated.hpp"
+#include "core/thread_pool.hpp"
+#include "testing/temporary_file.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
 
 using namespace averisera;
 using namespace averisera::microsim;
@@ -209,3 +219,302 @@ TEST(Simulator, Simples) {
 	std::cout << "Population increased from " << initial_pop_size << " to " << final_size;
 	ASSERT_NE(mutable_context->emigrants().size(), 0u);
 }
+
+static std::vector<std::shared_ptr<const MigrationGenerator>> build_checkpoint_test_migration_generators() {
+	const unsigned int migration_child_age_limit = 15;
+	std::vector<std::shared_ptr<const MigrationGenerator>> migration_generators;
+	migration_generators.push_back(std::make_shared<MigrationGeneratorReturn>("RETURN", Date(1991, 1, 1), Date(1995, 1, 1), 0.2, migration_child_age_limit, std::make_unique<EmigrantSelector>(PredicateFactory::make_ethnicity(Ethnicity::index_set_type({ ETHN_WHITE }), true), Date::MIN, Date::MAX, migration_child_age_limit)));
+	migration_generators.push_back(build_migration_generator_model(migration_child_age_limit));
+	return migration_generators;
+}
+
+static Simulator build_checkpoint_test_simulator(std::shared_ptr<ImmutableContext> immutable_context, std::shared_ptr<MutableContext> mutable_context,
+	std::vector<std::shared_ptr<Observer>>&& observers = std::vector<std::shared_ptr<Observer>>()) {
+	const Date start_date = immutable_context->schedule().start_date();
+	const unsigned int min_childbearing_age = 15;
+	const unsigned int max_childbearing_age = 45;
+	Contexts ctx(immutable_context, mutable_context);
+	std::vector<std::shared_ptr<Operator<Person>>> person_operators;
+	person_operators.push_back(OperatorFactory::make_birth(min_childbearing_age, max_childbearing_age));
+	person_operators.push_back(OperatorFactory::make_fetus_generator_simple(min_childbearing_age, max_childbearing_age, 0.52));
+	person_operators.push_back(OperatorFactory::make_pregnancy(Pregnancy(), nullptr, min_childbearing_age, max_childbearing_age));
+	const auto daycount = Daycount::DAYS_365();
+	person_operators.push_back(OperatorFactory::make_conception(Conception(AnchoredHazardCurve::build(start_date, daycount, HazardCurveFactory::make_flat(0.2))),
+		std::vector<std::shared_ptr<const RelativeRisk<Person>>>(), PredicateFactory::make_alive(),
+		nullptr, nullptr, min_childbearing_age, max_childbearing_age, Period(PeriodType::MONTHS, 3)));
+	person_operators.push_back(OperatorFactory::make_mortality(HazardModel(AnchoredHazardCurve::build(start_date, daycount, build_mortality_curve())), std::vector<std::shared_ptr<const RelativeRisk<Person>>>(), PredicateFactory::make_alive(), nullptr, true));
+	ctx.immutable_ctx().collect_history_requirements(person_operators);
+	return Simulator(std::move(ctx), std::move(person_operators), std::move(observers), build_checkpoint_test_migration_generators(),
+		true, 2000, { CommonFeatures::MORTALITY() }, std::string());
+}
+
+static std::vector<std::shared_ptr<Observer>> build_checkpoint_test_observers(const Schedule& schedule) {
+	std::vector<std::shared_ptr<Observer>> observers;
+	const ObserverDemographics::age_ranges_type age_ranges({ ObserverDemographics::age_range_type(0, 40), ObserverDemographics::age_range_type(40, 120) });
+	observers.push_back(std::make_shared<ObserverDemographicsMain>(nullptr, age_ranges, schedule.nbr_dates()));
+	observers.push_back(std::make_shared<ObserverDemographicsImmigrants>(nullptr, age_ranges, schedule.nbr_dates()));
+	observers.push_back(std::make_shared<ObserverDemographicsEmigrants>(nullptr, age_ranges, schedule.nbr_dates()));
+	const std::vector<ObservedQuantity<Person>> observed_quantities({ ObservedQuantity<Person>("Age", [](const Person& person, const Contexts& ctx) {
+		return person.age_fract(ctx.asof());
+	}) });
+	observers.push_back(std::make_shared<ObserverStats<Person>>(nullptr, observed_quantities, PredicateFactory::make_alive(), true));
+	return observers;
+}
+
+static std::string print_observer_results(const std::vector<std::shared_ptr<Observer>>& observers, const ImmutableContext& im_ctx) {
+	std::stringstream ss;
+	for (const auto& observer : observers) {
+		observer->save_results(ss, im_ctx);
+	}
+	return ss.str();
+}
+
+static std::string print_persons(const std::vector<Person::shared_ptr>& persons, const ImmutableContext& im_ctx) {
+	std::stringstream ss;
+	for (const auto& p : persons) {
+		ss << p->to_data(im_ctx) << "\n";
+	}
+	return ss.str();
+}
+
+TEST(Simulator, CheckpointRestart) {
+	const Schedule schedule(ScheduleDefinition(Date(1990, 1, 1), Date(1995, 1, 1), Period(PeriodType::MONTHS, 6)));
+	const InitialiserGenerations initialiser(build_initial_population_state());
+	averisera::testing::TemporaryFile checkpoint_file;
+
+	// reference run which saves checkpoints
+	const auto immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto mutable_context = std::make_shared<MutableContext>();
+	const auto observers = build_checkpoint_test_observers(schedule);
+	Simulator simulator = build_checkpoint_test_simulator(immutable_context, mutable_context, std::vector<std::shared_ptr<Observer>>(observers));
+	ASSERT_THROW(simulator.set_checkpointing("", 3), std::domain_error);
+	simulator.set_checkpointing(checkpoint_file.filename, 3);
+	Population population("MAIN");
+	simulator.initialise_population(initialiser, population);
+	simulator.run(population);
+
+	// restart from the last checkpoint (schedule date index 9)
+	const auto restarted_immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto restarted_mutable_context = std::make_shared<MutableContext>();
+	Population restarted_population("MAIN");
+	// the observers' state was saved, so they must be provided to resume
+	ASSERT_THROW(build_checkpoint_test_simulator(std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>()), std::make_shared<MutableContext>()).load_checkpoint(checkpoint_file.filename, restarted_population), std::domain_error);
+	ASSERT_TRUE(restarted_population.empty());
+	const auto restarted_observers = build_checkpoint_test_observers(schedule);
+	Simulator restarted = build_checkpoint_test_simulator(restarted_immutable_context, restarted_mutable_context, std::vector<std::shared_ptr<Observer>>(restarted_observers));
+	restarted.load_checkpoint(checkpoint_file.filename, restarted_population);
+	ASSERT_EQ(9u, restarted_mutable_context->date_index());
+	// saved atomically through a temporary file
+	ASSERT_FALSE(std::ifstream(checkpoint_file.filename + ".tmp").good());
+	ASSERT_THROW(restarted.load_checkpoint(checkpoint_file.filename, restarted_population), std::domain_error);
+	restarted.run(restarted_population);
+
+	ASSERT_EQ(population.persons().size(), restarted_population.persons().size());
+	ASSERT_EQ(print_persons(population.persons(), *immutable_context), print_persons(restarted_population.persons(), *restarted_immutable_context));
+	ASSERT_EQ(print_persons(static_cast<const MutableContext&>(*mutable_context).emigrant_population().persons(), *immutable_context),
+		print_persons(static_cast<const MutableContext&>(*restarted_mutable_context).emigrant_population().persons(), *restarted_immutable_context));
+	ASSERT_EQ(mutable_context->get_max_id(), restarted_mutable_context->get_max_id());
+	ASSERT_EQ(mutable_context->emigrants().size(), restarted_mutable_context->emigrants().size());
+	ASSERT_EQ(mutable_context->rng().rand_int(), restarted_mutable_context->rng().rand_int());
+	ASSERT_EQ(print_observer_results(observers, *immutable_context), print_observer_results(restarted_observers, *restarted_immutable_context));
+}
+
+TEST(Simulator, DeadPersonArchiving) {
+	const Schedule schedule(ScheduleDefinition(Date(1990, 1, 1), Date(1995, 1, 1), Period(PeriodType::MONTHS, 6)));
+	const InitialiserGenerations initialiser(build_initial_population_state());
+	averisera::testing::TemporaryFile checkpoint_file;
+
+	const auto immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto mutable_context = std::make_shared<MutableContext>();
+	const auto observers = build_checkpoint_test_observers(schedule);
+	Simulator simulator = build_checkpoint_test_simulator(immutable_context, mutable_context, std::vector<std::shared_ptr<Observer>>(observers));
+	Population population("MAIN");
+	simulator.initialise_population(initialiser, population);
+	simulator.run(population);
+
+	// observers count the births and deaths of archived persons from the archive
+	const auto archiving_immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto archiving_mutable_context = std::make_shared<MutableContext>();
+	const auto archiving_observers = build_checkpoint_test_observers(schedule);
+	Simulator archiving = build_checkpoint_test_simulator(archiving_immutable_context, archiving_mutable_context, std::vector<std::shared_ptr<Observer>>(archiving_observers));
+	archiving.set_dead_person_archiving(true);
+	archiving.set_checkpointing(checkpoint_file.filename, 3);
+	Population archiving_population("MAIN");
+	archiving.initialise_population(initialiser, archiving_population);
+	archiving.run(archiving_population);
+	ASSERT_GT(archiving_population.archive().size(), 0u);
+	ASSERT_LT(archiving_population.persons().size(), population.persons().size());
+	ASSERT_EQ(print_observer_results(observers, *immutable_context), print_observer_results(archiving_observers, *archiving_immutable_context));
+	// migrants who died before the last step are forgotten
+	const Date last_cutoff = schedule.date(schedule.nbr_dates() - 2);
+	const auto died_before_last_cutoff = [last_cutoff](const Person::shared_ptr& p) {
+		return !p->date_of_death().is_not_a_date() && p->date_of_death() < last_cutoff;
+	};
+	const MutableContext& archiving_mctx = *archiving_mutable_context;
+	ASSERT_TRUE(std::none_of(archiving_mctx.immigrants().begin(), archiving_mctx.immigrants().end(), died_before_last_cutoff));
+	for (const auto& kv : archiving_mctx.emigrants()) {
+		ASSERT_TRUE(std::none_of(kv.second.begin(), kv.second.end(), died_before_last_cutoff));
+	}
+
+	// the archives are saved in checkpoints
+	const auto restarted_immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto restarted_mutable_context = std::make_shared<MutableContext>();
+	const auto restarted_observers = build_checkpoint_test_observers(schedule);
+	Simulator restarted = build_checkpoint_test_simulator(restarted_immutable_context, restarted_mutable_context, std::vector<std::shared_ptr<Observer>>(restarted_observers));
+	restarted.set_dead_person_archiving(true);
+	Population restarted_population("MAIN");
+	restarted.load_checkpoint(checkpoint_file.filename, restarted_population);
+	ASSERT_GT(restarted_population.archive().size(), 0u);
+	restarted.run(restarted_population);
+	ASSERT_EQ(archiving_population.archive().ids(), restarted_population.archive().ids());
+	ASSERT_EQ(archiving_population.archive().mother_dates_of_birth(), restarted_population.archive().mother_dates_of_birth());
+	ASSERT_EQ(archiving_mctx.emigrant_population().archive().ids(), static_cast<const MutableContext&>(*restarted_mutable_context).emigrant_population().archive().ids());
+	ASSERT_EQ(print_persons(archiving_population.persons(), *archiving_immutable_context), print_persons(restarted_population.persons(), *restarted_immutable_context));
+	ASSERT_EQ(print_observer_results(observers, *immutable_context), print_observer_results(restarted_observers, *restarted_immutable_context));
+}
+
+TEST(Simulator, ConcurrentEmigrantStep) {
+	const Schedule schedule(ScheduleDefinition(Date(1990, 1, 1), Date(1995, 1, 1), Period(PeriodType::MONTHS, 6)));
+	const InitialiserGenerations initialiser(build_initial_population_state());
+	averisera::testing::TemporaryFile checkpoint_file;
+
+	const auto immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto mutable_context = std::make_shared<MutableContext>();
+	Simulator simulator = build_checkpoint_test_simulator(immutable_context, mutable_context);
+	simulator.set_concurrent_emigrant_step(true);
+	simulator.set_checkpointing(checkpoint_file.filename, 3);
+	Population population("MAIN");
+	simulator.initialise_population(initialiser, population);
+	simulator.run(population);
+	const Population& emigrant_population = static_cast<const MutableContext&>(*mutable_context).emigrant_population();
+	ASSERT_FALSE(emigrant_population.empty());
+	// children born to emigrants have IDs from the auxiliary range
+	size_t nbr_emigrant_newborns = 0;
+	for (const auto& p : emigrant_population.persons()) {
+		if (p->id() >= MutableContext::AUXILIARY_MIN_ID) {
+			++nbr_emigrant_newborns;
+			ASSERT_GE(p->date_of_birth(), Date(1991, 1, 1));
+		}
+	}
+	ASSERT_GT(nbr_emigrant_newborns, 0u);
+	for (const auto& p : population.persons()) {
+		ASSERT_LT(p->id(), MutableContext::AUXILIARY_MIN_ID);
+	}
+
+	// restarted simulation reproduces the results
+	const auto restarted_immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto restarted_mutable_context = std::make_shared<MutableContext>();
+	Simulator restarted = build_checkpoint_test_simulator(restarted_immutable_context, restarted_mutable_context);
+	restarted.set_concurrent_emigrant_step(true);
+	Population restarted_population("MAIN");
+	restarted.load_checkpoint(checkpoint_file.filename, restarted_population);
+	restarted.run(restarted_population);
+	ASSERT_EQ(print_persons(population.persons(), *immutable_context), print_persons(restarted_population.persons(), *restarted_immutable_context));
+	ASSERT_EQ(print_persons(emigrant_population.persons(), *immutable_context),
+		print_persons(static_cast<const MutableContext&>(*restarted_mutable_context).emigrant_population().persons(), *restarted_immutable_context));
+	ASSERT_EQ(mutable_context->get_max_id(), restarted_mutable_context->get_max_id());
+
+	// archiving dead persons does not change the live populations
+	const auto live_persons = [](const std::vector<Person::shared_ptr>& persons) {
+		std::vector<Person::shared_ptr> live;
+		std::copy_if(persons.begin(), persons.end(), std::back_inserter(live), [](const Person::shared_ptr& p) { return p->date_of_death().is_not_a_date(); });
+		return live;
+	};
+	const auto archiving_immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto archiving_mutable_context = std::make_shared<MutableContext>();
+	Simulator archiving = build_checkpoint_test_simulator(archiving_immutable_context, archiving_mutable_context);
+	archiving.set_concurrent_emigrant_step(true);
+	archiving.set_dead_person_archiving(true);
+	Population archiving_population("MAIN");
+	archiving.initialise_population(initialiser, archiving_population);
+	archiving.run(archiving_population);
+	ASSERT_GT(archiving_population.archive().size(), 0u);
+	ASSERT_EQ(print_persons(live_persons(population.persons()), *immutable_context), print_persons(live_persons(archiving_population.persons()), *archiving_immutable_context));
+	ASSERT_EQ(print_persons(live_persons(emigrant_population.persons()), *immutable_context),
+		print_persons(live_persons(static_cast<const MutableContext&>(*archiving_mutable_context).emigrant_population().persons()), *archiving_immutable_context));
+}
+
+TEST(Simulator, Fork) {
+	const Schedule schedule(ScheduleDefinition(Date(1990, 1, 1), Date(1995, 1, 1), Period(PeriodType::MONTHS, 6)));
+	const InitialiserGenerations initialiser(build_initial_population_state());
+	const auto immutable_context = std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>());
+	const auto mutable_context = std::make_shared<MutableContext>();
+	const Simulator simulator = build_checkpoint_test_simulator(immutable_context, mutable_context);
+	Population population("MAIN");
+	simulator.initialise_population(initialiser, population);
+	std::stringstream base_state;
+	simulator.save_checkpoint(base_state, population);
+	ASSERT_THROW(simulator.fork(nullptr, std::vector<std::shared_ptr<Observer>>(), build_checkpoint_test_migration_generators(), std::string()), std::domain_error);
+
+	// scenarios forked from the initialised state share the operators and the immutable context
+	const size_t nbr_scenarios = 3;
+	std::vector<std::shared_ptr<MutableContext>> forked_mutable_contexts;
+	std::vector<Simulator> forked_simulators;
+	std::vector<Population> forked_populations;
+	forked_simulators.reserve(nbr_scenarios);
+	forked_populations.reserve(nbr_scenarios);
+	for (size_t i = 0; i < nbr_scenarios; ++i) {
+		forked_mutable_contexts.push_back(std::make_shared<MutableContext>());
+		forked_simulators.push_back(simulator.fork(forked_mutable_contexts.back(), std::vector<std::shared_ptr<Observer>>(), build_checkpoint_test_migration_generators(), std::string()));
+		forked_populations.push_back(Population("MAIN"));
+		base_state.seekg(0);
+		forked_simulators.back().load_checkpoint(base_state, forked_populations.back());
+	}
+	ThreadPool pool(nbr_scenarios);
+	pool.for_each_index(nbr_scenarios, [&forked_simulators, &forked_populations](size_t i) {
+		forked_simulators[i].run(forked_populations[i]);
+	});
+	simulator.run(population);
+
+	const std::string expected(print_persons(population.persons(), *immutable_context));
+	for (size_t i = 0; i < nbr_scenarios; ++i) {
+		ASSERT_EQ(expected, print_persons(forked_populations[i].persons(), *immutable_context)) << i;
+		ASSERT_EQ(mutable_context->get_max_id(), forked_mutable_contexts[i]->get_max_id()) << i;
+	}
+}
+
+static Simulator build_operator_check_test_simulator(size_t sample_size) {
+	const Schedule schedule(ScheduleDefinition(Date(2000, 1, 1), Date(2002, 1, 1), Period(PeriodType::YEARS, 1)));
+	Contexts ctx(std::make_shared<ImmutableContext>(schedule, Ethnicity::IndexConversions::build<EthnicityMock>()), std::make_shared<MutableContext>());
+	// feature X is provided only for men but required by an operator applied to everybody
+	std::vector<std::shared_ptr<Operator<Person>>> person_operators;
+	person_operators.push_back(std::make_shared<MockOperator<PredSex, Person>>(PredSex(Sex::MALE), false, vf({ Feature("X") }), vf()));
+	person_operators.push_back(std::make_shared<MockOperator<PredAlive, Person>>(PredAlive(), false, vf(), vf({ Feature("X") })));
+	std::vector<std::shared_ptr<const MigrationGenerator>> migration_generators({ std::make_shared<MigrationGeneratorDummy>() });
+	Simulator simulator(std::move(ctx), std::move(person_operators), std::vector<std::shared_ptr<Observer>>(), std::move(migration_generators),
+		false, 100, Simulator::feature_set_type(), std::string());
+	simulator.set_operator_check_sample_size(sample_size);
+	return simulator;
+}
+
+static void add_operator_check_test_persons(Population& population, Sex sex, size_t n) {
+	for (size_t i = 0; i < n; ++i) {
+		population.add_person(std::make_shared<Person>(static_cast<Actor::id_t>(population.persons().size() + 1), PersonAttributes(sex, ETHN_WHITE), Date(static_cast<Date::year_type>(1950 + i % 30), 3, 1)));
+	}
+}
+
+TEST(Simulator, OperatorCheck) {
+	{
+		const Simulator simulator(build_operator_check_test_simulator(0));
+		ASSERT_EQ(0u, simulator.operator_check_sample_size());
+		Population population("MAIN");
+		add_operator_check_test_persons(population, Sex::MALE, 100);
+		simulator.run(population);
+	}
+	{
+		const Simulator simulator(build_operator_check_test_simulator(0));
+		Population population("MAIN");
+		add_operator_check_test_persons(population, Sex::MALE, 100);
+		add_operator_check_test_persons(population, Sex::FEMALE, 1);
+		ASSERT_THROW(simulator.run(population), std::runtime_error);
+	}
+	{
+		// the only woman is not in the sample
+		const Simulator simulator(build_operator_check_test_simulator(10));
+		ASSERT_EQ(10u, simulator.operator_check_sample_size());
+		Population population("MAIN");
+		add_operator_check_test_persons(population, Sex::MALE, 105);
+		add_operator_check_test_persons(population, Sex::FEMALE, 1);
+		simulator.run(population);
+	}
+}
@@ -0,0 +1,39 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "microsim-simulator/history_registry.hpp"
+#include "microsim-simulator/variable_handle.hpp"
+#include <stdexcept>
+
+using namespace averisera;
+using namespace averisera::microsim;
+
+TEST(VariableHandle, Resolve) {
+	ASSERT_THROW(VariableHandle(""), std::domain_error);
+	const VariableHandle handle("WHVAL");
+	ASSERT_EQ("WHVAL", handle.name());
+	HistoryRegistry registry1;
+	VariableHandle::index_t idx = 100;
+	ASSERT_FALSE(handle.find_index(registry1, idx));
+	ASSERT_EQ(100u, idx);
+	ASSERT_THROW(handle.index(registry1), std::domain_error);
+	registry1.register_variable("BMI");
+	registry1.register_variable("WHVAL");
+	ASSERT_EQ(1u, handle.index(registry1));
+	ASSERT_TRUE(handle.find_index(registry1, idx));
+	ASSERT_EQ(1u, idx);
+
+	// resolved again for a different registry
+	HistoryRegistry registry2;
+	registry2.register_variable("WHVAL");
+	ASSERT_EQ(0u, handle.index(registry2));
+	ASSERT_EQ(1u, handle.index(registry1));
+
+	// a copy of a registry can diverge from the original
+	HistoryRegistry registry3(registry2);
+	const VariableHandle copy(handle);
+	ASSERT_EQ(0u, copy.index(registry3));
+	VariableHandle assigned("BMI");
+	assigned = handle;
+	ASSERT_EQ("WHVAL", assigned.name());
+	ASSERT_EQ(1u, assigned.index(registry1));
+}
@@ -3,6 +3,9 @@
 #include "actor_data.hpp"
 #include "contexts.hpp"
 #include "history_registry.hpp"
+#include "history/history_copy_on_write.hpp"
+#include "variable_handle.hpp"
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
 #include <boost/format.hpp>
@@ -10,7 +13,7 @@
 namespace averisera {
 	namespace microsim {
 		Actor::Actor(id_t id)
-			: _id(id)
+			: _id(id), _nbr_copy_on_write(0)
 		{
 			validate();
 		}
@@ -23,6 +26,9 @@ namespace averisera {
 				throw std::logic_error("Actor: histories already set");
             }
             _histories = std::move(histories);
+			_nbr_copy_on_write = static_cast<histidx_t>(std::count_if(_histories.begin(), _histories.end(), [](const std::unique_ptr<History>& h) {
+				return dynamic_cast<const HistoryCopyOnWrite*>(h.get()) != nullptr;
+			}));
         }
 
         bool Actor::is_history_valid(histidx_t idx) const {
@@ -31,12 +37,23 @@ namespace averisera {
 
 		History& Actor::history(histidx_t idx) {
             if (is_history_valid(idx)) {
+				if (_nbr_copy_on_write) {
+					release_copy_on_write(idx);
+				}
                 return *_histories[idx];
             } else {
 				throw std::domain_error(boost::str(boost::format("Actor: no valid history with index %d for ID %d") % idx % _id));
             }
 		}
 
+		void Actor::release_copy_on_write(histidx_t idx) {
+			HistoryCopyOnWrite* const cow = dynamic_cast<HistoryCopyOnWrite*>(_histories[idx].get());
+			if (cow && !cow->is_shared()) {
+				_histories[idx] = cow->release_owned();
+				--_nbr_copy_on_write;
+			}
+		}
+
 		const History& Actor::history(histidx_t idx) const {
 			if (is_history_valid(idx)) {
                 return *_histories[idx];
@@ -70,6 +87,27 @@ namespace averisera {
             return get_history_registry(ctx.immutable_ctx()).variable_index(variable);
         }
 
+        bool Actor::has_history(const ImmutableContext& im_ctx, const VariableHandle& variable) const {
+            histidx_t idx;
+            if (variable.find_index(get_history_registry(im_ctx), idx)) {
+                return is_history_valid(idx);
+            } else {
+                return false;
+            }
+        }
+
+        History& Actor::history(const ImmutableContext& im_ctx, const VariableHandle& variable) {
+            return history(variable.index(get_history_registry(im_ctx)));
+        }
+
+        const History& Actor::history(const ImmutableContext& im_ctx, const VariableHandle& variable) const {
+            return history(variable.index(get_history_registry(im_ctx)));
+        }
+
+        Actor::histidx_t Actor::get_variable_index(const Contexts& ctx, const VariableHandle& variable) const {
+            return variable.index(get_history_registry(ctx.immutable_ctx()));
+        }
+
 		void Actor::validate() const {
             // Turn off null checks -- we can have null histories if we do not plan to use the history on given object
 			// for (auto it = _histories.begin(); it != _histories.end(); ++it) {
@@ -15,6 +15,7 @@ namespace averisera {
         class Contexts;
         class HistoryRegistry;
         class ImmutableContext;
+		class VariableHandle;
 
 		/**
 		@brief Base object representing agents taking part in the simulation. An Actor is a person, a household, an institution or a business entity.
@@ -33,6 +34,10 @@ namespace averisera {
 			template <class Derived, class... Args> static shared_ptr<Derived> make_shared(Args&&... args) {
 				return std::shared_ptr<Derived>(new Derived(std::forward<Args>(args)...));
 			}
+			/** Construct the object and its control block in a single block of memory obtained from alloc (e.g. a PoolAllocator) */
+			template <class Derived, class Alloc, class... Args> static shared_ptr<Derived> allocate_shared(const Alloc& alloc, Args&&... args) {
+				return std::allocate_shared<Derived>(alloc, std::forward<Args>(args)...);
+			}
 			template <class Derived> static weak_ptr<Derived> weak_from_shared(const shared_ptr<Derived>& shared) {
 				return weak_ptr<Derived>(shared);
 			}
@@ -78,7 +83,8 @@ namespace averisera {
             /** Is idx-th history valid (non-null). */
             bool is_history_valid(histidx_t idx) const;
 
-			/** Reference to idx-th history 
+			/** Reference to idx-th history. A HistoryCopyOnWrite which has been modified is replaced by its private clone,
+			  invalidating references to it obtained earlier.
               @throw std::domain_error If no valid idx-th history.
              */
 			History& history(histidx_t idx);
@@ -104,6 +110,18 @@ namespace averisera {
             /** Get the index of the variable history or throw an exception if not available */
             histidx_t get_variable_index(const Contexts& ctx, const std::string& variable) const;
 
+            /** Check if Actor has a valid history for this variable, without looking up its name if the handle is already resolved */
+            bool has_history(const ImmutableContext& im_ctx, const VariableHandle& variable) const;
+
+            /** Get the history for this variable or throw std::domain_error if not present */
+            History& history(const ImmutableContext& im_ctx, const VariableHandle& variable);
+
+            /** Get the history for this variable or throw std::domain_error if not present */
+            const History& history(const ImmutableContext& im_ctx, const VariableHandle& variable) const;
+
+            /** Get the index of the variable history or throw an exception if not available */
+            histidx_t get_variable_index(const Contexts& ctx, const VariableHandle& variable) const;
+
 			/** Convert to a pure data object */
 			ActorData to_data(const ImmutableContext& im_ctx) const;			
 
@@ -122,8 +140,12 @@ namespace averisera {
 		private:
 			id_t _id;
 			std::vector<std::unique_ptr<History>> _histories; /**< vector of histories */
+			histidx_t _nbr_copy_on_write; /**< Number of HistoryCopyOnWrite wrappers in _histories */
 
 			void validate() const;
+
+			/** Replace idx-th history by its private clone if it is a HistoryCopyOnWrite which has been modified */
+			void release_copy_on_write(histidx_t idx);
 		};
 
 		/** Convenience class to automatically define some typedefs. */
@@ -139,6 +161,10 @@ namespace averisera {
             template <class... Args> static shared_ptr make_shared(Args&&... args) {
                 return Actor::make_shared<Derived, Args...>(std::forward<Args>(args)...);
             }
+
+            template <class Alloc, class... Args> static shared_ptr allocate_shared(const Alloc& alloc, Args&&... args) {
+                return Actor::allocate_shared<Derived, Alloc, Args...>(alloc, std::forward<Args>(args)...);
+            }
 		};
 	}
 }
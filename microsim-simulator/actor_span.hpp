@@ -0,0 +1,82 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_ACTOR_SPAN_H
+#define __AVERISERA_MS_ACTOR_SPAN_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace averisera {
+	namespace microsim {
+		/** @brief Non-owning view of a sequence of shared pointers to objects of class T.
+
+		Elements are either stored contiguously (e.g. in a std::vector<std::shared_ptr<T>>) or referenced indirectly
+		by an array of pointers to shared pointers (e.g. pointing into Population::persons()). Copying the span or passing
+		its elements by reference does not touch reference counts. The referenced shared pointers must outlive the span.
+		*/
+		template <class T> class ActorSpan {
+		public:
+			typedef std::shared_ptr<T> pointer_type;
+
+			/** Empty span */
+			ActorSpan()
+				: data_(nullptr), refs_(nullptr), size_(0) {}
+
+			/** View of a vector */
+			ActorSpan(const std::vector<pointer_type>& objs)
+				: data_(objs.data()), refs_(nullptr), size_(objs.size()) {}
+
+			/** View of a vector of references */
+			ActorSpan(const std::vector<const pointer_type*>& refs)
+				: data_(nullptr), refs_(refs.data()), size_(refs.size()) {}
+
+			/** View of objs[0], ..., objs[size - 1] */
+			ActorSpan(const pointer_type* objs, size_t size)
+				: data_(objs), refs_(nullptr), size_(size) {}
+
+			/** View of *refs[0], ..., *refs[size - 1] */
+			ActorSpan(const pointer_type* const* refs, size_t size)
+				: data_(nullptr), refs_(refs), size_(size) {}
+
+			size_t size() const {
+				return size_;
+			}
+
+			bool empty() const {
+				return size_ == 0;
+			}
+
+			const pointer_type& operator[](size_t i) const {
+				assert(i < size_);
+				return refs_ ? *refs_[i] : data_[i];
+			}
+
+			/** Span of elements begin, ..., begin + n - 1 */
+			ActorSpan subspan(size_t begin, size_t n) const {
+				assert(begin + n <= size_);
+				if (refs_) {
+					return ActorSpan(refs_ + begin, n);
+				} else {
+					return ActorSpan(data_ + begin, n);
+				}
+			}
+
+			/** Copy the shared pointers to a vector (increments reference counts) */
+			std::vector<pointer_type> to_vector() const {
+				std::vector<pointer_type> objs;
+				objs.reserve(size_);
+				for (size_t i = 0; i < size_; ++i) {
+					objs.push_back((*this)[i]);
+				}
+				return objs;
+			}
+		private:
+			const pointer_type* data_;
+			const pointer_type* const* refs_;
+			size_t size_;
+		};
+	}
+}
+
+#endif // __AVERISERA_MS_ACTOR_SPAN_H
@@ -0,0 +1,726 @@
+// (C) Averisera Ltd 2014-2020
+#include "checkpoint.hpp"
+#include "contexts.hpp"
+#include "immutable_context.hpp"
+#include "mutable_context.hpp"
+#include "observer.hpp"
+#include "person.hpp"
+#include "person_data.hpp"
+#include "population.hpp"
+#include "microsim-core/schedule.hpp"
+#include "core/log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <boost/format.hpp>
+
+namespace averisera {
+	namespace microsim {
+		const uint32_t Checkpoint::VERSION;
+
+		namespace {
+			const char MAGIC[8] = { 'A', 'V', 'M', 'S', 'C', 'K', 'P', 'T' };
+			const uint32_t BYTE_ORDER_MARK = 0x01020304u;
+			const uint64_t ALIGNMENT = 8;
+			const char STRING_SEPARATOR = '\0';
+
+			const int64_t NAD_CODE = std::numeric_limits<int64_t>::min();
+			const int64_t NEG_INF_CODE = NAD_CODE + 1;
+			const int64_t POS_INF_CODE = std::numeric_limits<int64_t>::max();
+
+			uint64_t padded(uint64_t size) {
+				return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+			}
+
+			int64_t encode_date(Date date) {
+				if (date.is_not_a_date()) {
+					return NAD_CODE;
+				} else if (date.is_neg_infinity()) {
+					return NEG_INF_CODE;
+				} else if (date.is_pos_infinity()) {
+					return POS_INF_CODE;
+				} else {
+					return date.julian_day();
+				}
+			}
+
+			Date decode_date(int64_t code) {
+				if (code == NAD_CODE) {
+					return Date::NAD;
+				} else if (code == NEG_INF_CODE) {
+					return Date::NEG_INF;
+				} else if (code == POS_INF_CODE) {
+					return Date::POS_INF;
+				} else {
+					typedef boost::gregorian::gregorian_calendar calendar;
+					return Date(boost::gregorian::date(calendar::from_day_number(static_cast<calendar::date_int_type>(code))));
+				}
+			}
+
+			std::string join_strings(const std::vector<std::string>& strings) {
+				std::string joined;
+				for (const auto& str : strings) {
+					joined += str;
+					joined += STRING_SEPARATOR;
+				}
+				return joined;
+			}
+
+			std::vector<std::string> split_strings(const std::string& joined) {
+				std::vector<std::string> strings;
+				size_t begin = 0;
+				while (begin < joined.size()) {
+					const size_t end = joined.find(STRING_SEPARATOR, begin);
+					if (end == std::string::npos) {
+						throw std::runtime_error("Checkpoint: corrupt string list");
+					}
+					strings.push_back(joined.substr(begin, end - begin));
+					begin = end + 1;
+				}
+				return strings;
+			}
+
+			/** Collects named columns and writes them to a file */
+			class SectionWriter {
+			public:
+				template <class T> void add(const std::string& name, const std::vector<T>& column) {
+					static_assert(std::is_trivially_copyable<T>::value, "SectionWriter: column type must be trivially copyable");
+					std::string data(column.size() * sizeof(T), '\0');
+					if (!column.empty()) {
+						std::memcpy(&data[0], column.data(), data.size());
+					}
+					add_bytes(name, std::move(data));
+				}
+
+				template <class T> void add_scalar(const std::string& name, T value) {
+					add(name, std::vector<T>(1, value));
+				}
+
+				void add_bytes(const std::string& name, std::string data) {
+					sections_.push_back(std::make_pair(name, std::move(data)));
+				}
+
+				/** @param source Name of the output used in error messages */
+				void write(std::ostream& os, const std::string& source) const {
+					os.write(MAGIC, sizeof(MAGIC));
+					write_value(os, Checkpoint::VERSION);
+					write_value(os, BYTE_ORDER_MARK);
+					write_value(os, static_cast<uint64_t>(sections_.size()));
+					uint64_t offset = sizeof(MAGIC) + 2 * sizeof(uint32_t) + sizeof(uint64_t);
+					for (const auto& section : sections_) {
+						offset += 3 * sizeof(uint64_t) + padded(section.first.size());
+					}
+					for (const auto& section : sections_) {
+						write_value(os, static_cast<uint64_t>(section.first.size()));
+						write_padded(os, section.first);
+						write_value(os, offset);
+						write_value(os, static_cast<uint64_t>(section.second.size()));
+						offset += padded(section.second.size());
+					}
+					for (const auto& section : sections_) {
+						write_padded(os, section.second);
+					}
+					os.flush();
+					if (!os) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: error writing to %s") % source));
+					}
+				}
+			private:
+				template <class T> static void write_value(std::ostream& os, T value) {
+					os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+				}
+
+				static void write_padded(std::ostream& os, const std::string& data) {
+					os.write(data.data(), static_cast<std::streamsize>(data.size()));
+					const std::string padding(padded(data.size()) - data.size(), '\0');
+					os.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+				}
+
+				std::vector<std::pair<std::string, std::string>> sections_;
+			};
+
+			/** Reads named columns from a file written by SectionWriter */
+			class SectionReader {
+			public:
+				/** @param source Name of the input used in error messages */
+				SectionReader(std::istream& is, const std::string& source)
+					: source_(source), is_(is), start_(is.tellg()) {
+					char magic[sizeof(MAGIC)];
+					is_.read(magic, sizeof(magic));
+					if (!is_ || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: %s is not a checkpoint") % source_));
+					}
+					const auto version = read_value<uint32_t>();
+					if (version != Checkpoint::VERSION) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: %s has version %d, expected %d") % source_ % version % Checkpoint::VERSION));
+					}
+					if (read_value<uint32_t>() != BYTE_ORDER_MARK) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: %s has different byte order") % source_));
+					}
+					const auto nbr_sections = read_value<uint64_t>();
+					for (uint64_t i = 0; i < nbr_sections; ++i) {
+						const auto name_size = read_value<uint64_t>();
+						std::string name(padded(name_size), '\0');
+						is_.read(&name[0], static_cast<std::streamsize>(name.size()));
+						name.resize(name_size);
+						const auto offset = read_value<uint64_t>();
+						const auto size = read_value<uint64_t>();
+						sections_[name] = std::make_pair(offset, size);
+					}
+				}
+
+				template <class T> std::vector<T> get(const std::string& name) {
+					static_assert(std::is_trivially_copyable<T>::value, "SectionReader: column type must be trivially copyable");
+					const std::string data(get_bytes(name));
+					if (data.size() % sizeof(T)) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: section %s in %s has wrong size") % name % source_));
+					}
+					std::vector<T> column(data.size() / sizeof(T));
+					if (!column.empty()) {
+						std::memcpy(column.data(), data.data(), data.size());
+					}
+					return column;
+				}
+
+				template <class T> T get_scalar(const std::string& name) {
+					const auto column = get<T>(name);
+					if (column.size() != 1) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: section %s in %s is not a scalar") % name % source_));
+					}
+					return column.front();
+				}
+
+				std::string get_bytes(const std::string& name) {
+					const auto it = sections_.find(name);
+					if (it == sections_.end()) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: section %s missing in %s") % name % source_));
+					}
+					std::string data(it->second.second, '\0');
+					is_.seekg(start_ + static_cast<std::streamoff>(it->second.first));
+					is_.read(&data[0], static_cast<std::streamsize>(data.size()));
+					if (!is_) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: cannot read section %s from %s") % name % source_));
+					}
+					return data;
+				}
+			private:
+				template <class T> T read_value() {
+					T value;
+					is_.read(reinterpret_cast<char*>(&value), sizeof(T));
+					if (!is_) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: %s is truncated") % source_));
+					}
+					return value;
+				}
+
+				std::string source_;
+				std::istream& is_;
+				std::istream::pos_type start_; /**< Position of the checkpoint in the stream */
+				std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> sections_; /**< name -> (offset, size) */
+			};
+
+			/** Flattened values of one history of all persons */
+			struct HistoryColumns {
+				std::string factory_type;
+				std::vector<uint64_t> offsets;
+				std::vector<int64_t> dates;
+				std::vector<double> values;
+			};
+
+			template <class V> void append_values(const std::vector<V>& src, std::vector<double>& dst) {
+				for (V v : src) {
+					dst.push_back(static_cast<double>(v));
+				}
+			}
+
+			void append_values(const ObjectVector& src, std::vector<double>& dst) {
+				switch (src.type()) {
+				case ObjectVector::Type::DOUBLE:
+					append_values(src.as<double>(), dst);
+					break;
+				case ObjectVector::Type::FLOAT:
+					append_values(src.as<float>(), dst);
+					break;
+				case ObjectVector::Type::INT8:
+					append_values(src.as<int8_t>(), dst);
+					break;
+				case ObjectVector::Type::INT16:
+					append_values(src.as<int16_t>(), dst);
+					break;
+				case ObjectVector::Type::INT32:
+					append_values(src.as<int32_t>(), dst);
+					break;
+				case ObjectVector::Type::UINT8:
+					append_values(src.as<uint8_t>(), dst);
+					break;
+				case ObjectVector::Type::UINT16:
+					append_values(src.as<uint16_t>(), dst);
+					break;
+				case ObjectVector::Type::UINT32:
+					append_values(src.as<uint32_t>(), dst);
+					break;
+				default:
+					throw std::logic_error("Checkpoint: cannot save history values of null type");
+				}
+			}
+
+			std::string section_name(const char* prefix, size_t idx, const char* suffix) {
+				return boost::str(boost::format("%s%d%s") % prefix % idx % suffix);
+			}
+
+			std::vector<Actor::id_t> ids_of(const std::vector<Person::shared_ptr>& persons) {
+				std::vector<Actor::id_t> ids;
+				ids.reserve(persons.size());
+				for (const auto& p : persons) {
+					ids.push_back(p->id());
+				}
+				return ids;
+			}
+
+			std::vector<Person::shared_ptr> persons_of(const std::vector<Actor::id_t>& ids, const std::vector<Person::shared_ptr>& all_persons) {
+				std::vector<Person::shared_ptr> persons;
+				persons.reserve(ids.size());
+				for (Actor::id_t id : ids) {
+					const auto p = Population::find_by_id<Person>(all_persons, id);
+					if (!p) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: no saved Person with ID %d") % id));
+					}
+					persons.push_back(p);
+				}
+				return persons;
+			}
+
+			void check_offsets(const std::vector<uint64_t>& offsets, size_t nbr_persons, size_t nbr_values, const char* name) {
+				if (offsets.size() != nbr_persons + 1 || offsets.front() != 0 || offsets.back() != nbr_values || !std::is_sorted(offsets.begin(), offsets.end())) {
+					throw std::runtime_error(boost::str(boost::format("Checkpoint: invalid offsets in section %s") % name));
+				}
+			}
+
+			std::vector<int64_t> encode_dates(const std::vector<Date>& dates) {
+				std::vector<int64_t> codes(dates.size());
+				std::transform(dates.begin(), dates.end(), codes.begin(), encode_date);
+				return codes;
+			}
+
+			/** Save the records of archive in sections with names starting with prefix */
+			void add_archive(SectionWriter& writer, const std::string& prefix, const PersonArchive& archive) {
+				std::vector<uint8_t> sexes(archive.size());
+				std::transform(archive.sexes().begin(), archive.sexes().end(), sexes.begin(), [](Sex sex) { return static_cast<uint8_t>(sex); });
+				writer.add(prefix + "id", archive.ids());
+				writer.add(prefix + "sex", sexes);
+				writer.add(prefix + "ethnicity", archive.ethnicities());
+				writer.add(prefix + "date_of_birth", encode_dates(archive.dates_of_birth()));
+				writer.add(prefix + "date_of_death", encode_dates(archive.dates_of_death()));
+				writer.add(prefix + "immigration_date", encode_dates(archive.immigration_dates()));
+				writer.add(prefix + "mother_id", archive.mother_ids());
+				writer.add(prefix + "mother_date_of_birth", encode_dates(archive.mother_dates_of_birth()));
+				writer.add(prefix + "mother_immigration_date", encode_dates(archive.mother_immigration_dates()));
+			}
+
+			/** Append the records saved by add_archive to archive */
+			void get_archive(SectionReader& reader, const std::string& prefix, PersonArchive& archive) {
+				const auto ids = reader.get<Actor::id_t>(prefix + "id");
+				const size_t n = ids.size();
+				const auto sexes = reader.get<uint8_t>(prefix + "sex");
+				const auto ethnicities = reader.get<PersonAttributes::ethnicity_t>(prefix + "ethnicity");
+				const auto dobs = reader.get<int64_t>(prefix + "date_of_birth");
+				const auto dods = reader.get<int64_t>(prefix + "date_of_death");
+				const auto immigration_dates = reader.get<int64_t>(prefix + "immigration_date");
+				const auto mother_ids = reader.get<Actor::id_t>(prefix + "mother_id");
+				const auto mother_dobs = reader.get<int64_t>(prefix + "mother_date_of_birth");
+				const auto mother_immigration_dates = reader.get<int64_t>(prefix + "mother_immigration_date");
+				if (sexes.size() != n || ethnicities.size() != n || dobs.size() != n || dods.size() != n || immigration_dates.size() != n
+					|| mother_ids.size() != n || mother_dobs.size() != n || mother_immigration_dates.size() != n) {
+					throw std::runtime_error(boost::str(boost::format("Checkpoint: archive columns %s* have different sizes") % prefix));
+				}
+				for (size_t i = 0; i < n; ++i) {
+					PersonArchive::Record record;
+					record.id = ids[i];
+					record.attributes = PersonAttributes(static_cast<Sex>(sexes[i]), ethnicities[i]);
+					record.date_of_birth = decode_date(dobs[i]);
+					record.date_of_death = decode_date(dods[i]);
+					record.immigration_date = decode_date(immigration_dates[i]);
+					record.mother_id = mother_ids[i];
+					record.mother_date_of_birth = decode_date(mother_dobs[i]);
+					record.mother_immigration_date = decode_date(mother_immigration_dates[i]);
+					if (record.date_of_death.is_not_a_date()) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: archived Person with ID %d has no date of death") % record.id));
+					}
+					archive.add(record);
+				}
+				// records restored from the snapshot were observed before it was taken
+				archive.start_batch();
+			}
+		}
+
+		void Checkpoint::save(const std::string& filename, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			// write a temporary file first, so that an interrupted save leaves the previous snapshot intact
+			const std::string tmp_filename(filename + ".tmp");
+			{
+				std::ofstream os(tmp_filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+				if (!os) {
+					throw std::runtime_error(boost::str(boost::format("Checkpoint: cannot open file %s for writing") % tmp_filename));
+				}
+				try {
+					save(os, tmp_filename, population, ctx, observers);
+					os.close();
+					if (!os) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: error closing file %s") % tmp_filename));
+					}
+				} catch (...) {
+					os.close();
+					std::remove(tmp_filename.c_str());
+					throw;
+				}
+			}
+			if (std::rename(tmp_filename.c_str(), filename.c_str())) {
+				std::remove(tmp_filename.c_str());
+				throw std::runtime_error(boost::str(boost::format("Checkpoint: cannot rename %s to %s") % tmp_filename % filename));
+			}
+		}
+
+		void Checkpoint::save(std::ostream& os, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			save(os, "stream", population, ctx, observers);
+		}
+
+		void Checkpoint::load(const std::string& filename, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			std::ifstream is(filename, std::ios_base::in | std::ios_base::binary);
+			if (!is) {
+				throw std::runtime_error(boost::str(boost::format("Checkpoint: cannot open file %s for reading") % filename));
+			}
+			load(is, filename, population, ctx, observers);
+		}
+
+		void Checkpoint::load(std::istream& is, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			load(is, "stream", population, ctx, observers);
+		}
+
+		void Checkpoint::save(std::ostream& os, const std::string& source, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			const MutableContext& mctx = ctx.mutable_ctx();
+			const ImmutableContext& im_ctx = ctx.immutable_ctx();
+
+			// the same Person can belong to several collections; save each one once
+			std::vector<Person::shared_ptr> all_persons(population.persons());
+			const auto add_all = [&all_persons](const std::vector<Person::shared_ptr>& persons) {
+				all_persons.insert(all_persons.end(), persons.begin(), persons.end());
+			};
+			add_all(mctx.emigrant_population().persons());
+			add_all(mctx._newborns);
+			add_all(mctx.auxiliary_newborns_);
+			add_all(mctx.immigrants());
+			std::vector<Date> emigration_dates;
+			for (const auto& kv : mctx.emigrants()) {
+				emigration_dates.push_back(kv.first);
+				add_all(kv.second);
+			}
+			std::sort(emigration_dates.begin(), emigration_dates.end());
+			Population::sort_persons(all_persons);
+			all_persons.erase(std::unique(all_persons.begin(), all_persons.end()), all_persons.end());
+			for (size_t i = 1; i < all_persons.size(); ++i) {
+				if (all_persons[i]->id() == all_persons[i - 1]->id()) {
+					throw std::logic_error(boost::str(boost::format("Checkpoint: two different Persons with ID %d") % all_persons[i]->id()));
+				}
+			}
+			const size_t n = all_persons.size();
+
+			std::vector<Actor::id_t> ids(n);
+			std::vector<Actor::id_t> mother_ids(n);
+			std::vector<uint8_t> sexes(n);
+			std::vector<PersonAttributes::ethnicity_t> ethnicities(n);
+			std::vector<int64_t> dobs(n);
+			std::vector<int64_t> dods(n);
+			std::vector<int64_t> conception_dates(n);
+			std::vector<int64_t> immigration_dates(n);
+			std::vector<uint64_t> childbirth_offsets(1, 0);
+			std::vector<int64_t> childbirths;
+			std::vector<uint64_t> fetus_offsets(1, 0);
+			std::vector<uint8_t> fetus_sexes;
+			std::vector<PersonAttributes::ethnicity_t> fetus_ethnicities;
+			std::vector<int64_t> fetus_conception_dates;
+			std::map<std::string, HistoryColumns> histories;
+			for (size_t i = 0; i < n; ++i) {
+				const PersonData pd(all_persons[i]->to_data(im_ctx));
+				ids[i] = pd.id;
+				mother_ids[i] = pd.mother_id;
+				sexes[i] = static_cast<uint8_t>(pd.attributes.sex());
+				ethnicities[i] = pd.attributes.ethnicity();
+				dobs[i] = encode_date(pd.date_of_birth);
+				dods[i] = encode_date(pd.date_of_death);
+				conception_dates[i] = encode_date(pd.conception_date);
+				immigration_dates[i] = encode_date(pd.immigration_date);
+				for (Date d : pd.childbirths) {
+					childbirths.push_back(encode_date(d));
+				}
+				childbirth_offsets.push_back(childbirths.size());
+				for (const Fetus& fetus : pd.fetuses) {
+					fetus_sexes.push_back(static_cast<uint8_t>(fetus.attributes().sex()));
+					fetus_ethnicities.push_back(fetus.attributes().ethnicity());
+					fetus_conception_dates.push_back(encode_date(fetus.conception_date()));
+				}
+				fetus_offsets.push_back(fetus_sexes.size());
+				for (const auto& kv : pd.histories) {
+					const HistoryData& hd = kv.second;
+					if (!hd.size()) {
+						continue;
+					}
+					auto it = histories.find(kv.first);
+					if (it == histories.end()) {
+						it = histories.insert(std::make_pair(kv.first, HistoryColumns())).first;
+						it->second.factory_type = hd.factory_type();
+						it->second.offsets.assign(i + 1, 0);
+					} else if (it->second.factory_type != hd.factory_type()) {
+						throw std::logic_error(boost::str(boost::format("Checkpoint: history %s has factory types %s and %s") % kv.first % it->second.factory_type % hd.factory_type()));
+					}
+					HistoryColumns& columns = it->second;
+					columns.offsets.resize(i + 1, columns.dates.size());
+					for (Date d : hd.dates()) {
+						columns.dates.push_back(encode_date(d));
+					}
+					append_values(hd.values(), columns.values);
+					columns.offsets.push_back(columns.dates.size());
+				}
+			}
+
+			SectionWriter writer;
+			writer.add("person.id", ids);
+			writer.add("person.mother_id", mother_ids);
+			writer.add("person.sex", sexes);
+			writer.add("person.ethnicity", ethnicities);
+			writer.add("person.date_of_birth", dobs);
+			writer.add("person.date_of_death", dods);
+			writer.add("person.conception_date", conception_dates);
+			writer.add("person.immigration_date", immigration_dates);
+			writer.add("person.childbirths.offsets", childbirth_offsets);
+			writer.add("person.childbirths", childbirths);
+			writer.add("person.fetuses.offsets", fetus_offsets);
+			writer.add("person.fetuses.sex", fetus_sexes);
+			writer.add("person.fetuses.ethnicity", fetus_ethnicities);
+			writer.add("person.fetuses.conception_date", fetus_conception_dates);
+			std::vector<std::string> history_names;
+			std::vector<std::string> history_factory_types;
+			for (auto& kv : histories) {
+				HistoryColumns& columns = kv.second;
+				columns.offsets.resize(n + 1, columns.dates.size());
+				const size_t k = history_names.size();
+				writer.add(section_name("history.", k, ".offsets"), columns.offsets);
+				writer.add(section_name("history.", k, ".dates"), columns.dates);
+				writer.add(section_name("history.", k, ".values"), columns.values);
+				history_names.push_back(kv.first);
+				history_factory_types.push_back(columns.factory_type);
+			}
+			writer.add_bytes("history.names", join_strings(history_names));
+			writer.add_bytes("history.factory_types", join_strings(history_factory_types));
+
+			writer.add("population.ids", ids_of(population.persons()));
+			writer.add("emigrant_population.ids", ids_of(mctx.emigrant_population().persons()));
+			add_archive(writer, "population.archive.", population.archive());
+			add_archive(writer, "emigrant_population.archive.", mctx.emigrant_population().archive());
+			writer.add("newborns.ids", ids_of(mctx._newborns));
+			writer.add("auxiliary_newborns.ids", ids_of(mctx.auxiliary_newborns_));
+			writer.add("immigrants.ids", ids_of(mctx.immigrants()));
+			std::vector<int64_t> emigration_date_codes;
+			std::vector<uint64_t> emigrant_offsets(1, 0);
+			std::vector<Actor::id_t> emigrant_ids;
+			for (Date d : emigration_dates) {
+				emigration_date_codes.push_back(encode_date(d));
+				for (const auto& p : mctx.emigrants().find(d)->second) {
+					emigrant_ids.push_back(p->id());
+				}
+				emigrant_offsets.push_back(emigrant_ids.size());
+			}
+			writer.add("emigrants.dates", emigration_date_codes);
+			writer.add("emigrants.offsets", emigrant_offsets);
+			writer.add("emigrants.ids", emigrant_ids);
+
+			const Schedule& schedule = im_ctx.schedule();
+			std::vector<int64_t> schedule_dates;
+			for (size_t i = 0; i < schedule.nbr_dates(); ++i) {
+				schedule_dates.push_back(encode_date(schedule.date(i)));
+			}
+			writer.add("schedule.dates", schedule_dates);
+			writer.add_scalar("context.date_index", static_cast<uint64_t>(mctx.date_index()));
+			writer.add_scalar("context.max_id", mctx.get_max_id());
+			writer.add_scalar("context.auxiliary_max_id", mctx.auxiliary_max_id_);
+			writer.add_scalar("context.stream_seed", mctx.stream_seed_);
+			std::stringstream rng_state;
+			mctx._rng->save_state(rng_state);
+			writer.add_bytes("context.rng", rng_state.str());
+
+			std::stringstream observer_states;
+			std::vector<uint64_t> observer_offsets(1, 0);
+			for (const auto& observer : observers) {
+				check_not_null(observer, "Checkpoint: null observer");
+				observer->save_state(observer_states);
+				if (!observer_states) {
+					throw std::runtime_error("Checkpoint: error saving observer state");
+				}
+				observer_offsets.push_back(static_cast<uint64_t>(observer_states.tellp()));
+			}
+			writer.add("observers.offsets", observer_offsets);
+			writer.add_bytes("observers.states", observer_states.str());
+
+			writer.write(os, source);
+			LOG_INFO() << "Checkpoint: saved " << n << " Persons at schedule date index " << mctx.date_index() << " to " << source;
+		}
+
+		void Checkpoint::load(std::istream& is, const std::string& source, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers) {
+			check_that(population.empty() && population.archive().empty(), "Checkpoint: population must be empty");
+			MutableContext& mctx = ctx.mutable_ctx();
+			const ImmutableContext& im_ctx = ctx.immutable_ctx();
+			const PoolAllocator<Person> alloc(mctx.person_allocator());
+			const HistoryColumnStores::Scope history_column_scope(mctx.history_column_stores());
+			SectionReader reader(is, source);
+
+			const Schedule& schedule = im_ctx.schedule();
+			const auto schedule_dates = reader.get<int64_t>("schedule.dates");
+			bool same_schedule = schedule_dates.size() == schedule.nbr_dates();
+			for (size_t i = 0; same_schedule && i < schedule_dates.size(); ++i) {
+				same_schedule = decode_date(schedule_dates[i]) == schedule.date(i);
+			}
+			check_that(same_schedule, "Checkpoint: saved schedule differs from the context schedule");
+
+			// restore the observers first, they do not depend on the persons
+			const auto date_index = reader.get_scalar<uint64_t>("context.date_index");
+			const auto observer_offsets = reader.get<uint64_t>("observers.offsets");
+			const std::string observer_states(reader.get_bytes("observers.states"));
+			if (observer_offsets.empty()) {
+				throw std::runtime_error("Checkpoint: invalid offsets in section observers.offsets");
+			}
+			const size_t nbr_saved_observers = observer_offsets.size() - 1;
+			check_offsets(observer_offsets, nbr_saved_observers, observer_states.size(), "observers.offsets");
+			if (nbr_saved_observers || date_index) {
+				if (nbr_saved_observers != observers.size()) {
+					LOG_ERROR() << "Checkpoint: " << source << " has the state of " << nbr_saved_observers << " observers, but " << observers.size() << " were given";
+					throw std::domain_error("Checkpoint: different number of observers");
+				}
+				for (size_t i = 0; i < observers.size(); ++i) {
+					check_not_null(observers[i], "Checkpoint: null observer");
+					std::stringstream observer_state(observer_states.substr(static_cast<size_t>(observer_offsets[i]), static_cast<size_t>(observer_offsets[i + 1] - observer_offsets[i])));
+					observers[i]->load_state(observer_state);
+				}
+			}
+
+			const auto ids = reader.get<Actor::id_t>("person.id");
+			const size_t n = ids.size();
+			const auto mother_ids = reader.get<Actor::id_t>("person.mother_id");
+			const auto sexes = reader.get<uint8_t>("person.sex");
+			const auto ethnicities = reader.get<PersonAttributes::ethnicity_t>("person.ethnicity");
+			const auto dobs = reader.get<int64_t>("person.date_of_birth");
+			const auto dods = reader.get<int64_t>("person.date_of_death");
+			const auto conception_dates = reader.get<int64_t>("person.conception_date");
+			const auto immigration_dates = reader.get<int64_t>("person.immigration_date");
+			if (mother_ids.size() != n || sexes.size() != n || ethnicities.size() != n || dobs.size() != n || dods.size() != n || conception_dates.size() != n || immigration_dates.size() != n) {
+				throw std::runtime_error("Checkpoint: Person columns have different sizes");
+			}
+			const auto childbirth_offsets = reader.get<uint64_t>("person.childbirths.offsets");
+			const auto childbirths = reader.get<int64_t>("person.childbirths");
+			check_offsets(childbirth_offsets, n, childbirths.size(), "person.childbirths.offsets");
+			const auto fetus_offsets = reader.get<uint64_t>("person.fetuses.offsets");
+			const auto fetus_sexes = reader.get<uint8_t>("person.fetuses.sex");
+			const auto fetus_ethnicities = reader.get<PersonAttributes::ethnicity_t>("person.fetuses.ethnicity");
+			const auto fetus_conception_dates = reader.get<int64_t>("person.fetuses.conception_date");
+			if (fetus_ethnicities.size() != fetus_sexes.size() || fetus_conception_dates.size() != fetus_sexes.size()) {
+				throw std::runtime_error("Checkpoint: Fetus columns have different sizes");
+			}
+			check_offsets(fetus_offsets, n, fetus_sexes.size(), "person.fetuses.offsets");
+			const auto history_names = split_strings(reader.get_bytes("history.names"));
+			const auto history_factory_types = split_strings(reader.get_bytes("history.factory_types"));
+			if (history_factory_types.size() != history_names.size()) {
+				throw std::runtime_error("Checkpoint: history names and factory types have different sizes");
+			}
+			std::vector<HistoryColumns> histories(history_names.size());
+			for (size_t k = 0; k < histories.size(); ++k) {
+				const std::string offsets_name(section_name("history.", k, ".offsets"));
+				histories[k].offsets = reader.get<uint64_t>(offsets_name);
+				histories[k].dates = reader.get<int64_t>(section_name("history.", k, ".dates"));
+				histories[k].values = reader.get<double>(section_name("history.", k, ".values"));
+				if (histories[k].values.size() != histories[k].dates.size()) {
+					throw std::runtime_error(boost::str(boost::format("Checkpoint: history %s has different numbers of dates and values") % history_names[k]));
+				}
+				check_offsets(histories[k].offsets, n, histories[k].dates.size(), offsets_name.c_str());
+			}
+
+			std::vector<Person::shared_ptr> all_persons;
+			all_persons.reserve(n);
+			for (size_t i = 0; i < n; ++i) {
+				PersonData pd;
+				pd.id = ids[i];
+				pd.attributes = PersonAttributes(static_cast<Sex>(sexes[i]), ethnicities[i]);
+				pd.date_of_birth = decode_date(dobs[i]);
+				pd.conception_date = decode_date(conception_dates[i]);
+				pd.immigration_date = decode_date(immigration_dates[i]);
+				for (uint64_t j = childbirth_offsets[i]; j < childbirth_offsets[i + 1]; ++j) {
+					pd.childbirths.push_back(decode_date(childbirths[j]));
+				}
+				for (uint64_t j = fetus_offsets[i]; j < fetus_offsets[i + 1]; ++j) {
+					pd.fetuses.push_back(Fetus(PersonAttributes(static_cast<Sex>(fetus_sexes[j]), fetus_ethnicities[j]), decode_date(fetus_conception_dates[j])));
+				}
+				for (size_t k = 0; k < histories.size(); ++k) {
+					const HistoryColumns& columns = histories[k];
+					if (columns.offsets[i] < columns.offsets[i + 1]) {
+						HistoryData hd(history_factory_types[k], history_names[k]);
+						hd.reserve(columns.offsets[i + 1] - columns.offsets[i]);
+						for (uint64_t j = columns.offsets[i]; j < columns.offsets[i + 1]; ++j) {
+							hd.append(decode_date(columns.dates[j]), columns.values[j]);
+						}
+						pd.histories.insert(std::make_pair(history_names[k], std::move(hd)));
+					}
+				}
+				const Date dod = decode_date(dods[i]);
+				Person::shared_ptr person(Person::from_data(std::move(pd), im_ctx, alloc));
+				if (!dod.is_not_a_date()) {
+					person->die(dod);
+				}
+				all_persons.push_back(person);
+			}
+			if (!std::is_sorted(ids.begin(), ids.end())) {
+				throw std::runtime_error("Checkpoint: Persons not sorted by ID");
+			}
+			for (size_t i = 0; i < n; ++i) {
+				if (mother_ids[i] != Actor::INVALID_ID) {
+					const auto mother = Population::find_by_id<Person>(all_persons, mother_ids[i]);
+					if (!mother) {
+						throw std::runtime_error(boost::str(boost::format("Checkpoint: mother ID %d has no Person") % mother_ids[i]));
+					}
+					Person::link_parents_child(all_persons[i], mother, decode_date(conception_dates[i]));
+				}
+			}
+
+			population.add_persons(persons_of(reader.get<Actor::id_t>("population.ids"), all_persons));
+			mctx.emigrant_population().wipe_out();
+			// emigrant population is not necessarily sorted by ID, keep the saved order
+			for (const auto& p : persons_of(reader.get<Actor::id_t>("emigrant_population.ids"), all_persons)) {
+				mctx.emigrant_population().add_person(p, false);
+			}
+			get_archive(reader, "population.archive.", population.archive_);
+			get_archive(reader, "emigrant_population.archive.", mctx.emigrant_population().archive_);
+			mctx._newborns = persons_of(reader.get<Actor::id_t>("newborns.ids"), all_persons);
+			mctx.auxiliary_newborns_ = persons_of(reader.get<Actor::id_t>("auxiliary_newborns.ids"), all_persons);
+			mctx.immigrants_ = persons_of(reader.get<Actor::id_t>("immigrants.ids"), all_persons);
+			const auto emigration_dates = reader.get<int64_t>("emigrants.dates");
+			const auto emigrant_offsets = reader.get<uint64_t>("emigrants.offsets");
+			const auto emigrant_ids = reader.get<Actor::id_t>("emigrants.ids");
+			check_offsets(emigrant_offsets, emigration_dates.size(), emigrant_ids.size(), "emigrants.offsets");
+			mctx.emigrants_.clear();
+			for (size_t i = 0; i < emigration_dates.size(); ++i) {
+				const std::vector<Actor::id_t> ids_for_date(emigrant_ids.begin() + static_cast<std::ptrdiff_t>(emigrant_offsets[i]), emigrant_ids.begin() + static_cast<std::ptrdiff_t>(emigrant_offsets[i + 1]));
+				mctx.emigrants_[decode_date(emigration_dates[i])] = persons_of(ids_for_date, all_persons);
+			}
+
+			mctx.date_idx_ = static_cast<MutableContext::date_idx_t>(date_index);
+			mctx._max_id = reader.get_scalar<Actor::id_t>("context.max_id");
+			mctx.auxiliary_max_id_ = reader.get_scalar<Actor::id_t>("context.auxiliary_max_id");
+			mctx.stream_seed_ = reader.get_scalar<uint64_t>("context.stream_seed");
+			std::stringstream rng_state(reader.get_bytes("context.rng"));
+			mctx._rng->load_state(rng_state);
+			LOG_INFO() << "Checkpoint: loaded " << n << " Persons at schedule date index " << mctx.date_index() << " from " << source;
+		}
+	}
+}
@@ -0,0 +1,72 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MICROSIM_CHECKPOINT_HPP
+#define __AVERISERA_MICROSIM_CHECKPOINT_HPP
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace averisera {
+	namespace microsim {
+		class Contexts;
+		class Observer;
+		class Population;
+
+		/** Saves and restores the state of a simulation in a versioned binary file.
+
+		The snapshot contains the simulated Population with its archive of dead persons (see Population::archive_dead_persons) and the state
+		of MutableContext: emigrant population (also with its archive), newborns, immigrants and emigrants,
+		maximum Actor IDs (including the auxiliary ones, see MutableContext::AuxiliaryThread), schedule date index, the state of the RNG
+		and the results gathered by the observers (see Observer::save_state). The ImmutableContext and the configuration of the observers are not saved;
+		the snapshot must be restored into Contexts with the same schedule and history registry, and into observers constructed with the same arguments.
+
+		File layout: a header (magic "AVMSCKPT", uint32 version, uint32 byte order mark, uint64 number of sections), followed by a table
+		of sections (uint64 name length, name padded to 8 bytes, uint64 offset, uint64 size in bytes) and the section data.
+		Each section is a column of fixed-width values in native byte order, starting at an offset divisible by 8, so the file can be memory-mapped.
+		Person attributes are stored column by column; variable-length data (histories, childbirths, fetuses) are stored as flattened
+		columns with offsets. Dates are stored as Julian day numbers, history values as doubles (which represent all ObjectVector types exactly).
+		*/
+		class Checkpoint {
+		public:
+			/** Current format version */
+			static const uint32_t VERSION = 4;
+
+			/** Save population, the mutable state of ctx and the state of observers to file. The snapshot is written to filename + ".tmp" first,
+			which is then renamed to filename, so that an interrupted save does not destroy the previous snapshot (on POSIX systems the
+			replacement is atomic).
+			@throw std::logic_error If two different Person objects have the same ID, the RNG or any observer does not support saving its state.
+			@throw std::runtime_error If the file cannot be written.
+			*/
+			static void save(const std::string& filename, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers = std::vector<std::shared_ptr<Observer>>());
+
+			/** Restore population, the mutable state of ctx and the state of observers from file.
+			@param population Empty population
+			@param observers Observers in the same order as when saving. If the snapshot was taken before the first simulation step without any observers,
+			observers keep their state.
+			@throw std::domain_error If population is not empty, the schedule of ctx differs from the saved one or the number of observers differs from the saved one.
+			@throw std::runtime_error If the file cannot be read, has a different version or is corrupt.
+			*/
+			static void load(const std::string& filename, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers = std::vector<std::shared_ptr<Observer>>());
+
+			/** Save population, the mutable state of ctx and the state of observers to a binary stream (e.g. to keep the snapshot in memory).
+			@see save(const std::string&, const Population&, const Contexts&, const std::vector<std::shared_ptr<Observer>>&)
+			*/
+			static void save(std::ostream& os, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers = std::vector<std::shared_ptr<Observer>>());
+
+			/** Restore population, the mutable state of ctx and the state of observers from a binary stream, starting at its current position.
+			@see load(const std::string&, Population&, const Contexts&, const std::vector<std::shared_ptr<Observer>>&)
+			*/
+			static void load(std::istream& is, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers = std::vector<std::shared_ptr<Observer>>());
+		private:
+			/** @param source Name of the output used in messages */
+			static void save(std::ostream& os, const std::string& source, const Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers);
+
+			/** @param source Name of the input used in messages */
+			static void load(std::istream& is, const std::string& source, Population& population, const Contexts& ctx, const std::vector<std::shared_ptr<Observer>>& observers);
+		};
+	}
+}
+
+#endif // __AVERISERA_MICROSIM_CHECKPOINT_HPP
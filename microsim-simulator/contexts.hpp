@@ -55,6 +55,11 @@ namespace averisera {
                 return *_immutable;
             }
             
+            /** Shared pointer to the ImmutableContext, e.g. to create other Contexts sharing it */
+            const std::shared_ptr<ImmutableContext>& immutable_ctx_ptr() const {
+                return _immutable;
+            }
+
             MutableContext& mutable_ctx() const {
                 assert(_mutable);
                 return *_mutable;
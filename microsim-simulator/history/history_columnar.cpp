@@ -0,0 +1,38 @@
+// (C) Averisera Ltd 2014-2020
+#include "history_columnar.hpp"
+#include "microsim-core/schedule.hpp"
+
+namespace averisera {
+    namespace microsim {
+		thread_local HistoryColumnStores* HistoryColumnStores::tl_current_ = nullptr;
+
+		HistoryColumnStores::Scope::Scope(HistoryColumnStores& stores)
+			: prev_(tl_current_) {
+			tl_current_ = &stores;
+		}
+
+		HistoryColumnStores::Scope::~Scope() {
+			tl_current_ = prev_;
+		}
+
+		void HistoryColumnStores::set_dates(const std::vector<Date>& dates) {
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (dates == dates_) {
+				return;
+			}
+			if (!stores_.empty()) {
+				throw std::logic_error("HistoryColumnStores: cannot change column dates after creating stores");
+			}
+			dates_ = dates;
+		}
+
+		void HistoryColumnStores::set_dates(const Schedule& schedule) {
+			std::vector<Date> dates;
+			dates.reserve(schedule.nbr_dates());
+			for (Schedule::index_t i = 0; i < schedule.nbr_dates(); ++i) {
+				dates.push_back(schedule.date(i));
+			}
+			set_dates(dates);
+		}
+    }
+}
@@ -0,0 +1,659 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_HISTORY_COLUMNAR_H
+#define __AVERISERA_MS_HISTORY_COLUMNAR_H
+
+#include "../history.hpp"
+#include "../history_data.hpp"
+#include "core/dates.hpp"
+#include "core/log.hpp"
+#include "core/math_utils.hpp"
+#include "core/printable.hpp"
+#include "core/time_series.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <boost/format.hpp>
+#include <boost/lexical_cast.hpp>
+
+namespace averisera {
+    namespace microsim {
+		class Schedule;
+
+		/** @brief Columnar storage of the values of one history variable for all persons of a simulation.
+
+		Every HistoryColumnar object owns a slot in the store. A value appended on one of the column dates given to the constructor
+		is stored in the column for that date; values appended on other dates go to the exception list of the slot. Slots are
+		allocated in blocks, and each column is allocated block by block when the first value is stored in it, so a column only takes
+		memory for the blocks which have values on its date. Slots released by destroyed histories are reused.
+
+		Each slot keeps the sorted dates of its values, so date lookups are binary searches over the slot's own events.
+
+		Reading and writing a slot is lock-free and needs no synchronisation with other slots: a slot can be used concurrently with other
+		slots, but (like any other History) not with itself. Acquiring and releasing slots is synchronised by a spin lock.
+		scan_column() must not run concurrently with appends.
+
+		@tparam V Value type: double, float or integer type
+		*/
+		template <class V> class HistoryColumnStore {
+		private:
+			struct Block;
+			typedef std::vector<std::pair<Date, V>> exceptions_type;
+		public:
+			typedef History::index_t index_t;
+
+			/** Values of one history */
+			class Slot {
+			public:
+				Slot()
+					: block_(nullptr), offset_(0) {}
+			private:
+				friend class HistoryColumnStore<V>;
+				Block* block_;
+				size_t offset_; /**< Position in the block */
+				std::vector<Date> dates_; /**< Dates of all events, sorted */
+				exceptions_type exceptions_; /**< Values stored on dates without columns, sorted by date */
+			};
+
+			/** Number of slots in the first block */
+			static const size_t MIN_BLOCK_SIZE = 16;
+
+			/** Maximum number of slots in a block */
+			static const size_t MAX_BLOCK_SIZE = 4096;
+
+			/**
+			@param name Variable name
+			@param column_dates Dates with columns (e.g. simulation schedule dates)
+			@throw std::domain_error If column_dates are not strictly increasing.
+			*/
+			HistoryColumnStore(const std::string& name, const std::vector<Date>& column_dates)
+				: name_(name), column_dates_(column_dates), nbr_slots_(0), capacity_(0) {
+				if (std::adjacent_find(column_dates_.begin(), column_dates_.end(), std::greater_equal<Date>()) != column_dates_.end()) {
+					throw std::domain_error("HistoryColumnStore: column dates must be strictly increasing");
+				}
+			}
+
+			HistoryColumnStore(const HistoryColumnStore<V>&) = delete;
+			HistoryColumnStore<V>& operator=(const HistoryColumnStore<V>&) = delete;
+
+			const std::string& name() const {
+				return name_;
+			}
+
+			/** Number of slots in use */
+			size_t nbr_slots() const {
+				return nbr_slots_;
+			}
+
+			/** Number of columns */
+			size_t nbr_columns() const {
+				return column_dates_.size();
+			}
+
+			/** Number of values stored outside the columns. Must not run concurrently with appends. */
+			size_t nbr_exceptions() const {
+				const SpinLock lock(lock_);
+				size_t n = 0;
+				for (const auto& block : blocks_) {
+					for (const Slot& slot : block->slots) {
+						n += slot.exceptions_.size();
+					}
+				}
+				return n;
+			}
+
+			/** Call f(slot index, value) for every value stored in the column for given date. Used to aggregate the variable over all histories.
+			Must not run concurrently with appends.
+			@return False if date has no column. */
+			template <class F> bool scan_column(Date date, F f) const {
+				const size_t col = find_column(date);
+				if (col == NO_COLUMN) {
+					return false;
+				}
+				const SpinLock lock(lock_);
+				for (const auto& block : blocks_) {
+					const Column* const column = block->columns[col].load(std::memory_order_acquire);
+					if (column) {
+						const size_t n = block->slots.size();
+						for (size_t k = 0; k < n; ++k) {
+							if (column->present[k]) {
+								f(block->first_slot + k, column->values[k]);
+							}
+						}
+					}
+				}
+				return true;
+			}
+
+			/** Allocate an empty slot */
+			Slot& acquire() {
+				const SpinLock lock(lock_);
+				if (free_slots_.empty()) {
+					const size_t block_size = blocks_.empty() ? MIN_BLOCK_SIZE : std::min(2 * blocks_.back()->slots.size(), MAX_BLOCK_SIZE);
+					std::unique_ptr<Block> block(new Block(capacity_, block_size, column_dates_.size()));
+					// release() must not allocate
+					free_slots_.reserve(capacity_ + block_size);
+					blocks_.reserve(blocks_.size() + 1);
+					for (size_t k = block_size; k > 0; --k) {
+						free_slots_.push_back(&block->slots[k - 1]);
+					}
+					capacity_ += block_size;
+					blocks_.push_back(std::move(block));
+				}
+				Slot* const slot = free_slots_.back();
+				free_slots_.pop_back();
+				++nbr_slots_;
+				return *slot;
+			}
+
+			/** Clear the slot and make it available for reuse */
+			void release(Slot& slot) noexcept {
+				for (Date date : slot.dates_) {
+					const size_t col = find_column(date);
+					if (col != NO_COLUMN) {
+						Column* const column = slot.block_->columns[col].load(std::memory_order_relaxed);
+						assert(column);
+						column->present[slot.offset_] = 0;
+					}
+				}
+				std::vector<Date>().swap(slot.dates_);
+				exceptions_type().swap(slot.exceptions_);
+				const SpinLock lock(lock_);
+				free_slots_.push_back(&slot); // capacity reserved by acquire()
+				--nbr_slots_;
+			}
+
+			template <class V2> void append(Slot& slot, Date date, V2 value) {
+				if (!slot.dates_.empty() && date <= slot.dates_.back()) {
+					const std::string msg(boost::str(boost::format("HistoryColumnar::append: appending value %s: appended date %s not past the current last %s in history %s") % boost::lexical_cast<std::string>(value) % boost::lexical_cast<std::string>(date) % boost::lexical_cast<std::string>(slot.dates_.back()) % name_));
+					LOG_ERROR() << msg;
+					throw std::domain_error(msg);
+				}
+				const V v = MathUtils::safe_cast<V>(value);
+				slot.dates_.push_back(date);
+				const size_t col = find_column(date);
+				try {
+					if (col != NO_COLUMN) {
+						Column& column = get_column(*slot.block_, col);
+						column.values[slot.offset_] = v;
+						column.present[slot.offset_] = 1;
+					} else {
+						slot.exceptions_.push_back(std::make_pair(date, v));
+					}
+				} catch (...) {
+					slot.dates_.pop_back();
+					throw;
+				}
+			}
+
+			/** Correct the last value */
+			void correct(Slot& slot, History::double_t value) {
+				if (slot.dates_.empty()) {
+					throw std::domain_error("HistoryColumnar: History is empty");
+				}
+				*find_value(slot, slot.dates_.back()) = MathUtils::safe_cast<V>(value);
+			}
+
+			index_t size(const Slot& slot) const {
+				return static_cast<index_t>(slot.dates_.size());
+			}
+
+			/** @return False if slot is empty */
+			bool first_date(const Slot& slot, Date& date) const {
+				if (slot.dates_.empty()) {
+					return false;
+				}
+				date = slot.dates_.front();
+				return true;
+			}
+
+			/** @return False if slot is empty */
+			bool last(const Slot& slot, Date& date, V& value) const {
+				if (slot.dates_.empty()) {
+					return false;
+				}
+				date = slot.dates_.back();
+				value = *find_value(slot, date);
+				return true;
+			}
+
+			/** Value on given date
+			@return False if there is no value on this date */
+			bool value_on(const Slot& slot, Date date, V& value) const {
+				if (!std::binary_search(slot.dates_.begin(), slot.dates_.end(), date)) {
+					return false;
+				}
+				value = *find_value(slot, date);
+				return true;
+			}
+
+			/** Last date and value on or before asof
+			@return False if there is no such date */
+			bool last(const Slot& slot, Date asof, Date& date, V& value) const {
+				const auto it = std::upper_bound(slot.dates_.begin(), slot.dates_.end(), asof);
+				if (it == slot.dates_.begin()) {
+					return false;
+				}
+				date = *(it - 1);
+				value = *find_value(slot, date);
+				return true;
+			}
+
+			/** idx-th event
+			@return False if idx >= size */
+			bool event(const Slot& slot, index_t idx, Date& date, V& value) const {
+				if (idx >= slot.dates_.size()) {
+					return false;
+				}
+				date = slot.dates_[idx];
+				value = *find_value(slot, date);
+				return true;
+			}
+
+			/** Number of events with dates in [from, to] */
+			index_t count(const Slot& slot, Date from, Date to) const {
+				if (to < from) {
+					return 0;
+				}
+				const auto begin = std::lower_bound(slot.dates_.begin(), slot.dates_.end(), from);
+				const auto end = std::upper_bound(begin, slot.dates_.end(), to);
+				return static_cast<index_t>(end - begin);
+			}
+
+			/** Copy all events to a time series */
+			void events(const Slot& slot, TimeSeries<Date, V>& ts) const {
+				ts = TimeSeries<Date, V>();
+				ts.reserve(slot.dates_.size());
+				for (Date date : slot.dates_) {
+					ts.push_back(date, *find_value(slot, date));
+				}
+			}
+		private:
+			static const size_t NO_COLUMN = std::numeric_limits<size_t>::max();
+
+			/** Part of a column for the slots of one block */
+			struct Column {
+				explicit Column(size_t size)
+					: values(new V[size]()), present(new uint8_t[size]()) {}
+
+				std::unique_ptr<V[]> values;
+				std::unique_ptr<uint8_t[]> present; /**< present[k] is 1 if values[k] is set */
+			};
+
+			struct Block {
+				Block(size_t new_first_slot, size_t size, size_t nbr_columns)
+					: first_slot(new_first_slot), slots(size), columns(new std::atomic<Column*>[nbr_columns]), nbr_columns_(nbr_columns) {
+					for (size_t k = 0; k < size; ++k) {
+						slots[k].block_ = this;
+						slots[k].offset_ = k;
+					}
+					for (size_t col = 0; col < nbr_columns; ++col) {
+						columns[col].store(nullptr, std::memory_order_relaxed);
+					}
+				}
+
+				~Block() {
+					for (size_t col = 0; col < nbr_columns_; ++col) {
+						delete columns[col].load(std::memory_order_relaxed);
+					}
+				}
+
+				Block(const Block&) = delete;
+				Block& operator=(const Block&) = delete;
+
+				size_t first_slot; /**< Index of the first slot in the store */
+				std::vector<Slot> slots;
+				std::unique_ptr<std::atomic<Column*>[]> columns; /**< Allocated on first use */
+			private:
+				size_t nbr_columns_;
+			};
+
+			/** Scoped lock on an atomic flag. Never throws. */
+			class SpinLock {
+			public:
+				explicit SpinLock(std::atomic_flag& flag) noexcept
+					: flag_(flag) {
+					while (flag_.test_and_set(std::memory_order_acquire)) {
+					}
+				}
+
+				~SpinLock() {
+					flag_.clear(std::memory_order_release);
+				}
+
+				SpinLock(const SpinLock&) = delete;
+				SpinLock& operator=(const SpinLock&) = delete;
+			private:
+				std::atomic_flag& flag_;
+			};
+
+			size_t find_column(Date date) const {
+				const auto it = std::lower_bound(column_dates_.begin(), column_dates_.end(), date);
+				if (it != column_dates_.end() && *it == date) {
+					return static_cast<size_t>(it - column_dates_.begin());
+				} else {
+					return NO_COLUMN;
+				}
+			}
+
+			/** Column of the block, allocated if necessary. Blocks are shared by slots used by different threads. */
+			static Column& get_column(Block& block, size_t col) {
+				std::atomic<Column*>& ptr = block.columns[col];
+				Column* column = ptr.load(std::memory_order_acquire);
+				if (!column) {
+					std::unique_ptr<Column> created(new Column(block.slots.size()));
+					if (ptr.compare_exchange_strong(column, created.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+						column = created.release();
+					}
+				}
+				return *column;
+			}
+
+			/** Pointer to the value stored on a date from slot.dates_ */
+			const V* find_value(const Slot& slot, Date date) const {
+				const size_t col = find_column(date);
+				if (col != NO_COLUMN) {
+					const Column* const column = slot.block_->columns[col].load(std::memory_order_acquire);
+					assert(column && column->present[slot.offset_]);
+					return &column->values[slot.offset_];
+				}
+				const auto it = std::lower_bound(slot.exceptions_.begin(), slot.exceptions_.end(), date, [](const std::pair<Date, V>& e, Date d) { return e.first < d; });
+				assert(it != slot.exceptions_.end() && it->first == date);
+				return &it->second;
+			}
+
+			V* find_value(Slot& slot, Date date) {
+				return const_cast<V*>(static_cast<const HistoryColumnStore<V>*>(this)->find_value(slot, date));
+			}
+
+			std::string name_;
+			std::vector<Date> column_dates_;
+			mutable std::atomic_flag lock_ = ATOMIC_FLAG_INIT; /**< Guards blocks_ and free_slots_ */
+			std::vector<std::unique_ptr<Block>> blocks_;
+			std::vector<Slot*> free_slots_;
+			std::atomic<size_t> nbr_slots_;
+			size_t capacity_; /**< Total number of slots in blocks_ */
+		};
+
+		template <class V> const size_t HistoryColumnStore<V>::MIN_BLOCK_SIZE;
+		template <class V> const size_t HistoryColumnStore<V>::MAX_BLOCK_SIZE;
+		template <class V> const size_t HistoryColumnStore<V>::NO_COLUMN;
+
+		/** @brief HistoryColumnStore objects of one simulation, one for each variable name and value type.
+
+		Owned by the MutableContext, so scenarios forked from the same base do not share stores. HistoryFactory::COLUMNAR() factories take the
+		stores from the HistoryColumnStores::Scope active in the calling thread.
+		*/
+		class HistoryColumnStores {
+		public:
+			/** Make the stores available to HistoryFactory::COLUMNAR() factories called in the current thread while in scope. */
+			class Scope {
+			public:
+				explicit Scope(HistoryColumnStores& stores);
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+				~Scope();
+			private:
+				HistoryColumnStores* prev_;
+			};
+
+			/** Stores made available by the innermost Scope in this thread, or null */
+			static HistoryColumnStores* current() {
+				return tl_current_;
+			}
+
+			/** Set the column dates used by stores created from now on.
+			@throw std::logic_error If a store has already been created with different dates.
+			*/
+			void set_dates(const std::vector<Date>& dates);
+
+			/** Set the column dates to the dates of the schedule
+			@see set_dates(const std::vector<Date>&) */
+			void set_dates(const Schedule& schedule);
+
+			const std::vector<Date>& dates() const {
+				return dates_;
+			}
+
+			/** Store for the variable with given name, created on first use */
+			template <class V> std::shared_ptr<HistoryColumnStore<V>> get(const std::string& name) {
+				const std::string key(std::string(print_type_name<V>()) + " " + name);
+				std::lock_guard<std::mutex> lock(mutex_);
+				std::shared_ptr<void>& store = stores_[key];
+				if (!store) {
+					store = std::make_shared<HistoryColumnStore<V>>(name, dates_);
+				}
+				return std::static_pointer_cast<HistoryColumnStore<V>>(store);
+			}
+		private:
+			std::mutex mutex_;
+			std::vector<Date> dates_;
+			std::unordered_map<std::string, std::shared_ptr<void>> stores_; /**< Key: value type and variable name */
+
+			static thread_local HistoryColumnStores* tl_current_;
+		};
+
+		/** @brief History stored in a HistoryColumnStore shared by all histories with the same name and value type in a simulation.
+
+		Suitable for variables updated on schedule dates for most persons: the values for each column date are stored in one contiguous
+		column per block of slots, and the History object holds only a reference to its slot.
+
+		@tparam V Value type: double, float or integer type
+		*/
+		template <class V> class HistoryColumnar : public History {
+		public:
+			/** @throw std::domain_error If store is null */
+			explicit HistoryColumnar(std::shared_ptr<HistoryColumnStore<V>> store)
+				: store_(store), slot_(acquire(store)) {
+			}
+
+			~HistoryColumnar() {
+				store_->release(slot_);
+			}
+
+			bool empty() const override {
+				return size() == 0;
+			}
+
+			Date last_date() const override {
+				Date date;
+				V value;
+				if (store_->last(slot_, date, value)) {
+					return date;
+				} else {
+					throw std::logic_error("HistoryColumnar: history is empty");
+				}
+			}
+
+			Date last_date(Date asof) const override {
+				if (empty()) {
+					throw std::logic_error("HistoryColumnar: history is empty");
+				}
+				Date date;
+				V value;
+				if (store_->last(slot_, asof, date, value)) {
+					return date;
+				} else {
+					throw std::out_of_range(boost::str(boost::format("HistoryColumnar: no dates on or before %s") % boost::lexical_cast<std::string>(asof)));
+				}
+			}
+
+			Date first_date() const override {
+				Date date;
+				if (store_->first_date(slot_, date)) {
+					return date;
+				} else {
+					throw std::logic_error("HistoryColumnar: history is empty");
+				}
+			}
+
+			double_t as_double(Date asof) const override {
+				V value;
+				if (store_->value_on(slot_, asof, value)) {
+					return static_cast<double_t>(value);
+				} else {
+					return std::numeric_limits<double_t>::quiet_NaN();
+				}
+			}
+
+			int_t as_int(Date asof) const override {
+				V value;
+				if (store_->value_on(slot_, asof, value)) {
+					return static_cast<int_t>(value);
+				} else {
+					throw std::runtime_error(boost::str(boost::format("HistoryColumnar: no value on %s") % boost::lexical_cast<std::string>(asof)));
+				}
+			}
+
+			double_t last_as_double() const override {
+				return static_cast<double_t>(last_value());
+			}
+
+			int_t last_as_int() const override {
+				return static_cast<int_t>(last_value());
+			}
+
+			double_t last_as_double(Date asof) const override {
+				return static_cast<double_t>(last_value(asof));
+			}
+
+			int_t last_as_int(Date asof) const override {
+				return static_cast<int_t>(last_value(asof));
+			}
+
+			void append(Date date, double_t value) override {
+				store_->append(slot_, date, value);
+			}
+
+			void append(Date date, int_t value) override {
+				store_->append(slot_, date, value);
+			}
+
+			void correct(double_t value) override {
+				store_->correct(slot_, value);
+			}
+
+			index_t size() const override {
+				return store_->size(slot_);
+			}
+
+			Date date(index_t idx) const override {
+				Date date;
+				V value;
+				event(idx, date, value);
+				return date;
+			}
+
+			double_t as_double(index_t idx) const override {
+				Date date;
+				V value;
+				event(idx, date, value);
+				return static_cast<double_t>(value);
+			}
+
+			int_t as_int(index_t idx) const override {
+				Date date;
+				V value;
+				event(idx, date, value);
+				return static_cast<int_t>(value);
+			}
+
+			index_t last_index(Date asof) const override {
+				const index_t n = store_->count(slot_, Date::MIN, asof);
+				if (n) {
+					return n - 1;
+				} else {
+					throw std::out_of_range("HistoryColumnar: date given before first date");
+				}
+			}
+
+			index_t first_index(Date asof) const override {
+				const index_t n = store_->count(slot_, asof, Date::MAX);
+				if (n) {
+					return size() - n;
+				} else {
+					throw std::out_of_range("HistoryColumnar: date given after last date");
+				}
+			}
+
+			void print(std::ostream& os) const override {
+				TimeSeries<Date, V> ts;
+				store_->events(slot_, ts);
+				os << name() << " | " << print_type_name<V>() << ": " << ts;
+			}
+
+			/** The copy uses the same store */
+			std::unique_ptr<History> clone() const override {
+				TimeSeries<Date, V> ts;
+				store_->events(slot_, ts);
+				std::unique_ptr<History> copy(new HistoryColumnar<V>(store_));
+				for (const auto& tv : ts) {
+					copy->append(tv.first, static_cast<double_t>(tv.second));
+				}
+				return copy;
+			}
+
+			HistoryData to_data() const override {
+				TimeSeries<Date, V> ts;
+				store_->events(slot_, ts);
+				HistoryData hd(std::string("columnar ") + print_type_name<V>(), name());
+				hd.reserve(ts.size());
+				for (const auto& tv : ts) {
+					hd.append(tv.first, tv.second);
+				}
+				return hd;
+			}
+
+			const std::string& name() const override {
+				return store_->name();
+			}
+		private:
+			static typename HistoryColumnStore<V>::Slot& acquire(const std::shared_ptr<HistoryColumnStore<V>>& store) {
+				if (!store) {
+					throw std::domain_error("HistoryColumnar: null store");
+				}
+				return store->acquire();
+			}
+
+			V last_value() const {
+				Date date;
+				V value;
+				if (store_->last(slot_, date, value)) {
+					return value;
+				} else {
+					throw std::logic_error("HistoryColumnar: history is empty");
+				}
+			}
+
+			V last_value(Date asof) const {
+				Date date;
+				V value;
+				if (store_->last(slot_, asof, date, value)) {
+					return value;
+				} else {
+					throw std::out_of_range(boost::str(boost::format("HistoryColumnar: no dates on or before %s") % boost::lexical_cast<std::string>(asof)));
+				}
+			}
+
+			void event(index_t idx, Date& date, V& value) const {
+				if (!store_->event(slot_, idx, date, value)) {
+					throw std::out_of_range(boost::str(boost::format("HistoryColumnar: index %d too large (size %d)") % idx % size()));
+				}
+			}
+
+			std::shared_ptr<HistoryColumnStore<V>> store_;
+			typename HistoryColumnStore<V>::Slot& slot_;
+		};
+    }
+}
+
+#endif // __AVERISERA_MS_HISTORY_COLUMNAR_H
@@ -0,0 +1,78 @@
+// (C) Averisera Ltd 2014-2020
+#include "history_copy_on_write.hpp"
+#include <functional>
+#include <stdexcept>
+
+namespace averisera {
+    namespace microsim {
+		HistoryCopyOnWrite::HistoryCopyOnWrite(std::shared_ptr<const History> prototype)
+			: prototype_(prototype) {
+			if (!prototype_) {
+				throw std::domain_error("HistoryCopyOnWrite: null prototype");
+			}
+		}
+
+		History& HistoryCopyOnWrite::write() {
+			if (!owned_) {
+				owned_ = prototype_->clone();
+				prototype_.reset();
+			}
+			return *owned_;
+		}
+
+		void HistoryCopyOnWrite::append(Date date, double_t value) {
+			write().append(date, value);
+		}
+
+		void HistoryCopyOnWrite::append(Date date, int_t value) {
+			write().append(date, value);
+		}
+
+		void HistoryCopyOnWrite::correct(double_t value) {
+			write().correct(value);
+		}
+
+		std::unique_ptr<History> HistoryCopyOnWrite::clone() const {
+			if (owned_) {
+				return owned_->clone();
+			} else {
+				return std::unique_ptr<History>(new HistoryCopyOnWrite(prototype_));
+			}
+		}
+
+		std::unique_ptr<History> HistoryCopyOnWrite::release_owned() {
+			if (!owned_) {
+				throw std::logic_error("HistoryCopyOnWrite: history still shared");
+			}
+			return std::move(owned_);
+		}
+
+		std::unique_ptr<History> HistoryCopyOnWriteCache::make_history(const size_t idx, const std::string& name, const HistoryFactory::factory_t factory, const HistoryData& data) {
+			if (!factory) {
+				throw std::domain_error("HistoryCopyOnWriteCache: null factory");
+			}
+			const auto data_id = data.data_id();
+			const key_t key(idx, factory, data_id.first, data_id.second);
+			// payloads are heap-allocated, so the low bits of their addresses carry little information
+			Shard& shard = shards_[(std::hash<const void*>()(data_id.first) >> 4) % NBR_SHARDS];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto it = shard.prototypes.find(key);
+			if (it == shard.prototypes.end()) {
+				std::unique_ptr<History> prototype(factory(name));
+				HistoryData copy(data);
+				HistoryFactory::append(*prototype, std::move(copy));
+				it = shard.prototypes.insert(std::make_pair(key, std::make_pair(data, std::shared_ptr<const History>(std::move(prototype))))).first;
+			}
+			return std::unique_ptr<History>(new HistoryCopyOnWrite(it->second.second));
+		}
+
+		size_t HistoryCopyOnWriteCache::size() const {
+			size_t n = 0;
+			for (Shard& shard : shards_) {
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				n += shard.prototypes.size();
+			}
+			return n;
+		}
+    }
+}
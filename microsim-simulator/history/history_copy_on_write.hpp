@@ -0,0 +1,170 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_HISTORY_COPY_ON_WRITE_H
+#define __AVERISERA_MS_HISTORY_COPY_ON_WRITE_H
+
+#include "../history.hpp"
+#include "../history_data.hpp"
+#include "../history_factory.hpp"
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace averisera {
+    namespace microsim {
+		/** @brief History which shares an immutable prototype with other histories until it is modified.
+
+		Reads are forwarded to the prototype. The first append or correction replaces the prototype with a private clone,
+		which an owning Actor then takes over with release_owned(), so that the wrapper does not outlive the sharing.
+		*/
+		class HistoryCopyOnWrite : public History {
+		public:
+			/** @param[in] prototype Shared history. Must not be modified while shared.
+			@throw std::domain_error If prototype is null */
+			HistoryCopyOnWrite(std::shared_ptr<const History> prototype);
+
+			HistoryCopyOnWrite(const HistoryCopyOnWrite&) = delete;
+			HistoryCopyOnWrite& operator=(const HistoryCopyOnWrite&) = delete;
+
+			/** Does this history still share its prototype */
+			bool is_shared() const {
+				return owned_ == nullptr;
+			}
+
+			bool empty() const override {
+				return read().empty();
+			}
+
+			Date last_date() const override {
+				return read().last_date();
+			}
+
+			Date last_date(Date asof) const override {
+				return read().last_date(asof);
+			}
+
+			Date first_date() const override {
+				return read().first_date();
+			}
+
+			double_t as_double(Date asof) const override {
+				return read().as_double(asof);
+			}
+
+			int_t as_int(Date asof) const override {
+				return read().as_int(asof);
+			}
+
+			double_t last_as_double() const override {
+				return read().last_as_double();
+			}
+
+			int_t last_as_int() const override {
+				return read().last_as_int();
+			}
+
+			double_t last_as_double(Date asof) const override {
+				return read().last_as_double(asof);
+			}
+
+			int_t last_as_int(Date asof) const override {
+				return read().last_as_int(asof);
+			}
+
+			index_t size() const override {
+				return read().size();
+			}
+
+			Date date(index_t idx) const override {
+				return read().date(idx);
+			}
+
+			double_t as_double(index_t idx) const override {
+				return read().as_double(idx);
+			}
+
+			int_t as_int(index_t idx) const override {
+				return read().as_int(idx);
+			}
+
+			index_t last_index(Date asof) const override {
+				return read().last_index(asof);
+			}
+
+			index_t first_index(Date asof) const override {
+				return read().first_index(asof);
+			}
+
+			void print(std::ostream& os) const override {
+				read().print(os);
+			}
+
+			HistoryData to_data() const override {
+				return read().to_data();
+			}
+
+			const std::string& name() const override {
+				return read().name();
+			}
+
+			void append(Date date, double_t value) override;
+
+			void append(Date date, int_t value) override;
+
+			void correct(double_t value) override;
+
+			/** Shares the prototype if this history has not been modified yet. */
+			std::unique_ptr<History> clone() const override;
+
+			/** Hand over the private clone made by the first modification. This object must not be used afterwards.
+			@throw std::logic_error If still shared */
+			std::unique_ptr<History> release_owned();
+		private:
+			const History& read() const {
+				return owned_ ? *owned_ : *prototype_;
+			}
+
+			History& write();
+
+			std::shared_ptr<const History> prototype_; /**< Null after the first modification */
+			std::unique_ptr<History> owned_;
+		};
+
+		/** @brief Creates HistoryCopyOnWrite instances sharing a prototype for identical HistoryData.
+
+		HistoryData copies share their payload until modified (e.g. copies of the same template PersonData made
+		when bootstrapping a population), so payload identity is used to find the prototype. Thread-safe.
+		*/
+		class HistoryCopyOnWriteCache {
+		public:
+			/** Return a history for the variable with given index, created with the factory and filled with data, sharing
+			the prototype with histories returned earlier for the same variable, factory and data payload.
+			@param[in] idx Variable index
+			@param[in] name Variable name
+			@param[in] factory Factory creating an empty history
+			@param[in] data Data to be appended to the new history
+			@throw std::domain_error If factory is null
+			*/
+			std::unique_ptr<History> make_history(size_t idx, const std::string& name, HistoryFactory::factory_t factory, const HistoryData& data);
+
+			/** Number of prototypes stored */
+			size_t size() const;
+		private:
+			typedef std::tuple<size_t, HistoryFactory::factory_t, const void*, const void*> key_t;
+
+			/** Part of the cache with its own lock, to reduce contention between threads */
+			struct Shard {
+				std::mutex mutex;
+				/** Keeps a copy of the data so that its payload address cannot be reused by other data while cached */
+				std::map<key_t, std::pair<HistoryData, std::shared_ptr<const History>>> prototypes;
+			};
+
+			static const size_t NBR_SHARDS = 64;
+
+			mutable std::array<Shard, NBR_SHARDS> shards_;
+		};
+    }
+}
+
+#endif // __AVERISERA_MS_HISTORY_COPY_ON_WRITE_H
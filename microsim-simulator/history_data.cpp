@@ -6,14 +6,16 @@
 #include "core/time_series.hpp"
 #include "core/stl_utils.hpp"
 #include <algorithm>
+#include <atomic>
 
 namespace averisera {
 	namespace microsim {
 		HistoryData::HistoryData(const std::string& factory_type, const std::string& name)
-			: factory_type_(factory_type),
+			: dates_(std::make_shared<std::vector<Date>>()),
+			factory_type_(factory_type),
 			name_(name) {
 			const auto value_type_name = HistoryFactory::from_string(factory_type).second;
-			values_ = ObjectVector(type_from_string(value_type_name));
+			values_ = std::make_shared<ObjectVector>(type_from_string(value_type_name));
 		}
 
 		HistoryData::HistoryData(HistoryData&& other) noexcept
@@ -54,34 +56,71 @@ namespace averisera {
 			name_.swap(other.name_);
 		}
 
+		std::vector<Date>& HistoryData::mutable_dates() {
+			if (!dates_) {
+				dates_ = std::make_shared<std::vector<Date>>();
+			} else if (dates_.use_count() > 1) {
+				dates_ = std::make_shared<std::vector<Date>>(*dates_);
+			} else {
+				// synchronise with the release of the last other copy
+				std::atomic_thread_fence(std::memory_order_acquire);
+			}
+			return *dates_;
+		}
+
+		ObjectVector& HistoryData::mutable_values() {
+			if (!values_) {
+				values_ = std::make_shared<ObjectVector>();
+			} else if (values_.use_count() > 1) {
+				values_ = std::make_shared<ObjectVector>(*values_);
+			} else {
+				std::atomic_thread_fence(std::memory_order_acquire);
+			}
+			return *values_;
+		}
+
+		const std::vector<Date>& HistoryData::empty_dates() {
+			static const std::vector<Date> empty;
+			return empty;
+		}
+
+		const ObjectVector& HistoryData::empty_values() {
+			static const ObjectVector empty;
+			return empty;
+		}
+
 		HistoryData::date_iterator HistoryData::find_by_date(Date date) {
-			date_iterator it = std::lower_bound(dates_.begin(), dates_.end(), date);
-			if (it != dates_.end() && *it == date) {
+			std::vector<Date>& dates = mutable_dates();
+			date_iterator it = std::lower_bound(dates.begin(), dates.end(), date);
+			if (it != dates.end() && *it == date) {
 				return it;
 			} else {
-				return dates_.end();
+				return dates.end();
 			}
 		}
 
 		HistoryData::const_date_iterator HistoryData::find_by_date(Date date) const {
-			const_date_iterator it = std::lower_bound(dates_.begin(), dates_.end(), date);
-			if (it != dates_.end() && *it == date) {
+			const std::vector<Date>& dates = this->dates();
+			const_date_iterator it = std::lower_bound(dates.begin(), dates.end(), date);
+			if (it != dates.end() && *it == date) {
 				return it;
 			} else {
-				return dates_.end();
+				return dates.end();
 			}
 		}
 
 		bool HistoryData::change_date_safely(const Date old_date, const Date new_date) {
+			const HistoryData& const_this = *this;
 			if (new_date == old_date) {
-				return find_by_date(old_date) != dates_.end();
+				return const_this.find_by_date(old_date) != dates().end();
 			}
-			const date_iterator old_it = find_by_date(old_date);
-			if (old_it == dates_.end()) {
+			if (const_this.find_by_date(old_date) == dates().end()) {
 				return false;
 			}
+			const std::vector<Date>& dates = mutable_dates();
+			const date_iterator old_it = find_by_date(old_date);
 			if (new_date < old_date) {
-				if (old_it > dates_.begin()) {
+				if (old_it > dates.begin()) {
 					const const_date_iterator prev_it = old_it - 1;
 					if (*prev_it < new_date) {
 						*old_it = new_date;
@@ -95,7 +134,7 @@ namespace averisera {
 				}
 			} else {
 				const const_date_iterator next_it = old_it + 1;
-				if (next_it < dates_.end()) {
+				if (next_it < dates.end()) {
 					if (*next_it > new_date) {
 						*old_it = new_date;
 						return true;
@@ -110,8 +149,8 @@ namespace averisera {
 		}
 
 		void HistoryData::clear() {
-			values_ = ObjectVector();
-			dates_ = std::vector<Date>();
+			values_ = std::make_shared<ObjectVector>();
+			dates_ = std::make_shared<std::vector<Date>>();
 			factory_type_ = "";
 			name_ = "";
 		}
@@ -119,9 +158,9 @@ namespace averisera {
 		template <class V> size_t HistoryData::append_impl(const std::string& str) {
 			const TimeSeries<Date, V> ts(TimeSeries<Date, V>::from_string(str));
 			for (const auto& date_value : ts) {
-                if (dates_.empty() || date_value.first > dates_.back()) {
-                    dates_.push_back(date_value.first);
-                    values_.push_back(date_value.second);
+                if (dates().empty() || date_value.first > dates().back()) {
+                    mutable_dates().push_back(date_value.first);
+                    mutable_values().push_back(date_value.second);
                 } else {
                     throw std::runtime_error("HistoryData: input dates out of order");
                 }
@@ -147,7 +186,7 @@ namespace averisera {
 		void HistoryData::shift_dates(const Period& delta) {
 			size_t max_cnt = 0;
 			size_t min_cnt = 0;
-			for (Date& dt : dates_) {
+			for (Date& dt : mutable_dates()) {
 				try {
 					dt = dt + delta;
 				} catch (std::out_of_range&) {
@@ -174,8 +213,8 @@ namespace averisera {
 
         std::ostream& operator<<(std::ostream& os, const HistoryData& data) {
 			os << "{NAME=" << data.name_ << "|";
-            os << "DATES=" << data.dates_ << "|";
-            os << "VALUES=" << data.values_ << "|";
+            os << "DATES=" << data.dates() << "|";
+            os << "VALUES=" << data.values() << "|";
             os << "FACTORY_TYPE=" << data.factory_type_ << "}";
             return os;
         }
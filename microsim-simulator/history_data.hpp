@@ -5,13 +5,18 @@
 #include <cassert>
 #include <cstdint>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace averisera {
 	struct Period;
 	namespace microsim {
 		/** Data to create History implementations from.
+
+		Copies share the dates and values (separately) until one of them is modified, so that e.g. bootstrapped copies
+		of a template record do not duplicate its history payload.
 		@see History */
 		class HistoryData {
 		public:
@@ -47,7 +52,7 @@ namespace averisera {
 
 			void swap(HistoryData& other) noexcept;
 
-			/** Return iterator to dates element with given date, or dates.end() if not found. */
+			/** Return iterator to dates element with given date, or dates.end() if not found. Stops sharing the dates with copies. */
 			date_iterator find_by_date(Date date);
 
 			/** Return iterator to dates element with given date, or dates.end() if not found. */
@@ -75,44 +80,54 @@ namespace averisera {
 
             /** Append value */
             template <class V> HistoryData& append(Date date, V value) {
-                dates_.push_back(date);
-                values_.push_back(value);
+                mutable_dates().push_back(date);
+                mutable_values().push_back(value);
 				return *this;
             }
             
             /** Number of (date, value) pairs */
             size_t size() const {
-                assert(dates_.size() == values_.size());
-                return dates_.size();
+                assert(dates().size() == values().size());
+                return dates().size();
             }
 
 			void reserve(size_t capacity) {
-				dates_.reserve(capacity);
-				values_.reserve(capacity);
+				mutable_dates().reserve(capacity);
+				mutable_values().reserve(capacity);
 			}
 
 			/** Resize to a new smaller size, or leave size intact if new_size > size() */
 			void truncate_to(size_t new_size) {
 				if (new_size < size()) {
-					dates_.resize(new_size);
-					values_.resize(new_size);
+					mutable_dates().resize(new_size);
+					mutable_values().resize(new_size);
 				}
 			}
 
 			const std::vector<Date>& dates() const {
-				return dates_;
+				return dates_ ? *dates_ : empty_dates();
 			}
 
 			const ObjectVector& values() const {
-				return values_;
+				return values_ ? *values_ : empty_values();
 			}
 
 			template <class V> HistoryData& set_value(size_t idx, V value) {
 				assert(idx < size());
-				values_.as<V>()[idx] = value;
+				mutable_values().as<V>()[idx] = value;
 				return *this;
 			}
 
+			/** Identifies the stored dates and values. Equal for copies which have not been modified since copying. */
+			std::pair<const void*, const void*> data_id() const {
+				return std::make_pair(static_cast<const void*>(dates_.get()), static_cast<const void*>(values_.get()));
+			}
+
+			/** Are the dates and values shared with another HistoryData */
+			bool is_data_shared() const {
+				return dates_.use_count() > 1 && values_.use_count() > 1;
+			}
+
 			/** Return HistoryFactory type */
 			const std::string& factory_type() const {
 				return factory_type_;
@@ -129,8 +144,18 @@ namespace averisera {
 
 			friend std::ostream& operator<<(std::ostream& os, const HistoryData& data);
 		private:
-			ObjectVector values_;
-			std::vector<Date> dates_;
+			/** Dates for modification, unshared if necessary */
+			std::vector<Date>& mutable_dates();
+
+			/** Values for modification, unshared if necessary */
+			ObjectVector& mutable_values();
+
+			static const std::vector<Date>& empty_dates();
+
+			static const ObjectVector& empty_values();
+
+			std::shared_ptr<ObjectVector> values_; /**< Null in a moved-from object */
+			std::shared_ptr<std::vector<Date>> dates_; /**< Null in a moved-from object */
 			std::string factory_type_; /** Type of HistoryFactory */
 			std::string name_; /** History name */
 
@@ -4,6 +4,7 @@
 #include "history.hpp"
 #include "history_data.hpp"
 #include "history_factory.hpp"
+#include "history/history_columnar.hpp"
 #include "history/history_sparse.hpp"
 #include "history/history_time_series.hpp"
 #include <stdexcept>
@@ -44,6 +45,17 @@ namespace averisera {
             return make_backed_by_time_series<uint8_t>(name);
         }*/
 
+        template <class T> static std::unique_ptr<History> make_columnar(const std::string& name) {
+            HistoryColumnStores* const stores = HistoryColumnStores::current();
+            // without a simulation, the history has a store of its own
+            std::shared_ptr<HistoryColumnStore<T>> store(stores ? stores->get<T>(name) : std::make_shared<HistoryColumnStore<T>>(name, std::vector<Date>()));
+            return std::unique_ptr<History>(new HistoryColumnar<T>(store));
+        }
+
+        template <class T> static std::unique_ptr<History> make_sparse_columnar(const std::string& name) {
+            return HistoryFactory::make_sparse(make_columnar<T>(name));
+        }
+
         template <class T> static std::unique_ptr<History> make_sparse_backed_by_time_series(const std::string& name) {
             return HistoryFactory::make_sparse(std::unique_ptr<History>(new HistoryTimeSeries<T>(name)));
         }
@@ -136,6 +148,70 @@ namespace averisera {
 			return make_backed_by_time_series<uint32_t>;
 		}
 
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<float>() {
+			return make_columnar<float>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<double>() {
+			return make_columnar<double>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int8_t>() {
+			return make_columnar<int8_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int16_t>() {
+			return make_columnar<int16_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int32_t>() {
+			return make_columnar<int32_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint8_t>() {
+			return make_columnar<uint8_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint16_t>() {
+			return make_columnar<uint16_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint32_t>() {
+			return make_columnar<uint32_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<float>() {
+			return make_sparse_columnar<float>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<double>() {
+			return make_sparse_columnar<double>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int8_t>() {
+			return make_sparse_columnar<int8_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int16_t>() {
+			return make_sparse_columnar<int16_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int32_t>() {
+			return make_sparse_columnar<int32_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint8_t>() {
+			return make_sparse_columnar<uint8_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint16_t>() {
+			return make_sparse_columnar<uint16_t>;
+		}
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint32_t>() {
+			return make_sparse_columnar<uint32_t>;
+		}
+
         static std::pair<HistoryFactory::factory_t, std::string> from_elements(std::vector<std::string>::const_iterator begin, std::vector<std::string>::const_iterator end) {
             if (begin == end) {
                 return std::make_pair(nullptr, "");
@@ -146,7 +222,31 @@ namespace averisera {
                 if (begin == end) {
                     return std::make_pair(nullptr, "");
                 }
-				if (*begin == print_type_name<double>()) {
+				if (*begin == "columnar") {
+					++begin;
+					if (begin == end) {
+						return std::make_pair(nullptr, "");
+					}
+					if (*begin == print_type_name<double>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<double>();
+					} else if (*begin == print_type_name<float>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<float>();
+					} else if (*begin == print_type_name<int32_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<int32_t>();
+					} else if (*begin == print_type_name<int16_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<int16_t>();
+					} else if (*begin == print_type_name<int8_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<int8_t>();
+					} else if (*begin == print_type_name<uint8_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<uint8_t>();
+					} else if (*begin == print_type_name<uint16_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<uint16_t>();
+					} else if (*begin == print_type_name<uint32_t>()) {
+						factory = HistoryFactory::SPARSE_COLUMNAR<uint32_t>();
+					} else {
+						throw std::runtime_error(boost::str(boost::format("HistoryFactory: unknown type \"%s\"") % (*begin)));
+					}
+				} else if (*begin == print_type_name<double>()) {
 					factory = HistoryFactory::SPARSE<double>();
 				} else if (*begin == print_type_name<float>()) {
 					factory = HistoryFactory::SPARSE<float>();
@@ -165,6 +265,30 @@ namespace averisera {
 				} else {
                     throw std::runtime_error(boost::str(boost::format("HistoryFactory: unknown type \"%s\"") % (*begin)));
                 }
+            } else if (*begin == "columnar") {
+                ++begin;
+                if (begin == end) {
+                    return std::make_pair(nullptr, "");
+                }
+				if (*begin == print_type_name<double>()) {
+					factory = HistoryFactory::COLUMNAR<double>();
+				} else if (*begin == print_type_name<float>()) {
+					factory = HistoryFactory::COLUMNAR<float>();
+				} else if (*begin == print_type_name<int32_t>()) {
+                    factory = HistoryFactory::COLUMNAR<int32_t>();
+				} else if (*begin == print_type_name<int16_t>()) {
+					factory = HistoryFactory::COLUMNAR<int16_t>();
+				} else if (*begin == print_type_name<int8_t>()) {
+                    factory = HistoryFactory::COLUMNAR<int8_t>();
+                } else if (*begin == print_type_name<uint8_t>()) {
+                    factory = HistoryFactory::COLUMNAR<uint8_t>();
+				} else if (*begin == print_type_name<uint16_t>()) {
+					factory = HistoryFactory::COLUMNAR<uint16_t>();
+				} else if (*begin == print_type_name<uint32_t>()) {
+					factory = HistoryFactory::COLUMNAR<uint32_t>();
+				} else {
+                    throw std::runtime_error(boost::str(boost::format("HistoryFactory: unknown type \"%s\"") % (*begin)));
+                }
             } else {
 				if (*begin == print_type_name<double>()) {
 					factory = HistoryFactory::DENSE<double>();
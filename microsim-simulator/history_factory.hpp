@@ -6,6 +6,7 @@
 
 #include <cstdint>
 #include <memory>
+#include "history/history_columnar.hpp"
 #include "history/history_sparse.hpp"
 #include "history/history_time_series.hpp"
 
@@ -36,6 +37,14 @@ namespace averisera {
             /** Return a factory building dense histories backed by TimeSeries */
             template <class T> static factory_t DENSE();
 
+            /** Return a factory building dense histories stored in a HistoryColumnStore shared by all histories with the same name,
+              taken from the HistoryColumnStores::Scope active in the calling thread (if there is none, each history gets a store of its own).
+              Use it for variables updated on schedule dates for most persons. */
+            template <class T> static factory_t COLUMNAR();
+
+            /** Return a factory building sparse histories backed by histories made by COLUMNAR() */
+            template <class T> static factory_t SPARSE_COLUMNAR();
+
             /** Append to given history data read from str. If the first character of the string is 'D', read the rest to TimeSeries<Date, History::double_t> and
               append each element. If the first character is 'I', read the rest to TimeSeries<Date, History::int_t> and append each element.
               If string is empty, do nothing.
@@ -94,6 +103,38 @@ namespace averisera {
 		template <> HistoryFactory::factory_t HistoryFactory::DENSE<uint16_t>();
 
 		template <> HistoryFactory::factory_t HistoryFactory::DENSE<uint32_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<float>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<double>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int8_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int16_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<int32_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint8_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint16_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::COLUMNAR<uint32_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<float>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<double>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int8_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int16_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<int32_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint8_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint16_t>();
+
+		template <> HistoryFactory::factory_t HistoryFactory::SPARSE_COLUMNAR<uint32_t>();
 	}
 }
 
@@ -78,6 +78,11 @@ namespace averisera {
              */
             std::vector<std::unique_ptr<History>> make_histories(const T& obj) const;
 
+			/** Factories used by make_histories(const T&) for this object, with null factories for variables whose dispatchers do not select it.
+			@param obj Object which needs the histories.
+			*/
+			std::vector<factory_t> make_factories(const T& obj) const;
+
             /** Create a vector of empty histories using common factories (registered without a dispatcher) only.
             If some variable does not have a common factory, we will make a null history for it.            
 
@@ -95,18 +100,31 @@ namespace averisera {
         }
         
         template <class T> std::vector<std::unique_ptr<History>> HistoryFactoryRegistry<T>::make_histories(const T& obj) const {
+            const std::vector<factory_t> factories(make_factories(obj));
             std::vector<std::unique_ptr<History>> hv;
-            hv.reserve(variable_history_factory_dispatchers_.size());
+            hv.reserve(factories.size());
+            for (size_t i = 0; i < factories.size(); ++i) {
+                if (factories[i]) {
+                    hv.push_back(factories[i](variable_history_factory_dispatchers_[i].first));
+                } else {
+                    hv.push_back(nullptr);
+                }
+            }
+            return std::move(hv);
+        }
+
+        template <class T> std::vector<typename HistoryFactoryRegistry<T>::factory_t> HistoryFactoryRegistry<T>::make_factories(const T& obj) const {
+            std::vector<factory_t> factories;
+            factories.reserve(variable_history_factory_dispatchers_.size());
             for (const auto& name_dispatcher_ptr_pair: variable_history_factory_dispatchers_) {
 				const auto dispatcher_ptr = name_dispatcher_ptr_pair.second;
                 if (dispatcher_ptr->predicate()->select_out_of_context(obj)) {
-                    const auto factory = dispatcher_ptr->dispatch_out_of_context(obj);
-                    hv.push_back(factory(name_dispatcher_ptr_pair.first));
+                    factories.push_back(dispatcher_ptr->dispatch_out_of_context(obj));
                 } else {
-                    hv.push_back(nullptr);
+                    factories.push_back(nullptr);
                 }
             }
-            return std::move(hv);
+            return factories;
         }
 
         template <class T> std::vector<std::unique_ptr<History>> HistoryFactoryRegistry<T>::make_histories() const {
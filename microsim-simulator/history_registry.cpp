@@ -2,16 +2,36 @@
 * (C) Averisera Ltd 2015
 */
 #include "history_registry.hpp"
+#include <atomic>
 #include <boost/format.hpp>
 
 namespace averisera {
 	namespace microsim {
+        HistoryRegistry::HistoryRegistry()
+            : id_(next_id()) {
+        }
+
         HistoryRegistry::~HistoryRegistry() {
         }
 
+        HistoryRegistry::HistoryRegistry(const HistoryRegistry& other)
+            : _variables_by_name(other._variables_by_name),
+              _variable_names(other._variable_names),
+              id_(next_id()) {
+        }
+
         HistoryRegistry::HistoryRegistry(HistoryRegistry&& other) noexcept
             : _variables_by_name(std::move(other._variables_by_name)),
-              _variable_names(std::move(other._variable_names)) {
+              _variable_names(std::move(other._variable_names)),
+              id_(other.id_) {
+            other._variables_by_name.clear();
+            other._variable_names.clear();
+            other.id_ = next_id();
+        }
+
+        uint32_t HistoryRegistry::next_id() {
+            static std::atomic<uint32_t> counter(0);
+            return ++counter;
         }
         
 		HistoryRegistry::index_t HistoryRegistry::register_variable(const std::string& name) {
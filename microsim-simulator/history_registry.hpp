@@ -5,6 +5,7 @@
 #define __AVERISERA_MS_HISTORY_REGISTRY_H
 
 #include <cassert>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 #include <vector>
@@ -12,15 +13,25 @@
 namespace averisera {
 	namespace microsim {
 		/** Registers History names for an Actor implementation. 
+
+		Variables are never unregistered, so the index of a registered variable does not change. Every registry object has a unique ID, 
+		which lets VariableHandle cache the indices.
          */
 		class HistoryRegistry {
 		public:
             typedef size_t index_t;
             
-            HistoryRegistry() = default;
+            HistoryRegistry();
             virtual ~HistoryRegistry();
-            HistoryRegistry(const HistoryRegistry&) = default;
+            /** Copy gets a new ID */
+            HistoryRegistry(const HistoryRegistry& other);
+            /** Moved-from object gets a new ID */
             HistoryRegistry(HistoryRegistry&& other) noexcept;
+
+			/** Unique ID of this registry (positive) */
+			uint32_t id() const {
+				return id_;
+			}
             
 			/** Register a new variable
 			@param[in] name Variable name
@@ -65,8 +76,11 @@ namespace averisera {
                 return _variable_names;
             }
 		private:
+			static uint32_t next_id();
+
 			std::unordered_map<std::string, index_t> _variables_by_name;
 			std::vector<std::string> _variable_names;
+			uint32_t id_;
 		};
 	}
 }
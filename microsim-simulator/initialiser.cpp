@@ -1,9 +1,14 @@
 // (C) Averisera Ltd 2014-2020
 #include "initialiser.hpp"
+#include "population_data.hpp"
 
 namespace averisera {
     namespace microsim {
         Initialiser::~Initialiser() {
         }
+
+		PopulationData Initialiser::initialise_parallel(pop_size_t total_size, const Contexts& ctx, ThreadPool&) const {
+			return initialise(total_size, ctx);
+		}
     }
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <cstdlib>
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
         struct ActorData;
         class Contexts;
@@ -24,6 +26,12 @@ namespace averisera {
               @throw std::logic_error If initialiser procedure malfunctions due to programmer error.
              */
             virtual PopulationData initialise(pop_size_t total_size, const Contexts& ctx) const = 0;                   
+
+			/** Initialise a population using the pool threads. The result must not depend on the number of threads, but can differ from
+			the result of initialise(). Default implementation calls initialise(total_size, ctx).
+			@see initialise(pop_size_t, const Contexts&)
+			*/
+			virtual PopulationData initialise_parallel(pop_size_t total_size, const Contexts& ctx, ThreadPool& pool) const;
         };
     }
 }
@@ -1,8 +1,11 @@
 // (C) Averisera Ltd 2014-2020
 #pragma once
+#include <cstddef>
 #include <vector>
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
 		class Contexts;
 
@@ -15,6 +18,13 @@ namespace averisera {
             /** Apply perturbation.
             */
             virtual void apply(std::vector<AD>& datas, const Contexts& ctx) const = 0;
+
+			/** Apply perturbation using the pool threads, drawing random numbers from streams for the stage_idx-th initialisation stage
+			(see InitialisationChunks). Default implementation calls apply(datas, ctx).
+			*/
+			virtual void apply_parallel(std::vector<AD>& datas, const Contexts& ctx, ThreadPool& /*pool*/, size_t /*stage_idx*/) const {
+				apply(datas, ctx);
+			}
         };
     }
 }
@@ -1,6 +1,7 @@
 // (C) Averisera Ltd 2014-2020
 #pragma once
 #include "data_perturbation.hpp"
+#include "initialisation_chunks.hpp"
 
 namespace averisera {
 	namespace microsim {
@@ -12,6 +13,12 @@ namespace averisera {
 					apply(data, ctx);
 				}
 			}
+
+			void apply_parallel(std::vector<AD>& datas, const Contexts& ctx, ThreadPool& pool, size_t stage_idx) const override {
+				InitialisationChunks::for_each(datas.size(), ctx, pool, stage_idx, [this, &datas, &ctx](size_t i) {
+					apply(datas[i], ctx);
+				});
+			}
 		private:
 			virtual void apply(AD& data, const Contexts& ctx) const = 0;
 		};
@@ -0,0 +1,42 @@
+// (C) Averisera Ltd 2014-2020
+#pragma once
+#include "../contexts.hpp"
+#include "../mutable_context.hpp"
+#include "core/rng_philox.hpp"
+#include "core/thread_pool.hpp"
+#include <algorithm>
+
+namespace averisera {
+	namespace microsim {
+		/** @brief Processes data objects created during population initialisation in parallel, in chunks of fixed size.
+
+		While a chunk is processed, MutableContext::rng() returns a stream which depends only on the stage and chunk index
+		(see MutableContext::make_initialisation_stream()), so the results do not depend on the number of threads.
+		*/
+		class InitialisationChunks {
+		public:
+			/** Number of data objects in a chunk */
+			static const size_t CHUNK_SIZE = 1024;
+
+			static size_t nbr_chunks(size_t n) {
+				return (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+			}
+
+			/** Call f(i) for i in [0, n), using the pool threads.
+			@param stage_idx Index of the initialisation stage, selecting the random streams
+			*/
+			template <class F> static void for_each(size_t n, const Contexts& ctx, ThreadPool& pool, size_t stage_idx, F f) {
+				MutableContext& mctx = ctx.mutable_ctx();
+				pool.for_each_index(nbr_chunks(n), [n, &mctx, stage_idx, &f](size_t chunk_idx) {
+					RNGPhilox rng(mctx.make_initialisation_stream(stage_idx, chunk_idx));
+					const MutableContext::RNGOverride rng_override(mctx, rng);
+					const size_t begin = chunk_idx * CHUNK_SIZE;
+					const size_t end = std::min(n, begin + CHUNK_SIZE);
+					for (size_t i = begin; i < end; ++i) {
+						f(i);
+					}
+				});
+			}
+		};
+	}
+}
@@ -3,6 +3,7 @@
 #include "initialiser_bootstrapping.hpp"
 #include "../mutable_context.hpp"
 #include "../population_data.hpp"
+#include "core/log.hpp"
 #include "core/rng.hpp"
 #include <algorithm>
 #include <cassert>
@@ -24,6 +25,30 @@ namespace averisera {
 
         PopulationData InitialiserBootstrapping::initialise(const pop_size_t total_size, const Contexts& ctx) const {
             PopulationData population;
+			sample_all(population.persons, total_size, ctx);
+            for (const std::unique_ptr<const DataPerturbation<PersonData>>& pptr : _person_perturbations) {
+				pptr->apply(population.persons, ctx);
+            }
+            return population;
+        }
+
+		PopulationData InitialiserBootstrapping::initialise_parallel(const pop_size_t total_size, const Contexts& ctx, ThreadPool& pool) const {
+			PopulationData population;
+			if (!sample_parallel(population.persons, total_size, ctx, pool)) {
+				LOG_DEBUG() << "InitialiserBootstrapping: sampling serially";
+				population.persons.clear();
+				sample_all(population.persons, total_size, ctx);
+			}
+			assert(population.persons.size() == total_size);
+			size_t stage_idx = 1; // stage 0 is sampling
+			for (const std::unique_ptr<const DataPerturbation<PersonData>>& pptr : _person_perturbations) {
+				pptr->apply_parallel(population.persons, ctx, pool, stage_idx);
+				++stage_idx;
+			}
+			return population;
+		}
+
+		void InitialiserBootstrapping::sample_all(std::vector<PersonData>& persons, const pop_size_t total_size, const Contexts& ctx) const {
             std::vector<PersonData> added_persons;
             added_persons.reserve(1);
             pop_size_t remaining_size = total_size;
@@ -33,15 +58,11 @@ namespace averisera {
                 assert(remaining_size >= added_persons.size());
                 assert(added_persons.size() > 0);
                 for (PersonData& p : added_persons) {
-                    population.persons.push_back(std::move(p));
+                    persons.push_back(std::move(p));
                 }
                 remaining_size -= added_persons.size();
             }
-            for (const std::unique_ptr<const DataPerturbation<PersonData>>& pptr : _person_perturbations) {
-				pptr->apply(population.persons, ctx);
-            }
-            return population;
-        }
+		}
 
         void InitialiserBootstrapping::add_copy(std::vector<PersonData>& added_persons, const PersonData& person, const Contexts& ctx) {
             PersonData copy(person.clone_without_links(ctx.mutable_ctx().gen_id()));
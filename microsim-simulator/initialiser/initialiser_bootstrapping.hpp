@@ -29,6 +29,11 @@ namespace averisera {
 
 				/** Find index of person with given ID or throw std::out_of_range if no such ID in sample */
 				virtual size_t find_by_id(Actor::id_t id) const = 0;
+
+				/** Can sample_person() be called concurrently from several threads */
+				virtual bool is_thread_safe() const {
+					return false;
+				}
 			};
 
             /**
@@ -44,6 +49,10 @@ namespace averisera {
 
             PopulationData initialise(pop_size_t total_size, const Contexts& ctx) const override;
 
+			/** Samples in parallel if the derived class supports it (see sample_parallel()), otherwise serially, and applies
+			the perturbations in parallel where possible. */
+			PopulationData initialise_parallel(pop_size_t total_size, const Contexts& ctx, ThreadPool& pool) const override;
+
 			class PersonDataSamplerFromData: public PersonDataSampler {
 			public:
 				PersonDataSamplerFromData(std::vector<PersonData>&& sample);
@@ -58,6 +67,10 @@ namespace averisera {
 				}
 
 				size_t find_by_id(Actor::id_t id) const override;
+
+				bool is_thread_safe() const override {
+					return true;
+				}
 			private:
 				std::vector<PersonData> sample_persons_;
 			};
@@ -95,6 +108,10 @@ namespace averisera {
 				return person_data_sampler_->find_by_id(id);
 			}
 
+			bool is_sampler_thread_safe() const {
+				return person_data_sampler_->is_thread_safe();
+			}
+
             /** Add copy of person at the back of added_persons. Break all mother/child links. */
             static void add_copy(std::vector<PersonData>& added_persons, const PersonData& person, const Contexts& ctx);
         private:
@@ -103,6 +120,15 @@ namespace averisera {
 
             // Clear added_persons and sample at most remaining_size persons into it.
             virtual void sample(std::vector<PersonData>& added_persons, pop_size_t remaining_size, const Contexts& ctx) const = 0;			
+
+			/** Sample exactly total_size persons into empty added_persons using the pool threads, with random streams for
+			initialisation stage 0 (see InitialisationChunks). Return false if not supported; default implementation does nothing. */
+			virtual bool sample_parallel(std::vector<PersonData>& /*added_persons*/, pop_size_t /*total_size*/, const Contexts& /*ctx*/, ThreadPool& /*pool*/) const {
+				return false;
+			}
+
+			/** Sample total_size persons serially with sample() */
+			void sample_all(std::vector<PersonData>& persons, pop_size_t total_size, const Contexts& ctx) const;
         };
     }
 }
@@ -1,5 +1,6 @@
 // (C) Averisera Ltd 2014-2020
 #include "../contexts.hpp"
+#include "initialisation_chunks.hpp"
 #include "initialiser_bootstrapping_unlinked.hpp"
 #include "../mutable_context.hpp"
 #include "../person.hpp"
@@ -20,5 +21,20 @@ namespace averisera {
             const PersonData& sampled = sample_person(idx);
             add_copy(added_persons, sampled, ctx);
         }
+
+		bool InitialiserBootstrappingUnlinked::sample_parallel(std::vector<PersonData>& added_persons, const pop_size_t total_size, const Contexts& ctx, ThreadPool& pool) const {
+			check_that(added_persons.empty());
+			if (!is_sampler_thread_safe() || !total_size) {
+				return false;
+			}
+			added_persons.resize(total_size);
+			const Actor::id_t first_id = ctx.mutable_ctx().gen_ids(total_size);
+			InitialisationChunks::for_each(total_size, ctx, pool, 0, [this, &added_persons, &ctx, first_id](size_t i) {
+				const size_t idx = static_cast<size_t>(ctx.mutable_ctx().rng().next_uniform(sample_size() - 1));
+				assert(idx < sample_size());
+				added_persons[i] = sample_person(idx).clone_without_links(first_id + i);
+			});
+			return true;
+		}
     }
 }
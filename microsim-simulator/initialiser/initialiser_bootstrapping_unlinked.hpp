@@ -13,6 +13,9 @@ namespace averisera {
 				: InitialiserBootstrappingUnlinked(std::move(person_data_sampler), std::vector<std::unique_ptr<const DataPerturbation<PersonData>>>()) {}
         private:
             void sample(std::vector<PersonData>& added_persons, pop_size_t remaining_size, const Contexts& ctx) const override;
+
+			/** Supported if the sampler is thread-safe. IDs of sampled persons are reserved in advance with MutableContext::gen_ids(). */
+			bool sample_parallel(std::vector<PersonData>& added_persons, pop_size_t total_size, const Contexts& ctx, ThreadPool& pool) const override;
         };
     }
 }
@@ -1,4 +1,5 @@
 // (C) Averisera Ltd 2014-2020
+#include "initialisation_chunks.hpp"
 #include "perturb_date_of_birth.hpp"
 #include "../person_data.hpp"
 #include "core/dates.hpp"
@@ -27,44 +28,54 @@ namespace averisera {
         
         void PerturbDateOfBirth::apply(std::vector<PersonData>& datas, const Contexts& ctx) const {
             for (PersonData& data : datas) {
-                if (_avoid_linked && data.mother_id != Actor::INVALID_ID) {
-                    continue;
-                }
-                
-                Date new_date_of_birth = perturb_date_of_birth(data.date_of_birth, ctx);
-                const Period delta(PeriodType::DAYS, MathUtils::safe_cast<int>((new_date_of_birth - data.date_of_birth).days()));
-                if (!_shift_history_dates) {
-                    // try to fit in the new birth date
-                    new_date_of_birth = std::min(new_date_of_birth, first_history_date(data));
-                } else {
-                    shift_all_dates(data, delta);
-                }
-                if (!data.conception_date.is_not_a_date()) {                    
-                    Date new_conception_date;
-                    try {
-                        new_conception_date = data.conception_date + delta;
-                    } catch (std::out_of_range&) {
-                        // overflow detected... unlikely!
-                        if (delta.size > 0) {
-                            new_conception_date = Date::MAX;
-                        } else {
-                            new_conception_date = Date::MIN;
-                        }
-                    }
-                    assert(!new_conception_date.is_not_a_date());
-                    data.conception_date = new_conception_date;
-                }
-                if (data.mother_id != Actor::INVALID_ID) {
-                    assert(!_avoid_linked);
-                    const auto mother_it = ActorData::find_by_id(datas, data.mother_id);
-                    if (mother_it != datas.end()) {
-                        throw std::runtime_error("PerturbDateOfBirth: changing pregnancy history not implemented");
+				apply(data, datas, ctx);
+			}
+		}
+
+		void PerturbDateOfBirth::apply_parallel(std::vector<PersonData>& datas, const Contexts& ctx, ThreadPool& pool, size_t stage_idx) const {
+			InitialisationChunks::for_each(datas.size(), ctx, pool, stage_idx, [this, &datas, &ctx](size_t i) {
+				apply(datas[i], datas, ctx);
+			});
+		}
+
+		void PerturbDateOfBirth::apply(PersonData& data, const std::vector<PersonData>& datas, const Contexts& ctx) const {
+            if (_avoid_linked && data.mother_id != Actor::INVALID_ID) {
+                return;
+            }
+            
+            Date new_date_of_birth = perturb_date_of_birth(data.date_of_birth, ctx);
+            const Period delta(PeriodType::DAYS, MathUtils::safe_cast<int>((new_date_of_birth - data.date_of_birth).days()));
+            if (!_shift_history_dates) {
+                // try to fit in the new birth date
+                new_date_of_birth = std::min(new_date_of_birth, first_history_date(data));
+            } else {
+                shift_all_dates(data, delta);
+            }
+            if (!data.conception_date.is_not_a_date()) {                    
+                Date new_conception_date;
+                try {
+                    new_conception_date = data.conception_date + delta;
+                } catch (std::out_of_range&) {
+                    // overflow detected... unlikely!
+                    if (delta.size > 0) {
+                        new_conception_date = Date::MAX;
                     } else {
-                        throw std::domain_error("PerturbDateOfBirth: no mother with this ID");
+                        new_conception_date = Date::MIN;
                     }
                 }
-                data.date_of_birth = new_date_of_birth;
+                assert(!new_conception_date.is_not_a_date());
+                data.conception_date = new_conception_date;
+            }
+            if (data.mother_id != Actor::INVALID_ID) {
+                assert(!_avoid_linked);
+                const auto mother_it = ActorData::find_by_id(datas, data.mother_id);
+                if (mother_it != datas.end()) {
+                    throw std::runtime_error("PerturbDateOfBirth: changing pregnancy history not implemented");
+                } else {
+                    throw std::domain_error("PerturbDateOfBirth: no mother with this ID");
+                }
             }
-        }        
+            data.date_of_birth = new_date_of_birth;
+        }
 	}
 }
@@ -16,9 +16,14 @@ namespace averisera {
                 : _shift_history_dates(shift_history_dates), _avoid_linked(true) {}
             
             void apply(std::vector<PersonData>& datas, const Contexts& ctx) const override;
+
+			void apply_parallel(std::vector<PersonData>& datas, const Contexts& ctx, ThreadPool& pool, size_t stage_idx) const override;
 		private:
 			virtual Date perturb_date_of_birth(Date date_of_birth, const Contexts& ctx) const = 0;
 
+			/** Perturb a single element of datas */
+			void apply(PersonData& data, const std::vector<PersonData>& datas, const Contexts& ctx) const;
+
             bool _shift_history_dates;
             bool _avoid_linked; /**< If true, do not perturb birth dates of persons linked to their parents */
 		};
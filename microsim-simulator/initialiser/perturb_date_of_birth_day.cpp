@@ -12,7 +12,8 @@ namespace averisera {
 		Date PerturbDateOfBirthDay::perturb_date_of_birth(Date date_of_birth, const Contexts& ctx) const {
 			const Date d1(date_of_birth.year(), date_of_birth.month(), 1);
 			const Date d2(date_of_birth.end_of_month());
-			const auto new_day_of_month = static_cast<unsigned short>(ctx.mutable_ctx().rng().next_uniform(static_cast<uint32_t>((d2 - d1).days())));
+			// next_uniform(n) draws from [0, n]
+			const auto new_day_of_month = static_cast<unsigned short>(1 + ctx.mutable_ctx().rng().next_uniform(static_cast<uint32_t>((d2 - d1).days())));
 			return Date(date_of_birth.year(), date_of_birth.month(), new_day_of_month);
 		}
 	}
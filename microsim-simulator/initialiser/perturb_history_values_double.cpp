@@ -24,13 +24,12 @@ namespace averisera {
                 HistoryData& hd = data.histories[_variable_name];
                 if (hd.values().type() == HistoryData::type_t::DOUBLE) {
                     assert(hd.values().size() == hd.dates().size());
-                    size_t idx = 0;
-                    for (const double& v : hd.values().as<double>()) {
-                        double new_v = perturb(hd.dates()[idx], v, ctx);
+                    // set_value() may reallocate values shared with other copies, so do not hold references to them
+                    for (size_t idx = 0; idx < hd.size(); ++idx) {
+                        double new_v = perturb(hd.dates()[idx], hd.values().as<double>()[idx], ctx);
                         new_v = std::min(new_v, _upper_bound);
                         new_v = std::max(new_v, _lower_bound);
 						hd.set_value(idx, new_v);
-                        ++idx;
                     }
                 } else {
                     throw std::domain_error("PerturbHistoryValuesDouble: history type is not double");
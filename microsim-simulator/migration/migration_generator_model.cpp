@@ -5,6 +5,7 @@
 #include "../person.hpp"
 #include "../population.hpp"
 #include "../population_data.hpp"
+#include "../population_index.hpp"
 #include "../predicate.hpp"
 #include "core/bootstrap.hpp"
 #include "core/log.hpp"
@@ -46,6 +47,8 @@ namespace averisera {
 			const Date asof = sp.begin;
 			//const double dt = MigrationModel::calc_dt(sp.begin, sp.end);
 			const std::vector<std::shared_ptr<Person>> live_persons(population.live_persons(asof));
+			PopulationIndex live_index;
+			live_index.rebuild(live_persons);
 			for (const pred_model_pair& mp : models_) {
 				selected.clear();
 				const Predicate<Person>& pred = *mp.first;
@@ -54,12 +57,7 @@ namespace averisera {
 					continue;
 				}
 				if (pred.selects_alive_only()) {
-					for (const std::shared_ptr<Person>& person_ptr : live_persons) {
-						assert(person_ptr);
-						if (pred.select_alive(*person_ptr, ctx)) {
-							selected.push_back(person_ptr);
-						}
-					}
+					live_index.select_alive(pred, live_persons, ctx, selected);
 				} else {
 					for (const std::shared_ptr<Person>& person_ptr : population.persons()) {
 						assert(person_ptr);
@@ -4,26 +4,71 @@
 #include "immutable_context.hpp"
 #include "person.hpp"
 #include "mutable_context.hpp"
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include "core/log.hpp"
 #include "core/rng_impl.hpp"
 
 namespace averisera {
     namespace microsim {
 		const std::string EMIGRANT_POPULATION_NAME("EMIGRANTS");
 
+		thread_local const MutableContext* MutableContext::tl_override_ctx_ = nullptr;
+		thread_local RNG* MutableContext::tl_override_rng_ = nullptr;
+		thread_local const MutableContext* MutableContext::tl_auxiliary_ctx_ = nullptr;
+		const Actor::id_t MutableContext::AUXILIARY_MIN_ID;
+
         MutableContext::MutableContext(long seed)
-            : _rng(new RNGImpl(seed)), date_idx_(0), _max_id(0), emigrant_population_(EMIGRANT_POPULATION_NAME) {
+            : _rng(new RNGImpl(seed)), stream_seed_(static_cast<uint64_t>(seed)), date_idx_(0), _max_id(0), emigrant_population_(EMIGRANT_POPULATION_NAME),
+			person_pool_(std::make_shared<MemoryPool>()), history_column_stores_(std::make_shared<HistoryColumnStores>()), auxiliary_max_id_(AUXILIARY_MIN_ID - 1) {
         }
 
-        MutableContext::MutableContext(std::unique_ptr<RNG>&& rngimpl)
-            : _rng(std::move(rngimpl)), date_idx_(0), _max_id(0), emigrant_population_(EMIGRANT_POPULATION_NAME) {
+        MutableContext::MutableContext(std::unique_ptr<RNG>&& rngimpl, long stream_seed)
+            : _rng(std::move(rngimpl)), stream_seed_(static_cast<uint64_t>(stream_seed)), date_idx_(0), _max_id(0), emigrant_population_(EMIGRANT_POPULATION_NAME),
+			person_pool_(std::make_shared<MemoryPool>()), history_column_stores_(std::make_shared<HistoryColumnStores>()), auxiliary_max_id_(AUXILIARY_MIN_ID - 1) {
             if (!_rng) {
                 throw std::domain_error("MutableContext: null RNG");
             }
         }
 
+		RNGPhilox MutableContext::make_stream(Actor::id_t id, size_t stream_idx) const {
+			return RNGPhilox(RNGPhilox::make_key(stream_seed_, date_idx_, stream_idx), id);
+		}
+
+		RNGPhilox MutableContext::make_initialisation_stream(size_t stage_idx, size_t chunk_idx) const {
+			// schedule date indices never reach the maximum value
+			return RNGPhilox(RNGPhilox::make_key(stream_seed_, std::numeric_limits<uint64_t>::max(), stage_idx), chunk_idx);
+		}
+
+		MutableContext::RNGOverride::RNGOverride(const MutableContext& ctx, RNG& rng)
+			: prev_ctx_(tl_override_ctx_), prev_rng_(tl_override_rng_) {
+			tl_override_ctx_ = &ctx;
+			tl_override_rng_ = &rng;
+		}
+
+		MutableContext::RNGOverride::~RNGOverride() {
+			tl_override_ctx_ = prev_ctx_;
+			tl_override_rng_ = prev_rng_;
+		}
+
+		MutableContext::AuxiliaryThread::AuxiliaryThread(MutableContext& ctx, RNG& rng)
+			: rng_override_(ctx, rng), prev_ctx_(tl_auxiliary_ctx_) {
+			tl_auxiliary_ctx_ = &ctx;
+		}
+
+		MutableContext::AuxiliaryThread::~AuxiliaryThread() {
+			tl_auxiliary_ctx_ = prev_ctx_;
+		}
+
         Actor::id_t MutableContext::gen_id() {
+			if (is_auxiliary_thread()) {
+				if (auxiliary_max_id_ == std::numeric_limits<Actor::id_t>::max()) {
+					throw std::runtime_error("MutableContext: ran out of auxiliary IDs");
+				}
+				++auxiliary_max_id_;
+				return auxiliary_max_id_;
+			}
             if (_max_id == std::numeric_limits<Actor::id_t>::max()) {
                 throw std::runtime_error("MutableContext: ran out of IDs");
             }
@@ -31,6 +76,18 @@ namespace averisera {
             return _max_id;
         }
 
+		Actor::id_t MutableContext::gen_ids(const size_t n) {
+			if (!n) {
+				throw std::domain_error("MutableContext: requested zero IDs");
+			}
+			if (n > std::numeric_limits<Actor::id_t>::max() - _max_id) {
+				throw std::runtime_error("MutableContext: ran out of IDs");
+			}
+			const Actor::id_t first_id = _max_id + 1;
+			_max_id += static_cast<Actor::id_t>(n);
+			return first_id;
+		}
+
 		void MutableContext::increase_id(Actor::id_t new_max_id) {
 			if (new_max_id < get_max_id()) {
 				throw std::domain_error("MutableContext: attempt to modify maximum ID to lower value");
@@ -39,17 +96,19 @@ namespace averisera {
 		}
 
 		void MutableContext::add_newborns(const std::vector<std::shared_ptr<Person>>& babies) {
-			_newborns.reserve(_newborns.size() + babies.size());
+			std::vector<std::shared_ptr<Person>>& cache = newborns();
+			cache.reserve(cache.size() + babies.size());
 			for (const auto& p : babies) {
 				check_not_null(p, "MutableContext::add_newborns: null pointer");
-				_newborns.push_back(p);
+				cache.push_back(p);
 			}
-			Population::sort_persons(_newborns);
+			Population::sort_persons(cache);
 		}
 
 		void MutableContext::wipe_out_newborns() {
-			_newborns.clear();
-			_newborns.shrink_to_fit();
+			std::vector<std::shared_ptr<Person>>& cache = newborns();
+			cache.clear();
+			cache.shrink_to_fit();
 		}
 
 		void MutableContext::add_emigrants(const std::vector<std::shared_ptr<Person>>& emigrants, Date emigration_date) {
@@ -80,6 +139,22 @@ namespace averisera {
 			Population::sort_persons(immigrants_);
 		}
 
+		void MutableContext::remove_dead_migrants(const Date cutoff) {
+			const auto died_before_cutoff = [cutoff](const std::shared_ptr<Person>& p) {
+				const Date dod = p->date_of_death();
+				return !dod.is_not_a_date() && dod < cutoff;
+			};
+			size_t nbr_removed = immigrants_.size();
+			immigrants_.erase(std::remove_if(immigrants_.begin(), immigrants_.end(), died_before_cutoff), immigrants_.end());
+			nbr_removed -= immigrants_.size();
+			for (auto& kv : emigrants_) {
+				const size_t old_size = kv.second.size();
+				kv.second.erase(std::remove_if(kv.second.begin(), kv.second.end(), died_before_cutoff), kv.second.end());
+				nbr_removed += old_size - kv.second.size();
+			}
+			LOG_DEBUG() << "MutableContext: removed " << nbr_removed << " migrants who died before " << cutoff;
+		}
+
 		Date MutableContext::asof(const ImmutableContext& imm_ctx) const {
 			return imm_ctx.schedule().date(date_idx_);
 		}
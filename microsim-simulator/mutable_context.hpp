@@ -10,8 +10,11 @@
 #include <unordered_map>
 #include <vector>
 #include "core/dates_fwd.hpp"
+#include "core/memory_pool.hpp"
 #include "core/preconditions.hpp"
 #include "core/rng.hpp"
+#include "core/rng_philox.hpp"
+#include "history/history_columnar.hpp"
 #include "population.hpp"
 
 namespace averisera {
@@ -30,16 +33,66 @@ namespace averisera {
             MutableContext(long seed = 42);
 
             /** Takes ownership of this implementation of RNG.
+              @param stream_seed Seed for the random number streams returned by make_stream().
               @throw std::domain_error If rngimpl is null.
             */
-            MutableContext(std::unique_ptr<RNG>&& rngimpl);
+            MutableContext(std::unique_ptr<RNG>&& rngimpl, long stream_seed = 42);
 
             MutableContext(const MutableContext&) = default; 
             
-            /** Provide random number generator. */
+            /** Provide random number generator. If an RNGOverride for this context is active in the calling thread, returns the overriding generator. */
             RNG& rng() {
+				if (tl_override_ctx_ == this) {
+					return *tl_override_rng_;
+				}
                 return *_rng;
             }
+
+			/** Create a random number stream for the Actor with given ID, current schedule date and stream index (e.g. index of the operator drawing the numbers).
+			The stream depends only on the stream seed and the arguments, so objects can be processed in any order and by any thread with the same results.
+			*/
+			RNGPhilox make_stream(Actor::id_t id, size_t stream_idx) const;
+
+			/** Create a random number stream for the chunk_idx-th chunk of data objects processed in the stage_idx-th stage of population initialisation
+			(e.g. sampling or a perturbation). Independent of the streams returned by make_stream().
+			*/
+			RNGPhilox make_initialisation_stream(size_t stage_idx, size_t chunk_idx) const;
+
+			/** @brief Replaces the generator returned by MutableContext::rng() in the current thread while in scope. */
+			class RNGOverride {
+			public:
+				/** @param rng Generator which must outlive this object */
+				RNGOverride(const MutableContext& ctx, RNG& rng);
+				RNGOverride(const RNGOverride&) = delete;
+				RNGOverride& operator=(const RNGOverride&) = delete;
+				~RNGOverride();
+			private:
+				const MutableContext* prev_ctx_;
+				RNG* prev_rng_;
+			};
+
+			/** First ID generated in the scope of an AuxiliaryThread. IDs from this value up are reserved for it. */
+			static const Actor::id_t AUXILIARY_MIN_ID = Actor::id_t(1) << 63;
+
+			/** @brief Gives the current thread its own state of the context while in scope, so that another population
+			(e.g. the emigrant one) can be simulated concurrently with the main one.
+
+			In scope, rng() returns the given generator, gen_id() returns consecutive IDs starting from AUXILIARY_MIN_ID
+			(continuing the sequence from the previous scope), and add_newborns(), newborns_cache() and wipe_out_newborns()
+			use a separate newborns cache. IDs and newborns therefore do not depend on what other threads do.
+			At most one AuxiliaryThread per context can be active at a time.
+			*/
+			class AuxiliaryThread {
+			public:
+				/** @param rng Generator which must outlive this object */
+				AuxiliaryThread(MutableContext& ctx, RNG& rng);
+				AuxiliaryThread(const AuxiliaryThread&) = delete;
+				AuxiliaryThread& operator=(const AuxiliaryThread&) = delete;
+				~AuxiliaryThread();
+			private:
+				RNGOverride rng_override_;
+				const MutableContext* prev_ctx_;
+			};
             
             /** Return current schedule period index. */
 			date_idx_t date_index() const {
@@ -56,7 +109,26 @@ namespace averisera {
              */
             Actor::id_t gen_id();
 
-			/** Return current maximum ID */
+			/** Generate n consecutive new IDs, as if by calling gen_id() n times.
+			@return First ID in the range
+			@throw std::domain_error If n == 0
+			@throw std::runtime_error If run out of IDs
+			*/
+			Actor::id_t gen_ids(size_t n);
+
+			/** Allocator for Person objects created during the simulation (births, immigration, initialisation).
+			All copies draw from the same thread-safe MemoryPool owned by this context.
+			*/
+			PoolAllocator<Person> person_allocator() const {
+				return PoolAllocator<Person>(person_pool_);
+			}
+
+			/** Columnar history stores of this simulation. Install a HistoryColumnStores::Scope for them wherever histories are created. */
+			HistoryColumnStores& history_column_stores() const {
+				return *history_column_stores_;
+			}
+
+			/** Return current maximum ID, not counting the IDs generated in the scope of an AuxiliaryThread */
 			Actor::id_t get_max_id() const {
 				return _max_id;
 			}
@@ -68,7 +140,7 @@ namespace averisera {
 
 			/** Return newborns cache */
             const std::vector<std::shared_ptr<Person>>& newborns_cache() {
-                return _newborns;
+                return newborns();
             }
 
 			/** Remove all newborns from the cache */
@@ -96,6 +168,10 @@ namespace averisera {
 				return immigrants_;
 			}
 
+			/** Remove persons who died before cutoff from immigrants() and emigrants(), so that their memory can be freed
+			once they are archived (see Population::archive_dead_persons). */
+			void remove_dead_migrants(Date cutoff);
+
 			/** Return current as of date */
 			Date asof(const ImmutableContext& imm_ctx) const;			
 
@@ -104,19 +180,37 @@ namespace averisera {
 				return emigrant_population_;
 			}
 
+			friend class Checkpoint;
 			friend class Simulator;
         private:
             std::unique_ptr<RNG> _rng;
+			uint64_t stream_seed_; /**< Seed for make_stream() */
 			date_idx_t date_idx_; /** Current schedule date index */
             Actor::id_t _max_id;
             std::vector<std::shared_ptr<Person>> _newborns; /** New born babies. Sorted by ID. */
 			std::unordered_map<Date, std::vector<std::shared_ptr<Person>>> emigrants_; /**< Persons who left the simulated population due to emigration: map emigration date -> persons who emigrated on this date. Each value in map is sorted by ID. */
 			Population emigrant_population_; /**< Another structure containing the emigrants for the purpose of simulating their mortality and procreation */
 			std::vector<std::shared_ptr<Person>> immigrants_; /**< Persons who joined the simulated population due to immigration. Sorted by ID */
+			std::shared_ptr<MemoryPool> person_pool_; /**< Memory for Person objects and their control blocks */
+			std::shared_ptr<HistoryColumnStores> history_column_stores_;
+			Actor::id_t auxiliary_max_id_; /**< Last ID generated in the scope of an AuxiliaryThread */
+			std::vector<std::shared_ptr<Person>> auxiliary_newborns_; /**< Newborns cache used in the scope of an AuxiliaryThread. Sorted by ID. */
 
 			Population& emigrant_population() {
 				return emigrant_population_;
 			}
+
+			bool is_auxiliary_thread() const {
+				return tl_auxiliary_ctx_ == this;
+			}
+
+			std::vector<std::shared_ptr<Person>>& newborns() {
+				return is_auxiliary_thread() ? auxiliary_newborns_ : _newborns;
+			}
+
+			static thread_local const MutableContext* tl_override_ctx_; /**< Context whose generator is overridden in this thread */
+			static thread_local RNG* tl_override_rng_; /**< Overriding generator */
+			static thread_local const MutableContext* tl_auxiliary_ctx_; /**< Context with an AuxiliaryThread active in this thread */
         };
     }
 }
@@ -2,6 +2,7 @@
 #include "observer.hpp"
 #include "observer_result_saver.hpp"
 #include "core/dates.hpp"
+#include <stdexcept>
 
 namespace averisera {
     namespace microsim {
@@ -11,6 +12,50 @@ namespace averisera {
         Observer::~Observer() {
         }
 
+        void Observer::begin_pass(const Contexts&) {
+        }
+
+        void Observer::observe_person(const Person&, const Contexts&) {
+            throw std::logic_error("Observer: single pass observation not supported");
+        }
+
+        void Observer::observe_archived(const PersonArchive&, const Contexts&) {
+        }
+
+        void Observer::end_pass(const Contexts&) {
+        }
+
+        Observer::results_writer_type Observer::date_results_writer(const ImmutableContext&, Date, Date) const {
+            throw std::logic_error("Observer: saving results for selected dates not supported");
+        }
+
+        void Observer::save_results_summary(std::ostream&, const ImmutableContext&) const {
+            throw std::logic_error("Observer: saving results for selected dates not supported");
+        }
+
+        void Observer::save_state(std::ostream&) const {
+            throw std::logic_error("Observer: saving state not supported");
+        }
+
+        void Observer::load_state(std::istream&) {
+            throw std::logic_error("Observer: loading state not supported");
+        }
+
+        void Observer::write_binary_date(std::ostream& os, const Date date) {
+            write_binary(os, static_cast<int64_t>(date.julian_day()));
+        }
+
+        Date Observer::read_binary_date(std::istream& is) {
+            typedef boost::gregorian::gregorian_calendar calendar;
+            return Date(boost::gregorian::date(calendar::from_day_number(static_cast<calendar::date_int_type>(read_binary<int64_t>(is)))));
+        }
+
+        void Observer::check_stream(const std::istream& is) {
+            if (!is) {
+                throw std::runtime_error("Observer: saved state is truncated");
+            }
+        }
+
         void Observer::save_intermediate_results(const ImmutableContext& im_ctx, Date asof) const {
             if (result_saver_) {
                 result_saver_->save_intermediate(*this, im_ctx, asof);
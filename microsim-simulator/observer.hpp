@@ -2,40 +2,153 @@
 #ifndef __AVERISERA_MS_OBSERVER_H
 #define __AVERISERA_MS_OBSERVER_H
 #include "core/dates_fwd.hpp"
-#include <iosfwd>
+#include <cstdint>
+#include <functional>
+#include <istream>
 #include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace averisera {
     namespace microsim {
         class Contexts;
 		class ImmutableContext;
         class ObserverResultSaver;
+        class Person;
+        class PersonArchive;
         class Population;
 		class Schedule;
+		template <class T> class Predicate;
         
         /** Observes the population during the simulation and gathers results */
         class Observer {
         public:
+			/** Function which writes a part of the results to a stream. It owns a copy of the data it writes, so that it can be called
+			on another thread (e.g. by BackgroundFileWriter) while the observer continues gathering results. */
+			typedef std::function<void(std::ostream&)> results_writer_type;
+
             /** @param result_saver If null, don't try to call it to save results. */
             Observer(std::shared_ptr<ObserverResultSaver> result_saver);
             
             virtual ~Observer();
 
-            /** Observe the population. Called once per simulation date. */
+            /** Observe the population. Called once per simulation date, unless is_single_pass() returns true. */
             virtual void observe(const Population& population, const Contexts& ctx) = 0;
 
+			/** If true, the observer gathers its data from the persons in the Population by begin_pass(), observe_person() and end_pass(), so that
+			it can share a single pass over the population with other observers. Simulator does not call observe() for it.
+			*/
+			virtual bool is_single_pass() const {
+				return false;
+			}
+
+			/** Prepare for observing the persons one by one on the current simulation date. */
+			virtual void begin_pass(const Contexts& ctx);
+
+			/** Predicate selecting the persons passed to observe_person(), or null (default) to pass all of them. Simulator evaluates
+			the predicates of all single-pass observers over the population columns with PredicateProgram, once per simulation date.
+			*/
+			virtual const Predicate<Person>* pass_predicate() const {
+				return nullptr;
+			}
+
+			/** Observe one person from the Population. Called for every person selected by pass_predicate(), in the order of Population::persons().
+			@throw std::logic_error If is_single_pass() returns false.
+			*/
+			virtual void observe_person(const Person& person, const Contexts& ctx);
+
+			/** Observe the persons archived from the Population on the current simulation date (records of population.archive()
+			from PersonArchive::batch_begin() onwards, see Population::archive_dead_persons()), who died since the previous date.
+			Called by Simulator after observe_person() was called for all persons and before end_pass(). Observers which
+			implement observe() can read Population::archive() there. Does nothing by default.
+			*/
+			virtual void observe_archived(const PersonArchive& archive, const Contexts& ctx);
+
+			/** Finish observing the persons one by one on the current simulation date. */
+			virtual void end_pass(const Contexts& ctx);
+
             /** Save results to stream. Called by ObserverResultSaver.
 			@param sim_schedule Simulation schedule
 			*/
             virtual void save_results(std::ostream& os, const ImmutableContext& im_ctx) const = 0;
 
+			/** If true, the output of save_results() is the output of date_results_writer(im_ctx, Date(), Date::MAX) followed by the output
+			of save_results_summary(), so that it can be built by appending the results for new dates as they are observed.
+			*/
+			virtual bool has_date_results() const {
+				return false;
+			}
+
+			/** Return a function which writes the results for the observed dates d such that after < d <= until, in ascending order.
+			If after is not a date, the results start from the beginning and the function writes their header first. Called by ObserverResultSaver.
+			@throw std::logic_error If has_date_results() returns false.
+			*/
+			virtual results_writer_type date_results_writer(const ImmutableContext& im_ctx, Date after, Date until) const;
+
+			/** Save the part of the results which follows the results for the observed dates. Called by ObserverResultSaver.
+			@throw std::logic_error If has_date_results() returns false.
+			*/
+			virtual void save_results_summary(std::ostream& os, const ImmutableContext& im_ctx) const;
+
+			/** Save the results gathered so far to a binary stream (in native byte order), so that a simulation resumed from a Checkpoint
+			can continue gathering them. The configuration of the observer is not saved.
+			@throw std::logic_error If the observer does not support it (default).
+			*/
+			virtual void save_state(std::ostream& os) const;
+
+			/** Replace the results gathered so far with the ones saved by save_state() of an observer constructed with the same arguments.
+			@throw std::logic_error If the observer does not support it (default).
+			@throw std::runtime_error If the saved state is corrupt or does not match the configuration.
+			*/
+			virtual void load_state(std::istream& is);
+
             /** Save intermediate results using the private result_saver 
              @param asof Date at which results are saved */
             void save_intermediate_results(const ImmutableContext& im_ctx, Date asof) const;
 
             /** Save final results using the private result_saver */
             void save_final_results(const ImmutableContext& im_ctx) const;
+		protected:
+			/** Helpers for save_state() and load_state() */
+			template <class T> static void write_binary(std::ostream& os, T value) {
+				static_assert(std::is_trivially_copyable<T>::value, "Observer: binary value must be trivially copyable");
+				os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+			}
+
+			/** @throw std::runtime_error If the stream ends prematurely */
+			template <class T> static T read_binary(std::istream& is) {
+				static_assert(std::is_trivially_copyable<T>::value, "Observer: binary value must be trivially copyable");
+				T value;
+				is.read(reinterpret_cast<char*>(&value), sizeof(T));
+				check_stream(is);
+				return value;
+			}
+
+			template <class T> static void write_binary(std::ostream& os, const std::vector<T>& values) {
+				static_assert(std::is_trivially_copyable<T>::value, "Observer: binary value must be trivially copyable");
+				write_binary(os, static_cast<uint64_t>(values.size()));
+				os.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+			}
+
+			/** @throw std::runtime_error If the stream ends prematurely */
+			template <class T> static void read_binary(std::istream& is, std::vector<T>& values) {
+				static_assert(std::is_trivially_copyable<T>::value, "Observer: binary value must be trivially copyable");
+				values.resize(static_cast<size_t>(read_binary<uint64_t>(is)));
+				is.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+				check_stream(is);
+			}
+
+			/** Write a normal date */
+			static void write_binary_date(std::ostream& os, Date date);
+
+			/** @throw std::runtime_error If the stream ends prematurely */
+			static Date read_binary_date(std::istream& is);
         private:
+			/** @throw std::runtime_error If is has failed */
+			static void check_stream(const std::istream& is);
+
             std::shared_ptr<ObserverResultSaver> result_saver_;
         };
     }
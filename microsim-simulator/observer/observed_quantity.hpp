@@ -4,6 +4,7 @@
 
 #include "../contexts.hpp"
 #include "../immutable_history.hpp"
+#include "../variable_handle.hpp"
 #include <functional>
 #include <limits>
 #include <stdexcept>
@@ -40,12 +41,13 @@ namespace averisera {
             }
 
             /** Factory method which creates an ObservedQuantity object which reads the last value of a variable
-              with given name from its History, as double */
+              with given name from its History, as double. The variable index is looked up once per HistoryRegistry. */
             static ObservedQuantity<T> last_as_double(const std::string& variable_name ) {
-                return std::move(ObservedQuantity<T>(variable_name, std::function<double(const T&, const Contexts&)>([&variable_name](const T& obj, const Contexts& ctx) -> double {
+				const VariableHandle variable(variable_name);
+                return std::move(ObservedQuantity<T>(variable_name, std::function<double(const T&, const Contexts&)>([variable](const T& obj, const Contexts& ctx) -> double {
 					const ImmutableContext& imm_ctx = ctx.immutable_ctx();
-					if (obj.has_history(imm_ctx, variable_name)) {
-						const ImmutableHistory& history = obj.history(imm_ctx, variable_name);
+					if (obj.has_history(imm_ctx, variable)) {
+						const ImmutableHistory& history = obj.history(imm_ctx, variable);
 						if (!history.empty()) {
 							return history.last_as_double(ctx.asof());
 						}
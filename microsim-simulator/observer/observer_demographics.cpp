@@ -4,8 +4,10 @@
 #include "../contexts.hpp"
 #include "../immutable_context.hpp"
 #include "../person.hpp"
+#include "../person_archive.hpp"
 #include "../person_data.hpp"
 #include "../population.hpp"
+#include "core/daycount.hpp"
 #include "core/inclusion.hpp"
 #include "core/preconditions.hpp"
 #include <cassert>
@@ -14,77 +16,180 @@
 namespace averisera {
 	namespace microsim {
 		ObserverDemographics::ObserverDemographics(std::shared_ptr<ObserverResultSaver> result_saver, const std::string& category, const age_ranges_type& age_ranges, size_t nbr_dates, const std::string& own_filename_stub)
-			: Observer(result_saver), category_(category), age_ranges_(age_ranges), _nbr_dates(nbr_dates), own_filename_stub_(own_filename_stub), init_counters_(_nbr_dates, 0) {
+			: Observer(result_saver), category_(category), age_ranges_(age_ranges), _nbr_dates(nbr_dates), own_filename_stub_(own_filename_stub), init_counters_(_nbr_dates, 0),
+			pass_idx_(0), pass_cnt_newborns_(0) {
 			check_that(Inclusion::all_disjoint<false>(age_ranges), "ObserverDemographics: age ranges are not disjoint");
 		}
 
 		void ObserverDemographics::observe_persons(const std::vector<std::shared_ptr<Person>>& persons, const Contexts& ctx) {
-			const size_t idx = ctx.asof_idx();
-			if (idx < _nbr_dates) {
-				const Date asof = ctx.asof();
-				if (idx > 0) {
-					const Schedule& schedule = ctx.immutable_ctx().schedule();
-					const Date prev_asof = schedule.date(idx - 1);
-					size_t cnt_newborns = 0;
-					for (const Person::shared_ptr& person_ptr : persons) {
-						const PersonAttributes& attribs = person_ptr->attributes();
-						const Date dob = person_ptr->date_of_birth();
-						if (dob >= asof) {
-							// newborn in the future, will be counted in next step of simulation
-							++cnt_newborns;
-							continue;
-						}
-						const double age = person_ptr->age_fract(asof);
-						if (person_ptr->is_alive(asof)) {
-							++get_counters(_pop_counters, attribs, age)[idx];
-						}							
+			begin_pass(ctx);
+			for (const Person::shared_ptr& person_ptr : persons) {
+				observe_person(*person_ptr, ctx);
+			}
+			end_pass(ctx);
+		}
 
-						if (dob >= prev_asof && dob < asof) {
-							// it's a newborn person
-							// find mother if possible
-							double age_at_birth = 0.0; // mother's age if we can find it, child's age otherwise (==0)
-							if (const auto mother_ptr = person_ptr->mother().lock()) {
-								age_at_birth = mother_ptr->age_fract(dob);
-								const Date id = mother_ptr->immigration_date();
+		void ObserverDemographics::begin_pass(const Contexts& ctx) {
+			pass_idx_ = ctx.asof_idx();
+			pass_asof_ = ctx.asof();
+			if (pass_idx_ > 0 && pass_idx_ < _nbr_dates) {
+				pass_prev_asof_ = ctx.immutable_ctx().schedule().date(pass_idx_ - 1);
+			}
+			pass_cnt_newborns_ = 0;
+		}
 
-								if (!id.is_not_a_date()) {
-									//// HACK HACK HACK
-									//// For Brexit paper
-									//static const Date min_date(2016, 7, 1);
-									//static const Date max_date(2036, 7, 1);
-									//const bool pass = dob >= min_date && dob < max_date && id >= min_date && id < max_date;
+		void ObserverDemographics::observe_person(const Person& person, const Contexts& ctx) {
+			const size_t idx = pass_idx_;
+			if (idx >= _nbr_dates) {
+				return;
+			}
+			const Date asof = pass_asof_;
+			const PersonAttributes& attribs = person.attributes();
+			if (idx > 0) {
+				const Date prev_asof = pass_prev_asof_;
+				const Date dob = person.date_of_birth();
+				if (dob >= asof) {
+					// newborn in the future, will be counted in next step of simulation
+					++pass_cnt_newborns_;
+					return;
+				}
+				const double age = person.age_fract(asof);
+				if (person.is_alive(asof)) {
+					++get_counters(_pop_counters, attribs, age)[idx];
+				}							
 
-									//if (pass) { // replace with true if removing HACK
-										// child's mother is an immigrant
-										++get_counters(birth_to_immigrants_by_dob_counters_, attribs, age_at_birth)[idx];
-										const auto im_idx = schedule.find_containing_period(id) + 1;
-										assert(im_idx < _nbr_dates);
-										++get_counters(birth_to_immigrants_by_id_counters_, attribs, age_at_birth)[im_idx];
-									//}
-								}
-							} else {
-								LOG_WARN() << "ObserverDemographics(" << category_ << "): could not find mother of a newborn person: " << person_ptr->to_data(ctx.immutable_ctx());								
-							}
-							++get_counters(_birth_counters, attribs, age_at_birth)[idx];
-						}
-						const Date dod = person_ptr->date_of_death();
-						if (!dod.is_not_a_date()) {
-							if (dod >= prev_asof && dod < asof) {
-								++get_counters(_death_counters, attribs, age)[idx];
-							}
-						}
+				if (dob >= prev_asof && dob < asof) {
+					// it's a newborn person
+					// find mother if possible
+					const auto mother_ptr = person.mother().lock();
+					if (!mother_ptr) {
+						LOG_WARN() << "ObserverDemographics(" << category_ << "): could not find mother of a newborn person: " << person.to_data(ctx.immutable_ctx());
 					}
-					LOG_TRACE() << "ObserverDemographics(" << category_ << "): skipped " << cnt_newborns << " persons born in the future as of " << asof;
-				} else {
-					for (const Person::shared_ptr& person_ptr : persons) {
-						const PersonAttributes& attribs = person_ptr->attributes();
-						if (person_ptr->is_alive(asof)) {
-							const double age = person_ptr->age_fract(asof);
-							++get_counters(_pop_counters, attribs, age)[idx];
-						}
+					count_birth(attribs, dob, mother_ptr ? mother_ptr->date_of_birth() : Date(), mother_ptr ? mother_ptr->immigration_date() : Date(), ctx);
+				}
+				const Date dod = person.date_of_death();
+				if (!dod.is_not_a_date()) {
+					if (dod >= prev_asof && dod < asof) {
+						++get_counters(_death_counters, attribs, age)[idx];
 					}
 				}
+			} else {
+				if (person.is_alive(asof)) {
+					const double age = person.age_fract(asof);
+					++get_counters(_pop_counters, attribs, age)[idx];
+				}
+			}
+		}
+
+		void ObserverDemographics::observe_archived(const PersonArchive& archive, const Contexts& ctx) {
+			const size_t idx = pass_idx_;
+			if (idx == 0 || idx >= _nbr_dates) {
+				// archived persons are dead as of the observed date
+				return;
+			}
+			const Date asof = pass_asof_;
+			const Date prev_asof = pass_prev_asof_;
+			for (size_t i = archive.batch_begin(); i < archive.size(); ++i) {
+				const PersonArchive::Record record(archive.record(i));
+				if (record.date_of_birth >= prev_asof && record.date_of_birth < asof) {
+					if (record.mother_id == Actor::INVALID_ID) {
+						LOG_WARN() << "ObserverDemographics(" << category_ << "): could not find mother of an archived newborn person with ID " << record.id;
+					}
+					count_birth(record.attributes, record.date_of_birth, record.mother_date_of_birth, record.mother_immigration_date, ctx);
+				}
+				if (record.date_of_death >= prev_asof && record.date_of_death < asof) {
+					++get_counters(_death_counters, record.attributes, age_fract(record.date_of_birth, asof))[idx];
+				}
+			}
+		}
+
+		void ObserverDemographics::count_birth(const PersonAttributes& attribs, const Date dob, const Date mother_dob, const Date mother_immigration_date, const Contexts& ctx) {
+			const size_t idx = pass_idx_;
+			double age_at_birth = 0.0; // mother's age if we can find it, child's age otherwise (==0)
+			if (!mother_dob.is_not_a_date()) {
+				age_at_birth = age_fract(mother_dob, dob);
+				const Date id = mother_immigration_date;
+
+				if (!id.is_not_a_date()) {
+					//// HACK HACK HACK
+					//// For Brexit paper
+					//static const Date min_date(2016, 7, 1);
+					//static const Date max_date(2036, 7, 1);
+					//const bool pass = dob >= min_date && dob < max_date && id >= min_date && id < max_date;
+
+					//if (pass) { // replace with true if removing HACK
+						// child's mother is an immigrant
+						++get_counters(birth_to_immigrants_by_dob_counters_, attribs, age_at_birth)[idx];
+						const auto im_idx = ctx.immutable_ctx().schedule().find_containing_period(id) + 1;
+						assert(im_idx < _nbr_dates);
+						++get_counters(birth_to_immigrants_by_id_counters_, attribs, age_at_birth)[im_idx];
+					//}
+				}
+			}
+			++get_counters(_birth_counters, attribs, age_at_birth)[idx];
+		}
+
+		double ObserverDemographics::age_fract(const Date dob, const Date asof) {
+			// same as Person::age_fract
+			if (asof < dob) {
+				return 0.;
+			}
+			return Daycount::year_fract(dob, asof);
+		}
+
+		void ObserverDemographics::end_pass(const Contexts&) {
+			if (pass_idx_ > 0 && pass_idx_ < _nbr_dates) {
+				LOG_TRACE() << "ObserverDemographics(" << category_ << "): skipped " << pass_cnt_newborns_ << " persons born in the future as of " << pass_asof_;
+			}
+		}
+
+		void ObserverDemographics::save_state(std::ostream& os) const {
+			for (const CountersMaps* maps : { &_pop_counters, &_birth_counters, &birth_to_immigrants_by_dob_counters_, &birth_to_immigrants_by_id_counters_, &_death_counters }) {
+				save_counters_state(os, maps->female);
+				save_counters_state(os, maps->male);
+			}
+		}
+
+		void ObserverDemographics::load_state(std::istream& is) {
+			CountersMaps loaded[5];
+			for (CountersMaps& maps : loaded) {
+				maps.female = load_counters_state(is);
+				maps.male = load_counters_state(is);
+			}
+			std::swap(_pop_counters, loaded[0]);
+			std::swap(_birth_counters, loaded[1]);
+			std::swap(birth_to_immigrants_by_dob_counters_, loaded[2]);
+			std::swap(birth_to_immigrants_by_id_counters_, loaded[3]);
+			std::swap(_death_counters, loaded[4]);
+		}
+
+		void ObserverDemographics::save_counters_state(std::ostream& os, const counters_map_type& map) {
+			write_binary(os, static_cast<uint64_t>(map.size()));
+			for (const auto& kv : map) {
+				write_binary(os, kv.first.first.begin());
+				write_binary(os, kv.first.first.end());
+				write_binary(os, kv.first.second);
+				write_binary(os, kv.second);
+			}
+		}
+
+		ObserverDemographics::counters_map_type ObserverDemographics::load_counters_state(std::istream& is) const {
+			counters_map_type map;
+			const uint64_t size = read_binary<uint64_t>(is);
+			for (uint64_t i = 0; i < size; ++i) {
+				const age_type age_begin = read_binary<age_type>(is);
+				const age_type age_end = read_binary<age_type>(is);
+				if (age_begin > age_end) {
+					throw std::runtime_error("ObserverDemographics: saved state has invalid age range");
+				}
+				const PersonAttributes::ethnicity_t ethnicity = read_binary<PersonAttributes::ethnicity_t>(is);
+				counters_type& counters = map[key_type(age_range_type(age_begin, age_end), ethnicity)];
+				read_binary(is, counters);
+				if (counters.size() != _nbr_dates) {
+					throw std::runtime_error("ObserverDemographics: saved state has a different number of dates");
+				}
 			}
+			return map;
 		}
 
 		void ObserverDemographics::save_results(std::ostream& os, const ImmutableContext& im_ctx) const {
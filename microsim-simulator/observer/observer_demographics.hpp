@@ -2,6 +2,7 @@
 #pragma once
 #include "../observer.hpp"
 #include "microsim-core/person_attributes.hpp"
+#include "core/dates.hpp"
 #include "core/numerical_range.hpp"
 #include <vector>
 
@@ -29,6 +30,20 @@ namespace averisera {
 			ObserverDemographics(std::shared_ptr<ObserverResultSaver> result_saver, const std::string& category, const age_ranges_type& age_ranges, size_t nbr_dates, const std::string& own_filename_stub);
 
 			void save_results(std::ostream& os, const ImmutableContext& im_ctx) const override;
+
+			void begin_pass(const Contexts& ctx) override;
+
+			void observe_person(const Person& person, const Contexts& ctx) override;
+
+			/** Counts the births and deaths of archived persons in the observed period */
+			void observe_archived(const PersonArchive& archive, const Contexts& ctx) override;
+
+			void end_pass(const Contexts& ctx) override;
+
+			/** Saves all counters */
+			void save_state(std::ostream& os) const override;
+
+			void load_state(std::istream& is) override;
             
 			typedef int64_t counter_type; /**< Counter type - signed because we want to calculate the differences of them */
 			typedef std::vector<counter_type> counters_type; 
@@ -87,6 +102,10 @@ namespace averisera {
 			size_t _nbr_dates;
 			std::string own_filename_stub_;
 			counters_type init_counters_;			
+			size_t pass_idx_; /**< Index of the date observed in the current pass */
+			Date pass_asof_;
+			Date pass_prev_asof_;
+			size_t pass_cnt_newborns_; /**< Persons born in the future skipped in the current pass */
 
 			const counters_type& init_counters() const {
 				return init_counters_;
@@ -99,6 +118,20 @@ namespace averisera {
 
 			const counters_type& get_counters(const CountersMaps& maps, PersonAttributes attribs, double age) const;
 
+			/** Count a birth in the observed period.
+			@param mother_dob Mother's date of birth, NAD if the mother is not known
+			@param mother_immigration_date Mother's immigration date, NAD if she did not immigrate
+			*/
+			void count_birth(const PersonAttributes& attribs, Date dob, Date mother_dob, Date mother_immigration_date, const Contexts& ctx);
+
+			/** Age at asof in years of a person born on dob */
+			static double age_fract(Date dob, Date asof);
+
+			static void save_counters_state(std::ostream& os, const counters_map_type& map);
+
+			/** @throw std::runtime_error If the counters have different length than the number of dates */
+			counters_map_type load_counters_state(std::istream& is) const;
+
 			void save_event_stats(std::ostream& os, const Schedule& sim_schedule, const CountersMaps& maps, const ImmutableContext& im_ctx, const std::string& suffix, bool deltas) const;
 
 			void save_event_stats(std::ostream& os, const Schedule& sim_schedule, const counters_map_type& map, const ImmutableContext& im_ctx, const std::string& suffix, bool deltas) const;
@@ -2,12 +2,18 @@
 (C) Averisera Ltd 2017
 */
 #include "observer_demographics_main.hpp"
+#include "../person.hpp"
 #include "../population.hpp"
 
 namespace averisera {
 	namespace microsim {
         void ObserverDemographicsMain::observe(const Population& population, const Contexts& ctx) {
-            observe_persons(population.persons(), ctx);
+            begin_pass(ctx);
+            for (const auto& person : population.persons()) {
+                observe_person(*person, ctx);
+            }
+            observe_archived(population.archive(), ctx);
+            end_pass(ctx);
         }
     }
 }
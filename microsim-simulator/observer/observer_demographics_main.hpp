@@ -21,6 +21,10 @@ namespace averisera {
                 : ObserverDemographics(result_saver, "all", age_ranges, nbr_dates, own_filename_stub) {}
             
             void observe(const Population& population, const Contexts& ctx) override;
+
+			bool is_single_pass() const override {
+				return true;
+			}
         };
     }
 }
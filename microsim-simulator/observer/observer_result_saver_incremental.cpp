@@ -0,0 +1,48 @@
+/*
+(C) Averisera Ltd 2020
+*/
+#include "observer_result_saver_incremental.hpp"
+#include "../observer.hpp"
+#include "core/background_file_writer.hpp"
+#include <sstream>
+#include <stdexcept>
+
+namespace averisera {
+    namespace microsim {
+		ObserverResultSaverIncremental::ObserverResultSaverIncremental(const std::string& intermediate_filename, const std::string& final_filename, std::shared_ptr<BackgroundFileWriter> writer)
+			: ObserverResultSaverSimple(intermediate_filename, final_filename, writer), observer_(nullptr) {}
+
+        void ObserverResultSaverIncremental::save_intermediate(const Observer& observer, const ImmutableContext& imm_ctx, Date asof) {
+            if (!intermediate_filename().empty() && observer.has_date_results()) {
+				check_observer(observer);
+                writer().write(intermediate_filename(), observer.date_results_writer(imm_ctx, last_saved_, asof), !last_saved_.is_not_a_date());
+				last_saved_ = asof;
+				if (intermediate_filename() == final_filename()) {
+					set_final_started();
+				}
+            }
+        }
+
+		void ObserverResultSaverIncremental::save_final(const Observer& observer, const ImmutableContext& imm_ctx) {
+			if (observer.has_date_results() && !final_filename().empty() && final_filename() == intermediate_filename()) {
+				check_observer(observer);
+				// the file already holds the results up to last_saved_
+				std::stringstream ss;
+				observer.date_results_writer(imm_ctx, last_saved_, Date::MAX)(ss);
+				observer.save_results_summary(ss, imm_ctx);
+				write_final(ss.str());
+				writer().flush();
+			} else {
+				ObserverResultSaverSimple::save_final(observer, imm_ctx);
+			}
+		}
+
+		void ObserverResultSaverIncremental::check_observer(const Observer& observer) {
+			if (!observer_) {
+				observer_ = &observer;
+			} else if (observer_ != &observer) {
+				throw std::logic_error("ObserverResultSaverIncremental: results of only one observer can be saved incrementally");
+			}
+		}
+    }
+}
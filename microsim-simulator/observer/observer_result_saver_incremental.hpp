@@ -0,0 +1,37 @@
+#pragma once
+/*
+(C) Averisera Ltd 2020
+*/
+#include "observer_result_saver_simple.hpp"
+
+namespace averisera {
+    namespace microsim {
+        /** Saves intermediate results incrementally: at each date, the results for the dates observed since the last save are appended to the
+		intermediate file using Observer::date_results_writer(). They are formatted and written on the thread of the BackgroundFileWriter,
+		and the total amount of output grows linearly with the number of dates. The intermediate file has the same format as the final one;
+		if both filenames are the same, only the remaining dates and Observer::save_results_summary() are appended to it at the end.
+		Observers which do not support Observer::date_results_writer() save only the final results, as by ObserverResultSaverSimple.
+         */
+        class ObserverResultSaverIncremental: public ObserverResultSaverSimple {
+        public:
+			/** @see ObserverResultSaverSimple */
+			ObserverResultSaverIncremental(const std::string& intermediate_filename, const std::string& final_filename, std::shared_ptr<BackgroundFileWriter> writer = nullptr);
+
+			/** Use the same filename for intermediate and final results. */
+			ObserverResultSaverIncremental(const std::string& filename)
+				: ObserverResultSaverIncremental(filename, filename) {}
+
+			/** @throw std::logic_error If the saver was used by another observer which supports Observer::date_results_writer(). */
+            void save_intermediate(const Observer& observer, const ImmutableContext& imm_ctx, Date asof) override;
+
+			/** @throw std::logic_error If the saver was used by another observer which supports Observer::date_results_writer(). */
+			void save_final(const Observer& observer, const ImmutableContext& imm_ctx) override;
+        private:
+			/** Remember the only observer whose results are saved incrementally */
+			void check_observer(const Observer& observer);
+
+			const Observer* observer_;
+            Date last_saved_; /**< Last date saved to the intermediate file, or not a date */
+        };
+    }
+}
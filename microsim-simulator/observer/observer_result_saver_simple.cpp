@@ -3,32 +3,47 @@
 */
 #include "observer_result_saver_simple.hpp"
 #include "../observer.hpp"
-#include <fstream>
+#include "core/background_file_writer.hpp"
+#include <sstream>
 
 namespace averisera {
     namespace microsim {
-        ObserverResultSaverSimple::ObserverResultSaverSimple(const std::string& intermediate_filename, const std::string& final_filename)
-            : intermediate_filename_(intermediate_filename), final_filename_(final_filename), final_started_(false) {}
+		/** Writer shared by all savers which were not given one, so that they do not start a thread each */
+		static std::shared_ptr<BackgroundFileWriter> default_writer() {
+			static const std::shared_ptr<BackgroundFileWriter> writer(std::make_shared<BackgroundFileWriter>());
+			return writer;
+		}
 
-        static void save(const Observer& observer, const ImmutableContext& imm_ctx, const std::string& filename, std::ios_base::openmode flag) {
-            std::ofstream ofs(filename, flag);
-            observer.save_results(ofs, imm_ctx);
+        ObserverResultSaverSimple::ObserverResultSaverSimple(const std::string& intermediate_filename, const std::string& final_filename, std::shared_ptr<BackgroundFileWriter> writer)
+            : intermediate_filename_(intermediate_filename), final_filename_(final_filename), writer_(writer), final_started_(false) {
+			if (!writer_) {
+				writer_ = default_writer();
+			}
+		}
+
+        static std::string serialise(const Observer& observer, const ImmutableContext& imm_ctx) {
+            std::stringstream ss;
+            observer.save_results(ss, imm_ctx);
+            return ss.str();
         }
         
         void ObserverResultSaverSimple::save_intermediate(const Observer& observer, const ImmutableContext& imm_ctx, Date asof) {
             if (!intermediate_filename_.empty()) {
-                const auto flag = (dates_seen_.find(asof) != dates_seen_.end()) ? std::ios_base::app : std::ios_base::out;
-                save(observer, imm_ctx, intermediate_filename_, flag);
+                writer_->write(intermediate_filename_, serialise(observer, imm_ctx), dates_seen_.find(asof) != dates_seen_.end());
                 dates_seen_.insert(asof);
             }
         }
         
         void ObserverResultSaverSimple::save_final(const Observer& observer, const ImmutableContext& imm_ctx) {
             if (!final_filename_.empty()) {
-                save(observer, imm_ctx, final_filename_, final_started_ ? std::ios_base::app : std::ios_base::out);
-                final_started_ = true;
+                write_final(serialise(observer, imm_ctx));
             }
+			writer_->flush();
         }
 
+		void ObserverResultSaverSimple::write_final(std::string content) {
+			writer_->write(final_filename_, std::move(content), final_started_);
+			final_started_ = true;
+		}
     }
 }
@@ -4,21 +4,25 @@
 */
 #include "../observer_result_saver.hpp"
 #include "core/dates.hpp"
+#include <memory>
 #include <string>
 #include <unordered_set>
 
-
 namespace averisera {
+	class BackgroundFileWriter;
+
     namespace microsim {
         /** Simple implementation of ObserverResultSaver. If more than one Observer shares the same saver, the results will be appended not overwritten between observers, but overwritten at each date.
+		Results are written to files by a BackgroundFileWriter, so that the simulation does not wait for the disk between steps. save_final() waits until all results are written.
          */
         class ObserverResultSaverSimple: public ObserverResultSaver {
         public:
             /**
               @param intermediate_filename Filename to use for intermediate results. Do not save them if empty.
               @param final_filename Filename to use for final results. Do not save them if empty.
+			  @param writer Writer used to write the files, possibly shared with other savers. If null, use a writer shared by all savers created without one.
              */
-            ObserverResultSaverSimple(const std::string& intermediate_filename, const std::string& final_filename);
+            ObserverResultSaverSimple(const std::string& intermediate_filename, const std::string& final_filename, std::shared_ptr<BackgroundFileWriter> writer = nullptr);
 
 			/** Use the same filename for intermediate and final results. */
 			ObserverResultSaverSimple(const std::string& filename)
@@ -27,9 +31,30 @@ namespace averisera {
             void save_intermediate(const Observer& observer, const ImmutableContext& imm_ctx, Date asof) override;
 
             void save_final(const Observer& observer, const ImmutableContext& imm_ctx) override;
+		protected:
+			const std::string& intermediate_filename() const {
+				return intermediate_filename_;
+			}
+
+			const std::string& final_filename() const {
+				return final_filename_;
+			}
+
+			/** Write content to the final file, appending it if anything was written there before */
+			void write_final(std::string content);
+
+			/** Make write_final() append to the final file, which already has content */
+			void set_final_started() {
+				final_started_ = true;
+			}
+
+			BackgroundFileWriter& writer() {
+				return *writer_;
+			}
         private:
             std::string intermediate_filename_;
             std::string final_filename_;
+			std::shared_ptr<BackgroundFileWriter> writer_;
             std::unordered_set<Date> dates_seen_;
             bool final_started_;
         };
@@ -5,15 +5,17 @@
 #include "../predicate.hpp"
 #include "../person.hpp"
 #include "../population.hpp"
-#include "core/statistics.hpp"
+#include "core/preconditions.hpp"
+#include <boost/format.hpp>
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <sstream>
 
 namespace averisera {
     namespace microsim {
         template <class T, class V> ObserverStats<T, V>::ObserverStats(std::shared_ptr<ObserverResultSaver> result_saver, const std::vector<ObservedQuantity<T>>& variables, std::shared_ptr<const Predicate<T>> predicate, bool calc_medians, unsigned int precision)
-            : Observer(result_saver), _variables(variables), _predicate(predicate), _precision(precision), calc_medians_(calc_medians) {
+            : Observer(result_saver), _variables(variables), _predicate(predicate), _precision(precision), calc_medians_(calc_medians), current_stats_(nullptr), quantile_capacity_(RunningQuantiles<V>::EXACT) {
             if (!predicate) {
                 throw std::domain_error("ObserverStats: null predicate");
             }            
@@ -31,132 +33,276 @@ namespace averisera {
         template <class T, class V> ObserverStats<T, V>::ObserverStats(std::shared_ptr<ObserverResultSaver> result_saver, const std::vector<std::string>& variables, std::shared_ptr<const Predicate<T>> predicate, bool calc_medians, unsigned int precision)
             : ObserverStats(result_saver, to_functions<T>(variables), predicate, calc_medians, precision) {
         }
+
+		template <class T, class V> ObserverStats<T>& ObserverStats<T, V>::add_quantile(double q) {
+			check_that(q >= 0 && q <= 1, "ObserverStats: quantile level outside [0, 1]");
+			quantile_levels_.push_back(q);
+			quantiles_.resize(quantile_levels_.size());
+			return *this;
+		}
+
+		template <class T, class V> ObserverStats<T>& ObserverStats<T, V>::set_quantile_capacity(size_t capacity) {
+			check_that(capacity == RunningQuantiles<V>::EXACT || capacity >= 2, "ObserverStats: quantile estimator capacity must be at least 2");
+			quantile_capacity_ = capacity;
+			return *this;
+		}
             
         template <class T, class V> void ObserverStats<T, V>::observe(const Population& population, const Contexts& ctx) {
-            const Date asof = ctx.asof();            
-			auto stats_it = _stats.find(asof);
-            if (stats_it == _stats.end()) {
-				stats_it = _stats.insert(std::make_pair(asof, RunningStatisticsMulti<V>(_variables.size()))).first;
-            }
-			auto medians_it = medians_.find(asof);
-			if (calc_medians_ && (medians_it == medians_.end())) {
-				medians_it = medians_.insert(std::make_pair(asof, std::vector<V>(_variables.size()))).first;
-			}
-			RunningStatisticsMulti<V>& stats = stats_it->second;
+			begin_pass(ctx);
             const std::vector<std::shared_ptr<T>>& members = population.members<T>();            
-			std::vector<std::shared_ptr<T>> selected_members;
 			for (auto sit = members.begin(); sit != members.end(); ++sit) {
 				if (_predicate->select(**sit, ctx)) {
-					selected_members.push_back(*sit);
+					add_member(**sit, ctx);
 				}
 			}
-			selected_members.shrink_to_fit();
-			const size_t N = selected_members.size();
-			std::vector<V> values(stats.dim());
-			std::vector<std::vector<V>> all_values;
-			if (calc_medians_) {
-				all_values.resize(stats.dim());
-				std::for_each(all_values.begin(), all_values.end(), [N](std::vector<V>& v) { v.reserve(N); });
-			}
-            for (auto sit = selected_members.begin(); sit != selected_members.end(); ++sit) {
-                auto val_it = values.begin();
-				auto all_val_it = all_values.begin();
-                for (auto vit = _variables.begin(); vit != _variables.end(); ++vit, ++val_it) {
-                    assert(val_it != values.end());
-					const V x = (*vit)(**sit, ctx);
-					*val_it = x;
-					if (calc_medians_) {
-						// save value for median calculation
-						all_val_it->push_back(x);
-						++all_val_it;
-					}
-                }
-				val_it = values.begin();
-				for (size_t idx = 0; idx < stats.dim(); ++idx, ++val_it) {
-					assert(val_it != values.end());
-					const V x = *val_it;
-					stats.marginal(idx).add_if_not_nan(x);
-					auto val_it2 = values.begin();
-					for (size_t idx2 = 0; idx2 < idx; ++idx2, ++val_it2) {
-						assert(val_it2 != val_it);
-						stats.covariance(idx, idx2).add_if_not_nan(x, *val_it2);
-					}
+			end_pass(ctx);
+        }
+
+		template <class T, class V> void ObserverStats<T, V>::begin_pass(const Contexts& ctx) {
+			const Date asof = ctx.asof();
+			auto stats_it = _stats.find(asof);
+			if (stats_it == _stats.end()) {
+				stats_it = _stats.insert(std::make_pair(asof, RunningStatisticsMulti<V>(_variables.size()))).first;
+			}
+			current_stats_ = &stats_it->second;
+			values_.resize(current_stats_->dim());
+			sketches_.clear();
+			if (calc_quantiles()) {
+				sketches_.resize(current_stats_->dim(), RunningQuantiles<V>(quantile_capacity_));
+			}
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::add_member(const T& member, const Contexts& ctx) {
+			assert(current_stats_);
+			RunningStatisticsMulti<V>& stats = *current_stats_;
+			auto val_it = values_.begin();
+			for (auto vit = _variables.begin(); vit != _variables.end(); ++vit, ++val_it) {
+				assert(val_it != values_.end());
+				*val_it = (*vit)(member, ctx);
+			}
+			val_it = values_.begin();
+			for (size_t idx = 0; idx < stats.dim(); ++idx, ++val_it) {
+				assert(val_it != values_.end());
+				const V x = *val_it;
+				stats.marginal(idx).add_if_not_nan(x);
+				if (!sketches_.empty()) {
+					sketches_[idx].add_if_not_nan(x);
 				}
-            }
-			if (calc_medians_) {
-				std::vector<V>& medians = medians_it->second;
-				auto dst_it = medians.begin();
-				for (auto src_it = all_values.begin(); src_it != all_values.end(); ++src_it, ++dst_it) {
-					*dst_it = Statistics::median(*src_it);
+				auto val_it2 = values_.begin();
+				for (size_t idx2 = 0; idx2 < idx; ++idx2, ++val_it2) {
+					assert(val_it2 != val_it);
+					stats.covariance(idx, idx2).add_if_not_nan(x, *val_it2);
 				}
 			}
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::end_pass(const Contexts& ctx) {
+			const Date asof = ctx.asof();
+			const auto calc = [asof, this](std::unordered_map<Date, std::vector<V>>& results, double q) {
+				std::vector<V>& values = results[asof];
+				values.resize(sketches_.size());
+				std::transform(sketches_.begin(), sketches_.end(), values.begin(), [q](const RunningQuantiles<V>& sketch) { return sketch.quantile(q); });
+			};
+			if (calc_medians_) {
+				calc(medians_, 0.5);
+			}
+			for (size_t i = 0; i < quantile_levels_.size(); ++i) {
+				calc(quantiles_[i], quantile_levels_[i]);
+			}
+			sketches_.clear();
+			current_stats_ = nullptr;
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::observe_person(const Person& person, const Contexts& ctx) {
+			observe_person_impl(person, ctx, std::is_same<T, Person>());
+		}
+
+        template <class T, class V> void ObserverStats<T, V>::save_results(std::ostream& os, const ImmutableContext& im_ctx) const {
+			date_results_writer(im_ctx, Date(), Date::MAX)(os);
+			save_results_summary(os, im_ctx);
         }
-        
-        template <class T, class V> void ObserverStats<T, V>::save_results(std::ostream& os, const ImmutableContext&) const {
-			//const Schedule& sim_schedule = im_ctx.schedule();
+
+		template <class T, class V> Observer::results_writer_type ObserverStats<T, V>::date_results_writer(const ImmutableContext&, const Date after, const Date until) const {
+			std::vector<DateBlock> blocks;
+			for (auto d : sorted_dates()) {
+				if ((after.is_not_a_date() || d > after) && d <= until) {
+					blocks.push_back(make_date_block(d));
+				}
+			}
+			const bool with_header = after.is_not_a_date();
+			const unsigned int precision = _precision;
+			return [names = variable_names(), blocks = std::move(blocks), with_header, precision](std::ostream& os) {
+				const auto old_precision = os.precision();
+				os.precision(precision);
+				if (with_header) {
+					os << "ObserverStats\n";
+				}
+				for (const auto& block : blocks) {
+					save_date_block(os, names, block);
+				}
+				os.precision(old_precision);
+			};
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::save_results_summary(std::ostream& os, const ImmutableContext&) const {
 			const auto old_precision = os.precision();
 			os.precision(_precision);
-			os << "ObserverStats\n";
+			const std::vector<Date> dates(sorted_dates());
+			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.mean(); }, "MEAN", dates);
+			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.mean() * static_cast<double>(rs.nbr_samples()); }, "SUM", dates);
+			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.standard_deviation(); }, "ST_DEV", dates);
+			save_single_result(os, medians_, "MEDIAN", dates);
+			for (size_t i = 0; i < quantile_levels_.size(); ++i) {
+				std::stringstream ss;
+				ss << "QUANTILE_" << quantile_levels_[i];
+				save_single_result(os, quantiles_[i], ss.str().c_str(), dates);
+			}
+			os.precision(old_precision);
+        }
+
+		template <class T, class V> std::vector<Date> ObserverStats<T, V>::sorted_dates() const {
 			std::vector<Date> dates;
 			dates.reserve(_stats.size());
 			for (const auto& kv : _stats) {
 				dates.push_back(kv.first);
 			}
 			std::sort(dates.begin(), dates.end());
-			std::vector<V> nans(_variables.size(), std::numeric_limits<V>::quiet_NaN());
-			for (auto d: dates) {
-				const auto mit = _stats.find(d);
-				const auto medians_it = medians_.find(d);
-				assert(mit != _stats.end());
-                os << "#MARGINALS " << mit->first << "\n";
-				os << "name\tmean\tstd.dev.\tskew\tkurt.\tmin\tmax\tmedian\n";
-				const RunningStatisticsMulti<V>& sv = mit->second;
-                assert(sv.dim() == _variables.size());
-				const std::vector<V>& medians = calc_medians_ ? medians_it->second : nans;
-                size_t idx = 0;
-                for (auto varit = _variables.begin(); varit != _variables.end(); ++idx, ++varit) {
-					assert(idx < sv.dim());
-					const RunningStatistics<V>& rs = sv.marginal(idx);
-					os << varit->name() << "\t" << rs.mean() << "\t" << rs.standard_deviation() << "\t" << rs.skewness() << "\t" << rs.kurtosis() << "\t" << rs.min() << "\t" << rs.max() << "\t" << medians[idx];
-                    os << "\n";
-                }
-
-                os << "#COVARIANCES " << mit->first << "\n";
-                for (auto varit = _variables.begin(); varit != _variables.end(); ++varit) {
-                    os << "\t" << varit->name();                    
-                }
-                os << "\n";
-				idx = 0;
-				for (auto varit = _variables.begin(); varit != _variables.end(); ++varit, ++idx) {
-					assert(idx < sv.dim());
-					os << varit->name();
-					for (size_t j = 0; j < idx; ++j) {
-						os << "\t" << sv.covariance(idx, j).covariance();
-					}
-					os << "\t" << sv.marginal(idx).variance() << "\n";
+			return dates;
+		}
+
+		template <class T, class V> typename ObserverStats<T, V>::DateBlock ObserverStats<T, V>::make_date_block(const Date d) const {
+			const auto mit = _stats.find(d);
+			assert(mit != _stats.end());
+			const RunningStatisticsMulti<V>& sv = mit->second;
+			DateBlock block;
+			block.date = d;
+			block.marginals.reserve(sv.dim());
+			block.covariances.resize(sv.dim());
+			for (size_t i = 0; i < sv.dim(); ++i) {
+				block.marginals.push_back(sv.marginal(i));
+				for (size_t j = 0; j < i; ++j) {
+					block.covariances[i].push_back(sv.covariance(i, j));
 				}
+			}
+			const auto medians_it = medians_.find(d);
+			if (medians_it != medians_.end()) {
+				block.medians = medians_it->second;
+			}
+			return block;
+		}
+
+		template <class T, class V> std::vector<std::string> ObserverStats<T, V>::variable_names() const {
+			std::vector<std::string> names;
+			names.reserve(_variables.size());
+			for (const auto& variable : _variables) {
+				names.push_back(variable.name());
+			}
+			return names;
+		}
 
-				os << "#CORRELATIONS " << mit->first << "\n";
-				for (auto varit = _variables.begin(); varit != _variables.end(); ++varit) {
-					os << "\t" << varit->name();
+		template <class T, class V> void ObserverStats<T, V>::save_state(std::ostream& os) const {
+			const std::vector<Date> dates(sorted_dates());
+			write_binary(os, static_cast<uint64_t>(dates.size()));
+			for (auto d : dates) {
+				write_binary_date(os, d);
+				_stats.find(d)->second.save(os);
+			}
+			save_results_state(os, medians_);
+			write_binary(os, static_cast<uint64_t>(quantiles_.size()));
+			for (const auto& results : quantiles_) {
+				save_results_state(os, results);
+			}
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::load_state(std::istream& is) {
+			std::unordered_map<Date, RunningStatisticsMulti<V>> stats;
+			const uint64_t nbr_dates = read_binary<uint64_t>(is);
+			for (uint64_t i = 0; i < nbr_dates; ++i) {
+				const Date d = read_binary_date(is);
+				RunningStatisticsMulti<V> date_stats;
+				date_stats.load(is);
+				if (date_stats.dim() != _variables.size()) {
+					throw std::runtime_error("ObserverStats: saved state has a different number of variables");
 				}
-				os << "\n";
-				idx = 0;
-				for (auto varit = _variables.begin(); varit != _variables.end(); ++varit, ++idx) {
-					assert(idx < sv.dim());
-					os << varit->name();
-					for (size_t j = 0; j < idx; ++j) {
-						os << "\t" << sv.covariance(idx, j).correlation();
-					}
-					os << "\t1.0\n";
+				stats.insert(std::make_pair(d, std::move(date_stats)));
+			}
+			std::unordered_map<Date, std::vector<V>> medians(load_results_state(is));
+			if (read_binary<uint64_t>(is) != quantile_levels_.size()) {
+				throw std::runtime_error("ObserverStats: saved state has a different number of quantile levels");
+			}
+			std::vector<std::unordered_map<Date, std::vector<V>>> quantiles;
+			quantiles.reserve(quantile_levels_.size());
+			for (size_t i = 0; i < quantile_levels_.size(); ++i) {
+				quantiles.push_back(load_results_state(is));
+			}
+			_stats.swap(stats);
+			medians_.swap(medians);
+			quantiles_.swap(quantiles);
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::save_results_state(std::ostream& os, const std::unordered_map<Date, std::vector<V>>& results) {
+			write_binary(os, static_cast<uint64_t>(results.size()));
+			for (const auto& kv : results) {
+				write_binary_date(os, kv.first);
+				write_binary(os, kv.second);
+			}
+		}
+
+		template <class T, class V> std::unordered_map<Date, std::vector<V>> ObserverStats<T, V>::load_results_state(std::istream& is) const {
+			std::unordered_map<Date, std::vector<V>> results;
+			const uint64_t nbr_dates = read_binary<uint64_t>(is);
+			for (uint64_t i = 0; i < nbr_dates; ++i) {
+				const Date d = read_binary_date(is);
+				std::vector<V>& values = results[d];
+				read_binary(is, values);
+				if (values.size() != _variables.size()) {
+					throw std::runtime_error("ObserverStats: saved state has a different number of variables");
 				}
+			}
+			return results;
+		}
+
+		template <class T, class V> void ObserverStats<T, V>::save_date_block(std::ostream& os, const std::vector<std::string>& names, const DateBlock& block) {
+			const std::vector<V> nans(names.size(), std::numeric_limits<V>::quiet_NaN());
+            os << "#MARGINALS " << block.date << "\n";
+			os << "name\tmean\tstd.dev.\tskew\tkurt.\tmin\tmax\tmedian\n";
+            assert(block.marginals.size() == names.size());
+			const std::vector<V>& medians = block.medians.empty() ? nans : block.medians;
+            size_t idx = 0;
+            for (auto varit = names.begin(); varit != names.end(); ++idx, ++varit) {
+				const RunningStatistics<V>& rs = block.marginals[idx];
+				os << *varit << "\t" << rs.mean() << "\t" << rs.standard_deviation() << "\t" << rs.skewness() << "\t" << rs.kurtosis() << "\t" << rs.min() << "\t" << rs.max() << "\t" << medians[idx];
+                os << "\n";
             }
-			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.mean(); }, "MEAN", dates);
-			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.mean() * static_cast<double>(rs.nbr_samples()); }, "SUM", dates);
-			save_single_result(os, [](const RunningStatistics<V>& rs) { return rs.standard_deviation(); }, "ST_DEV", dates);
-			save_single_result(os, medians_, "MEDIAN", dates);
-			os.precision(old_precision);
-        }
+
+            os << "#COVARIANCES " << block.date << "\n";
+            for (auto varit = names.begin(); varit != names.end(); ++varit) {
+                os << "\t" << *varit;
+            }
+            os << "\n";
+			idx = 0;
+			for (auto varit = names.begin(); varit != names.end(); ++varit, ++idx) {
+				os << *varit;
+				for (size_t j = 0; j < idx; ++j) {
+					os << "\t" << block.covariances[idx][j].covariance();
+				}
+				os << "\t" << block.marginals[idx].variance() << "\n";
+			}
+
+			os << "#CORRELATIONS " << block.date << "\n";
+			for (auto varit = names.begin(); varit != names.end(); ++varit) {
+				os << "\t" << *varit;
+			}
+			os << "\n";
+			idx = 0;
+			for (auto varit = names.begin(); varit != names.end(); ++varit, ++idx) {
+				os << *varit;
+				for (size_t j = 0; j < idx; ++j) {
+					os << "\t" << block.covariances[idx][j].correlation();
+				}
+				os << "\t1.0\n";
+			}
+		}
 
 		template <class T, class V> template <class Functor> void ObserverStats<T, V>::save_single_result(std::ostream& os, Functor f, const char* result_name, const std::vector<Date>& dates) const {
 			os << "#" << result_name << "\n";
@@ -5,14 +5,17 @@
 #include "../observer.hpp"
 #include "observed_quantity.hpp"
 #include "core/dates_fwd.hpp"
+#include "core/running_quantiles.hpp"
 #include "core/running_statistics_multi.hpp"
 #include <functional>
 #include <memory>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 namespace averisera {
     namespace microsim {
+        class Person;
         template <class T> class Predicate;
 
         /** Observer which gathers statistics about particular type of members of the Population 
@@ -22,7 +25,7 @@ namespace averisera {
             /*
               @param[in] variables Vector of observed variables (functions which take a reference to the member of Population and Contextx and return a value)
               @param[in] predicate Selects members to be included in the statistics
-			  @param[in] calc_medians Calculate and save medians of observed variables 
+			  @param[in] calc_medians Calculate and save medians of observed variables (exact unless set_quantile_capacity() is called)
               @param[in] precision Precision of outputs in digits
               @throw std::domain_error If any of the pointers is null
             */
@@ -41,10 +44,54 @@ namespace averisera {
 			ObserverStats<T>& add_variable(const std::string& variable) {
 				return add_variable(ObservedQuantity<T>::last_as_double(variable));
 			}
+
+			/** Calculate and save the q-th quantile of each observed variable.
+			@throw std::domain_error If q is outside [0, 1]
+			*/
+			ObserverStats<T>& add_quantile(double q);
+
+			/** Set the compactor capacity of the quantile estimators used for medians and quantiles (see RunningQuantiles). By default
+			(RunningQuantiles::EXACT) all values are kept and the results are exact. Otherwise they are exact if there are fewer selected members
+			than capacity, and have a rank error of the order of log2(N / capacity) / capacity above that.
+			NaN values are skipped; if no member has a value, the median and quantiles are NaN.
+			@throw std::domain_error If capacity is 1
+			*/
+			ObserverStats<T>& set_quantile_capacity(size_t capacity);
             
             void observe(const Population& population, const Contexts& ctx) override;
 
+			bool is_single_pass() const override {
+				return std::is_same<T, Person>::value;
+			}
+
+			void begin_pass(const Contexts& ctx) override;
+
+			/** The predicate selecting members, if they are persons */
+			const Predicate<Person>* pass_predicate() const override {
+				return person_predicate(_predicate.get());
+			}
+
+			/** Adds the person to the statistics without checking the predicate */
+			void observe_person(const Person& person, const Contexts& ctx) override;
+
+			void end_pass(const Contexts& ctx) override;
+
             void save_results(std::ostream& os, const ImmutableContext& im_ctx) const override;
+
+			bool has_date_results() const override {
+				return true;
+			}
+
+			/** Writes marginals, covariances and correlations for each date */
+			results_writer_type date_results_writer(const ImmutableContext& im_ctx, Date after, Date until) const override;
+
+			/** Saves the means, sums, standard deviations, medians and quantiles of all dates */
+			void save_results_summary(std::ostream& os, const ImmutableContext& im_ctx) const override;
+
+			/** Saves statistics, medians and quantiles for all observed dates */
+			void save_state(std::ostream& os) const override;
+
+			void load_state(std::istream& is) override;
         private:
 			std::vector<ObservedQuantity<T>> _variables;
             std::shared_ptr<const Predicate<T>> _predicate;
@@ -52,6 +99,58 @@ namespace averisera {
 			std::unordered_map<Date, std::vector<V>> medians_;
             unsigned int _precision;            
 			bool calc_medians_;
+			RunningStatisticsMulti<V>* current_stats_; /**< Statistics for the date being observed */
+			std::vector<V> values_; /**< Buffer for the values of the observed member */
+			std::vector<double> quantile_levels_; /**< Levels of quantiles to calculate in addition to medians */
+			std::vector<std::unordered_map<Date, std::vector<V>>> quantiles_; /**< Values of quantiles for each level */
+			size_t quantile_capacity_;
+			std::vector<RunningQuantiles<V>> sketches_; /**< Quantile estimators for each variable */
+
+			bool calc_quantiles() const {
+				return calc_medians_ || !quantile_levels_.empty();
+			}
+
+			/** Add the member to the statistics */
+			void add_member(const T& member, const Contexts& ctx);
+
+			template <class P> void observe_person_impl(const P& person, const Contexts& ctx, std::true_type) {
+				add_member(person, ctx);
+			}
+
+			static const Predicate<Person>* person_predicate(const Predicate<Person>* predicate) {
+				return predicate;
+			}
+
+			template <class P> static const Predicate<Person>* person_predicate(const P*) {
+				return nullptr;
+			}
+
+			template <class P> void observe_person_impl(const P& person, const Contexts& ctx, std::false_type) {
+				Observer::observe_person(person, ctx);
+			}
+
+			/** Results for a single date, copied by date_results_writer() */
+			struct DateBlock {
+				Date date;
+				std::vector<RunningStatistics<V>> marginals;
+				std::vector<std::vector<RunningCovariance<V>>> covariances; /**< covariances[i][j] for j < i */
+				std::vector<V> medians; /**< Empty if not calculated */
+			};
+
+			DateBlock make_date_block(Date d) const;
+
+			/** Dates with statistics, in ascending order */
+			std::vector<Date> sorted_dates() const;
+
+			std::vector<std::string> variable_names() const;
+
+			static void save_results_state(std::ostream& os, const std::unordered_map<Date, std::vector<V>>& results);
+
+			/** @throw std::runtime_error If the number of values for any date differs from the number of variables */
+			std::unordered_map<Date, std::vector<V>> load_results_state(std::istream& is) const;
+
+			/** Save marginals, covariances and correlations for a single date */
+			static void save_date_block(std::ostream& os, const std::vector<std::string>& names, const DateBlock& block);
 
 			template <class Functor> void save_single_result(std::ostream& os, Functor f, const char* result_name, const std::vector<Date>& dates) const;
 
@@ -2,17 +2,22 @@
 #ifndef __AVERISERA_MS_OPERATOR_H
 #define __AVERISERA_MS_OPERATOR_H
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <string>
+#include "actor_span.hpp"
 #include "contexts.hpp"
 #include "feature.hpp"
 #include "feature_provider.hpp"
 #include "history_generator.hpp"
 #include "history_user.hpp"
 #include "microsim-core/schedule.hpp"
+#include "core/rng_philox.hpp"
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
         
         class Contexts;
@@ -72,6 +77,45 @@ namespace averisera {
              */
             virtual void apply(const std::vector<std::shared_ptr<T>>& selected, const Contexts& contexts) const = 0;
 
+			/** Function returning the random number stream for i-th selected object */
+			typedef std::function<RNGPhilox(size_t)> stream_factory_t;
+
+			/** Act on selected objects, possibly using the thread pool. Parallel implementations must draw random numbers for i-th object
+			only from make_stream(i), so that results do not depend on the number of threads.
+			Default implementation calls apply(selected, contexts) in the calling thread.
+			@param selected A non-empty vector
+			@param contexts Contexts.
+			@param pool Thread pool
+			@param make_stream Random number stream factory, called concurrently.
+			@throw std::domain_error If any pointer in selected is null.
+			*/
+			virtual void apply_parallel(const std::vector<std::shared_ptr<T>>& selected, const Contexts& contexts, ThreadPool& /*pool*/, const stream_factory_t& /*make_stream*/) const {
+				apply(selected, contexts);
+			}
+
+			/** Act on selected objects passed as a non-owning span, without copying the shared pointers. Invoked by Simulator.
+			Default implementation copies them into a vector and calls apply(const std::vector<std::shared_ptr<T>>&, const Contexts&).
+			@param selected A non-empty span
+			@see apply(const std::vector<std::shared_ptr<T>>&, const Contexts&)
+			*/
+			virtual void apply_span(ActorSpan<T> selected, const Contexts& contexts) const {
+				apply(selected.to_vector(), contexts);
+			}
+
+			/** Parallel version of apply_span(). Default implementation copies selected into a vector and calls apply_parallel().
+			@see apply_parallel(const std::vector<std::shared_ptr<T>>&, const Contexts&, ThreadPool&, const stream_factory_t&)
+			*/
+			virtual void apply_span_parallel(ActorSpan<T> selected, const Contexts& contexts, ThreadPool& pool, const stream_factory_t& make_stream) const {
+				apply_parallel(selected.to_vector(), contexts, pool, make_stream);
+			}
+
+			/** Whether applying the operator to an object reads or modifies other objects linked to it (e.g. the mother of a Person).
+			Such operators cannot be applied to two populations concurrently (see Simulator::set_concurrent_emigrant_step). Defaults to false.
+			*/
+			virtual bool accesses_relatives() const {
+				return false;
+			}
+
 			bool is_active(Date date) const {
 				return active(date) && predicate().active(date);
 			}
@@ -18,11 +18,11 @@ namespace averisera {
 
         Mortality::Mortality(const HazardModel& hazard_model, const std::vector<std::shared_ptr<const RelativeRisk<Person>>>& relative_risks, std::shared_ptr<const Predicate<Person>> predicate, std::unique_ptr<Schedule>&& schedule, bool move_to_birth_date)
 			: OperatorHazardModel<Person>(CommonFeatures::MORTALITY(), Utils::pass_through(hazard_model, [&hazard_model]() { check_dim(hazard_model); }), relative_risks, predicate, std::move(schedule)),
-			_move_to_birth_date(move_to_birth_date) {            			
+			_move_to_birth_date(move_to_birth_date), _hazard_model_cache(HAZARD_MODEL_CACHE_SIZE) {
         }
 
 		Mortality::Mortality(HazardModel&& hazard_model, std::vector<std::shared_ptr<const RelativeRisk<Person>>>&& relative_risks, std::shared_ptr<const Predicate<Person>> predicate, std::unique_ptr<Schedule>&& schedule, bool move_to_birth_date)
-			: OperatorHazardModel<Person>(CommonFeatures::MORTALITY(), std::move(Utils::pass_through(hazard_model, [&hazard_model]() { check_dim(hazard_model); })), std::move(relative_risks), predicate, std::move(schedule)), _move_to_birth_date(move_to_birth_date) {
+			: OperatorHazardModel<Person>(CommonFeatures::MORTALITY(), std::move(Utils::pass_through(hazard_model, [&hazard_model]() { check_dim(hazard_model); })), std::move(relative_risks), predicate, std::move(schedule)), _move_to_birth_date(move_to_birth_date), _hazard_model_cache(HAZARD_MODEL_CACHE_SIZE) {
 		}
 
 		Mortality::state_t Mortality::current_state(const Person& person, const Contexts& ctx) const {
@@ -35,9 +35,12 @@ namespace averisera {
             } // else do nothing
         }
 
-		std::unique_ptr<HazardModel> Mortality::adapt_hazard_model(const Person& obj) const {
+		const size_t Mortality::HAZARD_MODEL_CACHE_SIZE;
+
+		std::shared_ptr<const HazardModel> Mortality::adapt_hazard_model(const Person& obj) const {
 			if (_move_to_birth_date) {
-				return std::unique_ptr<HazardModel>(new HazardModel(hazard_model().move(obj.date_of_birth())));
+				const Date dob = obj.date_of_birth();
+				return _hazard_model_cache.get(dob, [this, dob]() { return std::make_shared<const HazardModel>(hazard_model().move(dob)); });
 			} else {
 				return nullptr;
 			}
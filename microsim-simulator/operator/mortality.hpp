@@ -4,6 +4,7 @@
 
 #include "../person.hpp"
 #include "operator_hazard_model.hpp"
+#include "core/bounded_object_cache.hpp"
 
 namespace averisera {
 	class CSVFileReader;
@@ -43,12 +44,22 @@ namespace averisera {
 			@param predicate Predicate AND-ed with the year of birth predicate for each curve
 			@throw std::domain_error If any mortality curve is null */
 			static std::vector<std::unique_ptr<Mortality>> build_operators(std::vector<std::unique_ptr<AnchoredHazardCurve>>&& mortality_curves, const Schedule* schedule, const std::shared_ptr<const Predicate<Person>>& predicate);
+
+			/** Cache of hazard models moved to birth dates */
+			const BoundedObjectCache<const HazardModel, Date>& hazard_model_cache() const {
+				return _hazard_model_cache;
+			}
+
+			/** Maximum number of birth dates for which moved hazard models are cached. Covers every birth date in a range of 89 years, so that the cache does not thrash
+			when a single operator is applied to the whole population. */
+			static const size_t HAZARD_MODEL_CACHE_SIZE = 32768;
         private:
             state_t current_state(const Person& person, const Contexts& ctx) const override;
             void set_next_state(Person& person, Date date, state_t state, const Contexts& ctx) const override;
-			std::unique_ptr<HazardModel> adapt_hazard_model(const Person& obj) const override;
+			std::shared_ptr<const HazardModel> adapt_hazard_model(const Person& obj) const override;
 
 			bool _move_to_birth_date;
+			mutable BoundedObjectCache<const HazardModel, Date> _hazard_model_cache;
         };
     }
 }
@@ -30,7 +30,7 @@ namespace averisera {
 			: OperatorBirth(make_sex_age_predicate(min_childbearing_age, max_childbearing_age)) {}
         
         void OperatorBirth::apply(const std::shared_ptr<Person>& obj, const Contexts& contexts) const {
-            const auto hist_idx = obj->get_variable_index(contexts, Procreation::PREGNANCY_EVENT());
+            const auto hist_idx = obj->get_variable_index(contexts, Procreation::PREGNANCY_EVENT_HANDLE());
             const ImmutableHistory& history = obj->history(hist_idx);
             const SchedulePeriod sp = contexts.current_period();
             unsigned int prev_nbr_children = obj->nbr_children();
@@ -24,15 +24,20 @@ namespace averisera {
 			_pred(predicate_for_operator(external_predicate, min_childbearing_age, max_childbearing_age)),
 			_schedule(std::move(schedule)),
 			min_childbearing_age_(min_childbearing_age),
-			zero_fertility_period_(zero_fertility_period)
+			zero_fertility_period_(zero_fertility_period),
+			hazard_model_cache_(HAZARD_MODEL_CACHE_SIZE)
 		{
 			check_greater_or_equal(max_childbearing_age, min_childbearing_age, "OperatorConception: max childbearing age should be greater or equal min childbearing age");
 			check_greater_or_equal(zero_fertility_period.size, 0);
         }
 
+		const size_t OperatorConception::HAZARD_MODEL_CACHE_SIZE;
+
         void OperatorConception::apply(const std::shared_ptr<Person>& obj, const Contexts& ctx) const {
             assert(!_schedule || ctx.immutable_ctx().schedule().contains(*_schedule));
-            const HazardModel hazard_model(_conception.hazard_model(obj->date_of_birth()));
+			const Date dob = obj->date_of_birth();
+			const std::shared_ptr<const HazardModel> hazard_model_ptr(hazard_model_cache_.get(dob, [this, dob]() { return std::make_shared<const HazardModel>(_conception.hazard_model(dob)); }));
+            const HazardModel& hazard_model = *hazard_model_ptr;
             const SchedulePeriod sp = Operator<Person>::current_period(_schedule, ctx);
             // we begin by assuming that the Person is not pregnant
             bool conceived = false;
@@ -74,7 +79,7 @@ namespace averisera {
                 const auto& multiplicity_distro = _conception.multiplicity(date.year(), age);
                 const Conception::multiplicity_type multiplicity = multiplicity_distro.random(ctx.mutable_ctx().rng());
 				LOG_TRACE() << "OperatorConception: person of age " << age << " and ethnicity " << ctx.immutable_ctx().ethnicity_conversions().name(obj->ethnicity()) << " conceived with multiplicity " << int(multiplicity) << " on " << date << ", sim date " << ctx.asof();
-				const auto hist_idx = obj->get_variable_index(ctx, Procreation::CONCEPTION());
+				const auto hist_idx = obj->get_variable_index(ctx, Procreation::CONCEPTION_HANDLE());
 				History& history = obj->history(hist_idx);
 				const auto value = MathUtils::safe_cast<History::int_t>(multiplicity);
 				if (history.empty() || (history.last_date() < date)) {
@@ -112,7 +117,7 @@ namespace averisera {
 			check_greater_or_equal(zero_fertility_period.size, 0);
 			Date date = (obj->date_of_birth() + Period::years(min_childbearing_age)) - Period::months(Pregnancy::PREGNANCY_IN_MONTHS);
 			if (zero_fertility_period.size != 0) {
-				const auto hist_idx = obj->get_variable_index(ctx, Procreation::PREGNANCY_EVENT());
+				const auto hist_idx = obj->get_variable_index(ctx, Procreation::PREGNANCY_EVENT_HANDLE());
 				const ImmutableHistory& history = obj->history(hist_idx);
 				if (!history.empty()) {
 					const Pregnancy::Event evt = static_cast<Pregnancy::Event>(history.last_as_int());
@@ -7,6 +7,7 @@
 #include "../history_user_simple.hpp"
 #include "../operator_individual.hpp"
 #include "microsim-core/conception.hpp"
+#include "core/bounded_object_cache.hpp"
 #include "core/period.hpp"
 #include <memory>
 #include <vector>
@@ -44,6 +45,10 @@ namespace averisera {
             
             void apply(const std::shared_ptr<Person>& obj, const Contexts& contexts) const override;
 
+			bool is_parallelisable() const override {
+				return true;
+			}
+
             bool active(Date date) const override {
                 return Operator<Person>::active(_schedule, date);
             }
@@ -67,6 +72,15 @@ namespace averisera {
 				return str;
 			}
 
+			/** Cache of hazard models for birth dates */
+			const BoundedObjectCache<const HazardModel, Date>& hazard_model_cache() const {
+				return hazard_model_cache_;
+			}
+
+			/** Maximum number of birth dates for which hazard models are cached. Covers every birth date in a range of 89 years, so that the cache does not thrash
+			when a single operator is applied to the whole population. */
+			static const size_t HAZARD_MODEL_CACHE_SIZE = 32768;
+
 			/** Calculate first date when conception can happen */
 			static Date calc_first_conception_date_allowed(const std::shared_ptr<Person>& obj, const Contexts& ctx, unsigned int min_childbearing_age, Period zero_fertility_period);
         private:			
@@ -80,6 +94,7 @@ namespace averisera {
 			unsigned int min_childbearing_age_;
 			unsigned int max_childbearing_age_;
 			Period zero_fertility_period_;
+			mutable BoundedObjectCache<const HazardModel, Date> hazard_model_cache_;
 
 			static std::shared_ptr<const Predicate<Person>> predicate_for_history_generator();
 
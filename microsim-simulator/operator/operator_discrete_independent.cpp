@@ -24,10 +24,14 @@ namespace averisera {
 			pred_(predicate), 
 			name_(std::string("DiscreteIndependent_") + feature),
 			feature_(feature),
+			feature_handle_(feature),
 			initialise_(initialise),
 			percentile_variable_name_(percentile_variable_name)
 		{			
 			check_that(pred_ != nullptr, "OperatorDiscreteIndependent: null predicate");
+			if (!percentile_variable_name.empty()) {
+				percentile_variable_handle_.reset(new VariableHandle(percentile_variable_name));
+			}
 			schedule_ = std::move(schedule);
 			LOG_TRACE() << "OperatorDiscreteIndependent: constructor";
 		}
@@ -66,7 +70,7 @@ namespace averisera {
 				assert(ctx.immutable_ctx().schedule().contains(*schedule_));
 			}
 
-			const auto hist_idx = person->get_variable_index(ctx, feature_);
+			const auto hist_idx = person->get_variable_index(ctx, feature_handle_);
 			History& history = person->history(hist_idx);
 			const Date asof = ctx.asof();
 			if (initialise_ && history.empty()) {
@@ -101,8 +105,8 @@ namespace averisera {
 		}
 
 		template <class S> void OperatorDiscreteIndependent<S>::append_percentile(const std::shared_ptr<Person>& person, const Contexts& ctx, Date asof, double p) const {
-			assert(!percentile_variable_name_.empty());
-			History& percentile_history = person->history(ctx.immutable_ctx(), percentile_variable_name_);
+			assert(percentile_variable_handle_);
+			History& percentile_history = person->history(ctx.immutable_ctx(), *percentile_variable_handle_);
 			percentile_history.append(asof, p);
 		}
 
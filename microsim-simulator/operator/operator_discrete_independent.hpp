@@ -7,6 +7,7 @@
 #include "../history_generator_simple.hpp"
 #include "../history_user_simple.hpp"
 #include "../operator_individual.hpp"
+#include "../variable_handle.hpp"
 #include "microsim-core/cohort.hpp"
 #include "microsim-core/stitched_markov_model_with_schedule.hpp"
 #include <string>
@@ -89,8 +90,10 @@ namespace averisera {
 			std::shared_ptr<const Predicate<Person>> pred_;
 			std::string name_;
 			std::string feature_;
+			VariableHandle feature_handle_;
 			bool initialise_;
 			std::string percentile_variable_name_;
+			std::unique_ptr<const VariableHandle> percentile_variable_handle_; /**< Null if percentile_variable_name_ is empty */
 			std::unique_ptr<Schedule> schedule_;
 
 			typedef typename StitchedMarkovModelWithSchedule<S>::state_type state_type;
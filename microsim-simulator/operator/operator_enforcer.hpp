@@ -4,6 +4,7 @@
 
 #include "../history_generator_simple.hpp"
 #include "../operator.hpp"
+#include "../variable_handle.hpp"
 #include "microsim-core/schedule.hpp"
 #include <memory>
 //#include <type_traits>
@@ -55,7 +56,7 @@ namespace averisera {
 			}
         private:
 			HistoryGeneratorSimple<T> hist_gen_;
-            std::string _variable;
+            VariableHandle _variable;
             std::shared_ptr<const Predicate<T>> _predicate;            
             std::vector<std::shared_ptr<const Distribution>> _distributions;
             std::unique_ptr<Schedule> _schedule;
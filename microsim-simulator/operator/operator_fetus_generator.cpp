@@ -49,7 +49,7 @@ namespace averisera {
 			if (start_date >= sp.end) {
 				return;
 			}
-			const auto hist_idx = mother->get_variable_index(contexts, Procreation::CONCEPTION());
+			const auto hist_idx = mother->get_variable_index(contexts, Procreation::CONCEPTION_HANDLE());
             const ImmutableHistory& history = mother->history(hist_idx);
 			const auto hist_size = history.size();
 			if (!hist_size || history.last_date() < start_date) {
@@ -75,9 +75,9 @@ namespace averisera {
 						try {
 							mother->add_fetus(fetus);
 						} catch (std::logic_error& e) {
-							const auto pregn_hist_idx = mother->get_variable_index(contexts, Procreation::PREGNANCY_EVENT());
+							const auto pregn_hist_idx = mother->get_variable_index(contexts, Procreation::PREGNANCY_EVENT_HANDLE());
 							const ImmutableHistory& pregn_hist = mother->history(pregn_hist_idx);
-							const auto conc_hist_idx = mother->get_variable_index(contexts, Procreation::CONCEPTION());
+							const auto conc_hist_idx = mother->get_variable_index(contexts, Procreation::CONCEPTION_HANDLE());
 							const ImmutableHistory& conc_hist = mother->history(conc_hist_idx);
 							LOG_ERROR() << "OperatorFetusGenerator: problem with adding fetus conceived on " << conception_date << " in period from " << start_date << " to " << sp.end << " with pregnancy history " << pregn_hist.as_string() << " and conception history " << conc_hist.as_string() << " as of " << contexts.asof();
 							throw e;
@@ -6,7 +6,10 @@
 #include "microsim-core/hazard_model.hpp"
 #include "../relative_risk.hpp"
 #include "../relative_risk_factory.hpp"
+#include <algorithm>
 #include <cassert>
+#include <functional>
+#include <numeric>
 #include <set>
 #include <stdexcept>
 #include <string>
@@ -35,8 +38,24 @@ namespace averisera {
                 return *_pred;
             }
             
+            using OperatorIndividual<T>::apply;
+
             void apply(const std::shared_ptr<T>& obj, const Contexts& contexts) const override;
 
+			/** If is_parallelisable() returns true, calculate the transition probabilities for the first step in batches. */
+			void apply_span(ActorSpan<T> selected, const Contexts& contexts) const override;
+
+			/** If is_parallelisable() returns true, process batches of objects concurrently, calculating the transition probabilities and jump dates
+			for the first step of each batch at once.
+			@see OperatorIndividual::apply_span_parallel
+			*/
+			void apply_span_parallel(ActorSpan<T> selected, const Contexts& contexts, ThreadPool& pool, const typename Operator<T>::stream_factory_t& make_stream) const override;
+
+			/** Derived classes whose set_next_state() modifies other objects than obj must return false. */
+			bool is_parallelisable() const override {
+				return true;
+			}
+
             bool active(Date date) const override {
                 return Operator<T>::active(_schedule, date);
             }
@@ -50,11 +69,21 @@ namespace averisera {
             virtual state_t current_state(const T& obj, const Contexts& ctx) const = 0;
             /** Set the next state */
             virtual void set_next_state(T& obj, Date date, state_t state, const Contexts& ctx) const = 0;
-			/** If returns null, use _hazard_model */
-			virtual std::unique_ptr<HazardModel> adapt_hazard_model(const T& /*obj*/) const {
+			/** If returns null, use _hazard_model. Returned model may be shared between objects. */
+			virtual std::shared_ptr<const HazardModel> adapt_hazard_model(const T& /*obj*/) const {
 				return nullptr;
 			}
             
+			/** Apply the operator to objs[0], ..., objs[objs.size() - 1]. If streams is not null, i-th object draws random numbers from streams[i], otherwise
+			from contexts.mutable_ctx().rng() in the order of objects.
+			*/
+			void apply_batch(ActorSpan<T> objs, const Contexts& contexts, RNGPhilox* streams) const;
+
+			/** Run the transition loop for obj starting from given state and date */
+			void run(T& obj, const HazardModel& hm, const SchedulePeriod& sp, state_t state, Date date, const Contexts& contexts) const;
+
+			static const size_t BATCH_SIZE = 512; /**< Number of objects processed together in apply_batch() */
+
             HazardModel _hazard_model;
             std::vector<std::shared_ptr<const RelativeRisk<T>>> _relative_risks;
             std::shared_ptr<const Predicate<T>> _pred;
@@ -84,14 +113,19 @@ namespace averisera {
 			_schedule = std::move(schedule);
 		}
         
+		template <class T> const size_t OperatorHazardModel<T>::BATCH_SIZE;
+
         template <class T> void OperatorHazardModel<T>::apply(const std::shared_ptr<T>& objptr, const Contexts& contexts) const {
             assert(!_schedule || contexts.immutable_ctx().schedule().contains(*_schedule));
             T& obj = *objptr;
-            Date date = contexts.asof(); //
             const SchedulePeriod sp = Operator<T>::current_period(_schedule, contexts);            
-            unsigned int state = current_state(obj, contexts);            
-			const std::unique_ptr<HazardModel> adapted_hazard_model(adapt_hazard_model(obj));
+            const state_t state = current_state(obj, contexts);            
+			const std::shared_ptr<const HazardModel> adapted_hazard_model(adapt_hazard_model(obj));
 			const HazardModel& hm = adapted_hazard_model ? *adapted_hazard_model : _hazard_model;
+			run(obj, hm, sp, state, contexts.asof(), contexts);
+        }
+
+		template <class T> void OperatorHazardModel<T>::run(T& obj, const HazardModel& hm, const SchedulePeriod& sp, state_t state, Date date, const Contexts& contexts) const {
             while (date < sp.end) {
                 const RelativeRiskValue rrv = (*(_relative_risks[state]))(obj, contexts);
                 const HazardRateMultiplier hazard_rate_multiplier = hm.calc_hazard_rate_multiplier(state, rrv);
@@ -105,6 +139,139 @@ namespace averisera {
                 date = jump_date;
             }
         }
+
+		template <class T> void OperatorHazardModel<T>::apply_span(const ActorSpan<T> selected, const Contexts& contexts) const {
+			if (!this->is_parallelisable()) {
+				// objects may depend on each other, keep the original order of evaluation
+				OperatorIndividual<T>::apply_span(selected, contexts);
+				return;
+			}
+			for (size_t begin = 0; begin < selected.size(); begin += BATCH_SIZE) {
+				apply_batch(selected.subspan(begin, std::min(BATCH_SIZE, selected.size() - begin)), contexts, nullptr);
+			}
+		}
+
+		template <class T> void OperatorHazardModel<T>::apply_span_parallel(const ActorSpan<T> selected, const Contexts& contexts, ThreadPool& pool, const typename Operator<T>::stream_factory_t& make_stream) const {
+			if (!this->is_parallelisable()) {
+				OperatorIndividual<T>::apply_span(selected, contexts);
+				return;
+			}
+			const size_t nbr_batches = (selected.size() + BATCH_SIZE - 1) / BATCH_SIZE;
+			pool.for_each_index(nbr_batches, [this, selected, &contexts, &make_stream](size_t batch_idx) {
+				const size_t begin = batch_idx * BATCH_SIZE;
+				const size_t n = std::min(BATCH_SIZE, selected.size() - begin);
+				std::vector<RNGPhilox> streams;
+				streams.reserve(n);
+				for (size_t i = 0; i < n; ++i) {
+					streams.push_back(make_stream(begin + i));
+				}
+				apply_batch(selected.subspan(begin, n), contexts, streams.data());
+			});
+		}
+
+		template <class T> void OperatorHazardModel<T>::apply_batch(const ActorSpan<T> objs, const Contexts& contexts, RNGPhilox* streams) const {
+			assert(!_schedule || contexts.immutable_ctx().schedule().contains(*_schedule));
+			const size_t n = objs.size();
+			for (size_t i = 0; i < n; ++i) {
+				if (!objs[i]) {
+					throw std::domain_error("OperatorHazardModel: null pointer");
+				}
+			}
+			const Date date = contexts.asof();
+			const SchedulePeriod sp = Operator<T>::current_period(_schedule, contexts);
+			if (!(date < sp.end)) {
+				return;
+			}
+			std::vector<state_t> states(n);
+			std::vector<std::shared_ptr<const HazardModel>> adapted_hazard_models(n);
+			std::vector<const HazardModel*> models(n);
+			std::vector<HazardRateMultiplier> hazard_rate_multipliers(n);
+			for (size_t i = 0; i < n; ++i) {
+				const T& obj = *objs[i];
+				states[i] = current_state(obj, contexts);
+				adapted_hazard_models[i] = adapt_hazard_model(obj);
+				models[i] = adapted_hazard_models[i] ? adapted_hazard_models[i].get() : &_hazard_model;
+				const RelativeRiskValue rrv = (*(_relative_risks[states[i]]))(obj, contexts);
+				hazard_rate_multipliers[i] = models[i]->calc_hazard_rate_multiplier(states[i], rrv);
+			}
+
+			// group objects sharing the hazard model and the state, so that each group is evaluated in one call
+			std::vector<size_t> order(n);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(), [&models, &states](size_t a, size_t b) {
+				return std::less<const HazardModel*>()(models[a], models[b]) || (models[a] == models[b] && states[a] < states[b]);
+			});
+			std::vector<HazardRateMultiplier> sorted_hrms(n);
+			for (size_t k = 0; k < n; ++k) {
+				sorted_hrms[k] = hazard_rate_multipliers[order[k]];
+			}
+			const std::vector<Date> starts(n, date);
+			const std::vector<Date> ends(n, sp.end);
+			// calls f(group_begin, group_size) for each group
+			const auto for_each_group = [n, &order, &models, &states](std::function<void(size_t, size_t)> f) {
+				size_t group_begin = 0;
+				while (group_begin < n) {
+					size_t group_end = group_begin + 1;
+					while (group_end < n && models[order[group_end]] == models[order[group_begin]] && states[order[group_end]] == states[order[group_begin]]) {
+						++group_end;
+					}
+					f(group_begin, group_end - group_begin);
+					group_begin = group_end;
+				}
+			};
+
+			std::vector<double> sorted_probas(n);
+			for_each_group([&](size_t group_begin, size_t group_size) {
+				const size_t first = order[group_begin];
+				models[first]->calc_transition_probabilities(states[first], starts.data() + group_begin, ends.data() + group_begin, sorted_hrms.data() + group_begin, sorted_probas.data() + group_begin, group_size);
+			});
+			std::vector<double> jump_probas(n);
+			for (size_t k = 0; k < n; ++k) {
+				jump_probas[order[k]] = sorted_probas[k];
+			}
+
+			if (streams) {
+				// each object has its own stream, so all uniform draws for the first step can be made upfront
+				std::vector<double> sorted_us(n);
+				for (size_t k = 0; k < n; ++k) {
+					sorted_us[k] = streams[order[k]].next_uniform();
+				}
+				std::vector<Date> sorted_jump_dates(n);
+				for_each_group([&](size_t group_begin, size_t group_size) {
+					const size_t first = order[group_begin];
+					models[first]->calc_end_dates(states[first], starts.data() + group_begin, sorted_us.data() + group_begin, sorted_hrms.data() + group_begin, sorted_jump_dates.data() + group_begin, group_size);
+				});
+				std::vector<double> us(n);
+				std::vector<Date> jump_dates(n);
+				for (size_t k = 0; k < n; ++k) {
+					us[order[k]] = sorted_us[k];
+					jump_dates[order[k]] = sorted_jump_dates[k];
+				}
+				MutableContext& mctx = contexts.mutable_ctx();
+				for (size_t i = 0; i < n; ++i) {
+					T& obj = *objs[i];
+					state_t state = states[i];
+					const MutableContext::RNGOverride rng_override(mctx, streams[i]);
+					if (us[i] < jump_probas[i] && jump_dates[i] < sp.end) {
+						++state;
+						set_next_state(obj, jump_dates[i], state, contexts);
+					}
+					run(obj, *models[i], sp, state, jump_dates[i], contexts);
+				}
+			} else {
+				for (size_t i = 0; i < n; ++i) {
+					T& obj = *objs[i];
+					state_t state = states[i];
+					const double u = contexts.mutable_ctx().rng().next_uniform();
+					const Date jump_date = models[i]->calc_end_date(state, date, u, hazard_rate_multipliers[i]);
+					if (u < jump_probas[i] && jump_date < sp.end) {
+						++state;
+						set_next_state(obj, jump_date, state, contexts);
+					}
+					run(obj, *models[i], sp, state, jump_date, contexts);
+				}
+			}
+		}
     }
 }
 
@@ -31,6 +31,18 @@ namespace averisera {
             state_history.append(date, MathUtils::safe_cast<History::int_t>(state));
         }
 
+        template <class T> unsigned int OperatorHazardModelActor<T>::current_state(const T& obj, const Contexts& ctx, const VariableHandle& state_variable) {
+            const auto state_variable_idx = obj.get_variable_index(ctx, state_variable);
+            const History& state_history = obj.history(state_variable_idx);
+            return static_cast<unsigned int>(state_history.last_as_int());
+        }
+
+        template <class T> void OperatorHazardModelActor<T>::set_next_state(T& obj, Date date, unsigned int state, const Contexts& ctx, const VariableHandle& state_variable) {
+            const auto state_variable_idx = obj.get_variable_index(ctx, state_variable);
+            History& state_history = obj.history(state_variable_idx);
+            state_history.append(date, MathUtils::safe_cast<History::int_t>(state));
+        }
+
         template <class T> unsigned int OperatorHazardModelActor<T>::current_state(const T& obj, const Contexts& ctx) const {
             return current_state(obj, ctx, _state_variable);
         }
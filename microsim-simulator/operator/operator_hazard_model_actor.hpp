@@ -5,6 +5,7 @@
 #include "operator_hazard_model.hpp"
 //#include "../actor.h"
 #include "../history_generator_simple.hpp"
+#include "../variable_handle.hpp"
 //#include <type_traits>
 
 namespace averisera {
@@ -31,6 +32,12 @@ namespace averisera {
             /** Get next state in a Poisson process history */
             static void set_next_state(T& obj, Date date, unsigned int state, const Contexts& ctx, const std::string& state_variable);
 
+            /** Get current state from a Poisson process history */
+            static unsigned int current_state(const T& obj, const Contexts& ctx, const VariableHandle& state_variable);
+
+            /** Get next state in a Poisson process history */
+            static void set_next_state(T& obj, Date date, unsigned int state, const Contexts& ctx, const VariableHandle& state_variable);
+
 			const typename HistoryGenerator<T>::reqvec_t& requirements() const override {
 				return hist_gen_.requirements();
 			}
@@ -44,7 +51,7 @@ namespace averisera {
             void set_next_state(T& obj, Date date, unsigned int state, const Contexts& ctx) const override;
 
 			HistoryGeneratorSimple<T> hist_gen_;
-            std::string _state_variable;
+            VariableHandle _state_variable;
         };
     }
 }
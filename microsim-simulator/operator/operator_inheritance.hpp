@@ -73,6 +73,11 @@ namespace averisera {
 				static const std::string str("Inheritance");
 				return str;
 			}
+
+			/** Reads the histories of the mother */
+			bool accesses_relatives() const override {
+				return true;
+			}
         private:
 			HistoryGeneratorSimple<Person> hist_gen_;
             std::vector<std::string> _variables;
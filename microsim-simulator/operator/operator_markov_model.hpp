@@ -49,6 +49,11 @@ namespace averisera {
             
             void apply(const std::shared_ptr<T>& obj, const Contexts& contexts) const override;
 
+			/** Derived classes whose set_next_state() modifies other objects than obj must return false. */
+			bool is_parallelisable() const override {
+				return true;
+			}
+
             /** Apply a single transition without initialising the state
               @param rrvs Vector to store relative risk values in, must have size() == dim()
              */
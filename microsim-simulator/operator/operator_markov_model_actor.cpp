@@ -19,25 +19,24 @@ namespace averisera {
 			HistoryFactory::factory_t history_factory)
         : OperatorMarkovModel<T>(required, variable, std::move(markov_model), pred, initialize, std::move(relative_risks_transitions), std::move(relative_risks_initial_state),
                                  std::move(schedule)),
-            hist_gen_(variable, history_factory, pred) {
+            hist_gen_(variable, history_factory, pred), variable_handle_(variable) {
 			check_not_null(history_factory, "OperatorMarkovModelActor: history factory cannot be null");
-			check_that(!variable.empty(), "OperatorMarkovModelActor: variable name is empty");
         }
 
         template <class T> bool OperatorMarkovModelActor<T>::is_initialized(const T& obj, const Contexts& contexts) const {
-            const auto state_variable_idx = obj.get_variable_index(contexts, this->variable());
+            const auto state_variable_idx = obj.get_variable_index(contexts, variable_handle_);
             const ImmutableHistory& state_history = obj.history(state_variable_idx);
             return !state_history.empty();
         }
         
         template <class T> std::pair<Date, unsigned int> OperatorMarkovModelActor<T>::get_last_date_and_state(const T& obj, const Contexts& ctx) const {
-            const auto state_variable_idx = obj.get_variable_index(ctx, this->variable());
+            const auto state_variable_idx = obj.get_variable_index(ctx, variable_handle_);
             const ImmutableHistory& state_history = obj.history(state_variable_idx);
             return std::make_pair(state_history.last_date(), MathUtils::safe_cast<unsigned int>(state_history.last_as_int()));
         }
         
         template <class T> void OperatorMarkovModelActor<T>::set_next_state(T& obj, Date date, unsigned int state, const Contexts& ctx) const {
-            const auto state_variable_idx = obj.get_variable_index(ctx, this->variable());
+            const auto state_variable_idx = obj.get_variable_index(ctx, variable_handle_);
             History& state_history = obj.history(state_variable_idx);
 			const auto value = MathUtils::safe_cast<History::int_t>(state);
 			LOG_TRACE() << "OperatorMarkovModelActor: setting value " << value << " as of " << date;
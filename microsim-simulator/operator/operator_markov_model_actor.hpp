@@ -4,6 +4,7 @@
 
 //#include "../actor.h"
 #include "../history_generator_simple.hpp"
+#include "../variable_handle.hpp"
 #include "operator_markov_model.hpp"
 //#include <type_traits>
 
@@ -40,6 +41,7 @@ namespace averisera {
 			}
 		private:
 			HistoryGeneratorSimple<T> hist_gen_;
+			VariableHandle variable_handle_; /**< Handle of this->variable() */
         };
     }
 }
@@ -107,7 +107,7 @@ namespace averisera {
             auto date_event = get_last_date_and_event(*obj, contexts);
 			first_relevant_date = std::max(first_relevant_date, date_event.first + Period::days(1)); // move start date to at least 1 day past the last pregnancy event and ignore all conception events before that date
             if (resulting_state(date_event.second) == Pregnancy::State::NOT_PREGNANT) { // last event ended a pregnancy
-                const auto conc_hist_idx = obj->get_variable_index(contexts, Procreation::CONCEPTION());
+                const auto conc_hist_idx = obj->get_variable_index(contexts, Procreation::CONCEPTION_HANDLE());
                 const ImmutableHistory& conc_history = obj->history(conc_hist_idx);
                 // check if any conceptions in current period which could start a pregnancy
 				// assume there is only 1 such event (the last one)
@@ -206,7 +206,7 @@ namespace averisera {
         }
 
         ImmutableHistory::index_t OperatorPregnancy::transitions_since_conception(const Person& obj, const Contexts& contexts, Date current_date) const {
-            const auto hist_idx = obj.get_variable_index(contexts, Procreation::PREGNANCY_EVENT());
+            const auto hist_idx = obj.get_variable_index(contexts, Procreation::PREGNANCY_EVENT_HANDLE());
             const ImmutableHistory& history = obj.history(hist_idx);            
             const ImmutableHistory::index_t curr_idx = history.last_index(current_date);
             auto idx = curr_idx;
@@ -7,6 +7,7 @@
 #include "dispatcher.hpp"
 #include "history_generator_simple.hpp"
 #include "predicate_factory.hpp"
+#include <algorithm>
 #include <cassert>
 #include <set>
 #include <sstream>
@@ -38,6 +39,10 @@ namespace averisera {
 			const std::string& name() const override {
 				return name_;
 			}
+
+			bool accesses_relatives() const override {
+				return std::any_of(_operators.begin(), _operators.end(), [](const std::shared_ptr<const Operator<T>>& op) { return op->accesses_relatives(); });
+			}
         private:
             static typename HistoryGenerator<T>::reqvec_t extract_history_requirements(const std::vector<std::shared_ptr<const Operator<T>>>& operators);
             std::vector<std::shared_ptr<const Operator<T>>> _operators;            
@@ -2,7 +2,10 @@
 #ifndef __AVERISERA_MS_OPERATOR_INDIVIDUAL_H
 #define __AVERISERA_MS_OPERATOR_INDIVIDUAL_H
 
+#include "contexts.hpp"
 #include "operator.hpp"
+#include "mutable_context.hpp"
+#include "core/thread_pool.hpp"
 #include <stdexcept>
 
 namespace averisera {
@@ -25,19 +28,59 @@ namespace averisera {
                 : Operator<T>(is_instantaneous)
                 {}
             
-            void apply(const std::vector<std::shared_ptr<T>>& selected, const Contexts& contexts) const {
-                for (auto it = selected.begin(); it != selected.end(); ++it) {
-                    if (*it) {
-                        apply(*it, contexts);
-                    } else {
-                        throw std::domain_error("OperatorIndividual: null pointer");
-                    }
-                }
+            void apply(const std::vector<std::shared_ptr<T>>& selected, const Contexts& contexts) const override {
+				apply_span(ActorSpan<T>(selected), contexts);
             }
 
+			void apply_span(ActorSpan<T> selected, const Contexts& contexts) const override {
+				for (size_t i = 0; i < selected.size(); ++i) {
+					const std::shared_ptr<T>& obj = selected[i];
+					if (obj) {
+						apply(obj, contexts);
+					} else {
+						throw std::domain_error("OperatorIndividual: null pointer");
+					}
+				}
+			}
+
+			/** @see apply_span_parallel */
+			void apply_parallel(const std::vector<std::shared_ptr<T>>& selected, const Contexts& contexts, ThreadPool& pool, const typename Operator<T>::stream_factory_t& make_stream) const override {
+				apply_span_parallel(ActorSpan<T>(selected), contexts, pool, make_stream);
+			}
+
+			/** If is_parallelisable() returns true, apply the operator to selected objects concurrently, with i-th object drawing random numbers
+			from the stream make_stream(i). Otherwise call apply_span(selected, contexts).
+			@see Operator::apply_parallel
+			*/
+			void apply_span_parallel(ActorSpan<T> selected, const Contexts& contexts, ThreadPool& pool, const typename Operator<T>::stream_factory_t& make_stream) const override {
+				if (!is_parallelisable()) {
+					apply_span(selected, contexts);
+					return;
+				}
+				MutableContext& mctx = contexts.mutable_ctx();
+				pool.for_each_index(selected.size(), [this, selected, &contexts, &mctx, &make_stream](size_t i) {
+					const std::shared_ptr<T>& obj = selected[i];
+					if (!obj) {
+						throw std::domain_error("OperatorIndividual: null pointer");
+					}
+					RNGPhilox stream(make_stream(i));
+					const MutableContext::RNGOverride rng_override(mctx, stream);
+					apply(obj, contexts);
+				}, MIN_PARALLEL_RANGE_SIZE);
+			}
+
             /** @param obj Not-null pointer to object T
              */
             virtual void apply(const std::shared_ptr<T>& obj, const Contexts& contexts) const = 0;
+
+			/** Can apply(obj, contexts) be called concurrently for different objects? Should return true only if apply(obj, contexts)
+			modifies nothing else than obj and draws random numbers only from contexts.mutable_ctx().rng().
+			*/
+			virtual bool is_parallelisable() const {
+				return false;
+			}
+		private:
+			static const size_t MIN_PARALLEL_RANGE_SIZE = 256; /**< Minimum number of objects processed by a thread in one go */
         };
     }
 }
@@ -7,17 +7,23 @@
 #include "mutable_context.hpp"
 #include "person.hpp"
 #include "person_data.hpp"
+#include "population.hpp"
+#include "history/history_copy_on_write.hpp"
 #include "core/daycount.hpp"
 #include "core/log.hpp"
 #include "core/preconditions.hpp"
+#include "core/thread_pool.hpp"
+#include <algorithm>
 #include <cassert>
+#include <limits>
 #include <stdexcept>
+#include <unordered_map>
 #include <boost/format.hpp>
 
 namespace averisera {
     namespace microsim {
 		Person::Person(Actor::id_t id, PersonAttributes attribs, Date dob)
-			: ActorImpl<Person>(id), _attribs(attribs), _dob(dob) {
+			: ActorImpl<Person>(id), _attribs(attribs), _dob(dob), population_(nullptr), population_row_(0) {
             if (dob.is_not_a_date()) {
                 throw std::domain_error("Person: date of birth invalid");
             }
@@ -28,11 +34,13 @@ namespace averisera {
             }
         }
 
-		static void build_histories_from_data(PersonData::histories_t&& history_data, std::vector<std::unique_ptr<History>>& histories, const HistoryFactoryRegistry<Person>& registry, bool override_registry) {
+		/** @param factories Factories for this object from the registry
+		@param histories Vector of null histories, filled with histories built from data */
+		static void build_histories_from_data(PersonData::histories_t&& history_data, const std::vector<HistoryFactory::factory_t>& factories, std::vector<std::unique_ptr<History>>& histories, const HistoryFactoryRegistry<Person>& registry, bool override_registry, HistoryCopyOnWriteCache* history_cache) {
 			for (auto& hp : history_data) {
 				if (registry.has_variable(hp.first)) {
 					const auto idx = registry.variable_index(hp.first);
-					if (!histories[idx]) { // histories[idx] != null means that we have a factory for that object
+					if (!factories[idx]) { // factories[idx] != null means that we have a factory for that object
 						if (override_registry) {
 							histories[idx] = HistoryFactory::from_data(std::move(hp.second));
 							LOG_WARN() << "Person: Overriding registry for variable " << hp.first;
@@ -40,7 +48,10 @@ namespace averisera {
 							LOG_WARN() << "Person: HistoryData present but no factory registered for variable " << hp.first;
 							continue;
 						}
+					} else if (history_cache && hp.second.is_data_shared()) {
+						histories[idx] = history_cache->make_history(idx, hp.first, factories[idx], hp.second);
 					} else {
+						histories[idx] = factories[idx](hp.first);
 						HistoryFactory::append(*(histories[idx]), std::move(hp.second));						
 					}
 				} else {
@@ -51,24 +62,40 @@ namespace averisera {
 
         std::unique_ptr<Person> Person::from_data(PersonData&& data, const ImmutableContext& im_ctx, bool override_registry) {
             std::unique_ptr<Person> p(new Person(data.id, data.attributes, data.date_of_birth));
+			p->init_from_data(std::move(data), im_ctx, override_registry, nullptr);
+            return p;
+        }
+
+        Person::shared_ptr Person::from_data(PersonData&& data, const ImmutableContext& im_ctx, const PoolAllocator<Person>& alloc, bool override_registry, HistoryCopyOnWriteCache* history_cache) {
+            const Person::shared_ptr p(Person::allocate_shared(alloc, data.id, data.attributes, data.date_of_birth));
+			p->init_from_data(std::move(data), im_ctx, override_registry, history_cache);
+            return p;
+        }
+
+		void Person::init_from_data(PersonData&& data, const ImmutableContext& im_ctx, bool override_registry, HistoryCopyOnWriteCache* history_cache) {
             const HistoryFactoryRegistry<Person>& registry = im_ctx.person_history_registry();
-            std::vector<std::unique_ptr<History>> histories(registry.make_histories(*p));
-			build_histories_from_data(std::move(data.histories), histories, registry, override_registry);			
-			p->_conception_date = data.conception_date;
-			p->set_histories(std::move(histories));
+			const std::vector<HistoryFactory::factory_t> factories(registry.make_factories(*this));
+            std::vector<std::unique_ptr<History>> histories(factories.size());
+			build_histories_from_data(std::move(data.histories), factories, histories, registry, override_registry, history_cache);
+			for (size_t idx = 0; idx < factories.size(); ++idx) {
+				if (factories[idx] && !histories[idx]) {
+					histories[idx] = factories[idx](registry.variable_name(idx));
+				}
+			}
+			_conception_date = data.conception_date;
+			set_histories(std::move(histories));
 			for (Date cbd : data.childbirths) {
-				p->add_childbirth(cbd);
+				add_childbirth(cbd);
 			}
 			if (!data.immigration_date.is_not_a_date()) {
-				p->set_immigration_date(data.immigration_date);
+				set_immigration_date(data.immigration_date);
 			}
 			if (!data.fetuses.empty()) {
 				for (const auto& fetus : data.fetuses) {
-					p->add_fetus(fetus);
+					add_fetus(fetus);
 				}
 			}
-            return p;
-        }
+		}
 
         /*Person::Person(Actor::id_t id, PersonAttributes attribs, Date dob, std::weak_ptr<const Person> mother, Date conception_date)
             : Person(id, attribs, dob) {
@@ -86,11 +113,15 @@ namespace averisera {
 			if (as_of < _dob) {
 				return 0.;
 			}
-            return Daycount::YEAR_FRACT()->calc(_dob, as_of);
+            return Daycount::year_fract(_dob, as_of);
         }
         
         Person& Person::die(Date date) {
             _dod = date;
+			if (population_) {
+				population_->update_person_columns(*this);
+				population_->register_death(*this);
+			}
             return *this;
         }
         
@@ -204,9 +235,10 @@ namespace averisera {
 				}
 				MutableContext& mc = ctx.mutable_ctx();
 				const HistoryFactoryRegistry<Person>& registry = ctx.immutable_ctx().person_history_registry();
+				const HistoryColumnStores::Scope history_column_scope(mc.history_column_stores());
                 for (Fetus fetus: *_fetuses) {
 					if (fetus.conception_date() < date) {
-						const Person::shared_ptr child = Person::make_shared(mc.gen_id(), fetus.attributes(), date);
+						const Person::shared_ptr child = Person::allocate_shared(mc.person_allocator(), mc.gen_id(), fetus.attributes(), date);
 						std::vector<std::unique_ptr<History>> histories(registry.make_histories(*child));
 						child->set_histories(std::move(histories));
 						LOG_TRACE() << "Person: giving birth to child with ID " << child->id() << " on " << date;
@@ -265,25 +297,138 @@ namespace averisera {
             if (!mother) {
                 throw std::domain_error("Person: mother is null");
             }
-			check_that(child != mother, "Person: mother equals to child");
-            if (mother->sex() != Sex::FEMALE) {
+			check_parents_child(*child, *mother, conception_date);
+            child->set_parents_data(std::weak_ptr<Person>(mother), conception_date);
+            mother->add_child(child);
+        }
+
+		void Person::check_parents_child(const Person& child, const Person& mother, Date conception_date) {
+			check_that(&child != &mother, "Person: mother equals to child");
+            if (mother.sex() != Sex::FEMALE) {
                 throw std::domain_error("Person: mother is not female");
             }
             if (conception_date.is_not_a_date()) {
                 throw std::domain_error("Person: conception date invalid");
             }
-			if (conception_date <= mother->date_of_birth()) {
+			if (conception_date <= mother.date_of_birth()) {
 				throw std::domain_error("Person: conception date on or before mother's date of birth");
 			}
-			if (conception_date >= child->date_of_birth()) {
+			if (conception_date >= child.date_of_birth()) {
 				throw std::domain_error("Person: conception date on or after child's date of birth");
 			}
-            if (!child->_conception_date.is_not_a_date()) {
+            if (!child._conception_date.is_not_a_date()) {
                 std::logic_error("Person: child parents data already set");
             }
-            child->set_parents_data(std::weak_ptr<Person>(mother), conception_date);
-            mother->add_child(child);
-        }
+		}
+
+		namespace {
+			/** Maps IDs of persons sorted by ID to their positions. IDs generated by MutableContext::gen_id() are mostly contiguous,
+			so a dense table is used unless they are too sparse. */
+			class PersonSlotMap {
+			public:
+				static const size_t NPOS = std::numeric_limits<size_t>::max();
+
+				PersonSlotMap(const std::vector<Person::shared_ptr>& persons)
+					: min_id_(0) {
+					if (persons.empty()) {
+						return;
+					}
+					for (const auto& p : persons) {
+						check_not_null(p, "Person::link_parents_child: null Person pointer");
+					}
+					min_id_ = persons.front()->id();
+					const Actor::id_t max_id = persons.back()->id();
+					if (max_id >= min_id_ && max_id - min_id_ < DENSITY * static_cast<Actor::id_t>(persons.size())) {
+						dense_.assign(static_cast<size_t>(max_id - min_id_ + 1), NPOS);
+						for (size_t i = 0; i < persons.size(); ++i) {
+							const Actor::id_t id = persons[i]->id();
+							if (id >= min_id_ && id <= max_id) {
+								dense_[static_cast<size_t>(id - min_id_)] = i;
+							}
+						}
+					} else {
+						sparse_.reserve(persons.size());
+						for (size_t i = 0; i < persons.size(); ++i) {
+							sparse_[persons[i]->id()] = i;
+						}
+					}
+				}
+
+				/** Return NPOS if not found */
+				size_t find(Actor::id_t id) const {
+					if (!dense_.empty()) {
+						if (id >= min_id_ && id - min_id_ < dense_.size()) {
+							return dense_[static_cast<size_t>(id - min_id_)];
+						} else {
+							return NPOS;
+						}
+					} else {
+						const auto it = sparse_.find(id);
+						return it != sparse_.end() ? it->second : NPOS;
+					}
+				}
+			private:
+				static const Actor::id_t DENSITY = 4; /**< Maximum ratio of the ID range to the number of persons for the dense table */
+
+				Actor::id_t min_id_;
+				std::vector<size_t> dense_;
+				std::unordered_map<Actor::id_t, size_t> sparse_;
+			};
+
+			const size_t PersonSlotMap::NPOS;
+		}
+
+		void Person::link_parents_child(std::vector<Person::shared_ptr>& persons, const std::vector<PersonData>& person_data, ThreadPool* pool) {
+            if (persons.size() != person_data.size()) {
+                throw std::domain_error("Person: persons and data vectors have different sizes");
+            }
+			const PersonSlotMap slots(persons);
+			std::vector<std::pair<size_t, size_t>> links; // (mother position, child position) in the order of person_data
+			for (size_t i = 0; i < person_data.size(); ++i) {
+				const PersonData& pd = person_data[i];
+                if (pd.mother_id != Actor::INVALID_ID) {
+					// persons are usually created from person_data element by element
+					const size_t child_pos = persons[i] && persons[i]->id() == pd.id ? i : slots.find(pd.id);
+                    if (child_pos == PersonSlotMap::NPOS) {
+                        throw std::domain_error(boost::str(boost::format("Population: child ID %d has no Person") % pd.id));
+                    }
+					const size_t mother_pos = slots.find(pd.mother_id);
+                    if (mother_pos == PersonSlotMap::NPOS) {
+                        throw std::domain_error(boost::str(boost::format("Population: mother ID %d has no Person") % pd.mother_id));
+                    }
+					links.push_back(std::make_pair(mother_pos, child_pos));
+                }
+			}
+			if (!pool) {
+				for (const auto& link : links) {
+					link_parents_child(persons[link.second], persons[link.first], person_data[link.second].conception_date);
+				}
+				return;
+			}
+			// each child has one mother, so children can be linked to mothers concurrently
+			pool->for_each_index(links.size(), [&persons, &person_data, &links](size_t k) {
+				const Person::shared_ptr& child = persons[links[k].second];
+				const Person::shared_ptr& mother = persons[links[k].first];
+				const Date conception_date = person_data[links[k].second].conception_date;
+				check_parents_child(*child, *mother, conception_date);
+				child->set_parents_data(std::weak_ptr<Person>(mother), conception_date);
+			}, 1024);
+			// add children to each mother in the same order as in the serial version
+			std::stable_sort(links.begin(), links.end(), [](const std::pair<size_t, size_t>& l, const std::pair<size_t, size_t>& r) { return l.first < r.first; });
+			std::vector<size_t> mother_ranges; // start of the range of links for each mother
+			for (size_t k = 0; k < links.size(); ++k) {
+				if (k == 0 || links[k].first != links[k - 1].first) {
+					mother_ranges.push_back(k);
+				}
+			}
+			mother_ranges.push_back(links.size());
+			pool->for_each_index(mother_ranges.size() - 1, [&persons, &links, &mother_ranges](size_t m) {
+				const Person::shared_ptr& mother = persons[links[mother_ranges[m]].first];
+				for (size_t k = mother_ranges[m]; k < mother_ranges[m + 1]; ++k) {
+					mother->add_child(persons[links[k].second]);
+				}
+			}, 256);
+		}
 
         void Person::unlink_children(Date since) {
             if (_children) {
@@ -329,6 +474,9 @@ namespace averisera {
 			if (imdate >= _dob) {
 				if (_dod.is_not_a_date() || imdate <= _dod) {
 					immigration_date_ = imdate;
+					if (population_) {
+						population_->update_person_columns(*this);
+					}
 				} else {
 					LOG_ERROR() << "Person: immigration date " << imdate << " after date of death " << _dod;
 					throw std::domain_error("Person: immigration date must be on or before date of death");
@@ -8,17 +8,23 @@
 #include "fetus.hpp"
 #include "history_factory_registry.hpp"
 #include "core/dates.hpp"
+#include "core/memory_pool.hpp"
 #include "microsim-core/person_attributes.hpp"
 #include "history.hpp"
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
         template <class T> class HistoryFactoryRegistry;
+        class HistoryCopyOnWriteCache;
         class MutableContext;
         struct PersonData;
+        class Population;
         
         /**
          *  @brief Represents a person in a simulated population.
@@ -40,6 +46,12 @@ namespace averisera {
             */
             static std::unique_ptr<Person> from_data(PersonData&& data, const ImmutableContext& im_ctx, bool override_registry = false);
 
+            /** Construct a Person from PersonData POD object, together with its shared pointer control block, in memory obtained from alloc.
+            @param history_cache If not null, histories created from HistoryData shared with other PersonData objects (e.g. bootstrapped copies) share their contents until modified.
+            @see from_data(PersonData&&, const ImmutableContext&, bool)
+            */
+            static Person::shared_ptr from_data(PersonData&& data, const ImmutableContext& im_ctx, const PoolAllocator<Person>& alloc, bool override_registry = false, HistoryCopyOnWriteCache* history_cache = nullptr);
+
             ///**
             // * @param[in] id ID number
             // * @param[in] attribs Fixed attributes
@@ -103,7 +115,7 @@ namespace averisera {
 				return as_of >= _dob && (_dod.is_not_a_date() || as_of < _dod);
             }
             
-            /** Mark the person as deceased.  Can be called more than once.
+            /** Mark the person as deceased.  Can be called more than once. Updates the columns of the Population the person belongs to.
              * @param[in] date Valid normal date.
              * @return Reference to person.
              */
@@ -191,12 +203,14 @@ namespace averisera {
              */
             static void link_parents_child(const Person::shared_ptr child, Person::shared_ptr mother, Date conception_date);            
 
-            /** Set up links between parents and children.
+            /** Set up links between parents and children. Finds persons by ID using a table built once (dense if the IDs are mostly contiguous),
+			so the cost is linear in the number of persons.
             @param persons Simulation objects which are lacking mother-child links. Pointers cannot be null. Assumed to be sorted by IDs.
             @param person_data Data from which persons were created. They do not need to have their histories. Assumed to be sorted by IDs.
+			@param pool If not null, links are set up in parallel using the pool threads, with the same result.
             @throw std::domain_error If vectors have different sizes. If there is no valid pointer to a Person with child or mother ID.
             */
-            static void link_parents_child(std::vector<Person::shared_ptr>& persons, const std::vector<PersonData>& person_data);
+            static void link_parents_child(std::vector<Person::shared_ptr>& persons, const std::vector<PersonData>& person_data, ThreadPool* pool = nullptr);
 
             /** Remove links to children born or on after "since" */
             void unlink_children(Date since);
@@ -225,12 +239,19 @@ namespace averisera {
 				return immigration_date_;
 			}
 
-			/** @throw std::domain_error If immigration date is already set, or if imdate is before date of birth or after date of death, or imdate is a "special" date. */
+			/** Updates the columns of the Population the person belongs to.
+			@throw std::domain_error If immigration date is already set, or if imdate is before date of birth or after date of death, or imdate is a "special" date. */
 			void set_immigration_date(Date imdate);
         private:
+			friend class Population;
+
+            /** Move the data other than ID, attributes and date of birth to this */
+            void init_from_data(PersonData&& data, const ImmutableContext& im_ctx, bool override_registry, HistoryCopyOnWriteCache* history_cache);
             void sort_childbirths();
 			void add_child(Person::shared_ptr child);
             void set_parents_data(Person::const_weak_ptr mother, Date conception_date);
+			/** Check the arguments of link_parents_child(const Person::shared_ptr, Person::shared_ptr, Date) */
+			static void check_parents_child(const Person& child, const Person& mother, Date conception_date);
         private:
             typedef std::pair<Date, Person::shared_ptr> child_t; /**< Stores information about Person's child. Date of birth is stored separately
                                                                       from the pointer so that we can store birth events from before the simulation without
@@ -247,6 +268,8 @@ namespace averisera {
             Date _dod; /**< date of death */
             Date _conception_date; /**< Date the person was conceived */
 			Date immigration_date_; /**< Date of last immigration event */			
+			Population* population_; /**< Population which last added this person, or null; notified when the date of death or immigration date changes */
+			size_t population_row_; /**< Position of this person in population_ */
         };
     }
 }
@@ -0,0 +1,80 @@
+// (C) Averisera Ltd 2014-2020
+#include "person_archive.hpp"
+#include "person.hpp"
+#include "core/preconditions.hpp"
+#include <algorithm>
+
+namespace averisera {
+    namespace microsim {
+        PersonArchive::PersonArchive()
+            : batch_begin_(0) {}
+
+        void PersonArchive::add(const Person& person) {
+            Record record;
+            record.id = person.id();
+            record.attributes = person.attributes();
+            record.date_of_birth = person.date_of_birth();
+            record.date_of_death = person.date_of_death();
+            record.immigration_date = person.immigration_date();
+            const auto mother = person.mother().lock();
+            record.mother_id = mother ? mother->id() : Actor::INVALID_ID;
+            record.mother_date_of_birth = mother ? mother->date_of_birth() : Date();
+            record.mother_immigration_date = mother ? mother->immigration_date() : Date();
+            add(record);
+        }
+
+        void PersonArchive::add(const Record& record) {
+            check_that(!record.date_of_death.is_not_a_date(), "PersonArchive: person is not dead");
+            ids_.push_back(record.id);
+            sexes_.push_back(record.attributes.sex());
+            ethnicities_.push_back(record.attributes.ethnicity());
+            dobs_.push_back(record.date_of_birth);
+            dods_.push_back(record.date_of_death);
+            immigration_dates_.push_back(record.immigration_date);
+            mother_ids_.push_back(record.mother_id);
+            mother_dobs_.push_back(record.mother_date_of_birth);
+            mother_immigration_dates_.push_back(record.mother_immigration_date);
+        }
+
+        PersonArchive::Record PersonArchive::record(const size_t i) const {
+            check_that(i < size(), "PersonArchive: record index out of range");
+            Record record;
+            record.id = ids_[i];
+            record.attributes = PersonAttributes(sexes_[i], ethnicities_[i]);
+            record.date_of_birth = dobs_[i];
+            record.date_of_death = dods_[i];
+            record.immigration_date = immigration_dates_[i];
+            record.mother_id = mother_ids_[i];
+            record.mother_date_of_birth = mother_dobs_[i];
+            record.mother_immigration_date = mother_immigration_dates_[i];
+            return record;
+        }
+
+        static size_t count_in_range(const std::vector<Date>& dates, const Date from, const Date to) {
+            return static_cast<size_t>(std::count_if(dates.begin(), dates.end(), [from, to](const Date d) {
+                return d >= from && d < to;
+            }));
+        }
+
+        size_t PersonArchive::nbr_births(const Date from, const Date to) const {
+            return count_in_range(dobs_, from, to);
+        }
+
+        size_t PersonArchive::nbr_deaths(const Date from, const Date to) const {
+            return count_in_range(dods_, from, to);
+        }
+
+        void PersonArchive::clear() {
+            std::vector<Actor::id_t>().swap(ids_);
+            std::vector<Sex>().swap(sexes_);
+            std::vector<PersonAttributes::ethnicity_t>().swap(ethnicities_);
+            std::vector<Date>().swap(dobs_);
+            std::vector<Date>().swap(dods_);
+            std::vector<Date>().swap(immigration_dates_);
+            std::vector<Actor::id_t>().swap(mother_ids_);
+            std::vector<Date>().swap(mother_dobs_);
+            std::vector<Date>().swap(mother_immigration_dates_);
+            batch_begin_ = 0;
+        }
+    }
+}
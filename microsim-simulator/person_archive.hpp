@@ -0,0 +1,132 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_PERSON_ARCHIVE_H
+#define __AVERISERA_MS_PERSON_ARCHIVE_H
+
+#include "actor.hpp"
+#include "core/dates.hpp"
+#include "microsim-core/person_attributes.hpp"
+#include <vector>
+
+namespace averisera {
+    namespace microsim {
+        class Person;
+
+        /** @brief Compact read-only store of persons removed from the simulated Population after their death.
+
+        Like ArchivedHistory for single histories, it keeps what is needed after the Person object itself is gone:
+        the fixed attributes and the dates of birth, death and immigration, stored column by column, together with the date of birth
+        and immigration date of the mother (needed to count births by mother's age). Histories, fetuses and links to children are not kept.
+        Records are stored in the order they were added, in batches (see start_batch()).
+        */
+        class PersonArchive {
+        public:
+            /** Single archived person */
+            struct Record {
+                Actor::id_t id;
+                PersonAttributes attributes;
+                Date date_of_birth;
+                Date date_of_death;
+                Date immigration_date; /**< NAD if the person did not immigrate */
+                Actor::id_t mother_id; /**< Actor::INVALID_ID if the person was not linked to the mother */
+                Date mother_date_of_birth; /**< NAD if the person was not linked to the mother */
+                Date mother_immigration_date; /**< NAD if the mother did not immigrate or is not known */
+            };
+
+            PersonArchive();
+
+            /** Append a record of a dead person.
+            @throw std::domain_error If person has no date of death.
+            */
+            void add(const Person& person);
+
+            /** Append a record (e.g. restored from a Checkpoint).
+            @throw std::domain_error If record has no date of death.
+            */
+            void add(const Record& record);
+
+            /** Return i-th record. */
+            Record record(size_t i) const;
+
+            /** Begin a new batch of records: the records added from now on form the latest batch. */
+            void start_batch() {
+                batch_begin_ = ids_.size();
+            }
+
+            /** Index of the first record in the latest batch */
+            size_t batch_begin() const {
+                return batch_begin_;
+            }
+
+            /** Number of archived persons */
+            size_t size() const {
+                return ids_.size();
+            }
+
+            bool empty() const {
+                return ids_.empty();
+            }
+
+            const std::vector<Actor::id_t>& ids() const {
+                return ids_;
+            }
+
+            const std::vector<Sex>& sexes() const {
+                return sexes_;
+            }
+
+            const std::vector<PersonAttributes::ethnicity_t>& ethnicities() const {
+                return ethnicities_;
+            }
+
+            const std::vector<Date>& dates_of_birth() const {
+                return dobs_;
+            }
+
+            const std::vector<Date>& dates_of_death() const {
+                return dods_;
+            }
+
+            /** Not-a-date for persons who did not immigrate */
+            const std::vector<Date>& immigration_dates() const {
+                return immigration_dates_;
+            }
+
+            /** Actor::INVALID_ID if the person was not linked to the mother */
+            const std::vector<Actor::id_t>& mother_ids() const {
+                return mother_ids_;
+            }
+
+            /** Not-a-date if the person was not linked to the mother */
+            const std::vector<Date>& mother_dates_of_birth() const {
+                return mother_dobs_;
+            }
+
+            /** Not-a-date if the mother did not immigrate or is not known */
+            const std::vector<Date>& mother_immigration_dates() const {
+                return mother_immigration_dates_;
+            }
+
+            /** Number of archived persons born in [from, to) */
+            size_t nbr_births(Date from, Date to) const;
+
+            /** Number of archived persons who died in [from, to) */
+            size_t nbr_deaths(Date from, Date to) const;
+
+            /** Free all records */
+            void clear();
+        private:
+            std::vector<Actor::id_t> ids_;
+            std::vector<Sex> sexes_;
+            std::vector<PersonAttributes::ethnicity_t> ethnicities_;
+            std::vector<Date> dobs_;
+            std::vector<Date> dods_;
+            std::vector<Date> immigration_dates_;
+            std::vector<Actor::id_t> mother_ids_;
+            std::vector<Date> mother_dobs_;
+            std::vector<Date> mother_immigration_dates_;
+            size_t batch_begin_;
+        };
+    }
+}
+
+#endif // __AVERISERA_MS_PERSON_ARCHIVE_H
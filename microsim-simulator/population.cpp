@@ -1,6 +1,8 @@
 // (C) Averisera Ltd 2014-2020
 #include "contexts.hpp"
+#include "history/history_copy_on_write.hpp"
 #include "immutable_context.hpp"
+#include "mutable_context.hpp"
 #include "person.hpp"
 #include "person_data.hpp"
 #include "population.hpp"
@@ -11,17 +13,38 @@
 #include <iterator>
 #include <stdexcept>
 #include "core/log.hpp"
+#include "core/preconditions.hpp"
+#include "core/thread_pool.hpp"
 #include <boost/format.hpp>
 
 namespace averisera {
     namespace microsim {
 		Population::Population(const std::string& name)
-			: name_(name) {}
+			: name_(name), has_columns_(false), hears_all_deaths_(true), tracks_deaths_(false) {}
 
         Population::Population(Population&& other)
-            : name_(std::move(other.name_)), _persons(std::move(other._persons)) {
+            : name_(std::move(other.name_)), _persons(std::move(other._persons)), columns_(std::move(other.columns_)),
+			has_columns_(other.has_columns_),
+			archive_(std::move(other.archive_)), hears_all_deaths_(other.hears_all_deaths_), tracks_deaths_(other.tracks_deaths_), dead_candidates_(std::move(other.dead_candidates_)),
+			live_indices_(std::move(other.live_indices_)), live_pending_(std::move(other.live_pending_)), live_changes_(std::move(other.live_changes_)),
+			live_asof_(other.live_asof_) {
             other._persons.resize(0);
+			other.has_columns_ = false;
+			other.hears_all_deaths_ = true;
+			other.invalidate_live_candidates();
+			other.invalidate_dead_candidates();
+			for (const auto& p : _persons) {
+				if (p->population_ == &other) {
+					p->population_ = this;
+				}
+			}
         }
+
+		Population::~Population() {
+			for (const auto& p : _persons) {
+				release_person(*p);
+			}
+		}
         
         void Population::add_person(Person::shared_ptr person, bool check_id) {
             if (!person) {
@@ -30,6 +53,13 @@ namespace averisera {
 			if ((!check_id) || _persons.empty() || _persons.back()->id() < person->id()) {
 				LOG_TRACE() << "Population " << name_ << ": added Person with ID " << person->id();
 				_persons.push_back(person);
+				adopt_persons(_persons.size() - 1);
+				if (!live_asof_.is_not_a_date()) {
+					live_changes_.push_back(_persons.size() - 1);
+				}
+				if (tracks_deaths_ && !person->date_of_death().is_not_a_date()) {
+					dead_candidates_.push_back(_persons.size() - 1);
+				}
 			} else {
 				LOG_ERROR() << "Population " << name_ << ": error adding Person(DOB=" << person->date_of_birth() << ", SEX=" << person->sex() << ", ETHN=" << int(person->ethnicity()) << ", ID=" << person->id() << "): max ID=" << _persons.back()->id();
 				const Person& p = *(_persons.back());
@@ -39,8 +69,10 @@ namespace averisera {
         }
 
         void Population::add_persons(const std::vector<Person::shared_ptr>& new_persons, bool check_ids) {
+			if (new_persons.empty()) {
+				return;
+			}
 			LOG_TRACE() << "Population: adding " << new_persons.size() << " new Persons";
-            _persons.reserve(_persons.size() + new_persons.size());
 			Actor::id_t prev_id = 0;
             for (const auto& p: new_persons) {
 				if (!p) {
@@ -48,12 +80,31 @@ namespace averisera {
 				}
 				const auto next_id = p->id();
 				check_that(next_id > prev_id, "Population::add_persons: added persons not sorted by ID");
-                add_person(p, check_ids);
 				prev_id = next_id;
             }
+			if (check_ids && !_persons.empty() && new_persons.front()->id() <= _persons.back()->id()) {
+				LOG_ERROR() << "Population " << name_ << ": error adding Persons with min. ID " << new_persons.front()->id() << ": max ID=" << _persons.back()->id();
+				throw std::domain_error("Population: IDs not increasing");
+			}
+			// let the vector grow geometrically, so that repeated additions cost O(added) amortised
+			const size_t old_size = _persons.size();
+			_persons.insert(_persons.end(), new_persons.begin(), new_persons.end());
+			adopt_persons(old_size);
+			if (!live_asof_.is_not_a_date()) {
+				for (size_t i = old_size; i < _persons.size(); ++i) {
+					live_changes_.push_back(i);
+				}
+			}
+			if (tracks_deaths_) {
+				for (size_t i = old_size; i < _persons.size(); ++i) {
+					if (!_persons[i]->date_of_death().is_not_a_date()) {
+						dead_candidates_.push_back(i);
+					}
+				}
+			}
         }
 
-        void Population::import_persons(std::vector<PersonData>& person_datas, const Contexts& ctx, const bool keep_ids, const bool immigration) {
+        void Population::import_persons(std::vector<PersonData>& person_datas, const Contexts& ctx, const bool keep_ids, const bool immigration, ThreadPool* const pool) {
 			if (person_datas.empty()) {
 				return;
 			}
@@ -64,20 +115,33 @@ namespace averisera {
             ActorData::sort_by_id(person_datas);			
 			LOG_DEBUG() << "Population " << name_ << ": adding PersonData vec with min. ID " << person_datas.front().id << " and max. ID " << person_datas.back().id;
             std::vector<Person::shared_ptr> added_persons;
-            added_persons.reserve(person_datas.size());
             const ImmutableContext& im_ctx = ctx.immutable_ctx();
-            for (PersonData& pd: person_datas) {
-                added_persons.push_back(Person::from_data(std::move(pd), im_ctx));
-            }
+			const PoolAllocator<Person> alloc(ctx.mutable_ctx().person_allocator());
+			HistoryCopyOnWriteCache history_cache; // bootstrapped copies share histories with each other
+			HistoryColumnStores& history_column_stores = ctx.mutable_ctx().history_column_stores();
+			if (pool) {
+				added_persons.resize(person_datas.size());
+				pool->for_each_index(person_datas.size(), [&person_datas, &added_persons, &im_ctx, &alloc, &history_cache, &history_column_stores](size_t i) {
+					const HistoryColumnStores::Scope history_column_scope(history_column_stores);
+					added_persons[i] = Person::from_data(std::move(person_datas[i]), im_ctx, alloc, false, &history_cache);
+				}, 256);
+			} else {
+				const HistoryColumnStores::Scope history_column_scope(history_column_stores);
+				added_persons.reserve(person_datas.size());
+				for (PersonData& pd : person_datas) {
+					added_persons.push_back(Person::from_data(std::move(pd), im_ctx, alloc, false, &history_cache));
+				}
+			}
+			LOG_TRACE() << "Population " << name_ << ": " << history_cache.size() << " shared history prototypes";
 			if (immigration) {
 				ctx.mutable_ctx().add_immigrants(added_persons);
 			}
-            link_parents_children(added_persons, person_datas);
+            link_parents_children(added_persons, person_datas, pool);
             add_persons(added_persons);
         }
 
-        void Population::import_data(PopulationData& data, const Contexts& ctx, bool keep_ids, bool immigration) {
-            import_persons(data.persons, ctx, keep_ids, immigration);
+        void Population::import_data(PopulationData& data, const Contexts& ctx, bool keep_ids, bool immigration, ThreadPool* pool) {
+            import_persons(data.persons, ctx, keep_ids, immigration, pool);
         }
         
         Person::shared_ptr Population::get_person(Actor::id_t id) const {
@@ -91,81 +155,103 @@ namespace averisera {
         }
 
         void Population::merge(const Population& other) {
-            merge_persons(_persons, other._persons);
+            adopt_persons(merge_persons(_persons, other._persons));
+			invalidate_live_candidates();
+			invalidate_dead_candidates();
         }        
 
         void Population::wipe_out() {
+			for (const auto& p : _persons) {
+				release_person(*p);
+			}
             std::vector<Person::shared_ptr>().swap(_persons); // force freeing memory
+			archive_.clear();
+			adopt_persons(0);
+			hears_all_deaths_ = true;
+			invalidate_live_candidates();
+			invalidate_dead_candidates();
         }
 
         void Population::transfer_persons(Population& source, const Predicate<Person>& selector, const Contexts& ctx) {
             if (!source._persons.empty()) {				
                 std::vector<Person::shared_ptr> elect;
-                std::vector<Person::shared_ptr> preterite; // cf. Gravity's Rainbow
-                const auto end = source._persons.end();
-                for (auto it = source._persons.begin(); it != end; ++it) {
-                    if (selector.select(**it, ctx)) {
-                        elect.push_back(*it);
-                    } else {
-                        preterite.push_back(*it);
+				std::vector<size_t> elect_positions;
+                for (size_t i = 0; i < source._persons.size(); ++i) {
+                    if (selector.select(*source._persons[i], ctx)) {
+                        elect.push_back(source._persons[i]);
+						elect_positions.push_back(i);
                     }
                 }
-				// elect and preterite are sorted by ID because source._persons is
-				elect.shrink_to_fit();
-				preterite.shrink_to_fit();
-				LOG_TRACE() << "Population " << name_ << ": transferring " << elect.size() << " Persons to Population and leaving " << preterite.size() << " behind";
+				// elect is sorted by ID because source._persons is
+				LOG_TRACE() << "Population " << name_ << ": transferring " << elect.size() << " Persons to Population and leaving " << (source._persons.size() - elect.size()) << " behind";
+				if (elect.empty()) {
+					return;
+				}
+				// erase first, so that the transferred persons are detached from the source before this population adopts them
+				source.erase_persons(elect_positions);
+				source.invalidate_live_candidates();
                 if (!_persons.empty()) {
-                    merge_persons(_persons, elect);
+                    adopt_persons(merge_persons(_persons, elect));
                 } else {
                     _persons.swap(elect);
+					adopt_persons(0);
                 }
-                source._persons.swap(preterite);
+				invalidate_live_candidates();
+				invalidate_dead_candidates();
             }
         }
 
-        void Population::merge_persons(std::vector<Person::shared_ptr>& dst, const std::vector<Person::shared_ptr>& src) {
-            if (!src.empty()) {
-                if (!dst.empty()) {
-                    std::vector<Person::shared_ptr> newdst(dst.size() + src.size());
-                    std::merge(dst.begin(), dst.end(), src.begin(), src.end(), newdst.begin(), Person::compare_ptr_by_id);
-                    assert(newdst.size() >= 2);
-                    auto prev_id = newdst.front()->id();
-                    for (auto it = newdst.begin() + 1; it != newdst.end(); ++it) {
-                        const auto next_id = (*it)->id();
-                        assert(next_id >= prev_id);                        
-                        if (prev_id == next_id) {
-                            if (*it == *(it - 1)) {
-                                throw std::logic_error("Population: the same person in both merged populations");
-                            } else {
-                                throw std::logic_error("Population: merged in persons with duplicate IDs");
-                            }
-                        }
-                        prev_id = next_id;
-                    }
-                    dst.swap(newdst);
-                } else {
-                    dst = src;
-                }
-            }
+        size_t Population::merge_persons(std::vector<Person::shared_ptr>& dst, const std::vector<Person::shared_ptr>& src) {
+            if (src.empty()) {
+				return dst.size();
+			}
+			if (dst.empty()) {
+				dst = src;
+				return 0;
+			}
+			// persons in dst with IDs lower than all merged persons stay where they are
+			const size_t nbr_kept = static_cast<size_t>(std::lower_bound(dst.begin(), dst.end(), src.front(), Person::compare_ptr_by_id) - dst.begin());
+			// check for duplicates before modifying dst
+			auto dst_it = dst.begin() + static_cast<std::ptrdiff_t>(nbr_kept);
+			Actor::id_t prev_id = Actor::MIN_ID - 1;
+			for (const auto& p : src) {
+				const auto next_id = p->id();
+				assert(next_id >= prev_id);
+				while (dst_it != dst.end() && (*dst_it)->id() < next_id) {
+					++dst_it;
+				}
+				if (dst_it != dst.end() && (*dst_it)->id() == next_id) {
+					if (*dst_it == p) {
+						throw std::logic_error("Population: the same person in both merged populations");
+					} else {
+						throw std::logic_error("Population: merged in persons with duplicate IDs");
+					}
+				}
+				if (next_id == prev_id) {
+					throw std::logic_error("Population: merged in persons with duplicate IDs");
+				}
+				prev_id = next_id;
+			}
+			// merge from the back in place; appending persons with higher IDs costs O(src.size()) amortised
+			size_t i = dst.size();
+			size_t j = src.size();
+			dst.resize(dst.size() + src.size());
+			size_t k = dst.size();
+			while (j > 0) {
+				if (i > nbr_kept && src[j - 1]->id() < dst[i - 1]->id()) {
+					--i;
+					dst[--k] = std::move(dst[i]);
+				} else {
+					--j;
+					dst[--k] = src[j];
+				}
+			}
+			assert(k == i);
+			return nbr_kept;
         }
 
-        void Population::link_parents_children(std::vector<Person::shared_ptr>& persons, const std::vector<PersonData>& person_data) {
-            if (persons.size() != person_data.size()) {
-                throw std::domain_error("Person: persons and data vectors have different sizes");
-            }
-            for (const PersonData& pd : person_data) {
-                if (pd.mother_id != Actor::INVALID_ID) {
-                    const Person::shared_ptr child = find_by_id<Person>(persons, pd.id);
-                    if (!child) {
-                        throw std::domain_error(boost::str(boost::format("Population: child ID %d has no Person") % pd.id));
-                    }
-                    const Person::shared_ptr mother = find_by_id<Person>(persons, pd.mother_id);
-                    if (!mother) {
-                        throw std::domain_error(boost::str(boost::format("Population: mother ID %d has no Person") % pd.mother_id));
-                    }
-                    Person::link_parents_child(child, mother, pd.conception_date);
-                }
-            }
+        void Population::link_parents_children(std::vector<Person::shared_ptr>& persons, const std::vector<PersonData>& person_data, ThreadPool* pool) {
+            Person::link_parents_child(persons, person_data, pool);
         }
 
 		bool Population::empty() const {
@@ -179,50 +265,269 @@ namespace averisera {
 			if (_persons.empty()) {
 				throw std::domain_error("Population: removing persons from empty population");
 			}
-			std::vector<Actor::shared_ptr<Person>> copy(_persons);
-			auto copy_it = copy.begin();
-			// mark removed as null
+			std::vector<size_t> removed_positions;
+			removed_positions.reserve(removed_persons.size());
+			// find the removed persons first, so that an error leaves the population unchanged
 			Actor::id_t prev_id = Actor::MIN_ID - 1;
-			for (auto removed_it = removed_persons.begin(); removed_it != removed_persons.end(); ++removed_it) {
-				assert(copy_it != copy.end());
-				assert(*copy_it);
-				if (*removed_it == nullptr) {
+			auto search_begin = _persons.begin();
+			for (const auto& removed : removed_persons) {
+				if (removed == nullptr) {
 					throw std::domain_error("Population: removing null Person");
 				}
-				const auto removed_id = (*removed_it)->id();
+				const auto removed_id = removed->id();
 				check_not_equals(removed_id, Actor::INVALID_ID, "Population::remove_persons: removed person has invalid ID");
 				if (removed_id <= prev_id) {
 					LOG_ERROR() << "Population::remove_persons: removed persons not sorted by ID: " << prev_id << " followed by " << removed_id;
 					throw std::domain_error("Population::remove_persons: removed persons not sorted by ID");
 				}
-				while (copy_it != copy.end() && (*copy_it)->id() < removed_id) {
-					++copy_it;
-				}
-				if (copy_it != copy.end()) {
-					*copy_it = nullptr;
-					++copy_it;
-				} else {
+				const auto found = std::lower_bound(search_begin, _persons.end(), removed_id,
+					[](const Person::shared_ptr& p, Actor::id_t id) { return p->id() < id; });
+				if (found == _persons.end() || (*found)->id() != removed_id) {
 					throw std::domain_error("Population: removing a Person not present in population - possible duplicate in removed_persons");
 				}
+				removed_positions.push_back(static_cast<size_t>(found - _persons.begin()));
+				search_begin = found + 1;
 				prev_id = removed_id;
 			}
-			// remove the marked ones
-			const auto to_erase_it = std::remove(copy.begin(), copy.end(), nullptr);
-			copy.erase(to_erase_it, copy.end());
-			copy.shrink_to_fit();
-			assert(removed_persons.size() == _persons.size() - copy.size());
-			LOG_DEBUG() << "Population " << name_ << ": removed " << (_persons.size() - copy.size()) << " persons";
-			// persist new population
-			_persons.swap(copy);
+			erase_persons(removed_positions);
+			LOG_DEBUG() << "Population " << name_ << ": removed " << removed_positions.size() << " persons";
 		}		
 
+		void Population::erase_persons(const std::vector<size_t>& positions) {
+			if (positions.empty()) {
+				return;
+			}
+			// mark erased as null and compact in place, starting from the first erased position
+			for (size_t pos : positions) {
+				release_person(*_persons[pos]);
+				_persons[pos] = nullptr;
+			}
+			const auto first_erased = _persons.begin() + static_cast<std::ptrdiff_t>(positions.front());
+			_persons.erase(std::remove(first_erased, _persons.end(), nullptr), _persons.end());
+			for (size_t i = positions.front(); i < _persons.size(); ++i) {
+				_persons[i]->population_row_ = i;
+			}
+			if (has_columns_) {
+				columns_.erase(positions);
+			}
+			erase_live_candidates(positions);
+			if (tracks_deaths_) {
+				std::sort(dead_candidates_.begin(), dead_candidates_.end());
+				dead_candidates_.erase(std::unique(dead_candidates_.begin(), dead_candidates_.end()), dead_candidates_.end());
+				remove_erased_positions(dead_candidates_, positions);
+			}
+		}
+
+		void Population::adopt_persons(const size_t first) {
+			for (size_t i = first; i < _persons.size(); ++i) {
+				Person& person = *_persons[i];
+				if (person.population_ && person.population_ != this) {
+					// the other population keeps the person but stops hearing about its death
+					person.population_->hears_all_deaths_ = false;
+				}
+				person.population_ = this;
+				person.population_row_ = i;
+			}
+			if (has_columns_) {
+				columns_.rebuild_from(_persons, first);
+			}
+		}
+
+		void Population::release_person(Person& person) {
+			if (person.population_ == this) {
+				person.population_ = nullptr;
+			}
+		}
+
+		void Population::update_person_columns(const Person& person) {
+			assert(person.population_ == this);
+			if (has_columns_) {
+				columns_.update(person.population_row_, person);
+			}
+		}
+
+		void Population::register_death(const Person& person) {
+			assert(person.population_ == this);
+			const bool tracks_live = !live_asof_.is_not_a_date();
+			if (tracks_deaths_ || tracks_live) {
+				std::lock_guard<std::mutex> lock(deaths_mutex_);
+				if (tracks_deaths_) {
+					dead_candidates_.push_back(person.population_row_);
+				}
+				if (tracks_live) {
+					live_changes_.push_back(person.population_row_);
+				}
+			}
+		}
+
+		void Population::invalidate_dead_candidates() {
+			tracks_deaths_ = false;
+			std::vector<size_t>().swap(dead_candidates_);
+		}
+
+		size_t Population::archive_dead_persons(const Date cutoff) {
+			const auto is_archived = [cutoff](const Person& person) {
+				const Date dod = person.date_of_death();
+				return !dod.is_not_a_date() && dod < cutoff;
+			};
+			if (!tracks_deaths_ || !hears_all_deaths_) {
+				dead_candidates_.clear();
+				for (size_t i = 0; i < _persons.size(); ++i) {
+					if (!_persons[i]->date_of_death().is_not_a_date()) {
+						dead_candidates_.push_back(i);
+					}
+				}
+				tracks_deaths_ = true;
+			} else {
+				std::sort(dead_candidates_.begin(), dead_candidates_.end());
+				dead_candidates_.erase(std::unique(dead_candidates_.begin(), dead_candidates_.end()), dead_candidates_.end());
+			}
+			archive_.start_batch();
+			// persons who died on or after cutoff, or have a child who did not, stay candidates
+			std::vector<size_t> archived_positions;
+			for (size_t i : dead_candidates_) {
+				const Person& person = *_persons[i];
+				if (!is_archived(person)) {
+					continue;
+				}
+				bool has_live_child = false;
+				for (Person::child_idx_t k = 0; k < person.nbr_children(); ++k) {
+					const Person::const_shared_ptr child = person.get_child(k);
+					if (child && !is_archived(*child)) {
+						has_live_child = true;
+						break;
+					}
+				}
+				if (!has_live_child) {
+					archived_positions.push_back(i);
+				}
+			}
+			if (archived_positions.empty()) {
+				return 0;
+			}
+			for (size_t pos : archived_positions) {
+				archive_.add(*_persons[pos]);
+			}
+			erase_persons(archived_positions);
+			LOG_DEBUG() << "Population " << name_ << ": archived " << archived_positions.size() << " persons who died before " << cutoff << ", " << dead_candidates_.size() << " dead persons left";
+			return archived_positions.size();
+		}
+
+		void Population::remove_erased_positions(std::vector<size_t>& positions, const std::vector<size_t>& erased_positions) {
+			auto erased_pos_it = erased_positions.begin();
+			size_t nbr_erased_before = 0;
+			size_t dst = 0;
+			for (size_t pos : positions) {
+				while (erased_pos_it != erased_positions.end() && *erased_pos_it < pos) {
+					++erased_pos_it;
+					++nbr_erased_before;
+				}
+				if (erased_pos_it == erased_positions.end() || *erased_pos_it != pos) {
+					positions[dst] = pos - nbr_erased_before;
+					++dst;
+				}
+			}
+			positions.resize(dst);
+		}
+
+		void Population::erase_live_candidates(const std::vector<size_t>& erased_positions) {
+			if (!live_asof_.is_not_a_date()) {
+				remove_erased_positions(live_indices_, erased_positions);
+				for (std::vector<size_t>* positions : { &live_pending_, &live_changes_ }) {
+					std::sort(positions->begin(), positions->end());
+					positions->erase(std::unique(positions->begin(), positions->end()), positions->end());
+					remove_erased_positions(*positions, erased_positions);
+				}
+			}
+		}
+
 		std::vector<Actor::shared_ptr<Person>> Population::live_persons(const Date asof) const {
-			std::vector<std::shared_ptr<Person>> live_persons;
-			live_persons.reserve(_persons.size());
-			for (const auto& person_ptr : _persons) {
-				if (person_ptr->is_alive(asof)) {
-					live_persons.push_back(person_ptr);
+			const std::vector<size_t>& indices = live_indices(asof);
+			std::vector<Actor::shared_ptr<Person>> persons;
+			persons.reserve(indices.size());
+			for (size_t i : indices) {
+				persons.push_back(_persons[i]);
+			}
+			return persons;
+		}
+
+		bool Population::check_live(const size_t pos, const Date asof) const {
+			const Person& person = *_persons[pos];
+			const Date dod = person.date_of_death();
+			const bool not_dead = dod.is_not_a_date() || asof < dod;
+			const bool born = person.date_of_birth() <= asof;
+			if (!born || (not_dead && !dod.is_not_a_date())) {
+				live_pending_.push_back(pos);
+			}
+			return born && not_dead;
+		}
+
+		const std::vector<size_t>& Population::live_indices(const Date asof) const {
+			check_that(!asof.is_not_a_date(), "Population::live_indices: asof is not a date");
+			if (!hears_all_deaths_ || live_asof_.is_not_a_date() || asof < live_asof_) {
+				LOG_TRACE() << "Population " << name_ << ": rebuilding live persons";
+				live_indices_.clear();
+				live_pending_.clear();
+				live_changes_.clear();
+				for (size_t i = 0; i < _persons.size(); ++i) {
+					if (check_live(i, asof)) {
+						live_indices_.push_back(i);
+					}
+				}
+			} else if (asof > live_asof_ || !live_changes_.empty()) {
+				// only pending and changed persons can have been born, died or come back to life
+				std::vector<size_t> checked;
+				checked.swap(live_changes_);
+				if (asof > live_asof_) {
+					checked.insert(checked.end(), live_pending_.begin(), live_pending_.end());
+					live_pending_.clear();
+				}
+				std::sort(checked.begin(), checked.end());
+				checked.erase(std::unique(checked.begin(), checked.end()), checked.end());
+				if (asof == live_asof_) {
+					// pending persons which changed are checked again below
+					live_pending_.erase(std::remove_if(live_pending_.begin(), live_pending_.end(), [&checked](size_t pos) {
+						return std::binary_search(checked.begin(), checked.end(), pos);
+					}), live_pending_.end());
+				}
+				// drop checked persons from the live set, then merge back those found alive
+				const size_t nbr_live = live_indices_.size();
+				live_indices_.erase(std::remove_if(live_indices_.begin(), live_indices_.end(), [&checked](size_t pos) {
+					return std::binary_search(checked.begin(), checked.end(), pos);
+				}), live_indices_.end());
+				const size_t nbr_kept = live_indices_.size();
+				for (size_t pos : checked) {
+					if (check_live(pos, asof)) {
+						live_indices_.push_back(pos);
+					}
 				}
+				std::inplace_merge(live_indices_.begin(), live_indices_.begin() + static_cast<std::ptrdiff_t>(nbr_kept), live_indices_.end());
+				LOG_TRACE() << "Population " << name_ << ": checked " << checked.size() << " persons, live persons " << nbr_live << " -> " << live_indices_.size();
+			}
+			live_asof_ = asof;
+			return live_indices_;
+		}
+
+		void Population::update_columns() {
+			if (!has_columns_) {
+				columns_.rebuild(_persons);
+				has_columns_ = true;
+			}
+		}
+
+		const PopulationColumns& Population::columns() const {
+			if (!has_columns_) {
+				throw std::logic_error("Population: columns were not built");
+			}
+			return columns_;
+		}
+
+		std::vector<Actor::shared_ptr<Person>> Population::live_persons_from_columns(const Date asof) const {
+			const std::vector<size_t> indices(columns().live_indices(asof));
+			std::vector<Actor::shared_ptr<Person>> live_persons;
+			live_persons.reserve(indices.size());
+			for (size_t i : indices) {
+				live_persons.push_back(_persons[i]);
 			}
 			return live_persons;
 		}
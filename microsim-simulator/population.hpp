@@ -3,11 +3,17 @@
 #define __AVERISERA_MS_POPULATION_H
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include "actor.hpp"
+#include "person_archive.hpp"
+#include "population_columns.hpp"
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
         class Contexts;
         class Person;
@@ -34,12 +40,16 @@ namespace averisera {
             /** Move constructor */
             Population(Population&& other);
 
+			/** Detaches the persons from this population (see update_columns()) */
+			~Population();
+
             /* Import Person objects from PersonData. Moves as much data as possible to save memory. 
 			Sorted added Person objects by ID in ascending order
             @param keep_ids If false, reset IDs.    
 			@param immigration This is immigration
+			@param pool If not null, Person objects are created from data in parallel using the pool threads
 			*/
-            void import_data(PopulationData& data, const Contexts& ctx, bool keep_ids, bool immigration);
+            void import_data(PopulationData& data, const Contexts& ctx, bool keep_ids, bool immigration, ThreadPool* pool = nullptr);
             
             /** Get person with given ID.
              * @return null if not found
@@ -50,15 +60,42 @@ namespace averisera {
                 return _persons;
             }
 
-			/** Return a vector with pointers to persons who are alive at asof date. */
+			/** Return a vector with pointers to persons who are alive at asof date, built from live_indices(). */
 			std::vector<Actor::shared_ptr<Person>> live_persons(Date asof) const;
 
+			/** Positions in persons() of persons alive at asof date, in ascending order.
+
+			Between calls the population keeps the positions of persons whose status can change as asof moves on (not born yet,
+			or with a date of death after the asof of the last call) and of persons added or reported by Person::die() since,
+			so that a call with asof not earlier than in the previous call checks only these persons. A call with an earlier asof,
+			transfer_persons(), merge() and sorting rebuild the live set from all persons, as does every call once a person
+			of this population was added to another one (it then notifies the other population instead).
+			Not thread-safe. The returned reference is valid until the next call to live_persons(), live_indices() or a modification of the population.
+			*/
+			const std::vector<size_t>& live_indices(Date asof) const;
+
+			/** Build columns() if they were not built yet. From then on they are updated when persons are added or removed,
+			and when a person changes its date of death or immigration date (the person notifies the population which added it last).
+			*/
+			void update_columns();
+
+			/** Columnar copy of the attributes of persons().
+			@throw std::logic_error If update_columns() was never called.
+			*/
+			const PopulationColumns& columns() const;
+
+			/** Return a vector with pointers to persons who are alive at asof date, using columns().
+			@throw std::logic_error If update_columns() was never called.
+			*/
+			std::vector<Actor::shared_ptr<Person>> live_persons_from_columns(Date asof) const;
+
             /** For templated access to members */
             template <class T> const std::vector<std::shared_ptr<T>>& members() const {
                 return get_members<T>(*this);
             }
 
-            /** Merge in elements of the other population
+            /** Merge in elements of the other population. Merged persons notify this population, not other, about changes
+			of their dates of death and immigration dates.
               @throw std::logic_error If populations have two same persons or with the same IDs
              */
             void merge(const Population& other);
@@ -83,18 +120,35 @@ namespace averisera {
             */
             void add_person(Actor::shared_ptr<Person> person, bool check_id = true);
 
-            /** Add new persons.
+            /** Add new persons. Costs O(persons.size()) amortised.
 			@param persons Vector of new persons, sorted by ID in ascending order.
-            * @throw std::domain_error If one of the added pointers is null or persons is not sorted by ID in ascending order
+            * @throw std::domain_error If one of the added pointers is null or persons is not sorted by ID in ascending order,
+			or (if check_ids is true) the first new person does not have a higher ID than other persons in the population. The population is not modified then.
             */
             void add_persons(const std::vector<Actor::shared_ptr<Person>>& persons, bool check_ids = true);
 
-			/** Remove this persons.
+			/** Remove this persons. Removed persons are found by binary search and the remaining ones are moved down in place,
+			starting from the first removed position.
 			@param persons Vector of removed persons, sorted by ID in ascending order.
-			@throw std::domain_error If any person in persons is not a member of this population, or is a null pointer.
+			@throw std::domain_error If any person in persons is not a member of this population, or is a null pointer. The population is not modified then.
 			*/
 			void remove_persons(const std::vector<Actor::shared_ptr<Person>>& persons);
 
+			/** Move persons who died before cutoff out of persons() into archive() as a new batch (see PersonArchive::start_batch()),
+			unless one of their children is alive or died on or after cutoff (so that links from children to their mothers remain valid).
+			Archived persons are no longer seen by operators and checkpoints (except via archive()); observers see them via Observer::observe_archived().
+
+			The first call scans all persons; afterwards the population keeps the positions of dead persons who were not archived yet
+			(reported by Person::die() and when dead persons are added), so the cost of a call is proportional to their number.
+			@return Number of archived persons
+			*/
+			size_t archive_dead_persons(Date cutoff);
+
+			/** Records of the persons removed by archive_dead_persons() */
+			const PersonArchive& archive() const {
+				return archive_;
+			}
+
 			/** Is population empty? */
 			bool empty() const;
 
@@ -105,20 +159,74 @@ namespace averisera {
 			/** Sort Person vector by ID in ascending order */
 			static void sort_persons(std::vector<Actor::shared_ptr<Person>>& persons);			
         private:
-			static void merge_persons(std::vector<Actor::shared_ptr<Person>>& dst, const std::vector<Actor::shared_ptr<Person>>& src);
-            static void link_parents_children(std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<PersonData>& person_data);
+			friend class Checkpoint;
+			friend class Person;
+
+			/** Merge sorted src into sorted dst in place. Persons in dst with IDs lower than src.front() are not moved.
+			@return Position of the first person in dst which was moved or added
+			@throw std::logic_error If src and dst have persons with the same IDs; dst is not modified then.
+			*/
+			static size_t merge_persons(std::vector<Actor::shared_ptr<Person>>& dst, const std::vector<Actor::shared_ptr<Person>>& src);
+
+			/** Point persons at positions from first onwards to this population and their positions in it, and rebuild their columns */
+			void adopt_persons(size_t first);
+
+			/** Detach person from this population, unless it was added to another one since */
+			void release_person(Person& person);
+
+			/** Called by Person when its date of death or immigration date changes. Safe to call concurrently for distinct persons. */
+			void update_person_columns(const Person& person);
+
+			/** Called by Person when its date of death is set or changed. Safe to call concurrently for distinct persons. */
+			void register_death(const Person& person);
+
+			/** Scan all persons for dead ones on the next call to archive_dead_persons() */
+			void invalidate_dead_candidates();
+
+			/** Detach the persons at given positions (ascending), erase them from _persons and update the rest */
+			void erase_persons(const std::vector<size_t>& positions);
+
+			/** Drop erased_positions (ascending) from positions (ascending) and shift the remaining positions down accordingly */
+			static void remove_erased_positions(std::vector<size_t>& positions, const std::vector<size_t>& erased_positions);
+
+			/** Update the live set after the persons at given positions (ascending) were erased from _persons */
+			void erase_live_candidates(const std::vector<size_t>& erased_positions);
+
+			/** Rebuild the live set from all persons on next call to live_indices() */
+			void invalidate_live_candidates() {
+				live_asof_ = Date();
+			}
+
+			/** Check if the person at position pos is alive as of asof, and add pos to live_pending_ if this can change for later asof */
+			bool check_live(size_t pos, Date asof) const;
+            /** @see Person::link_parents_child(std::vector<Person::shared_ptr>&, const std::vector<PersonData>&, ThreadPool*) */
+            static void link_parents_children(std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<PersonData>& person_data, ThreadPool* pool);
 
             /* Import Person objects from PersonData. Moves as much data as possible to save memory.
             */
-            void import_persons(std::vector<PersonData>& person_datas, const Contexts& ctx, bool keep_ids, bool immigration);
+            void import_persons(std::vector<PersonData>& person_datas, const Contexts& ctx, bool keep_ids, bool immigration, ThreadPool* pool);
 
 			/** Sort this persons by ID in ascending order */
 			void sort_persons() {
 				sort_persons(_persons);
+				adopt_persons(0);
+				invalidate_live_candidates();
+				invalidate_dead_candidates();
 			}
 
 			std::string name_;
             std::vector<Actor::shared_ptr<Person>> _persons; /**< Persons sorted by ID */
+			PopulationColumns columns_;
+			bool has_columns_; /**< Are columns_ built and kept up to date */
+			PersonArchive archive_;
+			bool hears_all_deaths_; /**< Is this the population notified by all its persons (none of them was added to another population since) */
+			bool tracks_deaths_; /**< Are dead_candidates_ kept up to date */
+			std::vector<size_t> dead_candidates_; /**< Positions in _persons of dead persons not archived yet; can contain duplicates */
+			std::mutex deaths_mutex_; /**< Guards dead_candidates_ and live_changes_ */
+			mutable std::vector<size_t> live_indices_; /**< Positions in _persons of persons alive as of live_asof_, ascending */
+			mutable std::vector<size_t> live_pending_; /**< Positions in _persons of persons not born or with a date of death after live_asof_ */
+			mutable std::vector<size_t> live_changes_; /**< Positions in _persons of persons added or reported by Person::die() since the last call to live_indices(); can contain duplicates */
+			mutable Date live_asof_; /**< Date of the last call to live_indices(); NAD if the live set must be rebuilt */
         };
 
         template <class AD> typename AD::shared_ptr Population::find_by_id(const std::vector<typename AD::shared_ptr>& objects, Actor::id_t id) {
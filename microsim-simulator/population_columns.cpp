@@ -0,0 +1,79 @@
+// (C) Averisera Ltd 2014-2020
+#include "person.hpp"
+#include "population_columns.hpp"
+#include "core/preconditions.hpp"
+#include <cassert>
+
+namespace averisera {
+    namespace microsim {
+        void PopulationColumns::rebuild_from(const std::vector<Actor::shared_ptr<Person>>& persons, const size_t first) {
+            check_that(first <= size(), "PopulationColumns: first rebuilt row out of range");
+            const size_t n = persons.size();
+            for (size_t i = first; i < n; ++i) {
+                check_not_null(persons[i].get(), "PopulationColumns: null Person");
+            }
+            ids_.resize(n);
+            dobs_.resize(n);
+            yobs_.resize(n);
+            sexes_.resize(n);
+            ethnicities_.resize(n);
+            dods_.resize(n);
+            immigration_dates_.resize(n);
+            for (size_t i = first; i < n; ++i) {
+                const Person& person = *persons[i];
+                ids_[i] = person.id();
+                dobs_[i] = person.date_of_birth();
+                yobs_[i] = person.year_of_birth();
+                sexes_[i] = person.sex();
+                ethnicities_[i] = person.ethnicity();
+                update(i, person);
+            }
+        }
+
+        template <class T> static void erase_positions(std::vector<T>& column, const std::vector<size_t>& positions) {
+            auto pos_it = positions.begin();
+            size_t dst = positions.front();
+            for (size_t i = dst; i < column.size(); ++i) {
+                if (pos_it != positions.end() && *pos_it == i) {
+                    ++pos_it;
+                } else {
+                    column[dst] = column[i];
+                    ++dst;
+                }
+            }
+            column.resize(dst);
+        }
+
+        void PopulationColumns::erase(const std::vector<size_t>& positions) {
+            if (positions.empty()) {
+                return;
+            }
+            check_that(positions.back() < size(), "PopulationColumns: erased row out of range");
+            erase_positions(ids_, positions);
+            erase_positions(dobs_, positions);
+            erase_positions(yobs_, positions);
+            erase_positions(sexes_, positions);
+            erase_positions(ethnicities_, positions);
+            erase_positions(dods_, positions);
+            erase_positions(immigration_dates_, positions);
+        }
+
+        void PopulationColumns::update(const size_t i, const Person& person) {
+            assert(i < size());
+            assert(ids_[i] == person.id());
+            dods_[i] = person.date_of_death();
+            immigration_dates_[i] = person.immigration_date();
+        }
+
+        std::vector<size_t> PopulationColumns::live_indices(const Date as_of) const {
+            std::vector<size_t> indices;
+            indices.reserve(size());
+            for (size_t i = 0; i < size(); ++i) {
+                if (is_alive(i, as_of)) {
+                    indices.push_back(i);
+                }
+            }
+            return indices;
+        }
+    }
+}
@@ -0,0 +1,100 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_POPULATION_COLUMNS_H
+#define __AVERISERA_MS_POPULATION_COLUMNS_H
+
+#include "actor.hpp"
+#include "core/dates.hpp"
+#include "microsim-core/person_attributes.hpp"
+#include <memory>
+#include <vector>
+
+namespace averisera {
+    namespace microsim {
+        class Person;
+
+        /** @brief Columnar (structure-of-arrays) copy of the fixed attributes of a vector of Persons.
+
+        Element i of every column describes the i-th Person of the vector the columns were built from. Scanning a column
+        touches contiguous memory instead of dereferencing a pointer per Person. Population keeps the columns in step with
+        its Person vector when persons are added or removed, and with the dates of death and immigration dates of its persons
+        when they change (see update()).
+        */
+        class PopulationColumns {
+        public:
+            /** Rebuild all columns.
+            @throw std::domain_error If any pointer is null.
+            */
+            void rebuild(const std::vector<Actor::shared_ptr<Person>>& persons) {
+                rebuild_from(persons, 0);
+            }
+
+            /** Rebuild the rows from first onwards, keeping rows before first.
+            @throw std::domain_error If first > size() or any pointer from first onwards is null. Rows before first are kept then.
+            */
+            void rebuild_from(const std::vector<Actor::shared_ptr<Person>>& persons, size_t first);
+
+            /** Erase rows at given positions.
+            @param positions Positions sorted in ascending order
+            */
+            void erase(const std::vector<size_t>& positions);
+
+            /** Copy again the attributes of the i-th Person which can change (date of death, immigration date).
+            Updating distinct rows from different threads is safe.
+            */
+            void update(size_t i, const Person& person);
+
+            /** Number of Persons */
+            size_t size() const {
+                return ids_.size();
+            }
+
+            const std::vector<Actor::id_t>& ids() const {
+                return ids_;
+            }
+
+            const std::vector<Date>& dates_of_birth() const {
+                return dobs_;
+            }
+
+            /** Not-a-date for Persons who have not died */
+            const std::vector<Date>& dates_of_death() const {
+                return dods_;
+            }
+
+            const std::vector<Date::year_type>& years_of_birth() const {
+                return yobs_;
+            }
+
+            const std::vector<Sex>& sexes() const {
+                return sexes_;
+            }
+
+            const std::vector<PersonAttributes::ethnicity_t>& ethnicities() const {
+                return ethnicities_;
+            }
+
+            /** Not-a-date for Persons who have never immigrated */
+            const std::vector<Date>& immigration_dates() const {
+                return immigration_dates_;
+            }
+
+            /** Is the i-th Person alive at as_of date. @see Person::is_alive */
+            bool is_alive(size_t i, Date as_of) const {
+                return as_of >= dobs_[i] && (dods_[i].is_not_a_date() || as_of < dods_[i]);
+            }
+
+            /** Indices of Persons alive at as_of date, in ascending order */
+            std::vector<size_t> live_indices(Date as_of) const;
+        private:
+            std::vector<Actor::id_t> ids_;
+            std::vector<Date> dobs_;
+            std::vector<Date> dods_;
+            std::vector<Date::year_type> yobs_;
+            std::vector<Sex> sexes_;
+            std::vector<PersonAttributes::ethnicity_t> ethnicities_;
+            std::vector<Date> immigration_dates_;
+        };
+    }
+}
+
+#endif // __AVERISERA_MS_POPULATION_COLUMNS_H
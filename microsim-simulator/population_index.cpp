@@ -0,0 +1,137 @@
+// (C) Averisera Ltd 2014-2020
+#include "population_index.hpp"
+#include "contexts.hpp"
+#include "person.hpp"
+#include "population_columns.hpp"
+#include "predicate.hpp"
+#include "core/preconditions.hpp"
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+
+namespace averisera {
+    namespace microsim {
+        PopulationIndex::PopulationIndex()
+            : min_year_of_birth_(0), max_year_of_birth_(-1), nbr_ethnicities_(0) {}
+
+        template <class F> void PopulationIndex::rebuild(const size_t n, F attributes) {
+            // counting sort of positions by bucket, stable so that every bucket is sorted
+            min_year_of_birth_ = std::numeric_limits<int>::max();
+            max_year_of_birth_ = std::numeric_limits<int>::min();
+            nbr_ethnicities_ = 0;
+            for (size_t k = 0; k < n; ++k) {
+                const auto attr = attributes(k);
+                min_year_of_birth_ = std::min(min_year_of_birth_, std::get<0>(attr));
+                max_year_of_birth_ = std::max(max_year_of_birth_, std::get<0>(attr));
+                nbr_ethnicities_ = std::max(nbr_ethnicities_, static_cast<size_t>(std::get<2>(attr)) + 1);
+            }
+            bucket_offsets_.clear();
+            positions_.resize(n);
+            if (!n) {
+                min_year_of_birth_ = 0;
+                max_year_of_birth_ = -1;
+                return;
+            }
+            const size_t nbr_buckets = static_cast<size_t>(max_year_of_birth_ - min_year_of_birth_ + 1) * 2 * nbr_ethnicities_;
+            bucket_offsets_.assign(nbr_buckets + 1, 0);
+            for (size_t k = 0; k < n; ++k) {
+                const auto attr = attributes(k);
+                ++bucket_offsets_[bucket(std::get<0>(attr), std::get<1>(attr), std::get<2>(attr)) + 1];
+            }
+            for (size_t b = 1; b <= nbr_buckets; ++b) {
+                bucket_offsets_[b] += bucket_offsets_[b - 1];
+            }
+            std::vector<size_t> next(bucket_offsets_.begin(), bucket_offsets_.end() - 1);
+            for (size_t k = 0; k < n; ++k) {
+                const auto attr = attributes(k);
+                positions_[next[bucket(std::get<0>(attr), std::get<1>(attr), std::get<2>(attr))]++] = k;
+            }
+        }
+
+        void PopulationIndex::rebuild(const PopulationColumns& columns, const std::vector<size_t>& indices) {
+            for (size_t i : indices) {
+                if (i >= columns.size()) {
+                    throw std::out_of_range("PopulationIndex: index out of range");
+                }
+            }
+            const auto& yobs = columns.years_of_birth();
+            const auto& sexes = columns.sexes();
+            const auto& ethnicities = columns.ethnicities();
+            rebuild(indices.size(), [&](size_t k) {
+                const size_t i = indices[k];
+                return std::make_tuple(static_cast<int>(yobs[i]), sexes[i], ethnicities[i]);
+            });
+        }
+
+        void PopulationIndex::rebuild(const std::vector<Actor::shared_ptr<Person>>& persons) {
+            check_all_not_null(persons, "PopulationIndex: null person");
+            rebuild(persons.size(), [&persons](size_t k) {
+                const Person& person = *persons[k];
+                return std::make_tuple(static_cast<int>(person.year_of_birth()), person.sex(), person.ethnicity());
+            });
+        }
+
+        void PopulationIndex::select(const SelectionBounds& bounds, std::vector<size_t>& positions) const {
+            if (bounds.empty() || positions_.empty()) {
+                return;
+            }
+            const size_t old_size = positions.size();
+            if (bounds.unbounded()) {
+                positions.reserve(old_size + positions_.size());
+                for (size_t k = 0; k < positions_.size(); ++k) {
+                    positions.push_back(k);
+                }
+                return;
+            }
+            const int min_yob = std::max(bounds.min_year_of_birth, min_year_of_birth_);
+            const int max_yob = std::min(bounds.max_year_of_birth, max_year_of_birth_);
+            std::vector<SelectionBounds::ethnicity_t> ethnicities;
+            for (size_t e = 0; e < nbr_ethnicities_; ++e) {
+                if (bounds.ethnicities[e]) {
+                    ethnicities.push_back(static_cast<SelectionBounds::ethnicity_t>(e));
+                }
+            }
+            size_t nbr_nonempty_buckets = 0;
+            for (int yob = min_yob; yob <= max_yob; ++yob) {
+                for (Sex sex : { Sex::FEMALE, Sex::MALE }) {
+                    if (!bounds.sexes[static_cast<size_t>(sex)]) {
+                        continue;
+                    }
+                    for (SelectionBounds::ethnicity_t eth : ethnicities) {
+                        const size_t b = bucket(yob, sex, eth);
+                        const auto begin = positions_.begin() + static_cast<std::ptrdiff_t>(bucket_offsets_[b]);
+                        const auto end = positions_.begin() + static_cast<std::ptrdiff_t>(bucket_offsets_[b + 1]);
+                        if (begin != end) {
+                            positions.insert(positions.end(), begin, end);
+                            ++nbr_nonempty_buckets;
+                        }
+                    }
+                }
+            }
+            if (nbr_nonempty_buckets > 1) {
+                std::sort(positions.begin() + static_cast<std::ptrdiff_t>(old_size), positions.end());
+            }
+        }
+
+        void PopulationIndex::select_alive(const Predicate<Person>& predicate, const std::vector<Actor::shared_ptr<Person>>& persons, const Contexts& ctx, std::vector<Actor::shared_ptr<Person>>& selected) const {
+            check_equals(size(), persons.size(), "PopulationIndex: wrong number of persons");
+            const SelectionBounds bounds(predicate.selection_bounds(ctx.asof()));
+            if (bounds.unbounded()) {
+                predicate.select_alive(persons, ctx, selected);
+                return;
+            }
+            std::vector<size_t> candidates;
+            select(bounds, candidates);
+            for (size_t k : candidates) {
+                const auto& person_ptr = persons[k];
+                assert(person_ptr);
+                if (predicate.select_alive(*person_ptr, ctx)) {
+                    selected.push_back(person_ptr);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_POPULATION_INDEX_H
+#define __AVERISERA_MS_POPULATION_INDEX_H
+
+#include "actor.hpp"
+#include "selection_bounds.hpp"
+#include <vector>
+
+namespace averisera {
+    namespace microsim {
+        class Contexts;
+        class Person;
+        class PopulationColumns;
+        template <class T> class Predicate;
+
+        /** @brief Index of persons bucketed by (year of birth, sex, ethnicity).
+
+        Persons are identified by their position in the indexed sequence. Lets Predicates with bounded SelectionBounds
+        visit only the persons in matching buckets instead of the whole population. Positions are returned in ascending order,
+        so the selection order (and hence the random numbers drawn by operators applied in serial) is the same as for a full scan.
+        */
+        class PopulationIndex {
+        public:
+            /** Empty index */
+            PopulationIndex();
+
+            /** Index the persons described by columns at given indices; position k refers to the person at indices[k].
+            @throw std::out_of_range If any index is not smaller than columns.size().
+            */
+            void rebuild(const PopulationColumns& columns, const std::vector<size_t>& indices);
+
+            /** Index persons; position k refers to persons[k].
+            @throw std::domain_error If any pointer is null.
+            */
+            void rebuild(const std::vector<Actor::shared_ptr<Person>>& persons);
+
+            /** Number of indexed persons */
+            size_t size() const {
+                return positions_.size();
+            }
+
+            /** Append to positions (in ascending order) the positions of indexed persons within bounds */
+            void select(const SelectionBounds& bounds, std::vector<size_t>& positions) const;
+
+            /** Append to selected the persons for which predicate.select_alive() is true, checking only those within predicate.selection_bounds(ctx.asof()).
+            @param persons Live persons, in the same order as indexed.
+            @throw std::domain_error If persons.size() != size().
+            */
+            void select_alive(const Predicate<Person>& predicate, const std::vector<Actor::shared_ptr<Person>>& persons, const Contexts& ctx, std::vector<Actor::shared_ptr<Person>>& selected) const;
+        private:
+            template <class F> void rebuild(size_t n, F attributes);
+
+            size_t bucket(int year_of_birth, Sex sex, SelectionBounds::ethnicity_t ethnicity) const {
+                return (static_cast<size_t>(year_of_birth - min_year_of_birth_) * 2 + static_cast<size_t>(sex)) * nbr_ethnicities_ + ethnicity;
+            }
+
+            int min_year_of_birth_;
+            int max_year_of_birth_;
+            size_t nbr_ethnicities_; /**< Maximum indexed ethnicity + 1 */
+            std::vector<size_t> bucket_offsets_; /**< Positions in bucket b are positions_[bucket_offsets_[b]], ..., positions_[bucket_offsets_[b + 1] - 1] */
+            std::vector<size_t> positions_;
+        };
+    }
+}
+
+#endif // __AVERISERA_MS_POPULATION_INDEX_H
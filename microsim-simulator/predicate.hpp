@@ -9,10 +9,12 @@
 #include <vector>
 #include "core/dates.hpp"
 #include "core/printable.hpp"
+#include "selection_bounds.hpp"
 
 namespace averisera {
     namespace microsim {
         class Contexts;
+        class PredicateProgram;
                 
         /** @brief Selects an object based on some criteria.
          * 
@@ -75,6 +77,8 @@ namespace averisera {
               assume that the context-sensitive selection criteria are met.
 
               Any object selected by select() must also be selected by select_out_of_context().
+
+              For Person, the result may depend only on year of birth, sex, ethnicity and immigration date (Simulator memoises it per combination of these).
             */
             virtual bool select_out_of_context(const T& obj) const = 0;
             
@@ -90,6 +94,20 @@ namespace averisera {
                 return false;
             }
 
+			/** Bounds on the basic attributes of persons selected by select_alive() on date asof, used to skip persons who cannot be selected.
+			Meaningful only for Predicate<Person>. Default implementation returns unbounded SelectionBounds.
+			*/
+			virtual SelectionBounds selection_bounds(Date /*asof*/) const {
+				return SelectionBounds();
+			}
+
+			/** Add a single instruction equivalent to this predicate to program, if possible. Meaningful only for Predicate<Person>.
+			@return False if the predicate cannot be compiled and must be evaluated by calling select() or select_alive().
+			*/
+			virtual bool compile(PredicateProgram& /*program*/) const {
+				return false;
+			}
+
 			/** Selects only entities which are "alive" (e.g. live persons, active companies, etc.) */
 			virtual bool selects_alive_only() const {
 				return false;
@@ -5,7 +5,11 @@
 #include <stdexcept>
 #include "../person.hpp"
 #include "../contexts.hpp"
+#include "../predicate_program.hpp"
 #include <boost/format.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 
 namespace averisera {
     namespace microsim {
@@ -30,6 +34,20 @@ namespace averisera {
 			return select_alive_impl(obj, asof);
 		}
 
+		SelectionBounds PredAge::selection_bounds(Date asof) const {
+			// Person aged A on asof was born in year asof.year() - A or asof.year() - A - 1.
+			SelectionBounds bounds;
+			const int64_t year = static_cast<int64_t>(asof.year());
+			bounds.min_year_of_birth = static_cast<int>(std::max<int64_t>(year - static_cast<int64_t>(_max_age) - 1, std::numeric_limits<int>::min()));
+			bounds.max_year_of_birth = static_cast<int>(year - static_cast<int64_t>(_min_age));
+			return bounds;
+		}
+
+		bool PredAge::compile(PredicateProgram& program) const {
+			program.add_age(_min_age, _max_age, _alive);
+			return true;
+		}
+
 		void PredAge::print(std::ostream& os) const {
 			os << "Age(" << _min_age << ", " << _max_age << ", " << _alive << ")";
 		}
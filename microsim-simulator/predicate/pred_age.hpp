@@ -41,6 +41,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return _alive;
 			}
+			SelectionBounds selection_bounds(Date asof) const override;
+			bool compile(PredicateProgram& program) const override;
         private:            
             unsigned int _min_age;
             unsigned int _max_age;
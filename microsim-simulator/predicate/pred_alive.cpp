@@ -3,9 +3,15 @@
 #include "pred_or.hpp"
 #include "../person.hpp"
 #include "../contexts.hpp"
+#include "../predicate_program.hpp"
 
 namespace averisera {
     namespace microsim {
+        bool PredAlive::compile(PredicateProgram& program) const {
+            program.add_alive();
+            return true;
+        }
+
         bool PredAlive::select(const Person& obj, const Contexts& contexts) const {
             const Date asof = contexts.asof();
             return obj.is_alive(asof);
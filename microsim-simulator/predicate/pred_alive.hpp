@@ -37,6 +37,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return true;
 			}
+
+			bool compile(PredicateProgram& program) const override;
         };
     }
 }
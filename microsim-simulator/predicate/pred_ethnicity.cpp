@@ -4,6 +4,7 @@
 #include "pred_ethnicity.hpp"
 #include "../person.hpp"
 #include "../contexts.hpp"
+#include "../predicate_program.hpp"
 #include "core/preconditions.hpp"
 #include <algorithm>
 
@@ -21,6 +22,22 @@ namespace averisera {
 			return life_signs_ok(obj, contexts) && select_out_of_context(obj);
 		}
 
+		SelectionBounds PredEthnicity::selection_bounds(Date /*asof*/) const {
+			SelectionBounds bounds;
+			bounds.ethnicities.reset();
+			for (int idx : get_group_indices()) {
+				if (idx >= 0 && static_cast<size_t>(idx) < bounds.ethnicities.size()) {
+					bounds.ethnicities.set(static_cast<size_t>(idx));
+				}
+			}
+			return bounds;
+		}
+
+		bool PredEthnicity::compile(PredicateProgram& program) const {
+			program.add_ethnicity(get_group_indices(), get_alive());
+			return true;
+		}
+
 		void PredEthnicity::print(std::ostream& os) const {
 			os << "Ethnicity" << get_name_suffix() << "(" << get_group_indices() << ", " << get_alive() << ")";
 		}
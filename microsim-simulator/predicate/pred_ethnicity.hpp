@@ -31,6 +31,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return get_alive();
 			}
+			SelectionBounds selection_bounds(Date asof) const override;
+			bool compile(PredicateProgram& program) const override;
 		protected:
 			bool get_alive() const {
 				return !accept_dead_;
@@ -2,6 +2,7 @@
 #include "pred_immigration_date.hpp"
 #include "core/preconditions.hpp"
 #include "../person.hpp"
+#include "../predicate_program.hpp"
 
 namespace averisera {
 	namespace microsim {
@@ -32,6 +33,11 @@ namespace averisera {
 			return allow_non_immigrants_ || date >= from_;
 		}
 		
+		bool PredImmigrationDate::compile(PredicateProgram& program) const {
+			program.add_immigration_date(from_, to_, allow_non_immigrants_, require_alive_);
+			return true;
+		}
+
 		void PredImmigrationDate::print(std::ostream& os) const {
 			os << "ImmigrationDate(" << from_ << ", " << to_ << ", " << allow_non_immigrants_ << ", " << require_alive_ << ")";
 		}
@@ -35,6 +35,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return require_alive_;
 			}
+
+			bool compile(PredicateProgram& program) const override;
 		private:
 			Date from_;
 			Date to_;
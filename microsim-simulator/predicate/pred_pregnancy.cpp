@@ -34,7 +34,7 @@ namespace averisera {
 		}
 
 		bool PredPregnancy::is_pregnant(const Person& obj, const Contexts& contexts) const {
-			const auto hist_idx = obj.get_variable_index(contexts, Procreation::PREGNANCY_EVENT());
+			const auto hist_idx = obj.get_variable_index(contexts, Procreation::PREGNANCY_EVENT_HANDLE());
 			const ImmutableHistory& history = obj.history(hist_idx);
 			const Date asof = at_start_ ? contexts.current_period().begin : contexts.current_period().end;
 			if (history.empty() || history.first_date() > asof) {
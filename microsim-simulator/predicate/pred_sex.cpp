@@ -4,6 +4,7 @@
 #include "pred_sex.hpp"
 #include "../person.hpp"
 #include "../contexts.hpp"
+#include "../predicate_program.hpp"
 
 namespace averisera {
 	namespace microsim {
@@ -22,6 +23,18 @@ namespace averisera {
             return _sex == obj.sex();
         }
 
+		SelectionBounds PredSex::selection_bounds(Date /*asof*/) const {
+			SelectionBounds bounds;
+			bounds.sexes.reset();
+			bounds.sexes.set(static_cast<size_t>(_sex));
+			return bounds;
+		}
+
+		bool PredSex::compile(PredicateProgram& program) const {
+			program.add_sex(_sex, _alive);
+			return true;
+		}
+
 		void PredSex::print(std::ostream& os) const {
 			os << "Sex(" << _sex << ", " << _alive << ")";
 		}
@@ -30,6 +30,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return _alive;
 			}
+			SelectionBounds selection_bounds(Date asof) const override;
+			bool compile(PredicateProgram& program) const override;
 		private:
 			Sex _sex;
             bool _alive;
@@ -3,6 +3,7 @@
 #define __AVERISERA_MS_PRED_TRUE_H
 
 #include "../predicate.hpp"
+#include "../predicate_program.hpp"
 #include <stdexcept>
 
 namespace averisera {
@@ -49,6 +50,11 @@ namespace averisera {
                 }
             }
 
+			bool compile(PredicateProgram& program) const override {
+				program.add_constant(true);
+				return true;
+			}
+
 			void print(std::ostream& os) const override {
 				os << "True";
 			}
@@ -23,9 +23,6 @@ namespace averisera {
 
         template <class T, class V> PredVariableRange<T, V>::PredVariableRange(const std::string& variable, V min, V max, bool accept_missing)
             : _variable(variable), _min(min), _max(max), _accept_missing(accept_missing), _always_true(is_always_true(min, max, accept_missing)) {
-            if (_variable.empty()) {
-                throw std::domain_error("PredVariableRange: variable name empty");
-            }
             if (_min > _max) {
                 throw std::domain_error("PredVariableRange: range limits out of order");
             }
@@ -54,7 +51,7 @@ namespace averisera {
         }
 
 		template <class T, class V> void PredVariableRange<T, V>::print(std::ostream& os) const {
-			os << "VariableRange(\"" << _variable << "\", " << _min << ", " << _max << ", " << _accept_missing << ")";
+			os << "VariableRange(\"" << _variable.name() << "\", " << _min << ", " << _max << ", " << _accept_missing << ")";
 		}
 
         template class PredVariableRange<Actor, History::double_t>;
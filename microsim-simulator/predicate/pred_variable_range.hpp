@@ -4,6 +4,7 @@
 
 //#include "../actor.h"
 #include "../predicate.hpp"
+#include "../variable_handle.hpp"
 #include <string>
 //#include <type_traits>
 
@@ -32,7 +33,7 @@ namespace averisera {
             }
 
             PredVariableRange<T, V>* clone() const override {
-                return new PredVariableRange<T, V>(_variable, _min, _max, _accept_missing);
+                return new PredVariableRange<T, V>(_variable.name(), _min, _max, _accept_missing);
             }
 
             bool select_out_of_context(const T&) const override {
@@ -45,7 +46,7 @@ namespace averisera {
 
 			void print(std::ostream& os) const override;
         private:
-            std::string _variable;
+            VariableHandle _variable;
             V _min;
             V _max;
             bool _accept_missing;
@@ -6,6 +6,7 @@
 #include "core/dates.hpp"
 #include "microsim-simulator/person.hpp"
 #include "../contexts.hpp"
+#include "../predicate_program.hpp"
 #include <stdexcept>
 
 namespace averisera {
@@ -31,6 +32,18 @@ namespace averisera {
 			return _min_yob <= yob && yob <= _max_yob;
         }
 
+		SelectionBounds PredYearOfBirth::selection_bounds(Date /*asof*/) const {
+			SelectionBounds bounds;
+			bounds.min_year_of_birth = _min_yob;
+			bounds.max_year_of_birth = _max_yob;
+			return bounds;
+		}
+
+		bool PredYearOfBirth::compile(PredicateProgram& program) const {
+			program.add_year_of_birth(_min_yob, _max_yob, _alive);
+			return true;
+		}
+
 		void PredYearOfBirth::print(std::ostream& os) const {
 			os << "YearOfBirth(" << _min_yob << ", " << _max_yob << ", " << _alive << ")";
 		}
@@ -39,6 +39,8 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return _alive;
 			}
+			SelectionBounds selection_bounds(Date asof) const override;
+			bool compile(PredicateProgram& program) const override;
 		private:
 			int _min_yob;
 			int _max_yob;
@@ -104,6 +104,10 @@ namespace averisera {
                 return _predicates.size();
             }
 
+			const std::vector<std::shared_ptr<const Predicate<T>>>& predicates() const {
+				return _predicates;
+			}
+
 			void print(std::ostream& os) const override {
 				os << "And(";
 				auto it = _predicates.begin();
@@ -121,6 +125,14 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return require_alive_;
 			}
+
+			SelectionBounds selection_bounds(Date asof) const override {
+				SelectionBounds bounds;
+				for (const auto& pred : _predicates) {
+					bounds.intersect(pred->selection_bounds(asof));
+				}
+				return bounds;
+			}
 		private:
 			std::vector<std::shared_ptr<const Predicate<T>>> _predicates;
             bool _always_true;
@@ -230,6 +242,10 @@ namespace averisera {
                 return _predicates.size();
             }
 
+			const std::vector<std::shared_ptr<const Predicate<T>>>& predicates() const {
+				return _predicates;
+			}
+
 			void print(std::ostream& os) const override {
 				os << "Or(";
 				auto it = _predicates.begin();
@@ -247,6 +263,16 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return require_alive_;
 			}
+
+			SelectionBounds selection_bounds(Date asof) const override {
+				auto it = _predicates.begin();
+				assert(it != _predicates.end());
+				SelectionBounds bounds((*it)->selection_bounds(asof));
+				for (++it; it != _predicates.end(); ++it) {
+					bounds.unite((*it)->selection_bounds(asof));
+				}
+				return bounds;
+			}
 		private:
             PredOr(const PredOr<T>& other) = default;
 
@@ -318,6 +344,10 @@ namespace averisera {
 			bool selects_alive_only() const override {
 				return false;
 			}
+
+			const Predicate<T>& predicate() const {
+				return *_pred;
+			}
 		private:
 			std::shared_ptr<const Predicate<T>> _pred;
 		};
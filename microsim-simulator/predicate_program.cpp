@@ -0,0 +1,333 @@
+// (C) Averisera Ltd 2014-2020
+#include "predicate_program.hpp"
+#include "contexts.hpp"
+#include "person.hpp"
+#include "population_columns.hpp"
+#include "predicate.hpp"
+#include "core/period.hpp"
+#include "core/preconditions.hpp"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace averisera {
+    namespace microsim {
+        PredicateProgram::PredicateProgram(const Predicate<Person>& predicate)
+            : max_depth_(0), level_(0) {
+            compile(predicate);
+            assert(level_ == 0);
+        }
+
+        size_t PredicateProgram::nbr_fallbacks() const {
+            return static_cast<size_t>(std::count_if(instructions_.begin(), instructions_.end(), [](const Instruction& instr) {
+                return instr.code == OpCode::FALLBACK;
+            }));
+        }
+
+        void PredicateProgram::compile(const Predicate<Person>& predicate) {
+            const PredAnd<Person>* pred_and = dynamic_cast<const PredAnd<Person>*>(&predicate);
+            const PredOr<Person>* pred_or = dynamic_cast<const PredOr<Person>*>(&predicate);
+            if (pred_and || pred_or) {
+                const auto& children = pred_and ? pred_and->predicates() : pred_or->predicates();
+                Instruction instr(pred_and ? OpCode::AND : OpCode::OR, false);
+                instr.nbr_args = children.size();
+                instructions_.push_back(instr);
+                ++level_;
+                for (const auto& child : children) {
+                    compile(*child);
+                }
+                --level_;
+                max_depth_ = std::max(max_depth_, level_ + 1);
+            } else if (const PredNot<Person>* pred_not = dynamic_cast<const PredNot<Person>*>(&predicate)) {
+                instructions_.push_back(Instruction(OpCode::NOT, false));
+                ++level_;
+                compile(pred_not->predicate());
+                --level_;
+            } else {
+                const size_t old_size = instructions_.size();
+                if (predicate.compile(*this)) {
+                    if (instructions_.size() != old_size + 1) {
+                        throw std::logic_error("PredicateProgram: Predicate::compile must add exactly one instruction");
+                    }
+                } else {
+                    Instruction instr(OpCode::FALLBACK, false);
+                    instr.predicate = &predicate;
+                    instructions_.push_back(instr);
+                }
+                max_depth_ = std::max(max_depth_, level_ + 1);
+            }
+        }
+
+        void PredicateProgram::add_constant(bool value) {
+            Instruction instr(OpCode::CONSTANT, false);
+            instr.min_value = value ? 1 : 0;
+            instructions_.push_back(instr);
+        }
+
+        void PredicateProgram::add_alive() {
+            instructions_.push_back(Instruction(OpCode::ALIVE, true));
+        }
+
+        void PredicateProgram::add_year_of_birth(int min_year, int max_year, bool require_alive) {
+            Instruction instr(OpCode::YEAR_OF_BIRTH, require_alive);
+            instr.min_value = min_year;
+            instr.max_value = max_year;
+            instructions_.push_back(instr);
+        }
+
+        void PredicateProgram::add_age(unsigned int min_age, unsigned int max_age, bool require_alive) {
+            Instruction instr(OpCode::AGE, require_alive);
+            instr.min_value = min_age;
+            instr.max_value = max_age;
+            instructions_.push_back(instr);
+        }
+
+        void PredicateProgram::add_sex(Sex sex, bool require_alive) {
+            Instruction instr(OpCode::SEX, require_alive);
+            instr.sex = sex;
+            instructions_.push_back(instr);
+        }
+
+        void PredicateProgram::add_ethnicity(const std::vector<int>& groups, bool require_alive) {
+            Instruction instr(OpCode::ETHNICITY, require_alive);
+            instr.nbr_args = ethnicity_tables_.size();
+            std::array<uint8_t, 256> table;
+            table.fill(0);
+            for (int group : groups) {
+                if (group >= 0 && static_cast<size_t>(group) < table.size()) {
+                    table[static_cast<size_t>(group)] = 1;
+                }
+            }
+            ethnicity_tables_.push_back(table);
+            instructions_.push_back(instr);
+        }
+
+        void PredicateProgram::add_immigration_date(Date from, Date to, bool allow_non_immigrants, bool require_alive) {
+            Instruction instr(OpCode::IMMIGRATION_DATE, require_alive);
+            instr.from = from;
+            instr.to = to;
+            instr.allow_non_immigrants = allow_non_immigrants;
+            instructions_.push_back(instr);
+        }
+
+        bool PredicateProgram::latest_birth_date(const Date asof, const unsigned int age, Date& dob) {
+            if (!age) {
+                dob = asof;
+                return true;
+            }
+            const int64_t max_offset = std::min<int64_t>((static_cast<int64_t>(age) + 1) * 366, Date::MIN.dist_days(asof));
+            if (max_offset <= 0) {
+                return false;
+            }
+            const auto has_age = [asof, age](int64_t offset) {
+                const Date d(asof - Period(PeriodType::DAYS, static_cast<Period::size_type>(offset)));
+                return static_cast<int64_t>(d.dist_years(asof)) >= static_cast<int64_t>(age);
+            };
+            if (!has_age(max_offset)) {
+                return false;
+            }
+            // Person::age is non-decreasing in the distance between date of birth and asof
+            int64_t lo = 0; // !has_age(lo)
+            int64_t hi = max_offset; // has_age(hi)
+            while (hi - lo > 1) {
+                const int64_t mid = lo + (hi - lo) / 2;
+                if (has_age(mid)) {
+                    hi = mid;
+                } else {
+                    lo = mid;
+                }
+            }
+            dob = asof - Period(PeriodType::DAYS, static_cast<Period::size_type>(hi));
+            return true;
+        }
+
+        void PredicateProgram::select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+            const Contexts& ctx, const bool alive_only, std::vector<Actor::shared_ptr<Person>>& selected) const {
+            select_rows(columns, persons, rows, ctx, alive_only, [&persons, &selected](size_t row) {
+                selected.push_back(persons[row]);
+            });
+        }
+
+        void PredicateProgram::select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+            const Contexts& ctx, const bool alive_only, std::vector<const Actor::shared_ptr<Person>*>& selected) const {
+            select_rows(columns, persons, rows, ctx, alive_only, [&persons, &selected](size_t row) {
+                selected.push_back(&persons[row]);
+            });
+        }
+
+        void PredicateProgram::select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+            const Contexts& ctx, const bool alive_only, std::vector<uint8_t>& mask) const {
+            mask.assign(persons.size(), 0);
+            select_rows(columns, persons, rows, ctx, alive_only, [&mask](size_t row) {
+                mask[row] = 1;
+            });
+        }
+
+        template <class F> void PredicateProgram::select_rows(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+            const Contexts& ctx, const bool alive_only, F append) const {
+            check_equals(persons.size(), columns.size(), "PredicateProgram: columns do not match persons");
+            for (size_t row : rows) {
+                if (row >= persons.size()) {
+                    throw std::out_of_range("PredicateProgram: row out of range");
+                }
+            }
+            // dates of birth giving the selected ages as of ctx.asof()
+            const Date asof = ctx.asof();
+            std::vector<std::pair<Date, Date>> age_ranges(instructions_.size());
+            for (size_t i = 0; i < instructions_.size(); ++i) {
+                const Instruction& instr = instructions_[i];
+                if (instr.code == OpCode::AGE) {
+                    Date hi;
+                    if (!latest_birth_date(asof, static_cast<unsigned int>(instr.min_value), hi)) {
+                        age_ranges[i] = std::make_pair(Date::MAX, Date::MIN);
+                        continue;
+                    }
+                    Date lo;
+                    if (instr.max_value < std::numeric_limits<unsigned int>::max() && latest_birth_date(asof, static_cast<unsigned int>(instr.max_value + 1), lo)) {
+                        lo = lo + Period(PeriodType::DAYS, 1);
+                    } else {
+                        lo = Date::MIN;
+                    }
+                    age_ranges[i] = std::make_pair(lo, hi);
+                }
+            }
+            std::vector<mask_type> values(max_depth_);
+            std::vector<mask_type> guards(max_depth_);
+            guards.front().fill(1);
+            for (size_t begin = 0; begin < rows.size(); begin += BATCH_SIZE) {
+                const size_t n = std::min(BATCH_SIZE, rows.size() - begin);
+                evaluate_node(0, 0, columns, persons, rows.data() + begin, n, ctx, alive_only, age_ranges, values, guards);
+                const mask_type& mask = values.front();
+                for (size_t j = 0; j < n; ++j) {
+                    if (mask[j]) {
+                        append(rows[begin + j]);
+                    }
+                }
+            }
+        }
+
+        size_t PredicateProgram::evaluate_node(const size_t i, const size_t level, const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const size_t* rows, const size_t n,
+            const Contexts& ctx, const bool alive_only, const std::vector<std::pair<Date, Date>>& age_ranges, std::vector<mask_type>& values, std::vector<mask_type>& guards) const {
+            assert(i < instructions_.size());
+            assert(level < values.size());
+            const Instruction& instr = instructions_[i];
+            size_t next = i + 1;
+            mask_type& result = values[level];
+            const mask_type& guard = guards[level];
+            if (instr.code == OpCode::AND || instr.code == OpCode::OR) {
+                const bool is_and = instr.code == OpCode::AND;
+                if (is_and) {
+                    std::copy(guard.begin(), guard.begin() + static_cast<std::ptrdiff_t>(n), result.begin());
+                } else {
+                    std::fill(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(n), static_cast<uint8_t>(0));
+                }
+                for (size_t k = 0; k < instr.nbr_args; ++k) {
+                    // operand k only matters for rows still selected (AND) or not yet selected (OR) by operands 0..k-1
+                    mask_type& child_guard = guards[level + 1];
+                    for (size_t j = 0; j < n; ++j) {
+                        child_guard[j] = is_and ? result[j] : static_cast<uint8_t>(guard[j] & (result[j] ^ 1));
+                    }
+                    next = evaluate_node(next, level + 1, columns, persons, rows, n, ctx, alive_only, age_ranges, values, guards);
+                    const mask_type& operand = values[level + 1];
+                    if (is_and) {
+                        for (size_t j = 0; j < n; ++j) {
+                            result[j] = static_cast<uint8_t>(result[j] & operand[j]);
+                        }
+                    } else {
+                        for (size_t j = 0; j < n; ++j) {
+                            result[j] = static_cast<uint8_t>(result[j] | operand[j]);
+                        }
+                    }
+                }
+                return next;
+            }
+            if (instr.code == OpCode::NOT) {
+                guards[level + 1] = guard;
+                next = evaluate_node(next, level + 1, columns, persons, rows, n, ctx, alive_only, age_ranges, values, guards);
+                const mask_type& operand = values[level + 1];
+                for (size_t j = 0; j < n; ++j) {
+                    result[j] = static_cast<uint8_t>(guard[j] & (operand[j] ^ 1));
+                }
+                return next;
+            }
+            const Date asof = ctx.asof();
+            switch (instr.code) {
+            case OpCode::CONSTANT:
+                std::fill(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(n), static_cast<uint8_t>(instr.min_value));
+                break;
+            case OpCode::ALIVE:
+                // evaluated below
+                std::fill(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(n), static_cast<uint8_t>(1));
+                break;
+            case OpCode::YEAR_OF_BIRTH:
+            {
+                const auto& yobs = columns.years_of_birth();
+                for (size_t j = 0; j < n; ++j) {
+                    const int64_t yob = yobs[rows[j]];
+                    result[j] = (yob >= instr.min_value) & (yob <= instr.max_value);
+                }
+                break;
+            }
+            case OpCode::AGE:
+            {
+                const auto& dobs = columns.dates_of_birth();
+                const Date lo = age_ranges[i].first;
+                const Date hi = age_ranges[i].second;
+                for (size_t j = 0; j < n; ++j) {
+                    const Date dob = dobs[rows[j]];
+                    result[j] = (dob >= lo) & (dob <= hi);
+                }
+                break;
+            }
+            case OpCode::SEX:
+            {
+                const auto& sexes = columns.sexes();
+                for (size_t j = 0; j < n; ++j) {
+                    result[j] = sexes[rows[j]] == instr.sex;
+                }
+                break;
+            }
+            case OpCode::ETHNICITY:
+            {
+                const auto& ethnicities = columns.ethnicities();
+                const auto& table = ethnicity_tables_[instr.nbr_args];
+                for (size_t j = 0; j < n; ++j) {
+                    result[j] = table[ethnicities[rows[j]]];
+                }
+                break;
+            }
+            case OpCode::IMMIGRATION_DATE:
+            {
+                const auto& immigration_dates = columns.immigration_dates();
+                for (size_t j = 0; j < n; ++j) {
+                    const Date d = immigration_dates[rows[j]];
+                    result[j] = d.is_not_a_date() ? instr.allow_non_immigrants : ((d >= instr.from) & (d < instr.to));
+                }
+                break;
+            }
+            case OpCode::FALLBACK:
+                for (size_t j = 0; j < n; ++j) {
+                    if (guard[j]) {
+                        const Person& person = *persons[rows[j]];
+                        result[j] = alive_only ? instr.predicate->select_alive(person, ctx) : instr.predicate->select(person, ctx);
+                    } else {
+                        result[j] = 0;
+                    }
+                }
+                break;
+            default:
+                throw std::logic_error("PredicateProgram: unknown instruction");
+            }
+            if (instr.require_alive && !alive_only) {
+                for (size_t j = 0; j < n; ++j) {
+                    result[j] = static_cast<uint8_t>(result[j] & static_cast<uint8_t>(columns.is_alive(rows[j], asof)));
+                }
+            }
+            for (size_t j = 0; j < n; ++j) {
+                result[j] = static_cast<uint8_t>(result[j] & guard[j]);
+            }
+            return i + 1;
+        }
+    }
+}
@@ -0,0 +1,149 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_PREDICATE_PROGRAM_H
+#define __AVERISERA_MS_PREDICATE_PROGRAM_H
+
+#include "actor.hpp"
+#include "core/dates.hpp"
+#include "microsim-core/person_attributes.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace averisera {
+    namespace microsim {
+        class Contexts;
+        class Person;
+        class PopulationColumns;
+        template <class T> class Predicate;
+
+        /** @brief Predicate<Person> tree lowered to a flat prefix program over PopulationColumns.
+
+        Leaf predicates which implement Predicate::compile() become instructions reading the columns of (a batch of) persons;
+        PredAnd, PredOr and PredNot become mask operations. Other predicates are evaluated by calling their select() or
+        select_alive() method on the Person object. The program is evaluated over batches of persons into a byte mask,
+        with every instruction a branch-free loop over the batch which the compiler can vectorise.
+
+        Like PredAnd and PredOr, the program short-circuits: each operand of an AND (OR) is evaluated under a guard mask of
+        the rows still selected (not yet selected) by the previous operands, and predicates which are not compiled are only
+        called for rows within the guard. This keeps guarded patterns such as And(Sex(FEMALE), VariableRange(female-only variable)) safe.
+
+        The program refers to the Predicate it was compiled from, which must outlive it.
+        */
+        class PredicateProgram {
+        public:
+            /** Number of persons evaluated together */
+            static const size_t BATCH_SIZE = 256;
+
+            /** Compile the predicate */
+            explicit PredicateProgram(const Predicate<Person>& predicate);
+
+            /** Number of instructions */
+            size_t size() const {
+                return instructions_.size();
+            }
+
+            /** Number of sub-predicates which could not be compiled and are evaluated by virtual calls */
+            size_t nbr_fallbacks() const;
+
+            /** Select persons[rows[j]], appending them to selected in the order of rows.
+            @param columns Columns built from persons, with up-to-date dates of death and immigration dates.
+            @param alive_only If true, all persons are known to be alive as of ctx.asof() and select_alive() semantics apply; otherwise select() semantics apply.
+            @throw std::domain_error If columns.size() != persons.size().
+            @throw std::out_of_range If any row is not smaller than persons.size().
+            */
+            void select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+                const Contexts& ctx, bool alive_only, std::vector<Actor::shared_ptr<Person>>& selected) const;
+
+            /** Select persons[rows[j]], appending pointers to the selected elements of persons (without copying the shared pointers) in the order of rows.
+            @see select(const PopulationColumns&, const std::vector<Actor::shared_ptr<Person>>&, const std::vector<size_t>&, const Contexts&, bool, std::vector<Actor::shared_ptr<Person>>&)
+            */
+            void select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+                const Contexts& ctx, bool alive_only, std::vector<const Actor::shared_ptr<Person>*>& selected) const;
+
+            /** Set mask to persons.size() elements equal to 1 for the selected persons among persons[rows[j]] and 0 for all others.
+            @see select(const PopulationColumns&, const std::vector<Actor::shared_ptr<Person>>&, const std::vector<size_t>&, const Contexts&, bool, std::vector<Actor::shared_ptr<Person>>&)
+            */
+            void select(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+                const Contexts& ctx, bool alive_only, std::vector<uint8_t>& mask) const;
+
+            /** Add instruction selecting everybody or nobody */
+            void add_constant(bool value);
+
+            /** Add instruction selecting live persons */
+            void add_alive();
+
+            /** Add instruction selecting persons born in [min_year, max_year] */
+            void add_year_of_birth(int min_year, int max_year, bool require_alive);
+
+            /** Add instruction selecting persons with age in [min_age, max_age] */
+            void add_age(unsigned int min_age, unsigned int max_age, bool require_alive);
+
+            /** Add instruction selecting persons of given sex */
+            void add_sex(Sex sex, bool require_alive);
+
+            /** Add instruction selecting persons with ethnicity in a set of group indices */
+            void add_ethnicity(const std::vector<int>& groups, bool require_alive);
+
+            /** Add instruction selecting persons who immigrated in [from, to) (or never, if allow_non_immigrants) */
+            void add_immigration_date(Date from, Date to, bool allow_non_immigrants, bool require_alive);
+
+            /** Latest date of birth such that a Person born on it has at least the given age as of asof.
+            @return False if there is no such date not earlier than Date::MIN.
+            */
+            static bool latest_birth_date(Date asof, unsigned int age, Date& dob);
+        private:
+            enum class OpCode : uint8_t {
+                CONSTANT,
+                ALIVE,
+                YEAR_OF_BIRTH,
+                AGE,
+                SEX,
+                ETHNICITY,
+                IMMIGRATION_DATE,
+                FALLBACK,
+                AND,
+                OR,
+                NOT
+            };
+
+            struct Instruction {
+                Instruction(OpCode new_code, bool new_require_alive)
+                    : code(new_code), require_alive(new_require_alive), nbr_args(0), min_value(0), max_value(0), sex(Sex::FEMALE), allow_non_immigrants(false), predicate(nullptr) {}
+
+                OpCode code;
+                bool require_alive;
+                size_t nbr_args; /**< AND, OR: number of operands; ETHNICITY: index of the lookup table */
+                int64_t min_value; /**< Minimum year of birth or age; CONSTANT: value */
+                int64_t max_value; /**< Maximum year of birth or age */
+                Sex sex;
+                Date from;
+                Date to;
+                bool allow_non_immigrants;
+                const Predicate<Person>* predicate; /**< FALLBACK */
+            };
+
+            typedef std::array<uint8_t, BATCH_SIZE> mask_type;
+
+            void compile(const Predicate<Person>& predicate);
+
+            /** Call append(row) for each selected row */
+            template <class F> void select_rows(const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const std::vector<size_t>& rows,
+                const Contexts& ctx, bool alive_only, F append) const;
+
+            /** Evaluate the subtree starting at the i-th instruction into values[level], for rows with guards[level] set (other rows are set to 0).
+            @return Index of the first instruction after the subtree.
+            */
+            size_t evaluate_node(size_t i, size_t level, const PopulationColumns& columns, const std::vector<Actor::shared_ptr<Person>>& persons, const size_t* rows, size_t n,
+                const Contexts& ctx, bool alive_only, const std::vector<std::pair<Date, Date>>& age_ranges, std::vector<mask_type>& values, std::vector<mask_type>& guards) const;
+
+            std::vector<Instruction> instructions_;
+            std::vector<std::array<uint8_t, 256>> ethnicity_tables_;
+            size_t max_depth_; /**< Maximum depth of the predicate tree */
+            size_t level_; /**< Depth of the predicate being compiled */
+        };
+    }
+}
+
+#endif // __AVERISERA_MS_PREDICATE_PROGRAM_H
@@ -1,6 +1,7 @@
 // (C) Averisera Ltd 2014-2020
 #include "procreation.hpp"
 #include "feature.hpp"
+#include "variable_handle.hpp"
 
 namespace averisera {
     namespace microsim {
@@ -15,6 +16,16 @@ namespace averisera {
                 return name;
             }
 
+            const VariableHandle& CONCEPTION_HANDLE() {
+                static const VariableHandle handle(CONCEPTION());
+                return handle;
+            }
+
+            const VariableHandle& PREGNANCY_EVENT_HANDLE() {
+                static const VariableHandle handle(PREGNANCY_EVENT());
+                return handle;
+            }
+
             const Feature& CONCEPTION_FEATURE() {
                 static const Feature conception_feature(CONCEPTION());
                 return conception_feature;
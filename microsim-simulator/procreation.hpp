@@ -7,6 +7,7 @@
 namespace averisera {
     namespace microsim {
         class Feature;
+		class VariableHandle;
         
         /** Common settings related to procreation modelling */
         namespace Procreation {
@@ -16,6 +17,12 @@ namespace averisera {
             /** Variable for pregnancy event */
             const std::string& PREGNANCY_EVENT();
 
+			/** Handle of the CONCEPTION() variable */
+			const VariableHandle& CONCEPTION_HANDLE();
+
+			/** Handle of the PREGNANCY_EVENT() variable */
+			const VariableHandle& PREGNANCY_EVENT_HANDLE();
+
 			/** Conception modelling feature */
             const Feature& CONCEPTION_FEATURE();
 
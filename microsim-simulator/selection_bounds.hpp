@@ -0,0 +1,74 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_SELECTION_BOUNDS_H
+#define __AVERISERA_MS_SELECTION_BOUNDS_H
+
+#include "microsim-core/person_attributes.hpp"
+#include "microsim-core/sex.hpp"
+#include <algorithm>
+#include <bitset>
+#include <limits>
+
+namespace averisera {
+    namespace microsim {
+        /** @brief Ranges of year of birth, sex and ethnicity which contain every Person selected by a Predicate.
+
+        Bounds can be wider than the actual selection; they are used to skip Persons who certainly are not selected (see PopulationIndex).
+        Default-constructed bounds contain everybody.
+        */
+        struct SelectionBounds {
+            typedef PersonAttributes::ethnicity_t ethnicity_t;
+            static const size_t NBR_ETHNICITIES = static_cast<size_t>(std::numeric_limits<ethnicity_t>::max()) + 1; /**< Number of representable ethnicity values */
+
+            /** Unbounded */
+            SelectionBounds()
+                : min_year_of_birth(std::numeric_limits<int>::min()), max_year_of_birth(std::numeric_limits<int>::max()) {
+                sexes.set();
+                ethnicities.set();
+            }
+
+            /** Restrict to persons within both this and other bounds */
+            void intersect(const SelectionBounds& other) {
+                min_year_of_birth = std::max(min_year_of_birth, other.min_year_of_birth);
+                max_year_of_birth = std::min(max_year_of_birth, other.max_year_of_birth);
+                sexes &= other.sexes;
+                ethnicities &= other.ethnicities;
+            }
+
+            /** Extend to the smallest bounds containing persons within this or other bounds */
+            void unite(const SelectionBounds& other) {
+                if (other.empty()) {
+                    return;
+                }
+                if (empty()) {
+                    *this = other;
+                    return;
+                }
+                min_year_of_birth = std::min(min_year_of_birth, other.min_year_of_birth);
+                max_year_of_birth = std::max(max_year_of_birth, other.max_year_of_birth);
+                sexes |= other.sexes;
+                ethnicities |= other.ethnicities;
+            }
+
+            /** Do the bounds contain nobody */
+            bool empty() const {
+                return min_year_of_birth > max_year_of_birth || sexes.none() || ethnicities.none();
+            }
+
+            /** Do the bounds contain everybody */
+            bool unbounded() const {
+                return min_year_of_birth == std::numeric_limits<int>::min() && max_year_of_birth == std::numeric_limits<int>::max() && sexes.all() && ethnicities.all();
+            }
+
+            bool contains(int year_of_birth, Sex sex, ethnicity_t ethnicity) const {
+                return year_of_birth >= min_year_of_birth && year_of_birth <= max_year_of_birth && sexes[static_cast<size_t>(sex)] && ethnicities[ethnicity];
+            }
+
+            int min_year_of_birth;
+            int max_year_of_birth;
+            std::bitset<2> sexes; /**< Indexed by static_cast<size_t>(Sex) */
+            std::bitset<NBR_ETHNICITIES> ethnicities;
+        };
+    }
+}
+
+#endif // __AVERISERA_MS_SELECTION_BOUNDS_H
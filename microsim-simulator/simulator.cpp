@@ -1,6 +1,8 @@
 // (C) Averisera Ltd 2014-2020
+#include "checkpoint.hpp"
 #include "feature.hpp"
 #include "feature_provider.hpp"
+#include "history/history_columnar.hpp"
 #include "initialiser.hpp"
 #include "immutable_context.hpp"
 #include "migration_generator.hpp"
@@ -10,21 +12,60 @@
 #include "person.hpp"
 #include "population.hpp"
 #include "population_data.hpp"
+#include "population_index.hpp"
 #include "predicate.hpp"
+#include "predicate_program.hpp"
 #include "predicate/pred_alive.hpp"
 #include "simulator.hpp"
 #include "microsim-core/schedule.hpp"
 #include "core/log.hpp"
 #include "core/preconditions.hpp"
+#include "core/thread_pool.hpp"
 #include <algorithm>
 #include <cassert>
+#include <future>
+#include <numeric>
 #include <unordered_map>
+#include <unordered_set>
 #include <boost/functional/hash.hpp>
 
 namespace averisera {
     namespace microsim {
 		const Simulator::feature_set_type IGNORED_REQUIREMENTS({ INSTANTANEOUS() });
 
+		struct Simulator::PersonClass {
+			Date::year_type year_of_birth;
+			Sex sex;
+			PersonAttributes::ethnicity_t ethnicity;
+			Date immigration_date;
+
+			bool operator==(const PersonClass& other) const {
+				return year_of_birth == other.year_of_birth && sex == other.sex && ethnicity == other.ethnicity && immigration_date == other.immigration_date;
+			}
+		};
+
+		struct Simulator::OperatorCheckCache {
+			struct PersonClassHash {
+				size_t operator()(const PersonClass& pc) const {
+					size_t seed = 0;
+					boost::hash_combine(seed, pc.year_of_birth);
+					boost::hash_combine(seed, static_cast<uint8_t>(pc.sex));
+					boost::hash_combine(seed, pc.ethnicity);
+					boost::hash_combine(seed, pc.immigration_date.is_not_a_date() ? 0 : pc.immigration_date.julian_day());
+					return seed;
+				}
+			};
+
+			std::vector<size_t> active_operator_indices; /**< Active set for which the cache is valid */
+			std::unordered_set<PersonClass, PersonClassHash> checked_classes;
+			std::unordered_set<std::vector<bool>> checked_selections; /**< Sets of operators (as flags over the active set) already checked */
+		};
+
+		struct Simulator::OperatorScratch {
+			std::vector<size_t> rows; /**< Candidate rows in population.persons() */
+			std::vector<const std::shared_ptr<Person>*> selected; /**< Pointers to selected elements of population.persons() */
+		};
+
         Simulator::Simulator(Contexts&& ctx,
                              std::vector<std::shared_ptr<Operator<Person>>>&& person_operators,
                              std::vector<std::shared_ptr<Observer>>&& observers,
@@ -32,11 +73,17 @@ namespace averisera {
                              bool add_newborns,
 			size_t initial_population_size,
 			feature_set_type&& required_features,
-			std::string&& intermediate_observer_results_filename
+			std::string&& intermediate_observer_results_filename,
+			unsigned int nbr_threads
             )
-            : person_operator_performance_(person_operators.size()),
-			_init_pop_size(initial_population_size), _add_newborns(add_newborns)
+            : person_operator_performance_(person_operators.size()), emigrant_operator_performance_(person_operators.size()),
+			_init_pop_size(initial_population_size), _add_newborns(add_newborns), checkpoint_interval_(0), operator_check_sample_size_(0), archive_dead_persons_(false),
+			concurrent_emigrant_step_(false)
         {
+			operator_check_caches_[0].reset(new OperatorCheckCache());
+			operator_check_caches_[1].reset(new OperatorCheckCache());
+			operator_scratches_[0].reset(new OperatorScratch());
+			operator_scratches_[1].reset(new OperatorScratch());
             validate(person_operators, observers, migration_generators, required_features);
             _ctx = std::move(ctx);
             _person_operators = std::move(person_operators);
@@ -47,6 +94,12 @@ namespace averisera {
 			intermediate_observer_results_filename_ = std::move(intermediate_observer_results_filename);
             person_operators.resize(0);
             observers.resize(0);            
+			if (nbr_threads) {
+				thread_pool_.reset(new ThreadPool(nbr_threads));
+			}
+			if (!_ctx.immutable_ctx().schedule().empty()) {
+				_ctx.mutable_ctx().history_column_stores().set_dates(_ctx.immutable_ctx().schedule());
+			}
 			LOG_INFO() << "Simulator: " << _person_operators.size() << " Person operators";
 			size_t idx = 0;
 			for (const std::shared_ptr<Operator<Person>>& op : _person_operators) {
@@ -56,18 +109,29 @@ namespace averisera {
 			LOG_INFO() << "Simulator: " << _observers.size() << " observers";
 			LOG_INFO() << "Simulator: initial population size: " << _init_pop_size;
 			LOG_INFO() << "Simulator: add newborns: " << _add_newborns;
+			LOG_INFO() << "Simulator: number of threads: " << nbr_threads;
 			LOG_INFO() << "Simulator: ethnicity conversions: " << _ctx.immutable_ctx().ethnicity_conversions();
         }
 
 		Simulator::Simulator(Simulator&& other)
 			: _ctx(std::move(other._ctx)),
 			_person_operators(std::move(other._person_operators)),
+			person_operator_performance_(std::move(other.person_operator_performance_)),
+			emigrant_operator_performance_(std::move(other.emigrant_operator_performance_)),
 			_observers(std::move(other._observers)),
 			migration_generators_(std::move(other.migration_generators_)),
 			_init_pop_size(other._init_pop_size),
 			_add_newborns(other._add_newborns),
 			required_features_(std::move(other.required_features_)),
-				intermediate_observer_results_filename_(std::move(other.intermediate_observer_results_filename_))				
+				intermediate_observer_results_filename_(std::move(other.intermediate_observer_results_filename_)),
+			thread_pool_(std::move(other.thread_pool_)),
+			checkpoint_filename_(std::move(other.checkpoint_filename_)),
+			checkpoint_interval_(other.checkpoint_interval_),
+			operator_check_sample_size_(other.operator_check_sample_size_),
+			archive_dead_persons_(other.archive_dead_persons_),
+			concurrent_emigrant_step_(other.concurrent_emigrant_step_),
+			operator_check_caches_(std::move(other.operator_check_caches_)),
+			operator_scratches_(std::move(other.operator_scratches_))
 		{
 			FeatureProvider<Feature>::sort(_person_operators);
 			other._person_operators.resize(0);
@@ -78,57 +142,124 @@ namespace averisera {
 			if (this != &other) {
 				_ctx = std::move(other._ctx);
 				_person_operators = std::move(other._person_operators);
+				person_operator_performance_ = std::move(other.person_operator_performance_);
+				emigrant_operator_performance_ = std::move(other.emigrant_operator_performance_);
 				_observers = std::move(other._observers);
 				migration_generators_ = std::move(other.migration_generators_);
 				_add_newborns = other._add_newborns;
 				_init_pop_size = other._init_pop_size;
 				required_features_ = std::move(other.required_features_);
 				intermediate_observer_results_filename_ = std::move(other.intermediate_observer_results_filename_);
+				thread_pool_ = std::move(other.thread_pool_);
+				checkpoint_filename_ = std::move(other.checkpoint_filename_);
+				checkpoint_interval_ = other.checkpoint_interval_;
+				operator_check_sample_size_ = other.operator_check_sample_size_;
+				archive_dead_persons_ = other.archive_dead_persons_;
+				concurrent_emigrant_step_ = other.concurrent_emigrant_step_;
+				operator_check_caches_ = std::move(other.operator_check_caches_);
+				operator_scratches_ = std::move(other.operator_scratches_);
 				other._person_operators.resize(0);
 				other._observers.resize(0);
 				other.intermediate_observer_results_filename_.clear();
 			}
 			return *this;
 		}
+
+		Simulator::~Simulator() {
+		}
+
+		unsigned int Simulator::nbr_threads() const {
+			return thread_pool_ ? thread_pool_->nbr_threads() : 0;
+		}
+
+		void Simulator::set_checkpointing(const std::string& filename, const size_t interval) {
+			check_that(!interval || !filename.empty(), "Simulator: checkpoint filename is empty");
+			checkpoint_filename_ = filename;
+			checkpoint_interval_ = interval;
+		}
+
+		void Simulator::save_checkpoint(const std::string& filename, const Population& population) const {
+			Checkpoint::save(filename, population, _ctx, _observers);
+		}
+
+		void Simulator::load_checkpoint(const std::string& filename, Population& population) const {
+			Checkpoint::load(filename, population, _ctx, _observers);
+		}
+
+		void Simulator::save_checkpoint(std::ostream& os, const Population& population) const {
+			Checkpoint::save(os, population, _ctx, _observers);
+		}
+
+		void Simulator::load_checkpoint(std::istream& is, Population& population) const {
+			Checkpoint::load(is, population, _ctx, _observers);
+		}
+
+		Simulator Simulator::fork(std::shared_ptr<MutableContext> mutable_ctx, std::vector<std::shared_ptr<Observer>>&& observers,
+			std::vector<std::shared_ptr<const MigrationGenerator>>&& migration_generators,
+			std::string&& intermediate_observer_results_filename) const {
+			std::vector<std::shared_ptr<Operator<Person>>> person_operators(_person_operators);
+			feature_set_type required_features(required_features_);
+			Simulator forked(Contexts(_ctx.immutable_ctx_ptr(), mutable_ctx), std::move(person_operators), std::move(observers), std::move(migration_generators),
+				_add_newborns, _init_pop_size, std::move(required_features), std::move(intermediate_observer_results_filename), nbr_threads());
+			forked.set_operator_check_sample_size(operator_check_sample_size_);
+			forked.set_dead_person_archiving(archive_dead_persons_);
+			forked.set_concurrent_emigrant_step(concurrent_emigrant_step_);
+			return forked;
+		}
 	
-        void Simulator::apply_operator(Population& population, const std::vector<std::shared_ptr<Person>>& live_persons, const Operator<Person>& op, const size_t op_idx, const bool is_main) const {
+        void Simulator::apply_operator(Population& population, const std::vector<size_t>& live_indices, const PopulationIndex& live_index, const Operator<Person>& op, const size_t op_idx, const bool is_main) const {
             const Predicate<Person>& predicate = op.predicate();
 			const Date asof = _ctx.asof();
 			check_that(predicate.active(asof), "Simulator::apply_operator: operator is not active");
-			std::vector<std::shared_ptr<Person>> selected;
-			selected.reserve(population.persons().size());
+			const PredicateProgram program(predicate);
+			// reuse the buffers from previous calls; selected points into population.persons(), so reference counts are not touched
+			OperatorScratch& scratch = *operator_scratches_[is_main ? 0 : 1];
+			std::vector<size_t>& rows = scratch.rows;
+			std::vector<const std::shared_ptr<Person>*>& selected = scratch.selected;
+			rows.clear();
+			selected.clear();
 			if (predicate.selects_alive_only()) {
-				for (const auto& person_ptr : live_persons) {
-					assert(person_ptr);
-					assert(person_ptr->date_of_birth() <= asof);
-					if (predicate.select_alive(*person_ptr, _ctx)) {
-						selected.push_back(person_ptr);
-					}
+				live_index.select(predicate.selection_bounds(asof), rows);
+				for (size_t& row : rows) {
+					row = live_indices[row];
 				}
+				program.select(population.columns(), population.persons(), rows, _ctx, true, selected);
 			} else {
-				for (const auto& person_ptr : population.persons()) {
-					assert(person_ptr);
-					if (person_ptr->date_of_birth() > asof) {
+				const std::vector<Date>& dobs = population.columns().dates_of_birth();
+				rows.reserve(dobs.size());
+				for (size_t i = 0; i < dobs.size(); ++i) {
+					if (dobs[i] > asof) {
 						if (is_main) {
-							LOG_ERROR() << "Simulator: person's date of birth " << person_ptr->date_of_birth() << " is after asof " << asof << " in population " << population.name() << " when applying operator " << op.name() << " with predicate " << predicate;
+							LOG_ERROR() << "Simulator: person's date of birth " << dobs[i] << " is after asof " << asof << " in population " << population.name() << " when applying operator " << op.name() << " with predicate " << predicate;
 							throw std::logic_error("Simulator: Person born in the future");
 						} else {
 							continue;
 						}
 					}
-					if (predicate.select(*person_ptr, _ctx)) {
-						selected.push_back(person_ptr);
-					}
+					rows.push_back(i);
 				}
+				program.select(population.columns(), population.persons(), rows, _ctx, false, selected);
 			}
 			
 			LOG_DEBUG() << "Simulator: operator " << op.name() << " (" << op_idx << ") was active and selected " << selected.size() << " persons as of " << _ctx.asof() << " using predicate " << op.predicate().as_string() << " on " << (is_main ? "MAIN" : "AUXILIARY") << " population";
 
 			if (!selected.empty()) {
+				const ActorSpan<Person> span(selected);
+				// the emigrant population stepped concurrently is processed serially in its own thread
+				const bool is_concurrent_emigrant = !is_main && concurrent_emigrant_step_;
+				ThreadPool* const pool = is_concurrent_emigrant ? nullptr : thread_pool_.get();
 				// measure operator performance
-				Performance& perf = person_operator_performance_[op_idx];
-				perf.measure_metrics([&op, &selected, this]() {
-					op.apply(selected, _ctx);
+				Performance& perf = is_concurrent_emigrant ? emigrant_operator_performance_[op_idx] : person_operator_performance_[op_idx];
+				perf.measure_metrics([&op, span, op_idx, pool, this]() {
+					if (pool) {
+						// streams depend on Person ID, date and operator, but not on the order of processing
+						const MutableContext& mctx = _ctx.mutable_ctx();
+						op.apply_span_parallel(span, _ctx, *pool, [span, &mctx, op_idx](size_t i) {
+							return mctx.make_stream(span[i]->id(), op_idx);
+						});
+					} else {
+						op.apply_span(span, _ctx);
+					}
 				}, selected.size());
 			}
         }
@@ -149,66 +280,112 @@ namespace averisera {
             }
 			LOG_INFO() << "Simulator: " << active_operators.size() << " active Person operators as of " << _ctx.asof();
 			FeatureProvider<Feature>::sort(active_operators);
-			check_active_operators(population, active_operators);
 			const Date asof = _ctx.asof(); 
-			const std::vector<std::shared_ptr<Person>> live_persons(population.live_persons(asof));
+			population.update_columns();
+			check_active_operators(population, active_operators, active_operator_indices, is_main);
+			const std::vector<size_t> live_indices(population.live_indices(asof));
+			PopulationIndex live_index;
+			live_index.rebuild(population.columns(), live_indices);
 			size_t active_op_idx = 0;
 			for (const std::shared_ptr<Operator<Person> >& op : active_operators) {
 				check_that(op != nullptr, "Simulator::apply_operator: null operator");
-				apply_operator(population, live_persons, *op, active_operator_indices[active_op_idx], is_main);
+				apply_operator(population, live_indices, live_index, *op, active_operator_indices[active_op_idx], is_main);
 				++active_op_idx;
 			}
         }
 
-		void Simulator::check_active_operators(const Population& population, const std::vector<std::shared_ptr<Operator<Person>>>& active_operators) const {
+		void Simulator::check_active_operators(const Population& population, const std::vector<std::shared_ptr<Operator<Person>>>& active_operators, const std::vector<size_t>& active_operator_indices, const bool is_main) const {
 			if (!FeatureProvider<Feature>::are_all_requirements_satisfied(active_operators, IGNORED_REQUIREMENTS, required_features_)) {
 				throw std::runtime_error("Simulator: not all requirements for Person Operaxtors satisfied by the active set");
 			}
+			OperatorCheckCache& cache = *operator_check_caches_[is_main ? 0 : 1];
+			if (cache.active_operator_indices != active_operator_indices) {
+				cache.active_operator_indices = active_operator_indices;
+				cache.checked_classes.clear();
+				cache.checked_selections.clear();
+			}
 			typedef std::vector<std::shared_ptr<Operator<Person>>> operator_vec_t;
 			const size_t nops = active_operators.size();
-			// select which operator to apply to which person without involving the context
+			const PopulationColumns& columns = population.columns();
+			const size_t n = columns.size();
+			// select_out_of_context() depends only on the attributes in PersonClass, so it is enough to check one person per class
+			const size_t stride = (operator_check_sample_size_ && n > operator_check_sample_size_) ? n / operator_check_sample_size_ : 1;
 			std::vector<bool> opsel(nops);
-			std::unordered_set<operator_vec_t, boost::hash<operator_vec_t>> selections;
-			for (auto pit = population.persons().begin(); pit != population.persons().end(); ++pit) {
-				const auto person = *pit;
-				assert(person);
-				size_t nsel = 0;
-				auto opsel_it = opsel.begin();
-				for (const std::shared_ptr<Operator<Person> >& op : active_operators) {
-					assert(op);
-					const bool s = op->predicate().select_out_of_context(*person);
-					*opsel_it = s;
-					if (s) {
-						++nsel;
-					}
-					++opsel_it;
+			for (size_t i = 0; i < n; i += stride) {
+				const PersonClass person_class{ columns.years_of_birth()[i], columns.sexes()[i], columns.ethnicities()[i], columns.immigration_dates()[i] };
+				if (cache.checked_classes.find(person_class) != cache.checked_classes.end()) {
+					continue;
 				}
-				assert(opsel_it == opsel.end());
-				operator_vec_t operators;
-				operators.reserve(nsel);
-				opsel_it = opsel.begin();
-				for (auto aop_it = active_operators.begin(); aop_it != active_operators.end(); ++aop_it, ++opsel_it) {
-					if (*opsel_it) {
-						operators.push_back(*aop_it);
-					}
+				const Person& person = *population.persons()[i];
+				for (size_t k = 0; k < nops; ++k) {
+					opsel[k] = active_operators[k]->predicate().select_out_of_context(person);
 				}
-				assert(opsel_it == opsel.end());
-				selections.insert(operators);
-			}
-
-			// check if operators are consistent
-			for (auto mit = selections.begin(); mit != selections.end(); ++mit) {
-				const operator_vec_t& operators = *mit;
-				if (!FeatureProvider<Feature>::are_all_requirements_satisfied(operators, IGNORED_REQUIREMENTS, required_features_)) {
-					throw std::runtime_error("Simulator: not all requirements for Person Operators satisfied");
+				if (cache.checked_selections.find(opsel) == cache.checked_selections.end()) {
+					// check if operators are consistent
+					operator_vec_t operators;
+					for (size_t k = 0; k < nops; ++k) {
+						if (opsel[k]) {
+							operators.push_back(active_operators[k]);
+						}
+					}
+					if (!FeatureProvider<Feature>::are_all_requirements_satisfied(operators, IGNORED_REQUIREMENTS, required_features_)) {
+						throw std::runtime_error("Simulator: not all requirements for Person Operators satisfied");
+					}
+					cache.checked_selections.insert(opsel);
 				}
+				cache.checked_classes.insert(person_class);
 			}
 		}
 
         void Simulator::apply_observers(Population& population) const {
-            std::for_each(_observers.begin(), _observers.end(), [this, &population](const std::shared_ptr<Observer>& obs) {
-                    obs->observe(population, _ctx);
-                });
+			std::vector<Observer*> single_pass_observers;
+			for (const std::shared_ptr<Observer>& obs : _observers) {
+				if (obs->is_single_pass()) {
+					single_pass_observers.push_back(obs.get());
+				} else {
+					obs->observe(population, _ctx);
+				}
+			}
+			if (!single_pass_observers.empty()) {
+				const std::vector<std::shared_ptr<Person>>& persons = population.persons();
+				// evaluate the predicates over the columns in batches, once per distinct predicate
+				std::vector<const std::vector<uint8_t>*> masks(single_pass_observers.size(), nullptr);
+				std::unordered_map<const Predicate<Person>*, std::vector<uint8_t>> masks_by_predicate;
+				std::vector<size_t> rows;
+				for (size_t k = 0; k < single_pass_observers.size(); ++k) {
+					const Predicate<Person>* const predicate = single_pass_observers[k]->pass_predicate();
+					if (!predicate) {
+						continue;
+					}
+					auto it = masks_by_predicate.find(predicate);
+					if (it == masks_by_predicate.end()) {
+						if (rows.empty()) {
+							population.update_columns();
+							rows.resize(persons.size());
+							std::iota(rows.begin(), rows.end(), 0);
+						}
+						it = masks_by_predicate.insert(std::make_pair(predicate, std::vector<uint8_t>())).first;
+						PredicateProgram(*predicate).select(population.columns(), persons, rows, _ctx, false, it->second);
+					}
+					masks[k] = &it->second;
+				}
+				// scan the population once for all of them
+				for (Observer* obs : single_pass_observers) {
+					obs->begin_pass(_ctx);
+				}
+				for (size_t i = 0; i < persons.size(); ++i) {
+					const Person& person = *persons[i];
+					for (size_t k = 0; k < single_pass_observers.size(); ++k) {
+						if (!masks[k] || (*masks[k])[i]) {
+							single_pass_observers[k]->observe_person(person, _ctx);
+						}
+					}
+				}
+				for (Observer* obs : single_pass_observers) {
+					obs->observe_archived(population.archive(), _ctx);
+					obs->end_pass(_ctx);
+				}
+			}
         }
 
         void Simulator::validate(const std::vector<std::shared_ptr<Operator<Person>>>& person_operators,
@@ -247,21 +424,76 @@ namespace averisera {
         void Simulator::step(Population& population, const bool is_main) const {
 			const auto sp = _ctx.current_period();
 			const clock_t time0 = std::clock();
+			archive_dead_persons(population, is_main);
+			advance(population, is_main);
+			if (is_main) {
+				observe_and_migrate(population);
+			}			
+			const clock_t time1 = std::clock();
+			LOG_INFO() << "Simulator: step for population " << population.name() << " with size " << population.persons().size() << " from " << sp.begin << " to " << sp.end << " took " << (static_cast<double>(time1 - time0) * 1000.0) / CLOCKS_PER_SEC << " miliseconds";
+        }
+
+		void Simulator::step_concurrently(Population& population) const {
+			const auto sp = _ctx.current_period();
+			const clock_t time0 = std::clock();
+			MutableContext& mctx = _ctx.mutable_ctx();
+			Population& emigrant_population = mctx.emigrant_population();
+			// archiving reads the dates of death of children, who can belong to the other population; deaths in this step happen
+			// after the cutoff date, so archiving both populations before the operators run gives the same result as sequential stepping
+			archive_dead_persons(emigrant_population, false);
+			archive_dead_persons(population, true);
+			// if advancing the main population throws, the destructor of the future waits for the emigrant step to finish
+			std::future<void> emigrant_step = std::async(std::launch::async, [this, &mctx, &emigrant_population]() {
+				RNGPhilox rng(mctx.make_stream(Actor::INVALID_ID, 0)); // no Actor has this ID, so the stream is not used by any Person
+				const MutableContext::AuxiliaryThread auxiliary_thread(mctx, rng);
+				advance(emigrant_population, false);
+			});
+			advance(population, true);
+			// migration adds persons to the emigrant population
+			emigrant_step.get();
+			observe_and_migrate(population);
+			const clock_t time1 = std::clock();
+			LOG_INFO() << "Simulator: concurrent step for populations " << population.name() << " and " << emigrant_population.name() << " with sizes " << population.persons().size() << " and " << emigrant_population.persons().size() << " from " << sp.begin << " to " << sp.end << " took " << (static_cast<double>(time1 - time0) * 1000.0) / CLOCKS_PER_SEC << " miliseconds";
+		}
+
+		void Simulator::archive_dead_persons(Population& population, const bool is_main) const {
+			if (archive_dead_persons_) {
+				// observers count the persons who died since the previous date from the latest batch of the archive
+				population.archive_dead_persons(_ctx.asof());
+				if (is_main && _ctx.asof_idx() > 0) {
+					// persons who died before the previous date are not counted by observers any more
+					_ctx.mutable_ctx().remove_dead_migrants(simulation_schedule().date(_ctx.asof_idx() - 1));
+				}
+			}
+		}
+
+		void Simulator::advance(Population& population, const bool is_main) const {
             apply_operators(population, is_main);
 			if (_add_newborns) {
                 add_newborns(population);
             } else {
                 unlink_children(population, _ctx.asof());
             }
-			if (is_main) {
-				apply_observers(population);
-				if (sp.end > sp.begin) {
-					apply_migration(population);					
+		}
+
+		void Simulator::observe_and_migrate(Population& population) const {
+			apply_observers(population);
+			const auto sp = _ctx.current_period();
+			if (sp.end > sp.begin) {
+				apply_migration(population);
+			}
+		}
+
+		void Simulator::set_concurrent_emigrant_step(const bool concurrent) {
+			if (concurrent) {
+				for (const auto& op : _person_operators) {
+					if (op->accesses_relatives()) {
+						throw std::domain_error("Simulator: operator " + op->name() + " accesses relatives and cannot be applied to two populations concurrently");
+					}
 				}
-			}			
-			const clock_t time1 = std::clock();
-			LOG_INFO() << "Simulator: step for population " << population.name() << " with size " << population.persons().size() << " from " << sp.begin << " to " << sp.end << " took " << (static_cast<double>(time1 - time0) * 1000.0) / CLOCKS_PER_SEC << " miliseconds";
-        }
+			}
+			concurrent_emigrant_step_ = concurrent;
+		}
 
 		const Schedule& Simulator::simulation_schedule() const {
 			return _ctx.immutable_ctx().schedule();
@@ -272,8 +504,8 @@ namespace averisera {
 			if (!population.empty()) {
 				throw std::domain_error("Simulator: population must be empty");
 			}
-			PopulationData population_data(initialiser.initialise(_init_pop_size, _ctx));
-			population.import_data(population_data, _ctx, true, false); // initialiser should ensure correct IDs
+			PopulationData population_data(thread_pool_ ? initialiser.initialise_parallel(_init_pop_size, _ctx, *thread_pool_) : initialiser.initialise(_init_pop_size, _ctx));
+			population.import_data(population_data, _ctx, true, false, thread_pool_.get()); // initialiser should ensure correct IDs
 			const clock_t time1 = std::clock();
 			LOG_INFO() << "Simulator: population initialisation took " << (static_cast<double>(time1 - time0) * 1000.0) / CLOCKS_PER_SEC << " miliseconds";
 		}
@@ -281,10 +513,14 @@ namespace averisera {
 		void Simulator::run(Population& population) const {
 			const clock_t time0 = std::clock();
 			while (_ctx.asof_idx() < simulation_schedule().nbr_dates()) {
-				// update the emigrant population (mortality, births) - do this first so that we don't handle the same person twice
-				step(_ctx.mutable_ctx().emigrant_population(), false);
-				// update the main population
-				step(population, true);
+				if (concurrent_emigrant_step_) {
+					step_concurrently(population);
+				} else {
+					// update the emigrant population (mortality, births) - do this first so that we don't handle the same person twice
+					step(_ctx.mutable_ctx().emigrant_population(), false);
+					// update the main population
+					step(population, true);
+				}
 				// save intermediate results if not yet finished
 				if (_ctx.asof_idx() < simulation_schedule().nbr_dates()) {
 					for (const auto& obs_ptr: _observers) {
@@ -292,10 +528,16 @@ namespace averisera {
                     }
 				}
 				_ctx.mutable_ctx().advance_date_index();
+				if (checkpoint_interval_ && _ctx.asof_idx() < simulation_schedule().nbr_dates() && _ctx.asof_idx() % checkpoint_interval_ == 0) {
+					save_checkpoint(checkpoint_filename_, population);
+				}
 			}
 			const clock_t time1 = std::clock();
 			LOG_INFO() << "Simulator: simulation for population " << population.name() << " took " << static_cast<double>(time1 - time0) / CLOCKS_PER_SEC << " seconds";
-			log_operator_performance();
+			log_operator_performance(person_operator_performance_, concurrent_emigrant_step_ ? "the main population" : "all populations");
+			if (concurrent_emigrant_step_) {
+				log_operator_performance(emigrant_operator_performance_, "the emigrant population");
+			}
 		}
 
         void Simulator::save_observer_results() const {
@@ -304,13 +546,13 @@ namespace averisera {
             }
         }
 
-		void Simulator::log_operator_performance() const {
+		void Simulator::log_operator_performance(const std::vector<Performance>& performance, const char* const populations) const {
 			std::stringstream perf_ss;
 			perf_ss << "Operator\tPredicate\tNbrElements\tTotalTime\tMeanTimePerStep\tMeanTimePerElement\tMeanTimePerElementPerStep\n";
 			for (size_t i = 0; i < _person_operators.size(); ++i) {
 				const auto name = _person_operators[i]->name();
 				const auto pred_str = _person_operators[i]->predicate().as_string();
-				const auto& perf = person_operator_performance_[i];
+				const auto& perf = performance[i];
 				perf_ss << name;
 				perf_ss << "\t" << pred_str;
 				perf_ss << "\t" << perf.total_nbr_processed();
@@ -320,7 +562,7 @@ namespace averisera {
 				perf_ss << "\t" << perf.time_per_element_stats().mean();
 				perf_ss << "\n";
 			}
-			LOG_INFO() << "Simulator: Person operator performance statistics:\n" << perf_ss.str();
+			LOG_INFO() << "Simulator: Person operator performance statistics for " << populations << ":\n" << perf_ss.str();
 		}
 
 		void Simulator::apply_migration(Population& population) const {
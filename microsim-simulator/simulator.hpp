@@ -6,18 +6,23 @@
 #include "feature.hpp"
 #include "feature_user.hpp"
 #include "performance.hpp"
+#include <array>
 #include <iosfwd>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace averisera {
+	class ThreadPool;
+
     namespace microsim {
 		class Initialiser;
 		class MigrationGenerator;
+		class MutableContext;
         class Observer;
         template <class T> class Operator;
         class Population;
+        class PopulationIndex;
         class Person;
 		class Schedule;
 	
@@ -37,6 +42,9 @@ namespace averisera {
 			@param initial_population_size Size of initial population
 			@param required_features Required features which have to be always provided by operators whether any operators requires them or not
 			@param intermediate_observer_results_filename If not empty, after each simulation step save the Observer results to file with this name
+			@param nbr_threads Number of threads used to apply operators. If 0, operators are applied serially using the shared RNG from the mutable context.
+			If positive, operators which support it (see Operator::apply_parallel) are applied in parallel, with random numbers for each Person drawn from its own stream;
+			the results do not depend on the number of threads then.
 			@throw std::runtime_error If relations between operators are inconsistent or feature requirements are not satisfied
 			@throw std::domain_error If any pointer is null or initial_population_size is zero.
 			*/
@@ -44,7 +52,8 @@ namespace averisera {
 				std::vector<std::shared_ptr<Observer>>&& observers, 
 				std::vector<std::shared_ptr<const MigrationGenerator>>&& migration_generators,
 				bool add_newborns, size_t initial_population_size, feature_set_type&& required_features,
-				std::string&& intermediate_observer_results_filename
+				std::string&& intermediate_observer_results_filename,
+				unsigned int nbr_threads = 0
                 );
 
             /** Move constructor */
@@ -52,6 +61,8 @@ namespace averisera {
 
 			/** Move assignment */
 			Simulator& operator=(Simulator&& other);
+
+			~Simulator();
             
             Simulator(const Simulator&) = delete;
             Simulator& operator=(const Simulator&) = delete;
@@ -70,7 +81,8 @@ namespace averisera {
 			/** Return simulation schedule */
 			const Schedule& simulation_schedule() const;
 
-			/** Given an empty population, initialise it. 
+			/** Given an empty population, initialise it. If the simulator has threads, uses Initialiser::initialise_parallel() and creates
+			Person objects in parallel; the population then depends on the seed but not on the number of threads.
 			@throw std::domain_error If population is not empty. 
 			*/
 			void initialise_population(const Initialiser& initialiser, Population& population) const;
@@ -82,6 +94,81 @@ namespace averisera {
 			bool is_add_newborns() const {
 				return _add_newborns;
 			}
+
+			/** Number of threads used to apply operators (0 for serial mode) */
+			unsigned int nbr_threads() const;
+
+			/** Make run() save a Checkpoint every interval steps, overwriting the previous one.
+			@param interval Number of steps between checkpoints. If 0, do not save checkpoints.
+			@throw std::domain_error If interval is positive and filename is empty
+			*/
+			void set_checkpointing(const std::string& filename, size_t interval);
+
+			/** Limit the per-step check that operators selected for each person have their feature requirements satisfied
+			to a sample of about sample_size persons, spread evenly over the population.
+			@param sample_size If 0 (default), check all persons.
+			*/
+			void set_operator_check_sample_size(size_t sample_size) {
+				operator_check_sample_size_ = sample_size;
+			}
+
+			size_t operator_check_sample_size() const {
+				return operator_check_sample_size_;
+			}
+
+			/** If true, at the start of each step move persons who died before the current simulation date out of the main and
+			emigrant populations into their archives (see Population::archive_dead_persons), and remove the persons who died before
+			the previous simulation date from MutableContext::immigrants() and MutableContext::emigrants(). Observers of the main population
+			see the deaths and births since the previous date via Observer::observe_archived(), but must not need older dead persons,
+			and operators must not select dead persons. Saves memory and time in long simulations. Defaults to false.
+			*/
+			void set_dead_person_archiving(bool archive) {
+				archive_dead_persons_ = archive;
+			}
+
+			bool dead_person_archiving() const {
+				return archive_dead_persons_;
+			}
+
+			/** If true, run() steps the emigrant population in its own thread concurrently with the main one, joining before the observers
+			and migration generators are applied. The emigrant population is then processed serially, with random numbers drawn from a separate
+			stream and newborn IDs generated from a separate range (see MutableContext::AuxiliaryThread), so the results do not depend on timing,
+			but differ from those obtained with sequential stepping. Defaults to false.
+			@throw std::domain_error If concurrent is true and any operator accesses relatives (see Operator::accesses_relatives), because
+			a Person's relatives can belong to the other population.
+			*/
+			void set_concurrent_emigrant_step(bool concurrent);
+
+			bool concurrent_emigrant_step() const {
+				return concurrent_emigrant_step_;
+			}
+
+			/** Save the state of the simulation of population, including the state of the observers, to a Checkpoint file.
+			@throw std::logic_error If any observer does not support saving its state (see Observer::save_state).
+			*/
+			void save_checkpoint(const std::string& filename, const Population& population) const;
+
+			/** Restore the state of the simulation, including the state of the observers, from a Checkpoint file into an empty population,
+			so that run() continues from the saved date.
+			@see Checkpoint::load
+			*/
+			void load_checkpoint(const std::string& filename, Population& population) const;
+
+			/** Save the state of the simulation of population to a binary stream. @see Checkpoint::save */
+			void save_checkpoint(std::ostream& os, const Population& population) const;
+
+			/** Restore the state of the simulation from a binary stream into an empty population. @see Checkpoint::load */
+			void load_checkpoint(std::istream& is, Population& population) const;
+
+			/** Create a Simulator for another scenario, which shares the operators, required features and ImmutableContext with this one
+			(they must not be modified while either Simulator is in use), but has its own MutableContext, observers and migration generators.
+			Simulators forked from the same one can run concurrently. Checkpointing settings are not copied, the operator check sample size is.
+			@param mutable_ctx Mutable context of the new Simulator
+			@throw std::domain_error If any pointer is null.
+			*/
+			Simulator fork(std::shared_ptr<MutableContext> mutable_ctx, std::vector<std::shared_ptr<Observer>>&& observers,
+				std::vector<std::shared_ptr<const MigrationGenerator>>&& migration_generators,
+				std::string&& intermediate_observer_results_filename) const;
         private:
 			/** Perform a simulation step, applying operators, handling births and doing all the necessary observations.
 			Step is forward-looking, i.e. the step applied at T_i causes changes in the [T_i, T_{i+1}) period.
@@ -89,16 +176,33 @@ namespace averisera {
 			*/
 			void step(Population& population, bool is_main) const;
 
+			/** Perform a simulation step for the main population and, concurrently, for the emigrant population */
+			void step_concurrently(Population& population) const;
+
+			/** First part of the step: archive dead persons if enabled (and for the main population, drop old dead migrants from MutableContext).
+			Reads the relatives of persons, so it must not run concurrently with advance() on another population. */
+			void archive_dead_persons(Population& population, bool is_main) const;
+
+			/** Part of the step which does not touch other populations: applying operators and handling births
+			@param is_main Is this the main population
+			*/
+			void advance(Population& population, bool is_main) const;
+
+			/** Part of the step applied only to the main population after the other populations have been advanced: observers and migration */
+			void observe_and_migrate(Population& population) const;
+
 			void validate(const std::vector<std::shared_ptr<Operator<Person>>>& person_operators,
                           const std::vector<std::shared_ptr<Observer>>& observers,
 				const std::vector<std::shared_ptr<const MigrationGenerator>>& migration_generators,
 				const feature_set_type& required_features) const;
 
             /** Apply operator to the population 
+			@param live_indices Indices of persons alive at the current date in population.persons()
+			@param live_index Index of the persons at live_indices
 			@param op_idx Index of the operator in the _person_operators vector
 			@param is_main Is this the main population
 			*/
-            void apply_operator(Population& population, const std::vector<std::shared_ptr<Person>>& live_persons, const Operator<Person>& op, size_t op_idx, bool is_main) const;
+            void apply_operator(Population& population, const std::vector<size_t>& live_indices, const PopulationIndex& live_index, const Operator<Person>& op, size_t op_idx, bool is_main) const;
 
             /** Apply stored operators to the population
 			@param is_main Is this the main population
@@ -109,8 +213,14 @@ namespace averisera {
             /** Apply observers to gather information about simulation results */
             void apply_observers(Population& population) const;
 
-			/** Assume active_operators are sorted w/r to feature requirements */
-			void check_active_operators(const Population& population, const std::vector<std::shared_ptr<Operator<Person>>>& active_operators) const;
+			/** Check that the active operators selected for each person satisfy each other's requirements.
+			The result is memoised per person class (see PersonClass) and reused until the active set changes.
+			Assume active_operators are sorted w/r to feature requirements and population.columns() are up to date.
+			@param active_operator_indices Indices of active_operators in _person_operators
+			@param is_main Is this the main population
+			*/
+			void check_active_operators(const Population& population, const std::vector<std::shared_ptr<Operator<Person>>>& active_operators,
+				const std::vector<size_t>& active_operator_indices, bool is_main) const;
 
             /** Add all recently born children to the population */
             void add_newborns(Population& population) const;
@@ -118,17 +228,33 @@ namespace averisera {
 			/** Subtract / add population members due to migration */
 			void apply_migration(Population& population) const;
 
-			void log_operator_performance() const;
+			void log_operator_performance(const std::vector<Performance>& performance, const char* populations) const;
 
             Contexts _ctx;
             std::vector<std::shared_ptr<Operator<Person>>> _person_operators;
 			mutable std::vector<Performance> person_operator_performance_; // mutable because we update the statistics during execution
+			mutable std::vector<Performance> emigrant_operator_performance_; /**< Statistics for the emigrant population stepped concurrently */
             std::vector<std::shared_ptr<Observer>> _observers;			
 			std::vector<std::shared_ptr<const MigrationGenerator>> migration_generators_;
             size_t _init_pop_size;
 			bool _add_newborns;
 			feature_set_type required_features_;
 			std::string intermediate_observer_results_filename_;
+			std::unique_ptr<ThreadPool> thread_pool_; /**< Null in serial mode */
+			std::string checkpoint_filename_;
+			size_t checkpoint_interval_; /**< 0 if checkpoints are not saved */
+
+			/** Attributes which Predicate::select_out_of_context() can depend on */
+			struct PersonClass;
+			struct OperatorCheckCache;
+			size_t operator_check_sample_size_; /**< 0 if all persons are checked */
+			bool archive_dead_persons_;
+			bool concurrent_emigrant_step_;
+			std::array<std::unique_ptr<OperatorCheckCache>, 2> operator_check_caches_; /**< For the main and the emigrant population */
+
+			/** Buffers reused by apply_operator() */
+			struct OperatorScratch;
+			std::array<std::unique_ptr<OperatorScratch>, 2> operator_scratches_; /**< For the main and the emigrant population */
         };
     }
 }
@@ -17,7 +17,7 @@
 namespace averisera {
     namespace microsim {
         SimulatorBuilder::SimulatorBuilder()
-            : _initial_population_size(0), _add_newborns(true) {
+            : _initial_population_size(0), _add_newborns(true), nbr_threads_(0), checkpoint_interval_(0), operator_check_sample_size_(0), archive_dead_persons_(false), concurrent_emigrant_step_(false) {
         }
         
 		SimulatorBuilder& SimulatorBuilder::add_operator(std::shared_ptr<Operator<Person>> op) {
@@ -66,10 +66,47 @@ namespace averisera {
 			intermediate_observer_results_filename_ = value;
 			return *this;
 		}
+
+		SimulatorBuilder& SimulatorBuilder::set_nbr_threads(unsigned int value) {
+			nbr_threads_ = value;
+			return *this;
+		}
+
+		SimulatorBuilder& SimulatorBuilder::set_checkpointing(const std::string& filename, size_t interval) {
+			check_that(!interval || !filename.empty(), "SimulatorBuilder: checkpoint filename is empty");
+			checkpoint_filename_ = filename;
+			checkpoint_interval_ = interval;
+			return *this;
+		}
+
+		SimulatorBuilder& SimulatorBuilder::set_operator_check_sample_size(size_t value) {
+			operator_check_sample_size_ = value;
+			return *this;
+		}
+
+		SimulatorBuilder& SimulatorBuilder::set_dead_person_archiving(bool value) {
+			archive_dead_persons_ = value;
+			return *this;
+		}
+
+		SimulatorBuilder& SimulatorBuilder::set_concurrent_emigrant_step(bool value) {
+			concurrent_emigrant_step_ = value;
+			return *this;
+		}
         
         Simulator SimulatorBuilder::build(Contexts&& ctx) {			
 			collect_history_requirements(ctx.immutable_ctx());
-			return Simulator(std::move(ctx), std::move(_person_operators), std::move(_observers), std::move(migration_generators_), _add_newborns, _initial_population_size, std::move(required_features_), std::move(intermediate_observer_results_filename_));
+			Simulator simulator(std::move(ctx), std::move(_person_operators), std::move(_observers), std::move(migration_generators_), _add_newborns, _initial_population_size, std::move(required_features_), std::move(intermediate_observer_results_filename_), nbr_threads_);
+			simulator.set_checkpointing(checkpoint_filename_, checkpoint_interval_);
+			checkpoint_filename_.clear();
+			checkpoint_interval_ = 0;
+			simulator.set_operator_check_sample_size(operator_check_sample_size_);
+			operator_check_sample_size_ = 0;
+			simulator.set_dead_person_archiving(archive_dead_persons_);
+			archive_dead_persons_ = false;
+			simulator.set_concurrent_emigrant_step(concurrent_emigrant_step_);
+			concurrent_emigrant_step_ = false;
+			return simulator;
         }
 
         void SimulatorBuilder::collect_history_requirements(ImmutableContext& imm_ctx) {
@@ -59,6 +59,21 @@ namespace averisera {
 
 			/** Set intermediate Observer results filename */
 			SimulatorBuilder& set_intermediate_observer_results_filename(const std::string& value);
+
+			/** Set number of threads used to apply operators (defaulted to 0, i.e. serial mode). @see Simulator::Simulator */
+			SimulatorBuilder& set_nbr_threads(unsigned int value);
+
+			/** Save a Checkpoint every interval steps (defaulted to 0, i.e. never). @see Simulator::set_checkpointing */
+			SimulatorBuilder& set_checkpointing(const std::string& filename, size_t interval);
+
+			/** Check operator consistency on a sample of persons (defaulted to 0, i.e. all persons). @see Simulator::set_operator_check_sample_size */
+			SimulatorBuilder& set_operator_check_sample_size(size_t value);
+
+			/** Archive dead persons during simulation (defaulted to false). @see Simulator::set_dead_person_archiving */
+			SimulatorBuilder& set_dead_person_archiving(bool value);
+
+			/** Step the emigrant population concurrently with the main one (defaulted to false). @see Simulator::set_concurrent_emigrant_step */
+			SimulatorBuilder& set_concurrent_emigrant_step(bool value);
             
             /** Builds a Simulator object and clears the state of the builder 
               @param ctx Contexts to use (moved)			  
@@ -74,6 +89,12 @@ namespace averisera {
 			bool _add_newborns;
 			std::unordered_set<Feature> required_features_;
 			std::string intermediate_observer_results_filename_;
+			unsigned int nbr_threads_;
+			std::string checkpoint_filename_;
+			size_t checkpoint_interval_;
+			size_t operator_check_sample_size_;
+			bool archive_dead_persons_;
+			bool concurrent_emigrant_step_;
         };
     }
 }
@@ -0,0 +1,35 @@
+// (C) Averisera Ltd 2014-2020
+#include "variable_handle.hpp"
+#include "core/preconditions.hpp"
+#include <stdexcept>
+#include <boost/format.hpp>
+
+namespace averisera {
+	namespace microsim {
+		VariableHandle::VariableHandle(const std::string& name)
+			: name_(name), resolved_(0) {
+			check_that(!name.empty(), "VariableHandle: empty name");
+		}
+
+		VariableHandle::VariableHandle(const VariableHandle& other)
+			: name_(other.name_), resolved_(other.resolved_.load(std::memory_order_relaxed)) {
+		}
+
+		VariableHandle& VariableHandle::operator=(const VariableHandle& other) {
+			if (this != &other) {
+				name_ = other.name_;
+				resolved_.store(other.resolved_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			}
+			return *this;
+		}
+
+		VariableHandle::index_t VariableHandle::resolve(const HistoryRegistry& registry) const {
+			const index_t idx = registry.variable_index(name_);
+			if (idx > INDEX_MASK) {
+				throw std::out_of_range(boost::str(boost::format("VariableHandle: index %d of variable %s too large") % idx % name_));
+			}
+			resolved_.store((static_cast<uint64_t>(registry.id()) << 32) | static_cast<uint64_t>(idx), std::memory_order_relaxed);
+			return idx;
+		}
+	}
+}
@@ -0,0 +1,73 @@
+// (C) Averisera Ltd 2014-2020
+#ifndef __AVERISERA_MS_VARIABLE_HANDLE_H
+#define __AVERISERA_MS_VARIABLE_HANDLE_H
+
+#include "history_registry.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace averisera {
+	namespace microsim {
+		/** @brief Name of a history variable together with its index in the last HistoryRegistry it was resolved in.
+
+		Avoids looking up the variable name in the registry on every access. The index is resolved on first use with a registry
+		and re-resolved if the handle is used with a different registry (the cached index is tagged with HistoryRegistry::id()).
+		Resolution is thread-safe, so handles can be members of objects shared between threads.
+		*/
+		class VariableHandle {
+		public:
+			typedef HistoryRegistry::index_t index_t;
+
+			/** @throw std::domain_error If name is empty */
+			explicit VariableHandle(const std::string& name);
+
+			VariableHandle(const VariableHandle& other);
+
+			VariableHandle& operator=(const VariableHandle& other);
+
+			/** Variable name */
+			const std::string& name() const {
+				return name_;
+			}
+
+			/** Index of the variable in registry.
+			@throw std::domain_error If the variable is not registered.
+			*/
+			index_t index(const HistoryRegistry& registry) const {
+				const uint64_t resolved = resolved_.load(std::memory_order_relaxed);
+				if (static_cast<uint32_t>(resolved >> 32) == registry.id()) {
+					return static_cast<index_t>(resolved & INDEX_MASK);
+				}
+				return resolve(registry);
+			}
+
+			/** Find the index of the variable in registry.
+			@param[out] idx Index, set if the variable is registered
+			@return Whether the variable is registered
+			*/
+			bool find_index(const HistoryRegistry& registry, index_t& idx) const {
+				const uint64_t resolved = resolved_.load(std::memory_order_relaxed);
+				if (static_cast<uint32_t>(resolved >> 32) == registry.id()) {
+					idx = static_cast<index_t>(resolved & INDEX_MASK);
+					return true;
+				}
+				if (!registry.has_variable(name_)) {
+					return false;
+				}
+				idx = resolve(registry);
+				return true;
+			}
+		private:
+			static const uint64_t INDEX_MASK = 0xFFFFFFFF;
+
+			/** Look the name up in registry and cache the index */
+			index_t resolve(const HistoryRegistry& registry) const;
+
+			std::string name_;
+			mutable std::atomic<uint64_t> resolved_; /**< (registry ID << 32) | index, or 0 if not resolved yet */
+		};
+	}
+}
+
+#endif // __AVERISERA_MS_VARIABLE_HANDLE_H
@@ -0,0 +1,46 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/background_file_writer.hpp"
+#include "testing/temporary_file.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace averisera;
+
+static std::string read_file(const std::string& filename) {
+	std::ifstream ifs(filename);
+	std::stringstream ss;
+	ss << ifs.rdbuf();
+	return ss.str();
+}
+
+TEST(BackgroundFileWriter, Write) {
+	averisera::testing::TemporaryFile tmp;
+	BackgroundFileWriter writer;
+	writer.write(tmp.filename, "old", false);
+	writer.write(tmp.filename, "a\n", false);
+	for (int i = 0; i < 100; ++i) {
+		writer.write(tmp.filename, "b", true);
+	}
+	writer.flush();
+	ASSERT_EQ(std::string("a\n") + std::string(100, 'b'), read_file(tmp.filename));
+}
+
+TEST(BackgroundFileWriter, Error) {
+	BackgroundFileWriter writer;
+	writer.write("/nonexistent_directory/file.txt", "a", false);
+	ASSERT_THROW(writer.flush(), std::runtime_error);
+	writer.flush();
+}
+
+TEST(BackgroundFileWriter, ContentWriter) {
+	averisera::testing::TemporaryFile tmp;
+	BackgroundFileWriter writer;
+	writer.write(tmp.filename, [](std::ostream& os) { os << "a" << 1 << "\n"; }, false);
+	writer.write(tmp.filename, "b", true);
+	writer.flush();
+	ASSERT_EQ(std::string("a1\nb"), read_file(tmp.filename));
+	writer.write(tmp.filename, [](std::ostream&) { throw std::runtime_error("formatting failed"); }, true);
+	ASSERT_THROW(writer.flush(), std::runtime_error);
+}
@@ -0,0 +1,59 @@
+/*
+* (C) Averisera Ltd 2019
+*/
+#include <gtest/gtest.h>
+#include "core/bounded_object_cache.hpp"
+
+using namespace averisera;
+
+TEST(BoundedObjectCache, test) {
+	BoundedObjectCache<const double, int> cache(2);
+	ASSERT_EQ(2u, cache.max_size());
+	unsigned int nbr_calls = 0;
+	auto make = [&nbr_calls](double x) { return [&nbr_calls, x]() { ++nbr_calls; return std::make_shared<const double>(x); }; };
+	const auto a = cache.get(1, make(0.1));
+	ASSERT_EQ(0.1, *a);
+	ASSERT_EQ(a, cache.get(1, make(0.5)));
+	ASSERT_EQ(1u, nbr_calls);
+	ASSERT_EQ(1u, cache.hits());
+	ASSERT_EQ(1u, cache.misses());
+	const auto b = cache.get(2, make(0.2));
+	ASSERT_EQ(2u, cache.size());
+	// full: the least recently used object 1 is evicted, although a still holds it
+	const auto c = cache.get(3, make(0.3));
+	ASSERT_EQ(0.3, *c);
+	ASSERT_EQ(2u, cache.size());
+	ASSERT_EQ(c, cache.get(3, make(0.4)));
+	ASSERT_EQ(0.1, *a);
+	ASSERT_EQ(3u, cache.misses());
+	ASSERT_EQ(b, cache.get(2, make(0.5)));
+	// 3 is now the least recently used
+	ASSERT_EQ(0.6, *cache.get(1, make(0.6)));
+	ASSERT_EQ(b, cache.get(2, make(0.7)));
+	ASSERT_EQ(0.8, *cache.get(3, make(0.8)));
+	ASSERT_EQ(5u, cache.misses());
+	ASSERT_EQ(4u, cache.hits());
+}
+
+TEST(BoundedObjectCache, EvictsOneEntryWhenFull) {
+	BoundedObjectCache<const double, int> cache(100);
+	auto make = [](double x) { return [x]() { return std::make_shared<const double>(x); }; };
+	for (int i = 0; i < 100; ++i) {
+		cache.get(i, make(i));
+	}
+	cache.get(100, make(100));
+	ASSERT_EQ(100u, cache.size());
+	// only object 0 was evicted, the rest are still cached
+	for (int i = 1; i <= 100; ++i) {
+		ASSERT_EQ(static_cast<double>(i), *cache.get(i, make(-1)));
+	}
+	ASSERT_EQ(100u, cache.hits());
+	ASSERT_EQ(101u, cache.misses());
+}
+
+TEST(BoundedObjectCache, Disabled) {
+	BoundedObjectCache<const double, int> cache(0);
+	const auto a = cache.get(1, []() { return std::make_shared<const double>(1.0); });
+	ASSERT_EQ(1.0, *a);
+	ASSERT_EQ(0u, cache.size());
+}
@@ -0,0 +1,88 @@
+// (C) Averisera Ltd 2014-2020
+#include "core/date_table.hpp"
+#include "core/dates.hpp"
+#include "core/daycount.hpp"
+#include "core/period.hpp"
+#include <gtest/gtest.h>
+
+using namespace averisera;
+
+TEST(DateTable, Range) {
+	ASSERT_EQ(Date::MIN.julian_day(), static_cast<long>(DateTable::FIRST_DAY));
+	ASSERT_EQ(Date::MAX.julian_day(), static_cast<long>(DateTable::LAST_DAY));
+	ASSERT_TRUE(DateTable::contains(Date::MIN.day_number()));
+	ASSERT_TRUE(DateTable::contains(Date::MAX.day_number()));
+	ASSERT_FALSE(DateTable::contains(Date::NAD.day_number()));
+	ASSERT_FALSE(DateTable::contains(Date::POS_INF.day_number()));
+	ASSERT_FALSE(DateTable::contains(Date::NEG_INF.day_number()));
+}
+
+TEST(DateTable, Calendar) {
+	for (int y : { 1400, 1600, 1899, 1900, 1999, 2000, 2015, 2016, 9999 }) {
+		const boost::gregorian::date jan1(static_cast<unsigned short>(y), 1, 1);
+		ASSERT_EQ(jan1.day_number(), DateTable::day_number_of_jan1(static_cast<unsigned int>(y))) << y;
+		ASSERT_EQ(boost::gregorian::gregorian_calendar::is_leap_year(static_cast<unsigned short>(y)), DateTable::is_leap(static_cast<unsigned int>(y))) << y;
+		const int year_length = DateTable::is_leap(static_cast<unsigned int>(y)) ? 366 : 365;
+		for (int i = 0; i < year_length; ++i) {
+			const boost::gregorian::date bd = jan1 + boost::gregorian::days(i);
+			const Date d(bd);
+			ASSERT_EQ(bd.year(), d.year()) << bd;
+			ASSERT_EQ(bd.month(), d.month()) << bd;
+			ASSERT_EQ(bd.day(), d.day()) << bd;
+			ASSERT_EQ(bd.day_of_year(), d.day_of_year()) << bd;
+			ASSERT_EQ(bd.julian_day(), d.julian_day()) << bd;
+		}
+	}
+}
+
+TEST(DateTable, FullYears) {
+	const std::vector<Date> dobs({ Date(2015, 2, 28), Date(2016, 2, 28), Date(2016, 2, 29), Date(2016, 3, 1), Date(2015, 3, 1), Date(1999, 12, 31), Date(2000, 1, 1), Date(1900, 2, 28) });
+	for (Date dob : dobs) {
+		for (int i = 0; i < 12000; i += 7) {
+			for (int j = 0; j < 3; ++j) {
+				const Date asof = dob + Period::days(i + j);
+				int k = 0;
+				while (dob + Period::years(k + 1) <= asof) {
+					++k;
+				}
+				ASSERT_EQ(static_cast<unsigned int>(k), DateTable::full_years(dob.day_number(), asof.day_number())) << dob << " " << asof;
+				ASSERT_EQ(k, dob.dist_years(asof)) << dob << " " << asof;
+				ASSERT_EQ(-k, asof.dist_years(dob)) << dob << " " << asof;
+			}
+		}
+	}
+	// end of February is preserved when adding years
+	ASSERT_EQ(0u, DateTable::full_years(Date(2015, 2, 28).day_number(), Date(2016, 2, 28).day_number()));
+	ASSERT_EQ(1u, DateTable::full_years(Date(2015, 2, 28).day_number(), Date(2016, 2, 29).day_number()));
+	ASSERT_EQ(1u, DateTable::full_years(Date(2016, 2, 29).day_number(), Date(2017, 2, 28).day_number()));
+	ASSERT_EQ(3u, DateTable::full_years(Date(2016, 2, 29).day_number(), Date(2019, 2, 28).day_number()));
+}
+
+static double reference_year_fract(Date d1, Date d2) {
+	if (d2 < d1) {
+		return -reference_year_fract(d2, d1);
+	}
+	const boost::gregorian::date b1(d1.year_month_day());
+	const boost::gregorian::date b2(d2.year_month_day());
+	const auto basis = [](int y) { return boost::gregorian::gregorian_calendar::is_leap_year(static_cast<unsigned short>(y)) ? 366.0 : 365.0; };
+	if (b2.year() > b1.year()) {
+		const double head_fract = 1.0 - static_cast<double>(b1.day_of_year() - 1) / basis(b1.year());
+		const double tail_fract = static_cast<double>(b2.day_of_year() - 1) / basis(b2.year());
+		return static_cast<double>(b2.year() - b1.year() - 1) + (head_fract + tail_fract);
+	} else {
+		return static_cast<double>((b2 - b1).days()) / basis(b1.year());
+	}
+}
+
+TEST(DateTable, YearFract) {
+	const auto daycount = Daycount::YEAR_FRACT();
+	const Date d1(2015, 2, 28);
+	for (int i = -800; i < 800; i += 3) {
+		const Date d2 = d1 + Period::days(i);
+		const Date d3 = d1 + Period::days(i * 17);
+		ASSERT_EQ(reference_year_fract(d1, d2), Daycount::year_fract(d1, d2)) << d2;
+		ASSERT_EQ(reference_year_fract(d3, d2), Daycount::year_fract(d3, d2)) << d3 << " " << d2;
+		ASSERT_EQ(daycount->calc(d3, d2), Daycount::year_fract(d3, d2)) << d3 << " " << d2;
+	}
+	ASSERT_EQ(1.0, Daycount::year_fract(Date(2015, 1, 1), Date(2016, 1, 1)));
+}
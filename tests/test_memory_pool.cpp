@@ -0,0 +1,103 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/memory_pool.hpp"
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace averisera;
+
+TEST(MemoryPool, Constructor) {
+	ASSERT_THROW(MemoryPool(MemoryPool::MAX_BLOCK_SIZE - 1), std::domain_error);
+}
+
+TEST(MemoryPool, AllocateDeallocate) {
+	MemoryPool pool(4096);
+	std::vector<void*> blocks;
+	for (size_t size = 1; size <= 200; ++size) {
+		void* ptr = pool.allocate(size);
+		ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % MemoryPool::ALIGNMENT) << size;
+		blocks.push_back(ptr);
+	}
+	ASSERT_EQ(200u, std::set<void*>(blocks.begin(), blocks.end()).size());
+	ASSERT_EQ(200u, pool.nbr_blocks());
+	const size_t nbr_chunks = pool.nbr_chunks();
+	ASSERT_GT(nbr_chunks, 1u);
+	for (size_t size = 1; size <= 200; ++size) {
+		pool.deallocate(blocks[size - 1], size);
+	}
+	ASSERT_EQ(0u, pool.nbr_blocks());
+	// freed blocks are reused
+	for (size_t size = 1; size <= 200; ++size) {
+		pool.allocate(size);
+	}
+	ASSERT_EQ(nbr_chunks, pool.nbr_chunks());
+	void* large = pool.allocate(MemoryPool::MAX_BLOCK_SIZE + 1);
+	ASSERT_EQ(nbr_chunks, pool.nbr_chunks());
+	ASSERT_EQ(201u, pool.nbr_blocks());
+	pool.deallocate(large, MemoryPool::MAX_BLOCK_SIZE + 1);
+	ASSERT_EQ(200u, pool.nbr_blocks());
+}
+
+TEST(MemoryPool, ConcurrentThreads) {
+	MemoryPool pool(4096);
+	const size_t nbr_threads = 4;
+	const size_t nbr_blocks = 1000;
+	std::vector<std::vector<void*>> blocks(nbr_threads);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < nbr_threads; ++t) {
+		threads.push_back(std::thread([&pool, &blocks, t]() {
+			for (size_t i = 0; i < nbr_blocks; ++i) {
+				blocks[t].push_back(pool.allocate(8 + i % 64));
+			}
+		}));
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	ASSERT_EQ(nbr_threads * nbr_blocks, pool.nbr_blocks());
+	std::set<void*> distinct;
+	for (const auto& thread_blocks : blocks) {
+		distinct.insert(thread_blocks.begin(), thread_blocks.end());
+	}
+	ASSERT_EQ(nbr_threads * nbr_blocks, distinct.size());
+	// free blocks allocated by other threads
+	threads.clear();
+	for (size_t t = 0; t < nbr_threads; ++t) {
+		threads.push_back(std::thread([&pool, &blocks, t]() {
+			const auto& thread_blocks = blocks[(t + 1) % nbr_threads];
+			for (size_t i = 0; i < nbr_blocks; ++i) {
+				pool.deallocate(thread_blocks[i], 8 + i % 64);
+			}
+		}));
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	ASSERT_EQ(0u, pool.nbr_blocks());
+}
+
+TEST(PoolAllocator, AllocateShared) {
+	auto pool = std::make_shared<MemoryPool>();
+	ASSERT_THROW(PoolAllocator<int>(nullptr), std::domain_error);
+	{
+		const PoolAllocator<double> alloc(pool);
+		ASSERT_EQ(alloc, PoolAllocator<int>(alloc));
+		ASSERT_NE(alloc, PoolAllocator<double>(std::make_shared<MemoryPool>()));
+	}
+	std::shared_ptr<double> x = std::allocate_shared<double>(PoolAllocator<double>(pool), 2.5);
+	ASSERT_EQ(2.5, *x);
+	ASSERT_EQ(1u, pool->nbr_blocks());
+	std::weak_ptr<MemoryPool> weak_pool(pool);
+	pool.reset();
+	// the control block keeps the pool alive
+	ASSERT_FALSE(weak_pool.expired());
+	x.reset();
+	ASSERT_TRUE(weak_pool.expired());
+	std::vector<int, PoolAllocator<int>> v(PoolAllocator<int>(std::make_shared<MemoryPool>()));
+	for (int i = 0; i < 1000; ++i) {
+		v.push_back(i);
+	}
+	ASSERT_EQ(999, v.back());
+}
@@ -0,0 +1,19 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/rng_impl.hpp"
+#include <sstream>
+
+using namespace averisera;
+
+TEST(RNGImpl, SaveLoadState) {
+    RNGImpl rng(7);
+    rng.next_gaussian();
+    std::stringstream ss;
+    rng.save_state(ss);
+    RNGImpl restored;
+    restored.load_state(ss);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(rng.next_gaussian(), restored.next_gaussian()) << i;
+        ASSERT_EQ(rng.next_uniform(), restored.next_uniform()) << i;
+    }
+}
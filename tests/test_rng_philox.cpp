@@ -0,0 +1,165 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/rng_philox.hpp"
+#include <sstream>
+#include <vector>
+
+using namespace averisera;
+
+TEST(RNGPhilox, KnownAnswers) {
+	// Known-answer tests from the Random123 library
+	const RNGPhilox::counter_type zero = RNGPhilox::encrypt({ 0, 0, 0, 0 }, { 0, 0 });
+	ASSERT_EQ(RNGPhilox::counter_type({ 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u }), zero);
+	const RNGPhilox::counter_type ones = RNGPhilox::encrypt({ 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }, { 0xffffffffu, 0xffffffffu });
+	ASSERT_EQ(RNGPhilox::counter_type({ 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu }), ones);
+}
+
+TEST(RNGPhilox, Discard) {
+	for (unsigned long long skip : { 0ull, 1ull, 2ull, 3ull, 10ull }) {
+		RNGPhilox rng1(7, 3);
+		RNGPhilox rng2(7, 3);
+		rng1.rand_int();
+		rng2.rand_int();
+		for (unsigned long long i = 0; i < skip; ++i) {
+			rng1.rand_int();
+		}
+		rng2.discard(skip);
+		ASSERT_EQ(rng1.rand_int(), rng2.rand_int()) << skip;
+	}
+}
+
+TEST(RNGPhilox, Streams) {
+	RNGPhilox rng1(7, 0);
+	RNGPhilox rng2(7, 1);
+	RNGPhilox rng3(8, 0);
+	RNGPhilox rng4(7, 0);
+	const auto x1 = rng1.rand_int();
+	ASSERT_NE(x1, rng2.rand_int());
+	ASSERT_NE(x1, rng3.rand_int());
+	ASSERT_EQ(x1, rng4.rand_int());
+}
+
+TEST(RNGPhilox, Uniform) {
+	RNGPhilox rng;
+	const size_t n = 100000;
+	double sum = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const double u = rng.next_uniform();
+		ASSERT_GE(u, 0.0);
+		ASSERT_LT(u, 1.0);
+		sum += u;
+	}
+	ASSERT_NEAR(0.5, sum / static_cast<double>(n), 0.005);
+	for (size_t i = 0; i < 1000; ++i) {
+		ASSERT_LE(rng.next_uniform(RNG::int_type(6)), 6u);
+	}
+}
+
+TEST(RNGPhilox, Gaussian) {
+	RNGPhilox rng(123);
+	const size_t n = 100000;
+	double sum = 0;
+	double sum2 = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const double x = rng.next_gaussian();
+		sum += x;
+		sum2 += x * x;
+	}
+	ASSERT_NEAR(0.0, sum / static_cast<double>(n), 0.01);
+	ASSERT_NEAR(1.0, sum2 / static_cast<double>(n), 0.01);
+}
+
+TEST(RNGPhilox, FillUniform) {
+	for (size_t offset : { 0, 1, 2, 3 }) {
+		for (size_t n : { 0, 1, 2, 5, 64, 129, 300 }) {
+			RNGPhilox rng1(11, 5);
+			RNGPhilox rng2(11, 5);
+			for (size_t i = 0; i < offset; ++i) {
+				rng1.next_uniform();
+				rng2.next_uniform();
+			}
+			std::vector<double> x(n);
+			rng1.fill_uniform(x.data(), n);
+			for (size_t i = 0; i < n; ++i) {
+				ASSERT_EQ(rng2.next_uniform(), x[i]) << offset << " " << n << " " << i;
+			}
+			ASSERT_EQ(rng2.rand_int(), rng1.rand_int());
+		}
+	}
+}
+
+TEST(RNGPhilox, FillGaussian) {
+	for (size_t offset : { 0, 1, 2 }) {
+		for (size_t n : { 0, 1, 2, 7, 200 }) {
+			RNGPhilox rng1(11, 5);
+			RNGPhilox rng2(11, 5);
+			for (size_t i = 0; i < offset; ++i) {
+				rng1.next_gaussian();
+				rng2.next_gaussian();
+			}
+			std::vector<double> x(n);
+			rng1.fill_gaussian(x.data(), n);
+			for (size_t i = 0; i < n; ++i) {
+				ASSERT_NEAR(rng2.next_gaussian(), x[i], 1E-15) << offset << " " << n << " " << i;
+			}
+			ASSERT_EQ(rng2.next_gaussian(), rng1.next_gaussian());
+		}
+	}
+}
+
+TEST(RNGPhilox, Split) {
+	const RNGPhilox rng(7, 3);
+	RNGPhilox parent(rng);
+	RNGPhilox child1 = rng.split(0);
+	RNGPhilox child1b = rng.split(0);
+	RNGPhilox child2 = rng.split(1);
+	RNGPhilox other_parent(7, 4);
+	RNGPhilox other_child = other_parent.split(0);
+	const auto x1 = child1.rand_int();
+	ASSERT_EQ(x1, child1b.rand_int());
+	ASSERT_NE(x1, child2.rand_int());
+	ASSERT_NE(x1, parent.rand_int());
+	ASSERT_NE(x1, other_child.rand_int());
+}
+
+TEST(RNGPhilox, Jump) {
+	RNGPhilox rng1(7, 3);
+	RNGPhilox rng2(7, 3);
+	rng1.rand_int();
+	rng2.rand_int();
+	rng1.jump();
+	rng2.discard(RNGPhilox::JUMP_SIZE);
+	ASSERT_EQ(rng1.rand_int(), rng2.rand_int());
+	RNGPhilox rng3(7, 3);
+	rng3.rand_int();
+	ASSERT_NE(rng3.rand_int(), rng1.rand_int());
+	// 8 jumps bring the 64-bit block counter back to the same position
+	for (int i = 0; i < 7; ++i) {
+		rng1.jump();
+	}
+	RNGPhilox rng4(7, 3);
+	rng4.discard(3);
+	ASSERT_EQ(rng4.rand_int(), rng1.rand_int());
+}
+
+TEST(RNGPhilox, MakeKey) {
+	ASSERT_EQ(RNGPhilox::make_key(1, 2, 3), RNGPhilox::make_key(1, 2, 3));
+	ASSERT_NE(RNGPhilox::make_key(1, 2, 3), RNGPhilox::make_key(1, 3, 2));
+	ASSERT_NE(RNGPhilox::make_key(1, 2, 3), RNGPhilox::make_key(2, 2, 3));
+}
+
+TEST(RNGPhilox, SaveLoadState) {
+    RNGPhilox rng(12, 3);
+    rng.next_uniform();
+    rng.next_gaussian(); // leaves a spare Gaussian
+    std::stringstream ss;
+    rng.save_state(ss);
+    RNGPhilox restored;
+    restored.load_state(ss);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(rng.next_gaussian(), restored.next_gaussian()) << i;
+        ASSERT_EQ(rng.rand_int(), restored.rand_int()) << i;
+    }
+    std::stringstream bad("1 2");
+    ASSERT_THROW(restored.load_state(bad), std::runtime_error);
+}
@@ -0,0 +1,85 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/running_quantiles.hpp"
+#include "core/statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace averisera;
+
+TEST(RunningQuantiles, Empty) {
+	RunningQuantiles<double> rq;
+	ASSERT_EQ(0u, rq.nbr_samples());
+	ASSERT_TRUE(std::isnan(rq.median()));
+	ASSERT_THROW(rq.quantile(-0.1), std::domain_error);
+	ASSERT_THROW(rq.quantile(1.1), std::domain_error);
+	ASSERT_THROW(RunningQuantiles<double>(1), std::domain_error);
+}
+
+TEST(RunningQuantiles, Exact) {
+	RunningQuantiles<double> rq(16);
+	std::vector<double> sample({ 3.0, -1.0, 2.5, 10.0, 0.5, 7.0, 4.0 });
+	for (double x : sample) {
+		rq.add(x);
+	}
+	ASSERT_FALSE(rq.add_if_not_nan(std::numeric_limits<double>::quiet_NaN()));
+	ASSERT_EQ(sample.size(), rq.nbr_samples());
+	ASSERT_EQ(Statistics::median(sample), rq.median());
+	sample.push_back(1.0);
+	rq.add(1.0);
+	ASSERT_EQ(Statistics::median(sample), rq.median());
+	ASSERT_EQ(-1.0, rq.quantile(0));
+	ASSERT_EQ(10.0, rq.quantile(1));
+}
+
+TEST(RunningQuantiles, ExactCapacity) {
+	RunningQuantiles<double> rq(RunningQuantiles<double>::EXACT);
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<double> dist(0, 1);
+	std::vector<double> sample(5000);
+	for (double& x : sample) {
+		x = dist(rng);
+		rq.add(x);
+	}
+	ASSERT_EQ(sample.size(), rq.nbr_stored());
+	ASSERT_EQ(Statistics::median(sample), rq.median());
+}
+
+TEST(RunningQuantiles, Approximate) {
+	const size_t n = 100000;
+	RunningQuantiles<double> rq(200);
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> dist(0.0, 1.0);
+	std::vector<double> sample(n);
+	for (size_t i = 0; i < n; ++i) {
+		sample[i] = dist(rng);
+		rq.add(sample[i]);
+	}
+	ASSERT_EQ(n, rq.nbr_samples());
+	ASSERT_LT(rq.nbr_stored(), 200u * 12);
+	std::sort(sample.begin(), sample.end());
+	for (double q : { 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99 }) {
+		const double estimate = rq.quantile(q);
+		const double rank = static_cast<double>(std::lower_bound(sample.begin(), sample.end(), estimate) - sample.begin()) / static_cast<double>(n);
+		ASSERT_NEAR(q, rank, 0.02) << q;
+	}
+}
+
+TEST(RunningQuantiles, Merge) {
+	RunningQuantiles<double> rq1(64);
+	RunningQuantiles<double> rq2(64);
+	RunningQuantiles<double> rq_all(64);
+	for (int i = 0; i < 1000; ++i) {
+		const double x = static_cast<double>((i * 7919) % 1000);
+		(i % 3 ? rq1 : rq2).add(x);
+		rq_all.add(x);
+	}
+	rq1.merge(rq2);
+	ASSERT_EQ(1000u, rq1.nbr_samples());
+	ASSERT_NEAR(rq_all.median(), rq1.median(), 30.0);
+	ASSERT_NEAR(499.5, rq1.median(), 30.0);
+	ASSERT_THROW(rq1.merge(RunningQuantiles<double>(32)), std::domain_error);
+}
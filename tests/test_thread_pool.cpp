@@ -0,0 +1,40 @@
+// (C) Averisera Ltd 2014-2020
+#include <gtest/gtest.h>
+#include "core/thread_pool.hpp"
+#include <stdexcept>
+#include <vector>
+
+using namespace averisera;
+
+TEST(ThreadPool, Constructor) {
+	ASSERT_THROW(ThreadPool(0), std::domain_error);
+	ThreadPool pool(3);
+	ASSERT_EQ(3u, pool.nbr_threads());
+	ASSERT_GE(ThreadPool::hardware_concurrency(), 1u);
+}
+
+TEST(ThreadPool, ForEachIndex) {
+	ThreadPool pool(4);
+	for (size_t n : { 0, 1, 5, 1001 }) {
+		std::vector<int> visits(n, 0);
+		pool.for_each_index(n, [&visits](size_t i) { ++visits[i]; }, 10);
+		for (int v : visits) {
+			ASSERT_EQ(1, v);
+		}
+	}
+}
+
+TEST(ThreadPool, Exception) {
+	ThreadPool pool(2);
+	ASSERT_THROW(pool.for_each_index(100, [](size_t i) {
+		if (i == 50) {
+			throw std::runtime_error("error");
+		}
+	}), std::runtime_error);
+	// pool remains usable
+	std::vector<int> visits(100, 0);
+	pool.for_each_index(visits.size(), [&visits](size_t i) { visits[i] = 1; });
+	for (int v : visits) {
+		ASSERT_EQ(1, v);
+	}
+}